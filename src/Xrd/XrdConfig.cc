@@ -1709,6 +1709,7 @@ int XrdConfig::xmaxfd(XrdSysError *eDest, XrdOucStream &Config)
 
    Purpose:  To parse directive: network [tls] [[no]keepalive] [buffsz <blen>]
                                          [kaparms parms] [cache <ct>] [[no]dnr]
+                                         [dnswait <dt>]
                                          [routes <rtype> [use <ifn1>,<ifn2>]]
                                          [[no]rpipa] [[no]dyndns]
 
@@ -1719,6 +1720,10 @@ int XrdConfig::xmaxfd(XrdSysError *eDest, XrdOucStream &Config)
              kaparms   keepalive paramters as specified by parms.
              <blen>    is the socket's send/rcv buffer size.
              <ct>      Seconds to cache address to name resolutions.
+             <dt>      Seconds to wait for a name resolution that is not cached
+                       (default 5). When it takes longer, the client's host
+                       name is its numeric address for the whole connection,
+                       which host-based authorization then sees as well.
              [no]dnr   do [not] perform a reverse DNS lookup if not needed.
              routes    specifies the network configuration (see reference)
              [no]rpipa do [not] resolve private IP addresses.
@@ -1731,7 +1736,7 @@ int XrdConfig::xnet(XrdSysError *eDest, XrdOucStream &Config)
 {
     char *val;
     int  i, n, V_keep = -1, V_nodnr = 0, V_istls = 0, V_blen = -1, V_ct = -1;
-    int   V_assumev4 = -1, v_rpip = -1, V_dyndns = -1;
+    int   V_assumev4 = -1, v_rpip = -1, V_dyndns = -1, V_dw = -1;
     long long llp;
     struct netopts {const char *opname; int hasarg; int opval;
                            int *oploc;  const char *etxt;}
@@ -1744,6 +1749,7 @@ int XrdConfig::xnet(XrdSysError *eDest, XrdOucStream &Config)
         {"buffsz",     1, 0, &V_blen,   "network buffsz"},
         {"cache",      2, 0, &V_ct,     "cache time"},
         {"dnr",        0, 0, &V_nodnr,  "option"},
+        {"dnswait",    2, 0, &V_dw,     "dns wait time"},
         {"nodnr",      0, 1, &V_nodnr,  "option"},
         {"dyndns",     0, 1, &V_dyndns, "option"},
         {"nodyndns",   0, 0, &V_dyndns, "option"},
@@ -1825,6 +1831,7 @@ int XrdConfig::xnet(XrdSysError *eDest, XrdOucStream &Config)
          XrdNetAddr::SetDynDNS(V_dyndns != 0);
         }
      if (V_ct >= 0) XrdNetAddr::SetCache(V_ct);
+     if (V_dw >= 0) XrdNetAddr::SetCacheWait(V_dw);
 
      if (v_rpip >= 0) XrdInet::netIF.SetRPIPA(v_rpip != 0);
      if (V_assumev4 >= 0) XrdInet::SetAssumeV4(true);
@@ -82,6 +82,25 @@ class XrdCksCalcadler32 : public XrdCksCalc
 {
 public:
 
+// Fold in the checksum of the data that immediately follows ours, computed
+// separately, as if the data had been passed to Update(). Derived from zlib.
+//
+void        Combine(XrdCksCalcadler32 &next, long long nextLen)
+                   {unsigned int rem, sum1;
+                    unsigned long long sum2;
+                    rem  = static_cast<unsigned int>(nextLen % AdlerBase);
+                    sum1 = unSum1;
+                    sum2 = (static_cast<unsigned long long>(rem)*sum1) % AdlerBase;
+                    sum1 += next.unSum1 + AdlerBase - 1;
+                    sum2 += unSum2 + next.unSum2 + AdlerBase - rem;
+                    if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+                    if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+                    if (sum2 >= (AdlerBase << 1)) sum2 -= (AdlerBase << 1);
+                    if (sum2 >= AdlerBase) sum2 -= AdlerBase;
+                    unSum1 = sum1;
+                    unSum2 = static_cast<unsigned int>(sum2);
+                   }
+
 char *Final()
             {AdlerValue = (unSum2 << 16) | unSum1;
 #ifndef Xrd_Big_Endian
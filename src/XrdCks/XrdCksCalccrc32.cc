@@ -176,3 +176,54 @@ void XrdCksCalccrc32::Update(const char *p, int reclen)
         C32Result = (C32Result<<8) 
                   ^ crctable[(unsigned char)((C32Result>>24)^*p++)];
 }
+
+/******************************************************************************/
+/*                               C o m b i n e                                */
+/******************************************************************************/
+
+namespace
+{
+// The CRC-32 polynomial. Unlike crc32c, this checksum is not reflected so
+// polynomials are held with x^31 in the most significant bit.
+//
+const unsigned int C32Poly = 0x04C11DB7;
+
+// Multiply two polynomials modulo the CRC polynomial
+//
+unsigned int MultModP(unsigned int a, unsigned int b)
+{
+   unsigned int p = 0;
+
+   for (int i = 31; i >= 0; i--)
+       {p = (p & 0x80000000 ? (p << 1) ^ C32Poly : p << 1);
+        if (a & (1U << i)) p ^= b;
+       }
+   return p;
+}
+
+// Compute x^(8*n) modulo the CRC polynomial, i.e. the effect of n bytes
+//
+unsigned int XPowModP(long long n)
+{
+   unsigned int p = 1, x2n = 2; // x^0 and x^1
+
+   for (int k = 0; k < 3; k++) x2n = MultModP(x2n, x2n);
+   while(n)
+        {if (n & 1) p = MultModP(x2n, p);
+         x2n = MultModP(x2n, x2n);
+         n >>= 1;
+        }
+   return p;
+}
+}
+
+// The running value starts at zero and is not inverted until Final() so it is
+// linear in the data: shifting ours by the length of the next segment and
+// adding the next segment's value gives the value of the concatenation.
+//
+void XrdCksCalccrc32::Combine(XrdCksCalccrc32 &next, long long nextLen)
+{
+   if (nextLen > 0)
+      C32Result = MultModP(XPowModP(nextLen), C32Result) ^ next.C32Result;
+   TotLen += next.TotLen;
+}
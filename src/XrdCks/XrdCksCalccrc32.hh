@@ -42,6 +42,11 @@ class XrdCksCalccrc32 : public XrdCksCalc
 {
 public:
 
+// Fold in the checksum of the data that immediately follows ours, computed
+// separately, as if the data had been passed to Update().
+//
+void        Combine(XrdCksCalccrc32 &next, long long nextLen);
+
 char *Final() {char buff[sizeof(long long)];
                long long tLcs = TotLen;
                int i = 0;
@@ -17,6 +17,52 @@
 
 */
 
+namespace
+{
+// CRC-32C polynomial in reversed bit order. Polynomials are held with x^0 in
+// the most significant bit, as the checksum itself is.
+//
+const unsigned int C32CPoly = 0x82F63B78;
+
+// Multiply two polynomials modulo the CRC polynomial
+//
+unsigned int MultModP(unsigned int a, unsigned int b)
+{
+    unsigned int m = 1U << 31, p = 0;
+
+    while(true)
+         {if (a & m)
+             {p ^= b;
+              if ((a & (m - 1)) == 0) break;
+             }
+          m >>= 1;
+          b = (b & 1 ? (b >> 1) ^ C32CPoly : b >> 1);
+         }
+    return p;
+}
+
+// Compute x^(8*n) modulo the CRC polynomial, i.e. the effect of n bytes
+//
+unsigned int XPowModP(long long n)
+{
+    unsigned int p = 1U << 31, x2n = 1U << 30; // x^0 and x^1
+
+    for (int k = 0; k < 3; k++) x2n = MultModP(x2n, x2n);
+    while(n)
+         {if (n & 1) p = MultModP(x2n, p);
+          x2n = MultModP(x2n, x2n);
+          n >>= 1;
+         }
+    return p;
+}
+}
+
+void XrdCksCalccrc32C::Combine(XrdCksCalccrc32C &next, long long nextLen)
+{
+    if (nextLen > 0)
+       C32CResult = MultModP(XPowModP(nextLen), C32CResult) ^ next.C32CResult;
+}
+
 void XrdCksCalccrc32C::Update(const char *Buff, int BLen)
 {
     C32CResult = (unsigned int)XrdOucCRC::Calc32C(Buff, BLen, C32CResult);
@@ -42,6 +42,10 @@
 class XrdCksCalccrc32C : public XrdCksCalc
 {
 public:
+    // Fold in the checksum of the data that immediately follows ours,
+    // computed separately, as if the data had been passed to Update().
+    void Combine(XrdCksCalccrc32C &next, long long nextLen);
+
     char *Final();
     
     void Init();
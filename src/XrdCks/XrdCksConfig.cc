@@ -114,7 +114,8 @@ XrdCks *XrdCksConfig::addCks(XrdCks *pCks, XrdOucEnv *envP)
 /******************************************************************************/
   
 XrdCks *XrdCksConfig::Configure(const char *dfltCalc, int rdsz,
-                                XrdOss *ossP, XrdOucEnv *envP)
+                                XrdOss *ossP, XrdOucEnv *envP,
+                                const char *calcOpts)
 {
    XrdCks *myCks = getCks(ossP, rdsz);
    XrdOucTList *tP = CksList;
@@ -133,6 +134,17 @@ XrdCks *XrdCksConfig::Configure(const char *dfltCalc, int rdsz,
 //
    while(tP) {NoGo |= myCks->Config("ckslib", tP->text); tP = tP->next;}
 
+// Pass along the calculation options. Only the default manager knows them.
+//
+   if (calcOpts)
+      {if (CksLib) eDest->Say("Config warning: ckscalc ignored; not supported "
+                              "by the checksum manager plugin.");
+          else {char *opts = strdup(calcOpts);
+                NoGo |= myCks->Config("ckscalc", opts);
+                free(opts);
+               }
+      }
+
 // Configure if all went well
 //
    if (!NoGo) NoGo = !myCks->Init(cfgFN, dfltCalc);
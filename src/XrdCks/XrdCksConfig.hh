@@ -45,7 +45,7 @@ class XrdCksConfig
 public:
 
 XrdCks *Configure(const char *dfltCalc=0, int rdsz=0,
-                  XrdOss *ossP=0, XrdOucEnv *envP=0);
+                  XrdOss *ossP=0, XrdOucEnv *envP=0, const char *calcOpts=0);
 
 int     Manager() {return CksLib != 0;}
 
@@ -33,7 +33,9 @@
 #include <cstring>
 #include <ctime>
 #include <cstdio>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -59,6 +61,94 @@
 #define ENOATTR ENODATA
 #endif
 
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// Feeds the same data to several checksum objects so that all of them are
+// calculated in a single pass over the file. Final() returns the value of the
+// first one; the others must be obtained from the objects themselves.
+//
+class MultiCalc : public XrdCksCalc
+{
+public:
+
+char       *Final() {return calcV[0]->Final();}
+
+void        Init() {for (int i = 0; i < calcN; i++) calcV[i]->Init();}
+
+XrdCksCalc *New()
+               {XrdCksCalc *newV[maxCalc];
+                for (int i = 0; i < calcN; i++)
+                    if (!(newV[i] = calcV[i]->New()))
+                       {while(i--) newV[i]->Recycle();
+                        return 0;
+                       }
+                return new MultiCalc(newV, calcN, true);
+               }
+
+void        Recycle()
+               {if (isOwner) for (int i = 0; i < calcN; i++) calcV[i]->Recycle();
+                delete this;
+               }
+
+const char *Type(int &csSize) {return calcV[0]->Type(csSize);}
+
+void        Update(const char *Buff, int BLen)
+                  {for (int i = 0; i < calcN; i++) calcV[i]->Update(Buff, BLen);}
+
+static const int maxCalc = 8;
+
+XrdCksCalc *calcV[maxCalc];
+int         calcN;
+bool        isOwner;
+
+            MultiCalc(XrdCksCalc **cV, int cN, bool owner=false)
+                     : calcN(cN), isOwner(owner)
+                     {for (int i = 0; i < cN; i++) calcV[i] = cV[i];}
+           ~MultiCalc() {}
+};
+
+// Fold the checksum of a segment into the checksum of the data preceding it.
+// When nextP is nil we only check whether this can be done at all, which is
+// the case for adler32, crc32 and crc32c but not for digests such as md5.
+//
+bool Combine(XrdCksCalc *csP, XrdCksCalc *nextP, long long nextLen)
+{
+   MultiCalc *mP;
+
+   if ((mP = dynamic_cast<MultiCalc *>(csP)))
+      {MultiCalc *nP = static_cast<MultiCalc *>(nextP);
+       for (int i = 0; i < mP->calcN; i++)
+           if (!Combine(mP->calcV[i], (nP ? nP->calcV[i] : 0), nextLen))
+              return false;
+       return true;
+      }
+
+   XrdCksCalcadler32 *aP;
+   if ((aP = dynamic_cast<XrdCksCalcadler32 *>(csP)))
+      {if (nextP) aP->Combine(*static_cast<XrdCksCalcadler32 *>(nextP), nextLen);
+       return true;
+      }
+
+   XrdCksCalccrc32 *cP;
+   if ((cP = dynamic_cast<XrdCksCalccrc32 *>(csP)))
+      {if (nextP) cP->Combine(*static_cast<XrdCksCalccrc32 *>(nextP), nextLen);
+       return true;
+      }
+
+   XrdCksCalccrc32C *c2P;
+   if ((c2P = dynamic_cast<XrdCksCalccrc32C *>(csP)))
+      {if (nextP) c2P->Combine(*static_cast<XrdCksCalccrc32C *>(nextP), nextLen);
+       return true;
+      }
+
+   return false;
+}
+}
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -83,6 +173,7 @@ XrdCksManager::XrdCksManager(XrdSysError *erP, int rdsz, XrdVersionInfo &vInfo,
 
 // Compute the i/o size
 //
+   parThreads = 1;
    if (rdsz <= 65536) segSize = 67108864;
       else segSize = ((rdsz/65536) + (rdsz%65536 != 0)) * 65536;
 }
@@ -109,10 +200,10 @@ XrdCksManager::~XrdCksManager()
   
 int XrdCksManager::Calc(const char *Pfn, XrdCksData &Cks, int doSet)
 {
-   XrdCksCalc *csP;
-   csInfo *csIP = &csTab[0];
+   XrdCksCalc *csP, *calcV[csMax];
+   csInfo *csIP = &csTab[0], *csV[csMax];
    time_t MTime;
-   int rc;
+   int i, csN = 1, rc;
 
 // Determine which checksum to get
 //
@@ -123,27 +214,50 @@ int XrdCksManager::Calc(const char *Pfn, XrdCksData &Cks, int doSet)
 // If we need not set the checksum then see if we can get it from the
 // extended attributes.
 
-// Obtain a new checksum object
+// Should this checksum be calculated in the same pass as others, include
+// them. This is only useful when the results are set as well.
+//
+   csV[0] = csIP;
+   if (doSet && csIP->onePass)
+      for (i = 0; i <= csLast; i++)
+          if (csTab[i].onePass && csTab[i].Obj && &csTab[i] != csIP)
+             csV[csN++] = &csTab[i];
+
+// Obtain new checksum objects
 //
-   if (!(csP = csIP->Obj->New())) return -ENOMEM;
+   for (i = 0; i < csN; i++)
+       if (!(calcV[i] = csV[i]->Obj->New()))
+          {while(i--) calcV[i]->Recycle();
+           return -ENOMEM;
+          }
+   MultiCalc allCalc(calcV, csN);
+   csP = (csN > 1 ? &allCalc : calcV[0]);
 
 // Use the calculator to get and possibly set the checksum
 //
    if (!(rc = Calc(Pfn, MTime, csP)))
-      {memcpy(Cks.Value, csP->Final(), csIP->Len);
+      {memcpy(Cks.Value, calcV[0]->Final(), csIP->Len);
        Cks.fmTime = static_cast<long long>(MTime);
        Cks.csTime = static_cast<int>(time(0) - MTime);
        Cks.Length = csIP->Len;
-       csP->Recycle();
        if (doSet)
           {XrdOucXAttr<XrdCksXAttr> xCS;
            memcpy(&xCS.Attr.Cks, &Cks, sizeof(xCS.Attr.Cks));
-           if ((rc = xCS.Set(Pfn))) return -rc;
+           rc = -xCS.Set(Pfn);
           }
+       for (i = 1; i < csN && !rc; i++)
+           {XrdOucXAttr<XrdCksXAttr> xCS;
+            xCS.Attr.Cks = Cks;
+            xCS.Attr.Cks.Set(csV[i]->Name);
+            memcpy(xCS.Attr.Cks.Value, calcV[i]->Final(), csV[i]->Len);
+            xCS.Attr.Cks.Length = csV[i]->Len;
+            rc = -xCS.Set(Pfn);
+           }
       }
 
 // All done
 //
+   for (i = 0; i < csN; i++) calcV[i]->Recycle();
    return rc;
 }
 
@@ -158,10 +272,6 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
             ~ioFD() {if (FD >= 0) close(FD);}
         } In;
    struct stat Stat;
-   char *inBuff;
-   off_t  Offset=0, fileSize;
-   size_t ioSize, calcSize;
-   int rc;
 
 // Open the input file
 //
@@ -171,23 +281,119 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
 //
    if (fstat(In.FD, &Stat)) return -errno;
    if (!(Stat.st_mode & S_IFREG)) return -EPERM;
-   calcSize = fileSize = Stat.st_size;
    MTime = Stat.st_mtime;
 
+// Large files are checksummed in segments on several threads if allowed and
+// the partial results can be combined.
+//
+   if (parThreads > 1 && Stat.st_size >= 2*parMinSeg && Combine(csP, 0, 0))
+      return CalcPar(In.FD, Pfn, Stat.st_size, csP);
+   return CalcRange(In.FD, Pfn, 0, Stat.st_size, csP);
+}
+
+/******************************************************************************/
+/* Private:                      C a l c P a r                                */
+/******************************************************************************/
+
+int XrdCksManager::CalcPar(int FD, const char *Pfn, off_t fileSize,
+                           XrdCksCalc *csP)
+{
+   off_t segLen;
+   int i, nSeg, rc = 0;
+
+// Compute the number of segments. Each one is a multiple of the i/o size so
+// that every mapping remains page aligned.
+//
+   nSeg = (fileSize / parMinSeg < parThreads ? fileSize / parMinSeg
+                                             : parThreads);
+   segLen = ((fileSize / nSeg + segSize - 1) / segSize) * segSize;
+   nSeg   = (fileSize + segLen - 1) / segLen;
+
+// Get a checksum object for each segment but the first
+//
+   std::vector<XrdCksCalc *> segCalc(nSeg, (XrdCksCalc *)0);
+   std::vector<int>          segRC(nSeg, 0);
+   std::vector<std::thread>  segThread;
+   segCalc[0] = csP;
+   for (i = 1; i < nSeg; i++)
+       if (!(segCalc[i] = csP->New())) {rc = -ENOMEM; break;}
+
+// Checksum all of the segments, the first one on this thread. Should we not
+// be able to get a thread, we do the segment ourselves.
+//
+   if (!rc)
+      {for (i = 1; i < nSeg; i++)
+           {off_t segOff = i * segLen;
+            off_t segEnd = (segOff + segLen < fileSize ? segOff + segLen
+                                                       : fileSize);
+            try {segThread.emplace_back([=, &segRC, &segCalc]()
+                          {segRC[i] = CalcRange(FD, Pfn, segOff,
+                                                segEnd - segOff, segCalc[i]);
+                          });
+                } catch(...)
+                {segRC[i] = CalcRange(FD, Pfn, segOff, segEnd-segOff,
+                                      segCalc[i]);
+                }
+           }
+       segRC[0] = CalcRange(FD, Pfn, 0, segLen, csP);
+       for (i = 0; i < (int)segThread.size(); i++) segThread[i].join();
+      }
+
+// Fold the segments into the first one, in order
+//
+   for (i = 0; i < nSeg && !rc; i++) rc = segRC[i];
+   for (i = 1; i < nSeg && !rc; i++)
+       {off_t segOff = i * segLen;
+        Combine(csP, segCalc[i], (segOff + segLen < fileSize ? segLen
+                                                             : fileSize-segOff));
+       }
+
+// Return the result
+//
+   for (i = 1; i < nSeg; i++) if (segCalc[i]) segCalc[i]->Recycle();
+   return rc;
+}
+
+/******************************************************************************/
+/* Private:                    C a l c R a n g e                              */
+/******************************************************************************/
+
+int XrdCksManager::CalcRange(int FD, const char *Pfn, off_t Offset,
+                             off_t Length, XrdCksCalc *csP)
+{
+   char *inBuff;
+   size_t ioSize, calcSize = Length;
+   int rc = 0;
+
+// Tell the system we will be reading this range sequentially
+//
+#if defined(__linux__) || (defined(__FreeBSD_kernel__) && defined(__GLIBC__))
+   posix_fadvise(FD, Offset, Length, POSIX_FADV_SEQUENTIAL);
+#endif
+
 // We now compute checksum 64MB at a time using mmap I/O
 //
-   ioSize = (fileSize < (off_t)segSize ? fileSize : segSize); rc = 0;
+   ioSize = (calcSize < (size_t)segSize ? calcSize : segSize);
    while(calcSize)
         {if ((inBuff = (char *)mmap(0, ioSize, PROT_READ, 
 #if defined(__FreeBSD__)
-                       MAP_RESERVED0040|MAP_PRIVATE, In.FD, Offset)) == MAP_FAILED)
+                       MAP_RESERVED0040|MAP_PRIVATE, FD, Offset)) == MAP_FAILED)
 #elif defined(__GNU__)
-                       MAP_PRIVATE, In.FD, Offset)) == MAP_FAILED)
+                       MAP_PRIVATE, FD, Offset)) == MAP_FAILED)
 #else
-                       MAP_NORESERVE|MAP_PRIVATE, In.FD, Offset)) == MAP_FAILED)
+                       MAP_NORESERVE|MAP_PRIVATE, FD, Offset)) == MAP_FAILED)
 #endif
             {rc = errno; eDest->Emsg("Cks", rc, "memory map", Pfn); break;}
          madvise(inBuff, ioSize, MADV_SEQUENTIAL);
+
+// Have the next window read in while we checksum this one
+//
+#if defined(__linux__) || (defined(__FreeBSD_kernel__) && defined(__GLIBC__))
+         if (calcSize > ioSize)
+            posix_fadvise(FD, Offset + ioSize, (calcSize - ioSize < ioSize
+                                               ? calcSize - ioSize : ioSize),
+                          POSIX_FADV_WILLNEED);
+#endif
          csP->Update(inBuff, ioSize);
          calcSize -= ioSize; Offset += ioSize;
          if (munmap(inBuff, ioSize) < 0)
@@ -211,6 +417,8 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
              <path>    the path of the checksum library to be used.
              <parms>   optional parms to be passed
 
+             The ckscalc directive is handled by ConfigCalc().
+
   Output: 0 upon success or !0 upon failure.
 */
 int XrdCksManager::Config(const char *Token, char *Line)
@@ -219,6 +427,10 @@ int XrdCksManager::Config(const char *Token, char *Line)
    char *val, *path = 0, name[XrdCksData::NameSize], *parms;
    int i;
 
+// Check if this is a calculation directive
+//
+   if (Token && !strcmp(Token, "ckscalc")) return ConfigCalc(Line);
+
 // Get the the checksum name
 //
    Cfg.GetLine();
@@ -262,6 +474,82 @@ int XrdCksManager::Config(const char *Token, char *Line)
    return 0;
 }
 
+/******************************************************************************/
+/* Private:                   C o n f i g C a l c                             */
+/******************************************************************************/
+/*
+   Purpose:  To parse the directive: ckscalc [onepass {all | <digest>[,...]}]
+                                             [parallel <n>]
+
+             onepass   the digests to calculate in a single pass over the file.
+                       When any one of them needs to be calculated, all of them
+                       are and all of the results are set. Specify all to
+                       include every configured digest.
+             parallel  the maximum number of threads used to checksum large
+                       files in segments. This is only done for checksums
+                       whose segment results can be combined (adler32, crc32,
+                       and crc32c). The default is 1 (i.e. not in parallel).
+
+  Output: 0 upon success or !0 upon failure.
+*/
+int XrdCksManager::ConfigCalc(char *Line)
+{
+   XrdOucTokenizer Cfg(Line);
+   char *val, *comma, name[XrdCksData::NameSize];
+   int i, n;
+
+// Process all of the options
+//
+   Cfg.GetLine();
+   while((val = Cfg.GetToken()) && *val)
+        {if (!strcmp(val, "parallel"))
+            {if (!(val = Cfg.GetToken()) || !*val)
+                {eDest->Emsg("Config", "ckscalc parallel value not specified");
+                 return 1;
+                }
+             if ((n = atoi(val)) < 1 || n > 64)
+                {eDest->Emsg("Config", "invalid ckscalc parallel value -", val);
+                 return 1;
+                }
+             parThreads = n;
+             continue;
+            }
+         if (strcmp(val, "onepass"))
+            {eDest->Emsg("Config", "invalid ckscalc option -", val);
+             return 1;
+            }
+         if (!(val = Cfg.GetToken()) || !*val)
+            {eDest->Emsg("Config", "ckscalc onepass digests not specified");
+             return 1;
+            }
+         if (!strcmp(val, "all"))
+            {for (i = 0; i <= csLast; i++) csTab[i].onePass = true;
+             continue;
+            }
+         while(val && *val)
+              {if ((comma = index(val, ','))) *comma++ = 0;
+               if ((int)strlen(val) >= XrdCksData::NameSize)
+                  {eDest->Emsg("Config", "ckscalc digest name too long");
+                   return 1;
+                  }
+               strcpy(name, val); XrdOucUtils::toLower(name);
+               for (i = 0; i <= csLast; i++)
+                   if (!strcmp(csTab[i].Name, name)) break;
+               if (i > csLast)
+                  {eDest->Emsg("Config", "ckscalc digest", name,
+                                         "is not configured");
+                   return 1;
+                  }
+               csTab[i].onePass = true;
+               val = comma;
+              }
+        }
+
+// All done
+//
+   return 0;
+}
+
 /******************************************************************************/
 /*                                  I n i t                                   */
 /******************************************************************************/
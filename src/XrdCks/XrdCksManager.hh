@@ -98,18 +98,25 @@ struct csInfo
        XrdSysPlugin *Plugin;
        int           Len;
        bool          doDel;
+       bool          onePass;
                      csInfo() : Obj(0), Path(0), Parms(0), Plugin(0), Len(0),
-                                doDel(true)
+                                doDel(true), onePass(false)
                                 {memset(Name, 0, sizeof(Name));}
       };
 
+int     CalcPar(int FD, const char *Pfn, off_t fileSize, XrdCksCalc *csP);
+int     CalcRange(int FD, const char *Pfn, off_t Offset, off_t Length,
+                  XrdCksCalc *csP);
 int     Config(const char *cFN, csInfo &Info);
+int     ConfigCalc(char *Line);
 csInfo *Find(const char *Name);
 
 static const int csMax = 8;
+static const long long parMinSeg = 256*1024*1024; // Min bytes per thread
 csInfo           csTab[csMax];
 int              csLast;
 int              segSize;
+int              parThreads;
 XrdCksLoader    *cksLoader;
 XrdVersionInfo  &myVersion;
 };
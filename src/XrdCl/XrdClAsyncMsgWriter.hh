@@ -28,6 +28,7 @@
 #include "XrdSys/XrdSysE2T.hh"
 
 #include <memory>
+#include <vector>
 
 namespace XrdCl
 {
@@ -60,8 +61,19 @@ namespace XrdCl
                                                     chdata( chdata ),
                                                     outmsg( nullptr ),
                                                     outmsgsize( 0 ),
-                                                    outhandler( nullptr )
+                                                    outhandler( nullptr ),
+                                                    batchsize( DefaultWriteBatchSize ),
+                                                    batchcount( DefaultWriteBatchCount ),
+                                                    batchoff( 0 ),
+                                                    batchmsgs( 0 ),
+                                                    wrtcount( socket.GetWriteCount() )
       {
+        Env *env = DefaultEnv::GetEnv();
+        env->GetInt( "WriteBatchSize",  batchsize );
+        env->GetInt( "WriteBatchCount", batchcount );
+        if( batchsize > 0 && batchcount > 1 )
+          batchbuf.reserve( batchsize );
+        else batchsize = 0;
       }
 
       //------------------------------------------------------------------------
@@ -74,6 +86,9 @@ namespace XrdCl
         outmsgsize = 0;;
         outhandler = nullptr;
         outsign.reset();
+        batchbuf.clear();
+        batchoff   = 0;
+        batchmsgs  = 0;
       }
 
       //------------------------------------------------------------------------
@@ -91,11 +106,20 @@ namespace XrdCl
             //------------------------------------------------------------------
             case WriteStart:
             {
+              //----------------------------------------------------------------
+              // Don't let the stream disable the uplink while we still hold
+              // batched messages that have to be written out
+              //----------------------------------------------------------------
               std::pair<Message *, MsgHandler *> toBeSent;
-              toBeSent = strm.OnReadyToWrite( substrmnb );
+              toBeSent = strm.OnReadyToWrite( substrmnb, batchbuf.empty() );
               outmsg = toBeSent.first;
               outhandler = toBeSent.second;
-              if( !outmsg ) return XRootDStatus( stOK, suAlreadyDone );
+              if( !outmsg )
+              {
+                if( batchbuf.empty() ) return XRootDStatus( stOK, suAlreadyDone );
+                writestage = WriteBatch;
+                continue;
+              }
 
               outmsg->SetCursor( 0 );
               outmsgsize = outmsg->GetSize();
@@ -112,12 +136,67 @@ namespace XrdCl
                 outmsgsize += outsign->GetSize();
 
               //----------------------------------------------------------------
-              // The next step is to write the signature
+              // Small requests without raw data are gathered, together with
+              // their signatures, so that they go out in a single write
+              //----------------------------------------------------------------
+              if( AddToBatch() ) continue;
+
               //----------------------------------------------------------------
-              writestage = WriteSign;
+              // The next step is to write the signature, but anything that
+              // has been batched so far has to go first
+              //----------------------------------------------------------------
+              writestage = batchbuf.empty() ? WriteSign : WriteBatch;
               continue;
             }
             //------------------------------------------------------------------
+            // Write out the batched messages
+            //------------------------------------------------------------------
+            case WriteBatch:
+            {
+              while( batchoff < batchbuf.size() )
+              {
+                int wrtcnt = 0;
+                XRootDStatus st = socket.Send( batchbuf.data() + batchoff,
+                                               batchbuf.size() - batchoff, wrtcnt );
+                if( !st.IsOK() || st.code == suRetry ) return st;
+                batchoff += wrtcnt;
+              }
+
+              XRootDStatus st = socket.Flash();
+              if( !st.IsOK() )
+              {
+                log->Error( AsyncSockMsg, "[%s] Unable to flash the socket: %s",
+                            strmname.c_str(), XrdSysE2T( st.errNo ) );
+                return st;
+              }
+
+              log->Dump( AsyncSockMsg, "[%s] Wrote %u batched messages, %zu bytes.",
+                         strmname.c_str(), batchmsgs, batchbuf.size() );
+              strm.OnBatchSent( substrmnb );
+              ReportWrites( batchmsgs );
+              batchbuf.clear();
+              batchoff  = 0;
+              batchmsgs = 0;
+
+              //----------------------------------------------------------------
+              // If a message did not fit in the batch it either starts a new
+              // one, in which case we give the poller a chance to handle other
+              // events before coming back, or it is written on its own.
+              // Otherwise we are done for now.
+              //----------------------------------------------------------------
+              if( outmsg )
+              {
+                if( AddToBatch() )
+                {
+                  writestage = WriteStart;
+                  return XRootDStatus( stOK, suRetry );
+                }
+                writestage = WriteSign;
+                continue;
+              }
+              return XRootDStatus();
+            }
+            //------------------------------------------------------------------
             // First write the signature (if there is one)
             //------------------------------------------------------------------
             case WriteSign:
@@ -186,6 +265,7 @@ namespace XrdCl
                          strmname.c_str(), outmsg->GetDescription().c_str(), outmsg );
 
               strm.OnMessageSent( substrmnb, outmsg, outmsgsize );
+              ReportWrites( 1 );
               return XRootDStatus();
             }
           }
@@ -200,12 +280,59 @@ namespace XrdCl
 
     private:
 
+      //------------------------------------------------------------------------
+      //! Copy the current message (and its signature) into the batch buffer
+      //! if it is eligible for batching.
+      //!
+      //! The message is handed back to the stream, which reports it as sent
+      //! only once the whole batch has been written out, and requeues it if
+      //! the connection breaks before that.
+      //!
+      //! @return true if the message has been batched
+      //------------------------------------------------------------------------
+      bool AddToBatch()
+      {
+        if( !batchsize || outhandler->IsRaw() ||
+            batchmsgs >= (uint32_t)batchcount ||
+            batchbuf.size() + outmsgsize > (size_t)batchsize )
+          return false;
+
+        if( outsign )
+          batchbuf.insert( batchbuf.end(), outsign->GetBuffer(),
+                           outsign->GetBuffer() + outsign->GetSize() );
+        batchbuf.insert( batchbuf.end(), outmsg->GetBuffer(),
+                         outmsg->GetBuffer() + outmsg->GetSize() );
+        ++batchmsgs;
+
+        Log *log = DefaultEnv::GetLog();
+        log->Dump( AsyncSockMsg, "[%s] Batched message: %s (0x%x).",
+                   strmname.c_str(), outmsg->GetDescription().c_str(), outmsg );
+
+        strm.OnMessageBatched( substrmnb, outmsgsize );
+        outmsg     = nullptr;
+        outmsgsize = 0;
+        outhandler = nullptr;
+        outsign.reset();
+        return true;
+      }
+
+      //------------------------------------------------------------------------
+      //! Report the socket writes used for the given number of messages
+      //------------------------------------------------------------------------
+      void ReportWrites( uint32_t msgcnt )
+      {
+        uint64_t now = socket.GetWriteCount();
+        strm.OnWriteStats( msgcnt, now - wrtcount );
+        wrtcount = now;
+      }
+
       //------------------------------------------------------------------------
       //! Stages of reading out a response from the socket
       //------------------------------------------------------------------------
       enum Stage
       {
         WriteStart,   //< the next step is to initialize the read
+        WriteBatch,   //< the next step is to write the batched messages
         WriteSign,    //< the next step is to write the signature
         WriteRequest, //< the next step is to write the request
         WriteRawData, //< the next step is to write the raw data
@@ -234,6 +361,16 @@ namespace XrdCl
       uint32_t                  outmsgsize;
       MsgHandler               *outhandler;
       std::unique_ptr<Message>  outsign;
+
+      //------------------------------------------------------------------------
+      // The batch of small requests waiting to be written
+      //------------------------------------------------------------------------
+      int                       batchsize;
+      int                       batchcount;
+      std::vector<char>         batchbuf;
+      size_t                    batchoff;
+      uint32_t                  batchmsgs;
+      uint64_t                  wrtcount;
   };
 
 }
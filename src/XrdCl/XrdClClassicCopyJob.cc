@@ -46,8 +46,14 @@
 #include <mutex>
 #include <queue>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <list>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <sys/types.h>
@@ -138,6 +144,270 @@ namespace
     return XrdCl::XRootDStatus();
   }
 
+  //----------------------------------------------------------------------------
+  //! Pool of chunk buffers shared by all the copy jobs of the process.
+  //!
+  //! Allocating a fresh buffer of several megabytes for every chunk costs a
+  //! mmap and a page fault for every page that is touched, recycling the
+  //! buffers avoids both. A buffer may be retained by several users (e.g.
+  //! the destination writing it and the checksum stage), it goes back to the
+  //! pool once all of them released it. Buffers that were not obtained from
+  //! the pool are simply deleted when released.
+  //----------------------------------------------------------------------------
+  class BufferPool
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! Get the pool of the process
+      //------------------------------------------------------------------------
+      static BufferPool& Instance()
+      {
+        static BufferPool pool;
+        return pool;
+      }
+
+      //------------------------------------------------------------------------
+      //! Get a buffer of given size
+      //------------------------------------------------------------------------
+      char* Get( uint32_t size )
+      {
+        std::unique_lock<std::mutex> lck( pMutex );
+        std::vector<char*> &idle = pIdle[size];
+        if( !idle.empty() )
+        {
+          char *buffer = idle.back();
+          idle.pop_back();
+          pIdleBytes -= size;
+          pOwned[buffer].refs = 1;
+          return buffer;
+        }
+        char *buffer = new char[size];
+        pOwned[buffer] = Owned{ size, 1 };
+        return buffer;
+      }
+
+      //------------------------------------------------------------------------
+      //! Take one more reference to a buffer obtained from the pool
+      //!
+      //! @return false if the buffer does not come from the pool
+      //------------------------------------------------------------------------
+      bool Retain( const void *ptr )
+      {
+        std::unique_lock<std::mutex> lck( pMutex );
+        auto itr = pOwned.find( (char*)ptr );
+        if( itr == pOwned.end() ) return false;
+        ++itr->second.refs;
+        return true;
+      }
+
+      //------------------------------------------------------------------------
+      //! Give a chunk buffer back
+      //------------------------------------------------------------------------
+      void Release( const void *ptr )
+      {
+        char *buffer = (char*)ptr;
+        if( !buffer ) return;
+
+        std::unique_lock<std::mutex> lck( pMutex );
+        auto itr = pOwned.find( buffer );
+        if( itr != pOwned.end() && --itr->second.refs > 0 ) return;
+        if( itr != pOwned.end() && pIdleBytes + itr->second.size <= MaxIdleBytes )
+        {
+          pIdle[itr->second.size].push_back( buffer );
+          pIdleBytes += itr->second.size;
+          return;
+        }
+        if( itr != pOwned.end() ) pOwned.erase( itr );
+        lck.unlock();
+        delete [] buffer;
+      }
+
+    private:
+      static const uint64_t MaxIdleBytes = 64 * 1024 * 1024;
+
+      BufferPool(): pIdleBytes( 0 ) { }
+
+      struct Owned
+      {
+        uint32_t size;
+        uint32_t refs;
+      };
+
+      std::mutex                                        pMutex;
+      std::unordered_map<char*, Owned>                  pOwned;
+      std::unordered_map<uint32_t, std::vector<char*>>  pIdle;
+      uint64_t                                          pIdleBytes;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Release a chunk buffer
+  //----------------------------------------------------------------------------
+  inline void ReleaseBuffer( const void *buffer )
+  {
+    BufferPool::Instance().Release( buffer );
+  }
+
+  //----------------------------------------------------------------------------
+  //! Checksum stage of the copy pipeline.
+  //!
+  //! Runs the checksum updates on a thread of its own, in the order they have
+  //! been queued, so that neither reading nor writing has to wait for the
+  //! calculation. The destructor waits until all the queued tasks are done.
+  //----------------------------------------------------------------------------
+  class CheckSumStage
+  {
+    public:
+      CheckSumStage(): pStop( false ), pBusy( false ),
+                       pThread( &CheckSumStage::Run, this ) { }
+
+      ~CheckSumStage()
+      {
+        {
+          std::unique_lock<std::mutex> lck( pMutex );
+          pStop = true;
+        }
+        pCond.notify_all();
+        pThread.join();
+      }
+
+      //------------------------------------------------------------------------
+      //! Queue a checksum update
+      //------------------------------------------------------------------------
+      void Queue( std::function<void()> &&task )
+      {
+        {
+          std::unique_lock<std::mutex> lck( pMutex );
+          pTasks.push( std::move( task ) );
+        }
+        pCond.notify_all();
+      }
+
+      //------------------------------------------------------------------------
+      //! Wait until all the queued tasks are done
+      //------------------------------------------------------------------------
+      void Wait()
+      {
+        std::unique_lock<std::mutex> lck( pMutex );
+        pCond.wait( lck, [this]{ return pTasks.empty() && !pBusy; } );
+      }
+
+    private:
+      void Run()
+      {
+        std::unique_lock<std::mutex> lck( pMutex );
+        while( true )
+        {
+          pCond.wait( lck, [this]{ return pStop || !pTasks.empty(); } );
+          if( pTasks.empty() ) return;
+          std::function<void()> task = std::move( pTasks.front() );
+          pTasks.pop();
+          pBusy = true;
+          lck.unlock();
+          task();
+          lck.lock();
+          pBusy = false;
+          pCond.notify_all();
+        }
+      }
+
+      std::mutex                        pMutex;
+      std::condition_variable           pCond;
+      std::queue<std::function<void()>> pTasks;
+      bool                              pStop;
+      bool                              pBusy;
+      std::thread                       pThread;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Auto-tuning of the number of chunks in flight.
+  //!
+  //! Tracks the throughput and the lowest chunk latency seen so far (the
+  //! round-trip time plus the time it takes to transfer one chunk) and aims
+  //! at keeping their product, the bandwidth-delay product, in flight plus
+  //! one chunk of slack. The depth is re-evaluated once per round of chunks
+  //! and is kept between the configured and the maximum number of chunks.
+  //----------------------------------------------------------------------------
+  class DepthTuner
+  {
+    public:
+      DepthTuner( const char *name, uint32_t chunkSize, uint16_t minDepth ):
+        pName( name ), pChunkSize( chunkSize ), pMinDepth( minDepth ),
+        pMaxDepth( minDepth ), pDepth( minDepth ), pMinLatency( 0 ),
+        pBytes( 0 ), pCount( 0 ), pStarted( false )
+      {
+        int val = XrdCl::DefaultCPMaxParallelChunks;
+        XrdCl::DefaultEnv::GetEnv()->GetInt( "CPMaxParallelChunks", val );
+        if( val > pMinDepth )
+          pMaxDepth = std::min( val, (int)UINT16_MAX );
+      }
+
+      //------------------------------------------------------------------------
+      //! Account for a completed chunk, called by the consumer of the chunks
+      //!
+      //! @param bytes   size of the chunk
+      //! @param latency time elapsed between issuing the request and getting
+      //!                the response
+      //------------------------------------------------------------------------
+      void Update( uint32_t bytes, std::chrono::nanoseconds latency )
+      {
+        if( pMaxDepth == pMinDepth ) return;
+
+        auto now = std::chrono::steady_clock::now();
+        if( !pMinLatency.count() || latency < pMinLatency )
+          pMinLatency = latency;
+        if( !pStarted )
+        {
+          pStarted = true;
+          pWindowStart = now;
+          return;
+        }
+
+        pBytes += bytes;
+        if( ++pCount < pDepth ) return;
+
+        double elapsed = std::chrono::duration<double>( now - pWindowStart ).count();
+        if( elapsed > 0 )
+        {
+          double rate   = pBytes / elapsed;
+          double bdp    = rate * std::chrono::duration<double>( pMinLatency ).count();
+          uint64_t want = uint64_t( std::ceil( bdp / pChunkSize ) ) + 1;
+          uint16_t depth = std::max<uint64_t>( pMinDepth, std::min<uint64_t>( want, pMaxDepth ) );
+          if( depth != pDepth )
+          {
+            XrdCl::Log *log = XrdCl::DefaultEnv::GetLog();
+            log->Debug( XrdCl::UtilityMsg, "%s: %.1f MB/s at %.1f ms, %d chunks "
+                        "in flight (was %d)", pName, rate / 1e6,
+                        std::chrono::duration<double, std::milli>( pMinLatency ).count(),
+                        depth, (uint16_t)pDepth );
+            pDepth = depth;
+          }
+        }
+        pWindowStart = now;
+        pBytes = 0;
+        pCount = 0;
+      }
+
+      //------------------------------------------------------------------------
+      //! Number of chunks that should be in flight
+      //------------------------------------------------------------------------
+      uint16_t Depth() const
+      {
+        return pDepth;
+      }
+
+    private:
+      const char                            *pName;
+      uint32_t                               pChunkSize;
+      uint16_t                               pMinDepth;
+      uint16_t                               pMaxDepth;
+      std::atomic<uint16_t>                  pDepth;
+      std::chrono::nanoseconds               pMinLatency;
+      std::chrono::steady_clock::time_point  pWindowStart;
+      uint64_t                               pBytes;
+      uint16_t                               pCount;
+      bool                                   pStarted;
+  };
+
   //----------------------------------------------------------------------------
   //! Abstract chunk source
   //----------------------------------------------------------------------------
@@ -423,7 +693,7 @@ namespace
         Log *log = DefaultEnv::GetLog();
 
         uint32_t toRead = pChunkSize;
-        char *buffer = new char[toRead];
+        char *buffer = BufferPool::Instance().Get( toRead );
 
         int64_t  bytesRead = 0;
         uint32_t offset    = 0;
@@ -434,7 +704,7 @@ namespace
           {
             log->Debug( UtilityMsg, "Unable to read from stdin: %s",
                         XrdSysE2T( errno ) );
-            delete [] buffer;
+            ReleaseBuffer( buffer );
             return XRootDStatus( stError, errOSError, errno );
           }
 
@@ -448,7 +718,7 @@ namespace
 
         if( bytesRead == 0 )
         {
-          delete [] buffer;
+          ReleaseBuffer( buffer );
           return XRootDStatus( stOK, suDone );
         }
 
@@ -586,7 +856,8 @@ namespace
         pCurrentOffset( 0 ), pChunkSize( chunkSize ),
         pParallel( parallelChunks ),
         pNbConn( 0 ), pUsePgRead( false ),
-        pDoServer( doserver )
+        pDoServer( doserver ),
+        pTuner( "source", chunkSize, parallelChunks )
       {
         int val = XrdCl::DefaultSubStreamsPerChannel;
         XrdCl::DefaultEnv::GetEnv()->GetInt( "SubStreamsPerChannel", val );
@@ -643,6 +914,8 @@ namespace
             st = cksHelper->Initialize();
             if( !st.IsOK() ) return st;
           }
+
+          pCkSumStage.reset( new CheckSumStage() );
         }
 
         //----------------------------------------------------------------------
@@ -700,6 +973,7 @@ namespace
       {
         pCurrentOffset = offset;
         pContinue      = true;
+        pCkSumStage.reset(); // the checksum will be calculated from scratch
         return XrdCl::XRootDStatus();
       }
 
@@ -734,7 +1008,7 @@ namespace
           ChunkHandler *ch = pChunks.front();
           pChunks.pop();
           ch->sem->Wait();
-          delete [] (char *)ch->chunk.GetBuffer();
+          ReleaseBuffer( ch->buffer );
           delete ch;
         }
       }
@@ -766,6 +1040,7 @@ namespace
             // in case of --continue option we have to calculate the checksum from scratch
             return XrdCl::Utils::GetLocalCheckSum( checkSum, checkSumType, pUrl->GetPath() );
 
+          WaitForCheckSum();
           if( cksHelper )
             return cksHelper->GetCheckSum( checkSum, checkSumType );
 
@@ -815,6 +1090,7 @@ namespace
                                                  NbConnectedStrm( pDataServer );
         }
         if( pNbConn ) parallel *= pNbConn;
+        parallel = std::max( parallel, pTuner.Depth() );
 
         while( pChunks.size() < parallel && pCurrentOffset < pSize )
         {
@@ -822,11 +1098,12 @@ namespace
           if( pCurrentOffset + chunkSize > (uint64_t)pSize )
             chunkSize = pSize - pCurrentOffset;
 
-          char *buffer = new char[chunkSize];
           ChunkHandler *ch = new ChunkHandler();
+          ch->buffer = BufferPool::Instance().Get( pChunkSize );
+          ch->issued = std::chrono::steady_clock::now();
           ch->status = pUsePgRead
-                     ? reader->PgRead( pCurrentOffset, chunkSize, buffer, ch )
-                     : reader->Read( pCurrentOffset, chunkSize, buffer, ch );
+                     ? reader->PgRead( pCurrentOffset, chunkSize, ch->buffer, ch )
+                     : reader->Read( pCurrentOffset, chunkSize, ch->buffer, ch );
           pChunks.push( ch );
           pCurrentOffset += chunkSize;
           if( !ch->status.IsOK() )
@@ -893,23 +1170,53 @@ namespace
           log->Debug( UtilityMsg, "Unable read %d bytes at %ld from %s: %s",
                       ch->chunk.GetLength(), ch->chunk.GetOffset(),
                       pUrl->GetURL().c_str(), ch->status.ToStr().c_str() );
-          delete [] (char *)ch->chunk.GetBuffer();
+          ReleaseBuffer( ch->buffer );
           CleanUpChunks();
           return ch->status;
         }
 
+        pTuner.Update( ch->chunk.GetLength(), ch->completed - ch->issued );
+        if( pCkSumStage ) QueueCheckSum( ch->chunk );
         ci = std::move( ch->chunk );
-        // if it is a local file update the checksum
-        if( pUrl->IsLocalFile() && !pUrl->IsMetalink() && !pContinue )
+        return XRootDStatus( stOK, suContinue );
+      }
+
+      //------------------------------------------------------------------------
+      //! If it is a local file, update the checksum with a chunk that has
+      //! been read. The chunks are handed out in order, so the checksum
+      //! stage gets them in order too, and it works on the chunk while the
+      //! destination writes it. It holds a reference to the buffer so that
+      //! the buffer is not reused in the meanwhile.
+      //------------------------------------------------------------------------
+      void QueueCheckSum( XrdCl::PageInfo &chunk )
+      {
+        const char *buffer = static_cast<const char*>( chunk.GetBuffer() );
+        uint32_t    length = chunk.GetLength();
+        bool        retained = BufferPool::Instance().Retain( buffer );
+
+        pCkSumStage->Queue( [this, buffer, length, retained]
         {
           if( pCkSumHelper )
-            pCkSumHelper->Update( ci.GetBuffer(), ci.GetLength() );
+            pCkSumHelper->Update( buffer, length );
 
           for( auto cksHelper : pAddCksHelpers )
-            cksHelper->Update( ci.GetBuffer(), ci.GetLength() );
-        }
+            cksHelper->Update( buffer, length );
 
-        return XRootDStatus( stOK, suContinue );
+          if( retained ) ReleaseBuffer( buffer );
+        } );
+
+        //----------------------------------------------------------------------
+        // We cannot keep a buffer that is not ours, so we have to wait
+        //----------------------------------------------------------------------
+        if( !retained ) pCkSumStage->Wait();
+      }
+
+      //------------------------------------------------------------------------
+      //! Wait for the checksum updates of the chunks handed out so far
+      //------------------------------------------------------------------------
+      void WaitForCheckSum()
+      {
+        if( pCkSumStage ) pCkSumStage->Wait();
       }
 
       //------------------------------------------------------------------------
@@ -918,11 +1225,14 @@ namespace
       class ChunkHandler: public XrdCl::ResponseHandler
       {
         public:
-          ChunkHandler(): sem( new XrdSysSemaphore(0) ) {}
+          ChunkHandler():
+            sem( new XrdSysSemaphore(0) ),
+            buffer( nullptr ) {}
           virtual ~ChunkHandler() { delete sem; }
           virtual void HandleResponse( XrdCl::XRootDStatus *statusval,
                                        XrdCl::AnyObject    *response )
           {
+            completed = std::chrono::steady_clock::now();
             this->status = *statusval;
             delete statusval;
             if( response )
@@ -950,9 +1260,12 @@ namespace
             }
           }
 
-        XrdSysSemaphore     *sem;
-        XrdCl::PageInfo      chunk;
-        XrdCl::XRootDStatus  status;
+        XrdSysSemaphore       *sem;
+        char                  *buffer;
+        XrdCl::PageInfo        chunk;
+        XrdCl::XRootDStatus    status;
+        std::chrono::steady_clock::time_point issued;
+        std::chrono::steady_clock::time_point completed;
       };
 
       const XrdCl::URL          *pUrl;
@@ -967,7 +1280,9 @@ namespace
       uint16_t                   pMaxNbConn;
       bool                       pUsePgRead;
       bool                       pDoServer;
+      DepthTuner                 pTuner;
 
+      std::unique_ptr<CheckSumStage>  pCkSumStage;
       std::shared_ptr<CancellableJob> pDataConnCB;
   };
 
@@ -1046,6 +1361,8 @@ namespace
             st = cksHelper->Initialize();
             if( !st.IsOK() ) return st;
           }
+
+          pCkSumStage.reset( new CheckSumStage() );
         }
 
         if( ( !pUrl->IsLocalFile() && !pZipArchive->IsSecure() ) ||
@@ -1125,7 +1442,10 @@ namespace
 
         // if it is a local file we can calculate the checksum ourself
         if( pUrl->IsLocalFile() && !pUrl->IsMetalink() && cksHelper && !pContinue )
+        {
+          WaitForCheckSum();
           return cksHelper->GetCheckSum( checkSum, checkSumType );
+        }
 
         // if it is a remote file other types of checksum are not supported
         return XrdCl::XRootDStatus( XrdCl::stError, XrdCl::errNotSupported );
@@ -1286,7 +1606,7 @@ namespace
         //----------------------------------------------------------------------
         // Fill the queue
         //----------------------------------------------------------------------
-        char     *buffer = new char[pChunkSize];
+        char     *buffer = BufferPool::Instance().Get( pChunkSize );
         uint32_t  bytesRead = 0;
 
         std::vector<uint32_t> cksums;
@@ -1296,13 +1616,13 @@ namespace
 
         if( !st.IsOK() )
         {
-          delete [] buffer;
+          ReleaseBuffer( buffer );
           return st;
         }
 
         if( !bytesRead )
         {
-          delete [] buffer;
+          ReleaseBuffer( buffer );
           return XRootDStatus( stOK, suDone );
         }
 
@@ -1633,7 +1953,7 @@ namespace
           {
             log->Debug( UtilityMsg, "Unable to write to stdout: %s",
                         XrdSysE2T( errno ) );
-            delete [] (char*)ci.GetBuffer();
+            ReleaseBuffer( ci.GetBuffer() );
             return XRootDStatus( stError, errOSError, errno );
           }
           pCurrentOffset += wr;
@@ -1644,7 +1964,7 @@ namespace
 
         if( pCkSumHelper )
           pCkSumHelper->Update( ci.GetBuffer(), ci.GetLength() );
-        delete [] (char*)ci.GetBuffer();
+        ReleaseBuffer( ci.GetBuffer() );
         return XRootDStatus();
       }
 
@@ -1698,11 +2018,12 @@ namespace
       //------------------------------------------------------------------------
       //! Constructor
       //------------------------------------------------------------------------
-      XRootDDestination( const XrdCl::URL &url, uint8_t parallelChunks,
+      XRootDDestination( const XrdCl::URL &url, uint32_t chunkSize, uint8_t parallelChunks,
                          const std::string &ckSumType, const XrdCl::ClassicCopyJob &cpjob ):
         Destination( ckSumType ),
         pUrl( url ), pFile( new XrdCl::File( XrdCl::File::DisableVirtRedirect ) ),
-        pParallel( parallelChunks ), pSize( -1 ), pUsePgWrt( false ), cpjob( cpjob )
+        pParallel( parallelChunks ), pDone( 0 ), pSize( -1 ), pUsePgWrt( false ),
+        cpjob( cpjob ), pTuner( "destination", chunkSize, parallelChunks )
       {
       }
 
@@ -1815,7 +2136,11 @@ namespace
         delete info;
 
         if( pUrl.IsLocalFile() && pCkSumHelper && !pContinue )
-          return pCkSumHelper->Initialize();
+        {
+          st = pCkSumHelper->Initialize();
+          if( !st.IsOK() ) return st;
+          pCkSumStage.reset( new CheckSumStage() );
+        }
 
         return XRootDStatus();
       }
@@ -1839,31 +2164,30 @@ namespace
         using namespace XrdCl;
         if( !pFile->IsOpen() )
         {
-          delete[] (char*)ci.GetBuffer(); // we took the ownership of the buffer
+          ReleaseBuffer( ci.GetBuffer() ); // we took the ownership of the buffer
           return XRootDStatus( stError, errUninitialized );
         }
 
         //----------------------------------------------------------------------
         // If there is still place for this chunk to be sent send it
         //----------------------------------------------------------------------
-        if( pChunks.size() < pParallel )
+        if( pChunks.size() < std::max<uint16_t>( pParallel, pTuner.Depth() ) )
           return QueueChunk( std::move( ci ) );
 
         //----------------------------------------------------------------------
         // We wait for a chunk to be sent so that we have space for the current
-        // one
+        // one, the writes go at explicit offsets so it does not matter which
+        // one completes first
         //----------------------------------------------------------------------
-        std::unique_ptr<ChunkHandler> ch( pChunks.front() );
-        pChunks.pop();
-        ch->sem->Wait();
-        delete [] (char*)ch->chunk.GetBuffer();
+        std::unique_ptr<ChunkHandler> ch( Reap() );
+        ReleaseBuffer( ch->chunk.GetBuffer() );
         if( !ch->status.IsOK() )
         {
           Log *log = DefaultEnv::GetLog();
           log->Debug( UtilityMsg, "Unable write %d bytes at %ld from %s: %s",
                       ch->chunk.GetLength(), ch->chunk.GetOffset(),
                       pUrl.GetURL().c_str(), ch->status.ToStr().c_str() );
-          delete[] (char*)ci.GetBuffer(); // we took the ownership of the buffer
+          ReleaseBuffer( ci.GetBuffer() ); // we took the ownership of the buffer
           CleanUpChunks();
 
           //--------------------------------------------------------------------
@@ -1891,10 +2215,8 @@ namespace
       {
         while( !pChunks.empty() )
         {
-          ChunkHandler *ch = pChunks.front();
-          pChunks.pop();
-          ch->sem->Wait();
-          delete [] (char *)ch->chunk.GetBuffer();
+          ChunkHandler *ch = Reap();
+          ReleaseBuffer( ch->chunk.GetBuffer() );
           delete ch;
         }
       }
@@ -1904,12 +2226,8 @@ namespace
       //------------------------------------------------------------------------
       XrdCl::XRootDStatus QueueChunk( XrdCl::PageInfo &&ci )
       {
-        // we are writing chunks in order so we can calc the checksum
-        // in case of local files
-        if( pUrl.IsLocalFile() && pCkSumHelper && !pContinue )
-          pCkSumHelper->Update( ci.GetBuffer(), ci.GetLength() );
-
-        ChunkHandler *ch = new ChunkHandler( std::move( ci ) );
+        ChunkHandler *ch = new ChunkHandler( std::move( ci ), pDone, pCkSumStage != nullptr );
+        ch->issued = std::chrono::steady_clock::now();
         XrdCl::XRootDStatus st;
         st = pUsePgWrt
            ? pFile->PgWrite(ch->chunk.GetOffset(), ch->chunk.GetLength(), ch->chunk.GetBuffer(), ch->chunk.GetCksums(), ch)
@@ -1917,11 +2235,23 @@ namespace
         if( !st.IsOK() )
         {
           CleanUpChunks();
-          delete [] (char*)ch->chunk.GetBuffer();
+          ReleaseBuffer( ch->chunk.GetBuffer() );
           delete ch;
           return st;
         }
-        pChunks.push( ch );
+        pChunks.push_back( ch );
+
+        //----------------------------------------------------------------------
+        // The chunks come in order so in case of a local file we can update
+        // the checksum while the write is in progress, the buffer is released
+        // once both are done
+        //----------------------------------------------------------------------
+        if( pCkSumStage )
+          pCkSumStage->Queue( [this, ch]
+          {
+            pCkSumHelper->Update( ch->chunk.GetBuffer(), ch->chunk.GetLength() );
+            ch->Done();
+          } );
         return XrdCl::XRootDStatus();
       }
 
@@ -1933,9 +2263,7 @@ namespace
         XrdCl::XRootDStatus st;
         while( !pChunks.empty() )
         {
-          ChunkHandler *ch = pChunks.front();
-          pChunks.pop();
-          ch->sem->Wait();
+          ChunkHandler *ch = Reap();
           if( !ch->status.IsOK() )
           {
             //--------------------------------------------------------------------
@@ -1944,7 +2272,7 @@ namespace
             //--------------------------------------------------------------------
             st = CheckIfRetriable( ch->status );
           }
-          delete [] (char *)ch->chunk.GetBuffer();
+          ReleaseBuffer( ch->chunk.GetBuffer() );
           delete ch;
         }
         return st;
@@ -2007,23 +2335,57 @@ namespace
       class ChunkHandler: public XrdCl::ResponseHandler
       {
         public:
-          ChunkHandler( XrdCl::PageInfo &&ci ):
-            sem( new XrdSysSemaphore(0) ),
-            chunk(std::move( ci ) ) {}
-          virtual ~ChunkHandler() { delete sem; }
+          ChunkHandler( XrdCl::PageInfo &&ci, XrdSysSemaphore &done,
+                        bool checksummed ):
+            pending( checksummed ? 2 : 1 ),
+            chunk(std::move( ci ) ),
+            done( done ) {}
           virtual void HandleResponse( XrdCl::XRootDStatus *statusval,
                                        XrdCl::AnyObject    */*response*/ )
           {
+            completed = std::chrono::steady_clock::now();
             this->status = *statusval;
             delete statusval;
-            sem->Post();
+            Done();
           }
 
-          XrdSysSemaphore        *sem;
+          //--------------------------------------------------------------------
+          // Called once the chunk has been written and once it has been
+          // checksummed (if needed)
+          //--------------------------------------------------------------------
+          void Done()
+          {
+            XrdSysSemaphore &sem = done; // the chunk may be gone once posted
+            if( --pending == 0 )
+              sem.Post();
+          }
+
+          std::atomic<int>        pending;
           XrdCl::PageInfo         chunk;
           XrdCl::XRootDStatus     status;
+          std::chrono::steady_clock::time_point issued;
+          std::chrono::steady_clock::time_point completed;
+
+        private:
+          XrdSysSemaphore        &done;
       };
 
+      //------------------------------------------------------------------------
+      //! Wait for any of the queued chunks to be done and take it off the
+      //! queue
+      //------------------------------------------------------------------------
+      ChunkHandler* Reap()
+      {
+        pDone.Wait();
+        auto itr = std::find_if( pChunks.begin(), pChunks.end(),
+                                 []( ChunkHandler *ch ){ return ch->pending == 0; } );
+        ChunkHandler *ch = *itr;
+        pChunks.erase( itr );
+        if( ch->status.IsOK() )
+          pTuner.Update( ch->chunk.GetLength(), ch->completed - ch->issued );
+        return ch;
+      }
+
       inline XrdCl::XRootDStatus CheckIfRetriable( XrdCl::XRootDStatus &status )
       {
         if( status.IsOK() ) return status;
@@ -2046,13 +2408,16 @@ namespace
       const XrdCl::URL             pUrl;
       XrdCl::File                 *pFile;
       uint8_t                      pParallel;
-      std::queue<ChunkHandler *>   pChunks;
+      std::list<ChunkHandler *>    pChunks;
+      XrdSysSemaphore              pDone;
       int64_t                      pSize;
 
       std::string                  pWrtRecoveryRedir;
       std::string                  pLastURL;
       bool                         pUsePgWrt;
       const XrdCl::ClassicCopyJob &cpjob;
+      DepthTuner                   pTuner;
+      std::unique_ptr<CheckSumStage> pCkSumStage;
   };
 
   //----------------------------------------------------------------------------
@@ -2186,7 +2551,7 @@ namespace
         std::unique_ptr<ChunkHandler> ch( pChunks.front() );
         pChunks.pop();
         ch->sem->Wait();
-        delete [] (char*)ch->chunk.GetBuffer();
+        ReleaseBuffer( ch->chunk.GetBuffer() );
         if( !ch->status.IsOK() )
         {
           Log *log = DefaultEnv::GetLog();
@@ -2223,7 +2588,7 @@ namespace
           ChunkHandler *ch = pChunks.front();
           pChunks.pop();
           ch->sem->Wait();
-          delete [] (char *)ch->chunk.GetBuffer();
+          ReleaseBuffer( ch->chunk.GetBuffer() );
           delete ch;
         }
       }
@@ -2249,7 +2614,7 @@ namespace
         if( !st.IsOK() )
         {
           CleanUpChunks();
-          delete [] (char*)ch->chunk.GetBuffer();
+          ReleaseBuffer( ch->chunk.GetBuffer() );
           delete ch;
           return st;
         }
@@ -2276,7 +2641,7 @@ namespace
             //--------------------------------------------------------------------
             st = CheckIfRetriable( ch->status );
           }
-          delete [] (char *)ch->chunk.GetBuffer();
+          ReleaseBuffer( ch->chunk.GetBuffer() );
           delete ch;
         }
         return st;
@@ -2561,7 +2926,7 @@ namespace XrdCl
         newDestUrl.SetParams( params );
  //     makeDir = true; // Backward compatibility for xroot destinations!!!
       }
-      dest.reset( new XRootDDestination( newDestUrl, parallelChunks, checkSumType, *this ) );
+      dest.reset( new XRootDDestination( newDestUrl, chunkSize, parallelChunks, checkSumType, *this ) );
     }
 
     dest->SetForce( force );
@@ -60,6 +60,7 @@ namespace XrdCl
   const int DefaultWorkerThreads           = 3;
   const int DefaultCPChunkSize             = 8388608;
   const int DefaultCPParallelChunks        = 4;
+  const int DefaultCPMaxParallelChunks     = DefaultCPParallelChunks;
   const int DefaultDataServerTTL           = 300;
   const int DefaultLoadBalancerTTL         = 1200;
   const int DefaultCPInitTimeout           = 600;
@@ -96,6 +97,19 @@ namespace XrdCl
   const int DefaultRetryWrtAtLBLimit       = 3;
   const int DefaultCpRetry                 = 0;
   const int DefaultCpUsePgWrtRd            = 1;
+  const int DefaultWriteBatchSize          = 16384; // fits a single TLS record
+  const int DefaultWriteBatchCount         = 64;
+  const int DefaultReadAhead               = 0;
+  const int DefaultReadAheadBlockSize      = 1024*1024;
+  const int DefaultReadAheadWindow         = 16;
+  const int DefaultReadAheadCacheSize      = 256*1024*1024;
+  const int DefaultReadVMergeWaste         = 0;
+  const int DefaultWorkerThreadsMax        = 0;
+  const int DefaultInlineCallbacks         = 0;
+  const int DefaultIoUring                 = 1;
+  const int DefaultIoUringDepth            = 256;
+  const int DefaultXCpHedging              = 1;
+  const int DefaultTlsSessionReuse         = 1;
 
   const char * const DefaultPollerPreference   = "built-in";
   const char * const DefaultNetworkStack       = "IPAuto";
@@ -112,6 +126,8 @@ namespace XrdCl
   const char * const DefaultClConfFile         = "";
   const char * const DefaultCpTarget           = "";
   const char * const DefaultCpRetryPolicy      = "force";
+  const char * const DefaultTlsSessionCache    = "";
+  const char * const DefaultZipCDCache         = "";
 
   inline static std::string to_lower( std::string str )
   {
@@ -133,6 +149,7 @@ namespace XrdCl
       { to_lower( "WorkerThreads" ),           DefaultWorkerThreads },
       { to_lower( "CPChunkSize" ),             DefaultCPChunkSize },
       { to_lower( "CPParallelChunks" ),        DefaultCPParallelChunks },
+      { to_lower( "CPMaxParallelChunks" ),     DefaultCPMaxParallelChunks },
       { to_lower( "DataServerTTL" ),           DefaultDataServerTTL },
       { to_lower( "LoadBalancerTTL" ),         DefaultLoadBalancerTTL },
       { to_lower( "CPInitTimeout" ),           DefaultCPInitTimeout },
@@ -161,7 +178,20 @@ namespace XrdCl
       { to_lower( "ZipMtlnCksum" ),            DefaultZipMtlnCksum },
       { to_lower( "IPNoShuffle" ),             DefaultIPNoShuffle },
       { to_lower( "WantTlsOnNoPgrw" ),         DefaultWantTlsOnNoPgrw },
-      { to_lower( "RetryWrtAtLBLimit" ),       DefaultRetryWrtAtLBLimit }
+      { to_lower( "RetryWrtAtLBLimit" ),       DefaultRetryWrtAtLBLimit },
+      { to_lower( "WriteBatchSize" ),          DefaultWriteBatchSize },
+      { to_lower( "WriteBatchCount" ),         DefaultWriteBatchCount },
+      { to_lower( "ReadAhead" ),               DefaultReadAhead },
+      { to_lower( "ReadAheadBlockSize" ),      DefaultReadAheadBlockSize },
+      { to_lower( "ReadAheadWindow" ),         DefaultReadAheadWindow },
+      { to_lower( "ReadAheadCacheSize" ),      DefaultReadAheadCacheSize },
+      { to_lower( "ReadVMergeWaste" ),         DefaultReadVMergeWaste },
+      { to_lower( "WorkerThreadsMax" ),        DefaultWorkerThreadsMax },
+      { to_lower( "InlineCallbacks" ),         DefaultInlineCallbacks },
+      { to_lower( "IoUring" ),                 DefaultIoUring },
+      { to_lower( "IoUringDepth" ),            DefaultIoUringDepth },
+      { to_lower( "XCpHedging" ),              DefaultXCpHedging },
+      { to_lower( "TlsSessionReuse" ),         DefaultTlsSessionReuse }
     };
 
   static std::unordered_map<std::string, std::string> theDefaultStrs
@@ -179,7 +209,9 @@ namespace XrdCl
       { to_lower( "TlsDbgLvl" ),          DefaultTlsDbgLvl },
       { to_lower( "ClConfDir" ),          DefaultClConfDir },
       { to_lower( "DefaultClConfFile" ),  DefaultClConfFile },
-      { to_lower( "CpTarget" ),           DefaultCpTarget }
+      { to_lower( "CpTarget" ),           DefaultCpTarget },
+      { to_lower( "TlsSessionCache" ),    DefaultTlsSessionCache },
+      { to_lower( "ZipCDCache" ),         DefaultZipCDCache }
     };
 }
 
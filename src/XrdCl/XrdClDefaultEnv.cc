@@ -21,6 +21,7 @@
 #include "XrdCl/XrdClPostMaster.hh"
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClForkHandler.hh"
+#include "XrdCl/XrdClIoUring.hh"
 #include "XrdCl/XrdClFileTimer.hh"
 #include "XrdCl/XrdClUtils.hh"
 #include "XrdCl/XrdClMonitor.hh"
@@ -275,6 +276,7 @@ namespace XrdCl
     REGISTER_VAR_INT( varsInt, "WorkerThreads",           DefaultWorkerThreads           );
     REGISTER_VAR_INT( varsInt, "CPChunkSize",             DefaultCPChunkSize             );
     REGISTER_VAR_INT( varsInt, "CPParallelChunks",        DefaultCPParallelChunks        );
+    REGISTER_VAR_INT( varsInt, "CPMaxParallelChunks",     DefaultCPMaxParallelChunks     );
     REGISTER_VAR_INT( varsInt, "DataServerTTL",           DefaultDataServerTTL           );
     REGISTER_VAR_INT( varsInt, "LoadBalancerTTL",         DefaultLoadBalancerTTL         );
     REGISTER_VAR_INT( varsInt, "CPInitTimeout",           DefaultCPInitTimeout           );
@@ -306,6 +308,19 @@ namespace XrdCl
     REGISTER_VAR_INT( varsInt, "XRateThreshold",          DefaultXRateThreshold          );
     REGISTER_VAR_INT( varsInt, "CpRetry",                 DefaultCpRetry                 );
     REGISTER_VAR_INT( varsInt, "CpUsePgWrtRd",            DefaultCpUsePgWrtRd            );
+    REGISTER_VAR_INT( varsInt, "WriteBatchSize",          DefaultWriteBatchSize          );
+    REGISTER_VAR_INT( varsInt, "WriteBatchCount",         DefaultWriteBatchCount         );
+    REGISTER_VAR_INT( varsInt, "ReadAhead",               DefaultReadAhead               );
+    REGISTER_VAR_INT( varsInt, "ReadAheadBlockSize",      DefaultReadAheadBlockSize      );
+    REGISTER_VAR_INT( varsInt, "ReadAheadWindow",         DefaultReadAheadWindow         );
+    REGISTER_VAR_INT( varsInt, "ReadAheadCacheSize",      DefaultReadAheadCacheSize      );
+    REGISTER_VAR_INT( varsInt, "ReadVMergeWaste",         DefaultReadVMergeWaste         );
+    REGISTER_VAR_INT( varsInt, "WorkerThreadsMax",        DefaultWorkerThreadsMax        );
+    REGISTER_VAR_INT( varsInt, "InlineCallbacks",         DefaultInlineCallbacks         );
+    REGISTER_VAR_INT( varsInt, "IoUring",                 DefaultIoUring                 );
+    REGISTER_VAR_INT( varsInt, "IoUringDepth",            DefaultIoUringDepth            );
+    REGISTER_VAR_INT( varsInt, "XCpHedging",              DefaultXCpHedging              );
+    REGISTER_VAR_INT( varsInt, "TlsSessionReuse",         DefaultTlsSessionReuse         );
 
     REGISTER_VAR_STR( varsStr, "ClientMonitor",           DefaultClientMonitor           );
     REGISTER_VAR_STR( varsStr, "ClientMonitorParam",      DefaultClientMonitorParam      );
@@ -319,6 +334,8 @@ namespace XrdCl
     REGISTER_VAR_STR( varsStr, "TlsDbgLvl",               DefaultTlsDbgLvl               );
     REGISTER_VAR_STR( varsStr, "CpTarget",                DefaultCpTarget                );
     REGISTER_VAR_STR( varsStr, "CpRetryPolicy",           DefaultCpRetryPolicy           );
+    REGISTER_VAR_STR( varsStr, "TlsSessionCache",         DefaultTlsSessionCache         );
+    REGISTER_VAR_STR( varsStr, "ZipCDCache",              DefaultZipCDCache              );
 
     //--------------------------------------------------------------------------
     // Process the configuration files
@@ -732,6 +749,12 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   void DefaultEnv::Finalize()
   {
+    //--------------------------------------------------------------------------
+    // The local file requests still in flight are answered through the post
+    // master
+    //--------------------------------------------------------------------------
+    IoUring::Shutdown();
+
     if( sPostMaster )
     {
       sPostMaster->Stop();
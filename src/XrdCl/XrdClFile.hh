@@ -434,11 +434,9 @@ namespace XrdCl
       //! Read scattered data chunks in one operation - async
       //!
       //! @param chunks    list of the chunks to be read and buffers to put
-      //!                  the data in. The default maximum chunk size is
-      //!                  2097136 bytes and the default maximum number
-      //!                  of chunks per request is 1024. The server
-      //!                  may be queried using FileSystem::Query for the
-      //!                  actual settings.
+      //!                  the data in. Lists exceeding the limits of the
+      //!                  server (queried when the file is opened) are
+      //!                  split into several requests sent in parallel.
       //! @param buffer    if zero the buffer pointers in the chunk list
       //!                  will be used, otherwise it needs to point to a
       //!                  buffer big enough to hold the requested data
@@ -457,11 +455,9 @@ namespace XrdCl
       //! Read scattered data chunks in one operation - sync
       //!
       //! @param chunks    list of the chunks to be read and buffers to put
-      //!                  the data in. The default maximum chunk size is
-      //!                  2097136 bytes and the default maximum number
-      //!                  of chunks per request is 1024. The server
-      //!                  may be queried using FileSystem::Query for the
-      //!                  actual settings.
+      //!                  the data in. Lists exceeding the limits of the
+      //!                  server (queried when the file is opened) are
+      //!                  split into several requests sent in parallel.
       //! @param buffer    if zero the buffer pointers in the chunk list
       //!                  will be used, otherwise it needs to point to a
       //!                  buffer big enough to hold the requested data
@@ -770,6 +766,8 @@ namespace XrdCl
       //! WriteRecovery    [true/false] - enable/disable write recovery
       //! FollowRedirects  [true/false] - enable/disable following redirections
       //! BundledClose     [true/false] - enable/disable bundled close
+      //! ReadAhead        [true/false] - enable/disable read-ahead, must be
+      //!                                 set before the file is opened
       //------------------------------------------------------------------------
       bool SetProperty( const std::string &name, const std::string &value );
 
@@ -52,6 +52,8 @@
 #include "XrdSys/XrdSysPthread.hh"
 
 #include <sstream>
+#include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <sys/time.h>
@@ -629,6 +631,173 @@ namespace
       XrdCl::Buffer buffer;
       XrdCl::ResponseHandler *handler;
   };
+
+  //----------------------------------------------------------------------------
+  // Vector read limits of the data servers, as reported by kXR_Qconfig
+  //----------------------------------------------------------------------------
+  struct ReadVLimits
+  {
+    ReadVLimits(): iovMax( XrdProto::maxRvecsz ),
+                   iorMax( 262144 - sizeof( readahead_list ) ) {}
+    uint32_t iovMax;
+    uint32_t iorMax;
+  };
+
+  XrdSysMutex                         readVLimitsMutex;
+  std::map<std::string, ReadVLimits>  readVLimits;
+
+  //----------------------------------------------------------------------------
+  // Helper callback storing the vector read limits of a data server
+  //----------------------------------------------------------------------------
+  class ReadVLimitsHandler : public XrdCl::ResponseHandler
+  {
+    public:
+      ReadVLimitsHandler( const std::string &hostId ): hostId( hostId )
+      {
+      }
+
+      virtual void HandleResponse( XrdCl::XRootDStatus *status,
+                                   XrdCl::AnyObject    *response )
+      {
+        if( status->IsOK() && response )
+        {
+          XrdCl::Buffer *buffer = 0;
+          response->Get( buffer );
+          std::istringstream in( buffer ? buffer->ToString() : "" );
+          uint32_t iovMax = 0, iorMax = 0;
+          if( in >> iovMax >> iorMax && iovMax && iorMax )
+          {
+            XrdSysMutexHelper scopedLock( readVLimitsMutex );
+            ReadVLimits &limits = readVLimits[hostId];
+            limits.iovMax = iovMax;
+            limits.iorMax = iorMax;
+          }
+        }
+        delete status;
+        delete response;
+        delete this;
+      }
+
+    private:
+      std::string hostId;
+  };
+
+  //----------------------------------------------------------------------------
+  // One kXR_readv element made of one or more user chunks. Chunks merged
+  // across a gap are read into a scratch buffer and copied out afterwards.
+  //----------------------------------------------------------------------------
+  struct ReadVElement
+  {
+    uint64_t  offset;
+    uint32_t  length;
+    char     *buffer;
+    size_t    first;
+    size_t    last;
+    uint64_t  useful;
+    uint64_t  waste;
+  };
+
+  //----------------------------------------------------------------------------
+  // A vector read sent as several kXR_readv requests, the user handler is
+  // called once all of them have come back
+  //----------------------------------------------------------------------------
+  class VectorReadGroup
+  {
+    public:
+      VectorReadGroup( XrdCl::ResponseHandler *handler,
+                       XrdCl::ChunkList       &&chunks ):
+        handler( handler ), chunks( std::move( chunks ) ), pending( 0 ),
+        hostList( 0 )
+      {
+      }
+
+      ~VectorReadGroup()
+      {
+        delete hostList;
+      }
+
+      //------------------------------------------------------------------------
+      // Account for a finished part, returns true if it was the last one
+      //------------------------------------------------------------------------
+      bool PartDone( const XrdCl::XRootDStatus &st, XrdCl::HostList *hosts )
+      {
+        XrdSysMutexHelper scopedLock( mutex );
+        if( !st.IsOK() && status.IsOK() ) status = st;
+        if( hosts )
+        {
+          delete hostList;
+          hostList = hosts;
+        }
+        return --pending == 0;
+      }
+
+      //------------------------------------------------------------------------
+      // Copy the scratch elements out and hand the result to the user
+      //------------------------------------------------------------------------
+      void Finish()
+      {
+        XrdCl::HostList *hosts = hostList;
+        hostList = 0;
+
+        if( !status.IsOK() )
+        {
+          handler->HandleResponseWithHosts( new XrdCl::XRootDStatus( status ),
+                                            0, hosts );
+          return;
+        }
+
+        for( auto &e : scratch )
+          for( size_t i = e.first; i <= e.last; ++i )
+            memcpy( chunks[i].buffer, e.buffer + ( chunks[i].offset - e.offset ),
+                    chunks[i].length );
+
+        XrdCl::VectorReadInfo *info = new XrdCl::VectorReadInfo();
+        uint32_t size = 0;
+        for( auto &c : chunks ) size += c.length;
+        info->SetSize( size );
+        info->GetChunks() = std::move( chunks );
+
+        XrdCl::AnyObject *obj = new XrdCl::AnyObject();
+        obj->Set( info );
+        handler->HandleResponseWithHosts( new XrdCl::XRootDStatus(), obj,
+                                          hosts ? hosts : new XrdCl::HostList() );
+      }
+
+      XrdCl::ResponseHandler                 *handler;
+      XrdCl::ChunkList                        chunks;
+      std::vector<ReadVElement>               scratch;
+      std::vector<std::unique_ptr<char[]>>    buffers;
+      XrdSysMutex                             mutex;
+      size_t                                  pending;
+      XrdCl::XRootDStatus                     status;
+      XrdCl::HostList                        *hostList;
+  };
+
+  //----------------------------------------------------------------------------
+  // Helper callback for one part of a split vector read
+  //----------------------------------------------------------------------------
+  class VectorReadPartHandler : public XrdCl::ResponseHandler
+  {
+    public:
+      VectorReadPartHandler( std::shared_ptr<VectorReadGroup> &group ):
+        group( group )
+      {
+      }
+
+      virtual void HandleResponseWithHosts( XrdCl::XRootDStatus *status,
+                                            XrdCl::AnyObject    *response,
+                                            XrdCl::HostList     *hostList )
+      {
+        if( group->PartDone( *status, hostList ) )
+          group->Finish();
+        delete status;
+        delete response;
+        delete this;
+      }
+
+    private:
+      std::shared_ptr<VectorReadGroup> group;
+  };
 }
 
 namespace XrdCl
@@ -654,10 +823,14 @@ namespace XrdCl
     pUseVirtRedirector( true ),
     pIsChannelEncrypted( false ),
     pAllowBundledClose( false ),
+    pDoReadAhead( false ),
     pPlugin( plugin )
   {
     pFileHandle = new uint8_t[4];
     ResetMonitoringVars();
+    int readAhead = DefaultReadAhead;
+    DefaultEnv::GetEnv()->GetInt( "ReadAhead", readAhead );
+    pDoReadAhead = readAhead;
     DefaultEnv::GetForkHandler()->RegisterFileObject( this );
     DefaultEnv::GetFileTimer()->RegisterFileObject( this );
     pLFileHandler = new LocalFileHandler();
@@ -686,10 +859,14 @@ namespace XrdCl
     pFollowRedirects( true ),
     pUseVirtRedirector( useVirtRedirector ),
     pAllowBundledClose( false ),
+    pDoReadAhead( false ),
     pPlugin( plugin )
   {
     pFileHandle = new uint8_t[4];
     ResetMonitoringVars();
+    int readAhead = DefaultReadAhead;
+    DefaultEnv::GetEnv()->GetInt( "ReadAhead", readAhead );
+    pDoReadAhead = readAhead;
     DefaultEnv::GetForkHandler()->RegisterFileObject( this );
     DefaultEnv::GetFileTimer()->RegisterFileObject( this );
     pLFileHandler = new LocalFileHandler();
@@ -828,6 +1005,10 @@ namespace XrdCl
                   self.get(), self->pFileUrl->GetURL().c_str() );
     }
 
+    it = urlParams.find( "xrdcl.readahead" );
+    if( it != urlParams.end() )
+      self->pDoReadAhead = ( it->second == "true" );
+
     //--------------------------------------------------------------------------
     // Open the file
     //--------------------------------------------------------------------------
@@ -1010,6 +1191,27 @@ namespace XrdCl
                                        void            *buffer,
                                        ResponseHandler *handler,
                                        uint16_t         timeout )
+  {
+    std::shared_ptr<ReadAhead> readAhead;
+    {
+      XrdSysMutexHelper scopedLock( self->pMutex );
+      readAhead = self->pReadAhead;
+    }
+
+    if( readAhead )
+      return readAhead->Read( self, offset, size, buffer, handler, timeout );
+    return ReadImpl( self, offset, size, buffer, handler, timeout );
+  }
+
+  //----------------------------------------------------------------------------
+  // Read a data chunk at a given offset, bypassing the read-ahead
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::ReadImpl( std::shared_ptr<FileStateHandler> &self,
+                                           uint64_t         offset,
+                                           uint32_t         size,
+                                           void            *buffer,
+                                           ResponseHandler *handler,
+                                           uint16_t         timeout )
   {
     XrdSysMutexHelper scopedLock( self->pMutex );
 
@@ -1613,28 +1815,14 @@ namespace XrdCl
                 *((uint32_t*)self->pFileHandle), self->pDataServer->GetHostId().c_str() );
 
     //--------------------------------------------------------------------------
-    // Build the message
+    // Figure out where the data should go
     //--------------------------------------------------------------------------
-    Message            *msg;
-    ClientReadVRequest *req;
-    MessageUtils::CreateRequest( msg, req, sizeof(readahead_list)*chunks.size() );
-
-    req->requestid = kXR_readv;
-    req->dlen      = sizeof(readahead_list)*chunks.size();
-
-    ChunkList *list   = new ChunkList();
+    ChunkList  list;
     char      *cursor = (char*)buffer;
-
-    //--------------------------------------------------------------------------
-    // Copy the chunk info
-    //--------------------------------------------------------------------------
-    readahead_list *dataChunk = (readahead_list*)msg->GetBuffer( 24 );
+    bool       noBuff = false;
+    list.reserve( chunks.size() );
     for( size_t i = 0; i < chunks.size(); ++i )
     {
-      dataChunk[i].rlen   = chunks[i].length;
-      dataChunk[i].offset = chunks[i].offset;
-      memcpy( dataChunk[i].fhandle, self->pFileHandle, 4 );
-
       void *chunkBuffer;
       if( cursor )
       {
@@ -1644,9 +1832,189 @@ namespace XrdCl
       else
         chunkBuffer = chunks[i].buffer;
 
-      list->push_back( ChunkInfo( chunks[i].offset,
-                                  chunks[i].length,
-                                  chunkBuffer ) );
+      if( !chunkBuffer ) noBuff = true;
+      list.push_back( ChunkInfo( chunks[i].offset,
+                                 chunks[i].length,
+                                 chunkBuffer ) );
+    }
+
+    if( noBuff || chunks.empty() || self->pDataServer->IsLocalFile() )
+      return SendReadV( self, new ChunkList( std::move( list ) ), handler,
+                        timeout );
+
+    //--------------------------------------------------------------------------
+    // Merge the chunks that are adjacent both in the file and in memory,
+    // and, within the allowed waste, the ones separated by small gaps
+    //--------------------------------------------------------------------------
+    ReadVLimits limits;
+    {
+      XrdSysMutexHelper limitsLock( readVLimitsMutex );
+      auto it = readVLimits.find( self->pDataServer->GetHostId() );
+      if( it != readVLimits.end() ) limits = it->second;
+    }
+
+    Env *env = DefaultEnv::GetEnv();
+    int mergeWaste = DefaultReadVMergeWaste;
+    int streams    = DefaultSubStreamsPerChannel;
+    env->GetInt( "ReadVMergeWaste",      mergeWaste );
+    env->GetInt( "SubStreamsPerChannel", streams );
+
+    std::vector<ReadVElement> elements;
+    elements.reserve( list.size() );
+    for( size_t i = 0; i < list.size(); ++i )
+    {
+      char *chunkBuffer = static_cast<char*>( list[i].buffer );
+      if( !elements.empty() )
+      {
+        ReadVElement &e    = elements.back();
+        uint64_t      eEnd = e.offset + e.length;
+        if( list[i].offset >= eEnd )
+        {
+          uint64_t gap    = list[i].offset - eEnd;
+          uint64_t newLen = list[i].offset + list[i].length - e.offset;
+          if( !gap && e.buffer && e.buffer + e.length == chunkBuffer &&
+              newLen <= std::numeric_limits<uint32_t>::max() )
+          {
+            e.length  = newLen;
+            e.last    = i;
+            e.useful += list[i].length;
+            continue;
+          }
+
+          if( mergeWaste > 0 && newLen <= limits.iorMax &&
+              ( e.waste + gap ) * 100 <= uint64_t( mergeWaste ) *
+                                         ( e.useful + list[i].length ) )
+          {
+            e.buffer  = 0;
+            e.length  = newLen;
+            e.last    = i;
+            e.useful += list[i].length;
+            e.waste  += gap;
+            continue;
+          }
+        }
+      }
+
+      ReadVElement e;
+      e.offset = list[i].offset;
+      e.length = list[i].length;
+      e.buffer = chunkBuffer;
+      e.first  = e.last = i;
+      e.useful = list[i].length;
+      e.waste  = 0;
+      elements.push_back( e );
+    }
+
+    //--------------------------------------------------------------------------
+    // Split the elements exceeding the server limit
+    //--------------------------------------------------------------------------
+    std::shared_ptr<VectorReadGroup> group;
+    ChunkList pieces;
+    uint64_t  total = 0;
+    for( auto &e : elements )
+    {
+      char *elemBuffer = e.buffer;
+      if( !elemBuffer )
+      {
+        if( !group )
+          group = std::make_shared<VectorReadGroup>( handler, ChunkList() );
+        group->buffers.emplace_back( new char[e.length] );
+        elemBuffer = e.buffer = group->buffers.back().get();
+        group->scratch.push_back( e );
+      }
+
+      for( uint64_t off = 0; off < e.length; off += limits.iorMax )
+        pieces.push_back( ChunkInfo( e.offset + off,
+                                     std::min<uint64_t>( e.length - off,
+                                                         limits.iorMax ),
+                                     elemBuffer + off ) );
+      total += e.length;
+    }
+
+    //--------------------------------------------------------------------------
+    // Fan the pieces out over as many requests as the server limits require,
+    // or as there are substreams to carry them if the read is large enough
+    //--------------------------------------------------------------------------
+    const uint64_t minPart = 1024*1024;
+    size_t nbParts = ( pieces.size() + limits.iovMax - 1 ) / limits.iovMax;
+    if( streams > 2 )
+    {
+      size_t fanOut = std::min<uint64_t>( std::min<uint64_t>( streams - 1,
+                                                              pieces.size() ),
+                                          total / minPart );
+      nbParts = std::max( nbParts, fanOut );
+    }
+
+    if( pieces.empty() ||
+        ( nbParts <= 1 && !group && pieces.size() == list.size() ) )
+      return SendReadV( self, new ChunkList( std::move( list ) ), handler,
+                        timeout );
+
+    if( !group )
+      group = std::make_shared<VectorReadGroup>( handler, std::move( list ) );
+    else
+      group->chunks = std::move( list );
+
+    log->Debug( FileMsg, "[0x%x@%s] Vector read of %zu chunks sent as %zu "
+                "requests with %zu elements", self.get(),
+                self->pFileUrl->GetURL().c_str(), chunks.size(), nbParts,
+                pieces.size() );
+
+    //--------------------------------------------------------------------------
+    // Send the parts, if one of them cannot be sent the ones that have been
+    // still need to come back before the user is notified
+    //--------------------------------------------------------------------------
+    nbParts = std::max<size_t>( nbParts, 1 );
+    size_t perPart = ( pieces.size() + nbParts - 1 ) / nbParts;
+    group->pending = ( pieces.size() + perPart - 1 ) / perPart;
+    for( size_t i = 0; i < pieces.size(); i += perPart )
+    {
+      size_t     n    = std::min( perPart, pieces.size() - i );
+      ChunkList *part = new ChunkList( pieces.begin() + i,
+                                       pieces.begin() + i + n );
+      VectorReadPartHandler *partHandler = new VectorReadPartHandler( group );
+      XRootDStatus st = SendReadV( self, part, partHandler, timeout );
+      if( st.IsOK() ) continue;
+
+      delete partHandler;
+      size_t unsent = ( pieces.size() - i + perPart - 1 ) / perPart;
+      if( i == 0 ) return st;
+      bool last = false;
+      for( size_t j = 0; j < unsent; ++j )
+        last = group->PartDone( st, 0 );
+      if( last ) group->Finish();
+      break;
+    }
+    return XRootDStatus();
+  }
+
+  //----------------------------------------------------------------------------
+  // Send a single kXR_readv request
+  //----------------------------------------------------------------------------
+  XRootDStatus FileStateHandler::SendReadV( std::shared_ptr<FileStateHandler> &self,
+                                            ChunkList                         *list,
+                                            ResponseHandler                   *handler,
+                                            uint16_t                           timeout )
+  {
+    //--------------------------------------------------------------------------
+    // Build the message
+    //--------------------------------------------------------------------------
+    Message            *msg;
+    ClientReadVRequest *req;
+    MessageUtils::CreateRequest( msg, req, sizeof(readahead_list)*list->size() );
+
+    req->requestid = kXR_readv;
+    req->dlen      = sizeof(readahead_list)*list->size();
+
+    //--------------------------------------------------------------------------
+    // Copy the chunk info
+    //--------------------------------------------------------------------------
+    readahead_list *dataChunk = (readahead_list*)msg->GetBuffer( 24 );
+    for( size_t i = 0; i < list->size(); ++i )
+    {
+      dataChunk[i].rlen   = (*list)[i].length;
+      dataChunk[i].offset = (*list)[i].offset;
+      memcpy( dataChunk[i].fhandle, self->pFileHandle, 4 );
     }
 
     //--------------------------------------------------------------------------
@@ -2266,6 +2634,12 @@ namespace XrdCl
       else pAllowBundledClose = false;
       return true;
     }
+    else if( name == "ReadAhead" )
+    {
+      if( value == "true" ) pDoReadAhead = true;
+      else pDoReadAhead = false;
+      return true;
+    }
     return false;
   }
 
@@ -2294,6 +2668,12 @@ namespace XrdCl
       else value = "false";
       return true;
     }
+    else if( name == "ReadAhead" )
+    {
+      if( pDoReadAhead ) value = "true";
+      else value = "false";
+      return true;
+    }
     else if( name == "DataServer" && pDataServer )
       { value = pDataServer->GetHostId(); return true; }
     else if( name == "LastURL" && pDataServer )
@@ -2437,6 +2817,19 @@ namespace XrdCl
         mon->Event( Monitor::EvOpen, &i );
       }
 
+      if( !pDataServer->IsLocalFile() )
+        QueryReadVLimits();
+
+      //------------------------------------------------------------------------
+      // Set up the read-ahead, it is only safe if nobody writes to the file
+      //------------------------------------------------------------------------
+      const uint16_t wrtFlags = OpenFlags::Update | OpenFlags::Write |
+                                OpenFlags::Delete | OpenFlags::New;
+      if( pDoReadAhead && !pReadAhead && !( pOpenFlags & wrtFlags ) &&
+          !pDataServer->IsLocalFile() )
+        pReadAhead = std::make_shared<ReadAhead>( pStatInfo ?
+                                                  pStatInfo->GetSize() : 0 );
+
       //------------------------------------------------------------------------
       // Resend the queued messages if any
       //------------------------------------------------------------------------
@@ -2463,6 +2856,7 @@ namespace XrdCl
 
     MonitorClose( status );
     ResetMonitoringVars();
+    pReadAhead.reset();
 
     pStatus    = *status;
     pFileState = Closed;
@@ -3214,6 +3608,40 @@ namespace XrdCl
       i.status  = status;
       mon->Event( Monitor::EvClose, &i );
     }
+
+    if( pReadAhead )
+      pReadAhead->Close( pFileUrl );
+  }
+
+  //----------------------------------------------------------------------------
+  // Ask the data server for its vector read limits, once per server
+  //----------------------------------------------------------------------------
+  void FileStateHandler::QueryReadVLimits()
+  {
+    std::string hostId = pDataServer->GetHostId();
+    {
+      XrdSysMutexHelper scopedLock( readVLimitsMutex );
+      if( readVLimits.count( hostId ) ) return;
+      readVLimits[hostId] = ReadVLimits();
+    }
+
+    static const std::string query = "readv_iov_max readv_ior_max";
+    Message            *msg;
+    ClientQueryRequest *req;
+    MessageUtils::CreateRequest( msg, req, query.size() );
+
+    req->requestid = kXR_query;
+    req->infotype  = kXR_Qconfig;
+    req->dlen      = query.size();
+    msg->Append( query.c_str(), query.size(), 24 );
+
+    MessageSendParams params;
+    MessageUtils::ProcessSendParams( params );
+    XRootDTransport::SetDescription( msg );
+
+    ReadVLimitsHandler *handler = new ReadVLimitsHandler( hostId );
+    if( !IssueRequest( *pDataServer, msg, handler, params ).IsOK() )
+      delete handler;
   }
 
   XRootDStatus FileStateHandler::IssueRequest( const URL         &url,
@@ -32,6 +32,7 @@
 #include "XrdCl/XrdClLocalFileHandler.hh"
 #include "XrdCl/XrdClOptional.hh"
 #include "XrdCl/XrdClPlugInInterface.hh"
+#include "XrdCl/XrdClReadAhead.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSys/XrdSysPageSize.hh"
 
@@ -185,6 +186,18 @@ namespace XrdCl
                                 ResponseHandler                   *handler,
                                 uint16_t                           timeout = 0 );
 
+      //------------------------------------------------------------------------
+      //! Read a data chunk at a given offset, bypassing the read-ahead
+      //!
+      //! @see FileStateHandler::Read for the parameters
+      //------------------------------------------------------------------------
+      static XRootDStatus ReadImpl( std::shared_ptr<FileStateHandler> &self,
+                                    uint64_t                           offset,
+                                    uint32_t                           size,
+                                    void                              *buffer,
+                                    ResponseHandler                   *handler,
+                                    uint16_t                           timeout = 0 );
+
       //------------------------------------------------------------------------
       //! Read data pages at a given offset
       //!
@@ -832,6 +845,19 @@ namespace XrdCl
       //------------------------------------------------------------------------
       void MonitorClose( const XRootDStatus *status );
 
+      //------------------------------------------------------------------------
+      //! Ask the data server for its vector read limits
+      //------------------------------------------------------------------------
+      void QueryReadVLimits();
+
+      //------------------------------------------------------------------------
+      //! Send a single kXR_readv request for the given chunks
+      //------------------------------------------------------------------------
+      static XRootDStatus SendReadV( std::shared_ptr<FileStateHandler> &self,
+                                     ChunkList                         *list,
+                                     ResponseHandler                   *handler,
+                                     uint16_t                           timeout );
+
       //------------------------------------------------------------------------
       //! Issues request:
       //!  - if the request is for a Metalink a redirect is generated
@@ -875,6 +901,7 @@ namespace XrdCl
       bool                    pUseVirtRedirector;
       bool                    pIsChannelEncrypted;
       bool                    pAllowBundledClose;
+      bool                    pDoReadAhead;
 
       //------------------------------------------------------------------------
       // Monitoring variables
@@ -896,6 +923,11 @@ namespace XrdCl
       //------------------------------------------------------------------------
       LocalFileHandler      *pLFileHandler;
 
+      //------------------------------------------------------------------------
+      // Read-ahead engine, only set for files opened for reading
+      //------------------------------------------------------------------------
+      std::shared_ptr<ReadAhead> pReadAhead;
+
       //------------------------------------------------------------------------
       // Responsible for Writing/Reading erasure-coded files
       //------------------------------------------------------------------------
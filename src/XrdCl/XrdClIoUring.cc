@@ -0,0 +1,477 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "XrdCl/XrdClIoUring.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClLog.hh"
+#include "XrdSys/XrdSysE2T.hh"
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <unistd.h>
+
+#ifdef HAVE_IO_URING
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // The raw system calls, so that we don't depend on liburing
+  //----------------------------------------------------------------------------
+  inline int Setup( unsigned entries, io_uring_params *params )
+  {
+    return syscall( __NR_io_uring_setup, entries, params );
+  }
+
+  inline int Enter( int fd, unsigned submit, unsigned minComplete,
+                    unsigned flags )
+  {
+    return syscall( __NR_io_uring_enter, fd, submit, minComplete, flags, 0, 0 );
+  }
+}
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  // The ring itself, the indices shared with the kernel are accessed with
+  // the atomic builtins since they are plain memory from our point of view
+  //----------------------------------------------------------------------------
+  struct IoUring::Impl
+  {
+    Impl(): ringFd( -1 ), pid( 0 ), sqHead( 0 ), sqTail( 0 ), sqMask( 0 ),
+            sqArray( 0 ), sqEntries( 0 ), sqes( 0 ), cqHead( 0 ), cqTail( 0 ),
+            cqMask( 0 ), cqes( 0 ), cqEntries( 0 ), sqPtr( MAP_FAILED ),
+            cqPtr( MAP_FAILED ), sqesPtr( MAP_FAILED ), sqLen( 0 ), cqLen( 0 ),
+            sqesLen( 0 ), stopping( false ), inFlight( 0 ) {}
+
+    ~Impl()
+    {
+      if( sqesPtr != MAP_FAILED ) munmap( sqesPtr, sqesLen );
+      if( cqPtr != MAP_FAILED && cqPtr != sqPtr ) munmap( cqPtr, cqLen );
+      if( sqPtr != MAP_FAILED ) munmap( sqPtr, sqLen );
+      if( ringFd >= 0 ) close( ringFd );
+    }
+
+    bool Init( unsigned depth );
+    bool Push( uint8_t opcode, int fd, uint64_t offset, uint32_t size,
+               void *buffer, Request *req );
+    void Reap();
+    void Stop();
+
+    int                    ringFd;
+    pid_t                  pid;
+    pthread_t              reaper;
+
+    unsigned              *sqHead;
+    unsigned              *sqTail;
+    unsigned              *sqMask;
+    unsigned              *sqArray;
+    unsigned               sqEntries;
+    io_uring_sqe          *sqes;
+
+    unsigned              *cqHead;
+    unsigned              *cqTail;
+    unsigned              *cqMask;
+    io_uring_cqe          *cqes;
+    unsigned               cqEntries;
+
+    void                  *sqPtr;
+    void                  *cqPtr;
+    void                  *sqesPtr;
+    size_t                 sqLen;
+    size_t                 cqLen;
+    size_t                 sqesLen;
+
+    XrdSysMutex            submitMutex;
+    bool                   stopping;
+    std::atomic<unsigned>  inFlight;
+  };
+
+  //----------------------------------------------------------------------------
+  // The ring of the process, set up on first use. These are constant
+  // initialized and never destroyed, so they are still usable when the
+  // environment is finalized by the static destructors.
+  //----------------------------------------------------------------------------
+  static std::mutex            sRingMutex;
+  static std::atomic<bool>     sRingInitialized( false );
+  static std::atomic<IoUring*> sRing( 0 );
+
+  //----------------------------------------------------------------------------
+  // Create the ring and map its memory
+  //----------------------------------------------------------------------------
+  bool IoUring::Impl::Init( unsigned depth )
+  {
+    io_uring_params params;
+    memset( &params, 0, sizeof( params ) );
+    ringFd = Setup( depth, &params );
+    if( ringFd < 0 ) return false;
+
+    //--------------------------------------------------------------------------
+    // IORING_OP_READ and IORING_OP_WRITE came together with this one
+    //--------------------------------------------------------------------------
+    if( !( params.features & IORING_FEAT_RW_CUR_POS ) )
+    {
+      errno = ENOTSUP;
+      return false;
+    }
+
+    sqLen   = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+    cqLen   = params.cq_off.cqes  + params.cq_entries * sizeof( io_uring_cqe );
+    sqesLen = params.sq_entries * sizeof( io_uring_sqe );
+
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if( single && cqLen > sqLen ) sqLen = cqLen;
+
+    sqPtr = mmap( 0, sqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ringFd, IORING_OFF_SQ_RING );
+    if( sqPtr == MAP_FAILED ) return false;
+
+    if( single )
+      cqPtr = sqPtr;
+    else
+    {
+      cqPtr = mmap( 0, cqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ringFd, IORING_OFF_CQ_RING );
+      if( cqPtr == MAP_FAILED ) return false;
+    }
+
+    sqesPtr = mmap( 0, sqesLen, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES );
+    if( sqesPtr == MAP_FAILED ) return false;
+
+    char *sq  = static_cast<char*>( sqPtr );
+    char *cq  = static_cast<char*>( cqPtr );
+    sqHead    = reinterpret_cast<unsigned*>( sq + params.sq_off.head );
+    sqTail    = reinterpret_cast<unsigned*>( sq + params.sq_off.tail );
+    sqMask    = reinterpret_cast<unsigned*>( sq + params.sq_off.ring_mask );
+    sqArray   = reinterpret_cast<unsigned*>( sq + params.sq_off.array );
+    sqEntries = params.sq_entries;
+    sqes      = static_cast<io_uring_sqe*>( sqesPtr );
+    cqHead    = reinterpret_cast<unsigned*>( cq + params.cq_off.head );
+    cqTail    = reinterpret_cast<unsigned*>( cq + params.cq_off.tail );
+    cqMask    = reinterpret_cast<unsigned*>( cq + params.cq_off.ring_mask );
+    cqes      = reinterpret_cast<io_uring_cqe*>( cq + params.cq_off.cqes );
+    cqEntries = params.cq_entries;
+    pid       = getpid();
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Queue an entry and hand it to the kernel, a request without a handler
+  // wakes the reaper up; must be called with the submit mutex held
+  //----------------------------------------------------------------------------
+  bool IoUring::Impl::Push( uint8_t opcode, int fd, uint64_t offset,
+                            uint32_t size, void *buffer, Request *req )
+  {
+    unsigned tail = *sqTail;
+    unsigned head = __atomic_load_n( sqHead, __ATOMIC_ACQUIRE );
+    if( tail - head >= sqEntries ) return false;
+
+    unsigned      idx = tail & *sqMask;
+    io_uring_sqe *sqe = &sqes[idx];
+    memset( sqe, 0, sizeof( io_uring_sqe ) );
+    sqe->opcode    = opcode;
+    sqe->fd        = fd;
+    sqe->off       = offset;
+    sqe->addr      = reinterpret_cast<uint64_t>( buffer );
+    sqe->len       = size;
+    sqe->user_data = reinterpret_cast<uint64_t>( req );
+    sqArray[idx] = idx;
+    __atomic_store_n( sqTail, tail + 1, __ATOMIC_RELEASE );
+    if( req ) ++inFlight;
+
+    int rc;
+    do rc = Enter( ringFd, 1, 0, 0 );
+    while( rc < 0 && errno == EINTR );
+
+    //--------------------------------------------------------------------------
+    // If the kernel did not take the entry we take it back, the caller will
+    // use the fallback
+    //--------------------------------------------------------------------------
+    if( rc < 1 && __atomic_load_n( sqHead, __ATOMIC_ACQUIRE ) == tail )
+    {
+      int err = errno;
+      __atomic_store_n( sqTail, tail, __ATOMIC_RELEASE );
+      if( req ) --inFlight;
+      errno = err;
+      return false;
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Wait for the completions and notify the requests, until told to stop and
+  // nothing is in flight anymore
+  //----------------------------------------------------------------------------
+  void IoUring::Impl::Reap()
+  {
+    Log *log = DefaultEnv::GetLog();
+    bool stop = false;
+    while( !stop || inFlight )
+    {
+      unsigned head = __atomic_load_n( cqHead, __ATOMIC_RELAXED );
+      unsigned tail = __atomic_load_n( cqTail, __ATOMIC_ACQUIRE );
+      if( head == tail )
+      {
+        if( Enter( ringFd, 0, 1, IORING_ENTER_GETEVENTS ) < 0 &&
+            errno != EINTR && errno != EAGAIN && errno != EBUSY )
+        {
+          log->Error( FileMsg, "io_uring: waiting for completions failed: %s",
+                      XrdSysE2T( errno ) );
+          XrdSysTimer::Wait( 100 );
+        }
+        continue;
+      }
+
+      //------------------------------------------------------------------------
+      // Free the slot before calling the request so that it can resubmit
+      //------------------------------------------------------------------------
+      while( head != tail )
+      {
+        io_uring_cqe *cqe = &cqes[head & *cqMask];
+        Request *req = reinterpret_cast<Request*>( cqe->user_data );
+        int      res = cqe->res;
+        ++head;
+        __atomic_store_n( cqHead, head, __ATOMIC_RELEASE );
+        if( !req )
+        {
+          stop = true;
+          continue;
+        }
+        --inFlight;
+        req->Done( res );
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Refuse new requests and let the reaper finish those in flight
+  //----------------------------------------------------------------------------
+  void IoUring::Impl::Stop()
+  {
+    //--------------------------------------------------------------------------
+    // The reaper does not exist in a forked child, there is nothing to wait
+    // for
+    //--------------------------------------------------------------------------
+    if( pid != getpid() ) return;
+
+    bool woken;
+    {
+      XrdSysMutexHelper scopedLock( submitMutex );
+      stopping = true;
+      woken    = Push( IORING_OP_NOP, -1, 0, 0, 0, 0 );
+    }
+
+    if( !woken )
+    {
+      //------------------------------------------------------------------------
+      // Without the wake-up the reaper would wait forever, so leave it be
+      //------------------------------------------------------------------------
+      DefaultEnv::GetLog()->Error( FileMsg, "io_uring: unable to stop the "
+                                   "reaper thread: %s", XrdSysE2T( errno ) );
+      pthread_detach( reaper );
+      return;
+    }
+    pthread_join( reaper, 0 );
+  }
+
+  //----------------------------------------------------------------------------
+  // Destructor
+  //----------------------------------------------------------------------------
+  IoUring::~IoUring()
+  {
+    delete pImpl;
+  }
+
+  //----------------------------------------------------------------------------
+  // Get the ring of the process
+  //----------------------------------------------------------------------------
+  IoUring *IoUring::Get()
+  {
+    IoUring *ring = sRing;
+    if( sRingInitialized && ( !ring || ring->pImpl->pid == getpid() ) )
+      return ring;
+
+    std::lock_guard<std::mutex> scopedLock( sRingMutex );
+    ring = sRing;
+    if( !sRingInitialized || ( ring && ring->pImpl->pid != getpid() ) )
+    {
+      //------------------------------------------------------------------------
+      // The ring of a parent is shared with it and its reaper did not survive
+      // the fork, so a child sets up a ring of its own. Falling back to POSIX
+      // aio instead would hang if the parent had used it, glibc does not
+      // reset its idle aio threads on fork.
+      //------------------------------------------------------------------------
+      delete ring;
+      ring = Create();
+      sRing = ring;
+      sRingInitialized = true;
+    }
+    return ring;
+  }
+
+  //----------------------------------------------------------------------------
+  // Tear the ring of the process down
+  //----------------------------------------------------------------------------
+  void IoUring::Shutdown()
+  {
+    std::lock_guard<std::mutex> scopedLock( sRingMutex );
+    IoUring *ring = sRing.exchange( 0 );
+    sRingInitialized = false;
+    if( !ring ) return;
+    ring->pImpl->Stop();
+    delete ring;
+  }
+
+  //----------------------------------------------------------------------------
+  // Set up a ring and start its reaper
+  //----------------------------------------------------------------------------
+  IoUring *IoUring::Create()
+  {
+    Log *log = DefaultEnv::GetLog();
+    int enabled = DefaultIoUring;
+    int depth   = DefaultIoUringDepth;
+    DefaultEnv::GetEnv()->GetInt( "IoUring", enabled );
+    DefaultEnv::GetEnv()->GetInt( "IoUringDepth", depth );
+    if( !enabled ) return 0;
+    if( depth < 1 ) depth = 1;
+
+    Impl *impl = new Impl();
+    if( !impl->Init( depth ) )
+    {
+      log->Debug( FileMsg, "io_uring not available (%s), using POSIX aio "
+                  "for local files", XrdSysE2T( errno ) );
+      delete impl;
+      return 0;
+    }
+
+    auto reaper = []( void *arg ) -> void*
+    {
+      static_cast<Impl*>( arg )->Reap();
+      return 0;
+    };
+
+    int rc = pthread_create( &impl->reaper, 0, reaper, impl );
+    if( rc )
+    {
+      log->Error( FileMsg, "io_uring: unable to start the reaper thread: %s",
+                  XrdSysE2T( rc ) );
+      delete impl;
+      return 0;
+    }
+
+    log->Debug( FileMsg, "Using io_uring for local files, %d entries",
+                impl->sqEntries );
+    return new IoUring( impl );
+  }
+
+  //----------------------------------------------------------------------------
+  // Submit a request
+  //----------------------------------------------------------------------------
+  bool IoUring::Submit( uint8_t opcode, int fd, uint64_t offset, uint32_t size,
+                        void *buffer, Request *req )
+  {
+    Impl *r = pImpl;
+    XrdSysMutexHelper scopedLock( r->submitMutex );
+
+    //--------------------------------------------------------------------------
+    // Never have more requests in flight than the completion queue can hold
+    //--------------------------------------------------------------------------
+    if( r->stopping || r->inFlight >= r->cqEntries ) return false;
+    return r->Push( opcode, fd, offset, size, buffer, req );
+  }
+}
+
+#else
+
+namespace XrdCl
+{
+  struct IoUring::Impl {};
+
+  IoUring::~IoUring()
+  {
+    delete pImpl;
+  }
+
+  IoUring *IoUring::Get()
+  {
+    return 0;
+  }
+
+  void IoUring::Shutdown()
+  {
+  }
+
+  bool IoUring::Submit( uint8_t, int, uint64_t, uint32_t, void*, Request* )
+  {
+    return false;
+  }
+}
+
+#endif
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  // Submit a read
+  //----------------------------------------------------------------------------
+  bool IoUring::Read( int fd, uint64_t offset, uint32_t size, void *buffer,
+                      Request *req )
+  {
+#ifdef HAVE_IO_URING
+    return Submit( IORING_OP_READ, fd, offset, size, buffer, req );
+#else
+    return false;
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  // Submit a write
+  //----------------------------------------------------------------------------
+  bool IoUring::Write( int fd, uint64_t offset, uint32_t size,
+                       const void *buffer, Request *req )
+  {
+#ifdef HAVE_IO_URING
+    return Submit( IORING_OP_WRITE, fd, offset, size,
+                   const_cast<void*>( buffer ), req );
+#else
+    return false;
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  // Submit a fsync
+  //----------------------------------------------------------------------------
+  bool IoUring::Fsync( int fd, Request *req )
+  {
+#ifdef HAVE_IO_URING
+    return Submit( IORING_OP_FSYNC, fd, 0, 0, 0, req );
+#else
+    return false;
+#endif
+  }
+}
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef __XRD_CL_IO_URING_HH__
+#define __XRD_CL_IO_URING_HH__
+
+#include <cstdint>
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  //! Asynchronous local file I/O on top of a Linux io_uring.
+  //!
+  //! A single ring is shared by all the local files of the process. The
+  //! requests are submitted by the calling thread and their completions are
+  //! reaped by one dedicated thread, so the number of threads does not grow
+  //! with the number of outstanding requests as it does with POSIX aio.
+  //----------------------------------------------------------------------------
+  class IoUring
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! A request to be notified about its completion
+      //------------------------------------------------------------------------
+      class Request
+      {
+        public:
+          virtual ~Request() {}
+
+          //--------------------------------------------------------------------
+          //! Called by the reaper thread when the request is done
+          //!
+          //! @param result number of bytes transferred or -errno
+          //--------------------------------------------------------------------
+          virtual void Done( int result ) = 0;
+      };
+
+      //------------------------------------------------------------------------
+      //! Get the ring of the process
+      //!
+      //! @return the ring or 0 if io_uring is disabled or not supported by
+      //!         the system, in which case another engine has to be used
+      //------------------------------------------------------------------------
+      static IoUring *Get();
+
+      //------------------------------------------------------------------------
+      //! Tear the ring of the process down
+      //!
+      //! Waits for the requests in flight to be notified, stops the reaper
+      //! thread and releases the ring. The next call to Get sets up a new
+      //! ring. Must not be called while local files are being accessed.
+      //------------------------------------------------------------------------
+      static void Shutdown();
+
+      //------------------------------------------------------------------------
+      //! Submit a read, the request is notified on completion
+      //!
+      //! @return false if the request could not be queued, in which case
+      //!         it will not be notified
+      //------------------------------------------------------------------------
+      bool Read( int fd, uint64_t offset, uint32_t size, void *buffer,
+                 Request *req );
+
+      //------------------------------------------------------------------------
+      //! Submit a write, the request is notified on completion
+      //!
+      //! @return false if the request could not be queued, in which case
+      //!         it will not be notified
+      //------------------------------------------------------------------------
+      bool Write( int fd, uint64_t offset, uint32_t size, const void *buffer,
+                  Request *req );
+
+      //------------------------------------------------------------------------
+      //! Submit a fsync, the request is notified on completion
+      //!
+      //! @return false if the request could not be queued, in which case
+      //!         it will not be notified
+      //------------------------------------------------------------------------
+      bool Fsync( int fd, Request *req );
+
+    private:
+      struct Impl;
+
+      IoUring( Impl *impl ): pImpl( impl ) {}
+      ~IoUring();
+      IoUring( const IoUring& ) = delete;
+      IoUring& operator=( const IoUring& ) = delete;
+
+      static IoUring *Create();
+
+      bool Submit( uint8_t opcode, int fd, uint64_t offset, uint32_t size,
+                   void *buffer, Request *req );
+
+      Impl *pImpl;
+  };
+}
+
+#endif // __XRD_CL_IO_URING_HH__
@@ -20,24 +20,150 @@
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClMonitor.hh"
 #include "XrdSys/XrdSysE2T.hh"
 
-//------------------------------------------------------------------------------
-// The thread
-//------------------------------------------------------------------------------
-extern "C"
+#include <chrono>
+
+namespace
 {
-  static void *RunRunnerThread( void *arg )
+  //----------------------------------------------------------------------------
+  // Slot number of the threads calling RunJobs directly
+  //----------------------------------------------------------------------------
+  const uint32_t noSlot = ~uint32_t( 0 );
+
+  //----------------------------------------------------------------------------
+  // The job manager the current thread works for, if any
+  //----------------------------------------------------------------------------
+  thread_local XrdCl::JobManager *workerOf = 0;
+
+  //----------------------------------------------------------------------------
+  // Monotonic time in nanoseconds
+  //----------------------------------------------------------------------------
+  inline uint64_t Now()
   {
-    using namespace XrdCl;
-    JobManager *mgr = (JobManager*)arg;
-    mgr->RunJobs();
-    return 0;
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>( steady_clock::now().time_since_epoch() ).count();
   }
+
+  struct WorkerArg
+  {
+    XrdCl::JobManager *mgr;
+    uint32_t           slot;
+  };
 }
 
 namespace XrdCl
 {
+  //----------------------------------------------------------------------------
+  // The thread
+  //----------------------------------------------------------------------------
+  void *RunJobManagerWorker( void *arg )
+  {
+    WorkerArg *wa  = static_cast<WorkerArg*>( arg );
+    JobManager *mgr = wa->mgr;
+    uint32_t    slot = wa->slot;
+    delete wa;
+    mgr->Work( slot );
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Ring constructor, the size has to be a power of 2
+  //----------------------------------------------------------------------------
+  JobManager::JobRing::JobRing( size_t size ):
+    pCells( new Cell[size] ), pMask( size - 1 ), pHead( 0 ), pTail( 0 )
+  {
+    for( size_t i = 0; i < size; ++i )
+      pCells[i].seq.store( i, std::memory_order_relaxed );
+  }
+
+  //----------------------------------------------------------------------------
+  // Put a job in the ring, fails if the ring is full
+  //----------------------------------------------------------------------------
+  bool JobManager::JobRing::Push( const JobHelper &job )
+  {
+    size_t pos = pTail.load( std::memory_order_relaxed );
+    for( ;; )
+    {
+      Cell     &cell = pCells[pos & pMask];
+      size_t    seq  = cell.seq.load( std::memory_order_acquire );
+      intptr_t  diff = (intptr_t)seq - (intptr_t)pos;
+      if( diff == 0 )
+      {
+        if( pTail.compare_exchange_weak( pos, pos + 1,
+                                         std::memory_order_relaxed ) )
+        {
+          cell.job = job;
+          cell.seq.store( pos + 1, std::memory_order_release );
+          return true;
+        }
+      }
+      else if( diff < 0 )
+        return false;
+      else
+        pos = pTail.load( std::memory_order_relaxed );
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Take a job from the ring, fails if the ring is empty
+  //----------------------------------------------------------------------------
+  bool JobManager::JobRing::Pop( JobHelper &job )
+  {
+    size_t pos = pHead.load( std::memory_order_relaxed );
+    for( ;; )
+    {
+      Cell     &cell = pCells[pos & pMask];
+      size_t    seq  = cell.seq.load( std::memory_order_acquire );
+      intptr_t  diff = (intptr_t)seq - (intptr_t)( pos + 1 );
+      if( diff == 0 )
+      {
+        if( pHead.compare_exchange_weak( pos, pos + 1,
+                                         std::memory_order_relaxed ) )
+        {
+          job = cell.job;
+          cell.seq.store( pos + pMask + 1, std::memory_order_release );
+          return true;
+        }
+      }
+      else if( diff < 0 )
+        return false;
+      else
+        pos = pHead.load( std::memory_order_relaxed );
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  JobManager::JobManager( uint32_t workers, uint32_t maxWorkers ):
+    pMinWorkers( workers ),
+    pMaxWorkers( std::max( workers, maxWorkers ) ),
+    pNbWorkers( 0 ),
+    pRing( pRingSize ),
+    pOverflowSize( 0 ),
+    pQueued( 0 ),
+    pIdle( 0 ),
+    pGrowing( false ),
+    pSleepCond( 0 ),
+    pWakeups( 0 ),
+    pStopping( false ),
+    pRunning( false ),
+    pLastReport( Now() )
+  {
+    pWorkers.reset( new Worker[pMaxWorkers] );
+    for( int i = 0; i < pHistBins; ++i )
+      pLatency[i] = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Destructor
+  //----------------------------------------------------------------------------
+  JobManager::~JobManager()
+  {
+  }
+
   //----------------------------------------------------------------------------
   // Initialize the job manager
   //----------------------------------------------------------------------------
@@ -51,7 +177,8 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   bool JobManager::Finalize()
   {
-    pJobs.Clear();
+    JobHelper h;
+    while( Get( h ) ) ;
     return true;
   }
 
@@ -70,20 +197,22 @@ namespace XrdCl
       return false;
     }
 
-    for( uint32_t i = 0; i < pWorkers.size(); ++i )
+    pStopping = false;
+    pWakeups  = 0;
+    pIdle     = 0;
+
+    for( uint32_t i = 0; i < pMinWorkers; ++i )
     {
-      int ret = ::pthread_create( &pWorkers[i], 0, ::RunRunnerThread, this );
-      if( ret != 0 )
+      if( !SpawnWorker( i ) )
       {
-        log->Error( JobMgrMsg, "Unable to spawn a job worker thread: %s",
-                    XrdSysE2T( errno ) );
         if( i > 0 )
           StopWorkers( i );
         return false;
       }
     }
     pRunning = true;
-    log->Debug( JobMgrMsg, "Job manager started, %d workers", pWorkers.size() );
+    log->Debug( JobMgrMsg, "Job manager started, %d workers (up to %d)",
+                pMinWorkers, pMaxWorkers );
     return true;
   }
 
@@ -101,57 +230,318 @@ namespace XrdCl
       return false;
     }
 
-    StopWorkers( pWorkers.size() );
+    StopWorkers( pMaxWorkers );
 
     pRunning = false;
     log->Debug( JobMgrMsg, "Job manager stopped" );
     return true;
   }
 
+  //----------------------------------------------------------------------------
+  // Add a job to be run
+  //----------------------------------------------------------------------------
+  void JobManager::QueueJob( Job *job, void *arg )
+  {
+    //--------------------------------------------------------------------------
+    // Once something went to the overflow list everything goes there until
+    // it is drained, so that the jobs are still run in order
+    //--------------------------------------------------------------------------
+    JobHelper h( job, arg, Now() );
+    if( pOverflowSize.load() || !pRing.Push( h ) )
+    {
+      XrdSysMutexHelper scopedLock( pOverflowMutex );
+      pOverflow.push_back( h );
+      ++pOverflowSize;
+    }
+    ++pQueued;
+    Wake();
+  }
+
+  //----------------------------------------------------------------------------
+  // Run a job in the calling thread
+  //----------------------------------------------------------------------------
+  void JobManager::RunInline( Job *job, void *arg )
+  {
+    JobManager *prev = workerOf;
+    workerOf = this;
+    job->Run( arg );
+    workerOf = prev;
+  }
+
+  //----------------------------------------------------------------------------
+  // Run the jobs
+  //----------------------------------------------------------------------------
+  void JobManager::RunJobs()
+  {
+    Work( noSlot );
+  }
+
+  //----------------------------------------------------------------------------
+  // Check if the calling thread is one of the workers
+  //----------------------------------------------------------------------------
+  bool JobManager::IsWorker()
+  {
+    return workerOf == this;
+  }
+
   //----------------------------------------------------------------------------
   // Stop all workers up to n'th
   //----------------------------------------------------------------------------
   void JobManager::StopWorkers( uint32_t n )
   {
     Log *log = DefaultEnv::GetLog();
+
+    pSleepCond.Lock();
+    pStopping = true;
+    pSleepCond.Broadcast();
+    pSleepCond.UnLock();
+
     for( uint32_t i = 0; i < n; ++i )
     {
+      if( !pWorkers[i].active ) continue;
+
       void *threadRet;
       log->Dump( JobMgrMsg, "Stopping worker #%d...", i );
-      int rc = pthread_cancel( pWorkers[i] );
-      if( rc != 0 )
-      {
-        log->Error( TaskMgrMsg, "Unable to cancel worker #%d: %s", i,
-                    XrdSysE2T( errno ) );
-        if( rc == ESRCH ) continue;
-        abort();
-      }
-      
-      rc = pthread_join( pWorkers[i], (void**)&threadRet );
+      int rc = pthread_join( pWorkers[i].thread, (void**)&threadRet );
       if( rc != 0 )
       {
         log->Error( TaskMgrMsg, "Unable to join worker #%d: %s", i,
-                    XrdSysE2T( errno ) );
-        if( rc == ESRCH ) continue;
-        abort();
+                    XrdSysE2T( rc ) );
+        if( rc != ESRCH ) abort();
       }
 
+      pWorkers[i].active = false;
+      --pNbWorkers;
       log->Dump( JobMgrMsg, "Worker #%d stopped", i );
     }
   }
 
   //----------------------------------------------------------------------------
-  // Initialize the job manager
+  // Take the next job
   //----------------------------------------------------------------------------
-  void JobManager::RunJobs()
+  bool JobManager::Get( JobHelper &job )
   {
-    pthread_setcanceltype( PTHREAD_CANCEL_DEFERRED, 0 );
+    if( pRing.Pop( job ) )
+    {
+      --pQueued;
+      return true;
+    }
+
+    if( pOverflowSize.load() )
+    {
+      XrdSysMutexHelper scopedLock( pOverflowMutex );
+      if( !pOverflow.empty() )
+      {
+        job = pOverflow.front();
+        pOverflow.pop_front();
+        --pOverflowSize;
+        --pQueued;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // Wait for jobs, returns false if the worker should exit
+  //----------------------------------------------------------------------------
+  bool JobManager::Sleep( uint32_t slot )
+  {
+    //--------------------------------------------------------------------------
+    // Tell the producers we are going to sleep and check again, either we
+    // see their job or they see us
+    //--------------------------------------------------------------------------
+    ++pIdle;
+    if( pQueued.load() && Unidle() )
+      return true;
+
+    bool elastic = slot != noSlot && slot >= pMinWorkers;
+    pSleepCond.Lock();
     for( ;; )
     {
-      JobHelper h = pJobs.Get();
-      pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, 0 );
-      h.job->Run( h.arg );
-      pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, 0 );
+      if( pStopping )
+      {
+        pSleepCond.UnLock();
+        return false;
+      }
+
+      if( pWakeups )
+      {
+        --pWakeups;
+        pSleepCond.UnLock();
+        return true;
+      }
+
+      if( !elastic )
+      {
+        pSleepCond.Wait();
+        continue;
+      }
+
+      //------------------------------------------------------------------------
+      // Retire the extra workers that have been idle for long enough, unless
+      // a producer has just counted on us
+      //------------------------------------------------------------------------
+      if( !pSleepCond.WaitMS( pIdleTimeout ) || pWakeups ) continue;
+      if( !pMutex.CondLock() ) continue;
+      if( !Unidle() )
+      {
+        pMutex.UnLock();
+        continue;
+      }
+      pWorkers[slot].active = false;
+      --pNbWorkers;
+      pthread_detach( pthread_self() );
+      pMutex.UnLock();
+      pSleepCond.UnLock();
+      DefaultEnv::GetLog()->Debug( JobMgrMsg, "Worker #%d retired", slot );
+      return false;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Take a sleeping worker off the idle count
+  //----------------------------------------------------------------------------
+  bool JobManager::Unidle()
+  {
+    uint32_t idle = pIdle.load();
+    while( idle > 0 )
+      if( pIdle.compare_exchange_weak( idle, idle - 1 ) )
+        return true;
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  // Wake up a sleeping worker for a new job, or add one if all of them are
+  // busy and the jobs are piling up
+  //----------------------------------------------------------------------------
+  void JobManager::Wake()
+  {
+    if( Unidle() )
+    {
+      pSleepCond.Lock();
+      ++pWakeups;
+      pSleepCond.Signal();
+      pSleepCond.UnLock();
+      return;
+    }
+
+    if( pMaxWorkers <= pMinWorkers ) return;
+    uint32_t workers = pNbWorkers.load();
+    if( workers >= pMaxWorkers || pQueued.load() <= workers ) return;
+    if( pGrowing.exchange( true ) ) return;
+
+    if( pMutex.CondLock() )
+    {
+      if( pRunning )
+        for( uint32_t i = pMinWorkers; i < pMaxWorkers; ++i )
+          if( !pWorkers[i].active )
+          {
+            SpawnWorker( i );
+            break;
+          }
+      pMutex.UnLock();
+    }
+    pGrowing = false;
+  }
+
+  //----------------------------------------------------------------------------
+  // Start a worker in the given slot
+  //----------------------------------------------------------------------------
+  bool JobManager::SpawnWorker( uint32_t slot )
+  {
+    WorkerArg *arg = new WorkerArg{ this, slot };
+    pWorkers[slot].active = true;
+    ++pNbWorkers;
+    int ret = ::pthread_create( &pWorkers[slot].thread, 0, RunJobManagerWorker,
+                                arg );
+    if( ret != 0 )
+    {
+      DefaultEnv::GetLog()->Error( JobMgrMsg, "Unable to spawn a job worker "
+                                   "thread: %s", XrdSysE2T( ret ) );
+      pWorkers[slot].active = false;
+      --pNbWorkers;
+      delete arg;
+      return false;
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // The worker loop
+  //----------------------------------------------------------------------------
+  void JobManager::Work( uint32_t slot )
+  {
+    workerOf = this;
+    while( !pStopping )
+    {
+      JobHelper h;
+      if( Get( h ) )
+      {
+        Account( h.qtime );
+        h.job->Run( h.arg );
+        Report();
+        continue;
+      }
+
+      if( !Sleep( slot ) ) break;
+    }
+    workerOf = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Record how long a job waited in the queue
+  //----------------------------------------------------------------------------
+  void JobManager::Account( uint64_t qtime )
+  {
+    uint64_t us  = ( Now() - qtime ) / 1000;
+    int      bin = 0;
+    while( us && bin < pHistBins - 1 )
+    {
+      us >>= 1;
+      ++bin;
+    }
+    pLatency[bin].fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  //----------------------------------------------------------------------------
+  // Report the queue latency percentiles to the monitoring every now and then
+  //----------------------------------------------------------------------------
+  void JobManager::Report()
+  {
+    uint64_t now  = Now();
+    uint64_t last = pLastReport.load( std::memory_order_relaxed );
+    if( now - last < pReportEvery * 1000000000ULL ) return;
+    if( !pLastReport.compare_exchange_strong( last, now ) ) return;
+
+    uint64_t bins[pHistBins];
+    uint64_t total = 0;
+    for( int i = 0; i < pHistBins; ++i )
+    {
+      bins[i]  = pLatency[i].exchange( 0, std::memory_order_relaxed );
+      total   += bins[i];
+    }
+
+    Monitor *mon = DefaultEnv::GetMonitor();
+    if( !mon || !total ) return;
+
+    //--------------------------------------------------------------------------
+    // The values reported are the upper bounds of the histogram bins
+    //--------------------------------------------------------------------------
+    Monitor::JobQueueInfo info;
+    info.workers = pNbWorkers;
+    info.jobs    = total;
+    uint64_t seen = 0;
+    for( int i = 0; i < pHistBins; ++i )
+    {
+      if( !bins[i] ) continue;
+      uint64_t bound = uint64_t( 1 ) << i;
+      seen += bins[i];
+      if( !info.p50 && seen * 100 >= total * 50 ) info.p50 = bound;
+      if( !info.p90 && seen * 100 >= total * 90 ) info.p90 = bound;
+      if( !info.p99 && seen * 100 >= total * 99 ) info.p99 = bound;
+      info.max = bound;
     }
+    mon->Event( Monitor::EvJobQueue, &info );
   }
 }
@@ -19,11 +19,14 @@
 #ifndef __XRD_CL_JOB_MANAGER_HH__
 #define __XRD_CL_JOB_MANAGER_HH__
 
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <vector>
-#include <algorithm>
 #include <pthread.h>
 #include "XrdCl/XrdClSyncQueue.hh"
+#include "XrdSys/XrdSysPthread.hh"
 
 namespace XrdCl
 {
@@ -45,26 +48,31 @@ namespace XrdCl
   };
 
   //----------------------------------------------------------------------------
-  //! A synchronized queue
+  //! A pool of worker threads running jobs.
+  //!
+  //! Jobs are passed to the workers through a bounded lock-free queue,
+  //! falling back to a locked list when it fills up. Idle workers sleep and
+  //! are only woken up when there is nobody awake to pick a new job up. If
+  //! the maximum number of workers is larger than the initial one, workers
+  //! are added while jobs keep piling up and retire after being idle for a
+  //! while.
   //----------------------------------------------------------------------------
   class JobManager
   {
     public:
       //------------------------------------------------------------------------
       //! Constructor
+      //!
+      //! @param workers    number of workers started with the job manager
+      //! @param maxWorkers maximum number of workers, if not larger than
+      //!                   workers the pool does not grow
       //------------------------------------------------------------------------
-      JobManager( uint32_t workers )
-      {
-        pRunning = false;
-        pWorkers.resize( workers );
-      }
+      JobManager( uint32_t workers, uint32_t maxWorkers = 0 );
 
       //------------------------------------------------------------------------
       //! Destructor
       //------------------------------------------------------------------------
-      ~JobManager()
-      {
-      }
+      ~JobManager();
 
       //------------------------------------------------------------------------
       //! Initialize the job manager
@@ -89,23 +97,24 @@ namespace XrdCl
       //------------------------------------------------------------------------
       //! Add a job to be run
       //------------------------------------------------------------------------
-      void QueueJob( Job *job, void *arg = 0 )
-      {
-        pJobs.Put( JobHelper( job, arg ) );
-      }
+      void QueueJob( Job *job, void *arg = 0 );
+
+      //------------------------------------------------------------------------
+      //! Run a job in the calling thread, jobs it spawns that would normally
+      //! be queued only if not called from a worker are run in place too
+      //------------------------------------------------------------------------
+      void RunInline( Job *job, void *arg = 0 );
 
       //------------------------------------------------------------------------
       //! Run the jobs
       //------------------------------------------------------------------------
       void RunJobs();
 
-      bool IsWorker()
-      {
-        pthread_t thread = pthread_self();
-        std::vector<pthread_t>::iterator itr =
-            std::find( pWorkers.begin(), pWorkers.end(), thread );
-        return itr != pWorkers.end();
-      }
+      //------------------------------------------------------------------------
+      //! Check if the calling thread is one of the workers (or is running
+      //! a job inline)
+      //------------------------------------------------------------------------
+      bool IsWorker();
 
     private:
       //------------------------------------------------------------------------
@@ -115,16 +124,84 @@ namespace XrdCl
 
       struct JobHelper
       {
-        JobHelper( Job *j = 0, void *a = 0 ): job(j), arg(a) {}
-        Job  *job;
-        void *arg;
+        JobHelper( Job *j = 0, void *a = 0, uint64_t t = 0 ):
+          job(j), arg(a), qtime(t) {}
+        Job      *job;
+        void     *arg;
+        uint64_t  qtime;
+      };
+
+      //------------------------------------------------------------------------
+      //! Bounded multi-producer multi-consumer queue, each cell carries a
+      //! sequence number telling whether it is free for the producer or
+      //! ready for the consumer of the current lap
+      //------------------------------------------------------------------------
+      class JobRing
+      {
+        public:
+          JobRing( size_t size );
+          bool Push( const JobHelper &job );
+          bool Pop( JobHelper &job );
+
+        private:
+          struct Cell
+          {
+            std::atomic<size_t> seq;
+            JobHelper           job;
+          };
+          std::unique_ptr<Cell[]>  pCells;
+          size_t                   pMask;
+          alignas(64) std::atomic<size_t> pHead;
+          alignas(64) std::atomic<size_t> pTail;
+      };
+
+      struct Worker
+      {
+        Worker(): active( false ) {}
+        pthread_t         thread;
+        std::atomic<bool> active;
       };
 
-      std::vector<pthread_t> pWorkers;
-      SyncQueue<JobHelper>   pJobs;
-      XrdSysMutex            pMutex;
-      bool                   pRunning;
+      friend void *RunJobManagerWorker( void *arg );
+
+      bool Get( JobHelper &job );
+      bool Sleep( uint32_t slot );
+      bool Unidle();
+      void Wake();
+      void Work( uint32_t slot );
+      bool SpawnWorker( uint32_t slot );
+      void Account( uint64_t qtime );
+      void Report();
+
+      static const size_t   pRingSize    = 4096;
+      static const int      pIdleTimeout = 30000; // ms
+      static const uint64_t pReportEvery = 60;    // s
+      static const int      pHistBins    = 32;
+
+      std::unique_ptr<Worker[]> pWorkers;
+      uint32_t                  pMinWorkers;
+      uint32_t                  pMaxWorkers;
+      std::atomic<uint32_t>     pNbWorkers;
+      JobRing                   pRing;
+      std::deque<JobHelper>     pOverflow;
+      XrdSysMutex               pOverflowMutex;
+      std::atomic<size_t>       pOverflowSize;
+      std::atomic<size_t>       pQueued;
+      std::atomic<uint32_t>     pIdle;
+      std::atomic<bool>         pGrowing;
+      XrdSysCondVar             pSleepCond;
+      uint32_t                  pWakeups;
+      std::atomic<bool>         pStopping;
+      XrdSysMutex               pMutex;
+      bool                      pRunning;
+
+      //------------------------------------------------------------------------
+      // Queue latency histogram, bin i counts the jobs that waited less than
+      // 2^i microseconds
+      //------------------------------------------------------------------------
+      std::atomic<uint64_t>     pLatency[pHistBins];
+      std::atomic<uint64_t>     pLastReport;
   };
 }
 
-#endif // __XRD_CL_ANY_OBJECT_HH__
+#endif // __XRD_CL_JOB_MANAGER_HH__
@@ -22,6 +22,7 @@
 #include "XrdCl/XrdClURL.hh"
 #include "XrdCl/XrdClMessageUtils.hh"
 #include "XrdCl/XrdClFileSystem.hh"
+#include "XrdCl/XrdClIoUring.hh"
 #include "XProtocol/XProtocol.hh"
 
 #include "XrdSys/XrdSysE2T.hh"
@@ -126,6 +127,45 @@ namespace
         return cb.get();
       }
 
+      static const char* GetErrMsg( Opcode opcode )
+      {
+        static const char readmsg[]  = "Read:  failed %s";
+        static const char writemsg[] = "Write: failed %s";
+        static const char syncmsg[]  = "Sync:  failed %s";
+
+        switch( opcode )
+        {
+          case Opcode::Read:  return readmsg;
+
+          case Opcode::Write: return writemsg;
+
+          case Opcode::Sync:  return syncmsg;
+
+          default:            return 0;
+        }
+      }
+
+      static void QueueTask( XrdCl::XRootDStatus *status, XrdCl::AnyObject *resp,
+                             XrdCl::HostList *hosts, XrdCl::ResponseHandler *handler )
+      {
+        using namespace XrdCl;
+
+        // if it is simply the sync handler we can release the semaphore
+        // and return there is no need to execute this in the thread-pool
+        SyncResponseHandler *syncHandler =
+            dynamic_cast<SyncResponseHandler*>( handler );
+        if( syncHandler || DefaultEnv::GetPostMaster() == nullptr )
+        {
+          syncHandler->HandleResponse( status, resp );
+        }
+        else
+        {
+          JobManager *jmngr = DefaultEnv::GetPostMaster()->GetJobManager();
+          LocalFileTask *task = new LocalFileTask( status, resp, hosts, handler );
+          jmngr->QueueJob( task );
+        }
+      }
+
     private:
 
       struct SignalHandlerRegistrator
@@ -174,47 +214,106 @@ namespace
         }
       }
 
-      static const char* GetErrMsg( Opcode opcode )
-      {
-        static const char readmsg[]  = "Read:  failed %s";
-        static const char writemsg[] = "Write: failed %s";
-        static const char syncmsg[]  = "Sync:  failed %s";
+      std::unique_ptr<aiocb>  cb;
+      Opcode                  opcode;
+      XrdCl::HostList        *hosts;
+      XrdCl::ResponseHandler *handler;
+  };
 
-        switch( opcode )
-        {
-          case Opcode::Read:  return readmsg;
+  //----------------------------------------------------------------------------
+  // A read, write or sync handled by the io_uring engine
+  //----------------------------------------------------------------------------
+  class UringCtx : public XrdCl::IoUring::Request
+  {
+    public:
 
-          case Opcode::Write: return writemsg;
+      UringCtx( const XrdCl::HostList &hostList, XrdCl::ResponseHandler *handler,
+                AioCtx::Opcode opcode, int fd, uint64_t offset = 0,
+                uint32_t size = 0, const void *buffer = 0 ) :
+        opcode( opcode ), fd( fd ), offset( offset ), size( size ),
+        buffer( const_cast<void*>( buffer ) ),
+        hosts( new XrdCl::HostList( hostList ) ), handler( handler )
+      {
+      }
 
-          case Opcode::Sync:  return syncmsg;
+      ~UringCtx()
+      {
+        delete hosts;
+      }
 
-          default:            return 0;
+      //------------------------------------------------------------------------
+      // Hand the request over to the ring, if it fails the request is still
+      // ours
+      //------------------------------------------------------------------------
+      bool Submit( XrdCl::IoUring *ring )
+      {
+        switch( opcode )
+        {
+          case AioCtx::Opcode::Read:
+            return ring->Read( fd, offset, size, buffer, this );
+          case AioCtx::Opcode::Write:
+            return ring->Write( fd, offset, size, buffer, this );
+          case AioCtx::Opcode::Sync:
+            return ring->Fsync( fd, this );
+          default:
+            return false;
         }
       }
 
-      static void QueueTask( XrdCl::XRootDStatus *status, XrdCl::AnyObject *resp,
-                             XrdCl::HostList *hosts, XrdCl::ResponseHandler *handler )
+      void Done( int result )
       {
         using namespace XrdCl;
+        std::unique_ptr<UringCtx> me( this );
+
+        //----------------------------------------------------------------------
+        // Short writes are very unlikely for regular files, just finish them
+        // synchronously
+        //----------------------------------------------------------------------
+        if( opcode == AioCtx::Opcode::Write && result >= 0 &&
+            uint32_t( result ) < size )
+        {
+          const char *buff = static_cast<const char*>( buffer );
+          uint32_t    done = result;
+          while( done < size )
+          {
+            ssize_t ret = pwrite( fd, buff + done, size - done, offset + done );
+            if( ret <= 0 )
+            {
+              result = ret < 0 ? -errno : -EIO;
+              break;
+            }
+            done += ret;
+          }
+        }
 
-        // if it is simply the sync handler we can release the semaphore
-        // and return there is no need to execute this in the thread-pool
-        SyncResponseHandler *syncHandler =
-            dynamic_cast<SyncResponseHandler*>( handler );
-        if( syncHandler || DefaultEnv::GetPostMaster() == nullptr )
+        HostList *h = hosts;
+        hosts = 0;
+        if( result < 0 )
         {
-          syncHandler->HandleResponse( status, resp );
+          Log *log = DefaultEnv::GetLog();
+          log->Error( FileMsg, AioCtx::GetErrMsg( opcode ), XrdSysE2T( -result ) );
+          XRootDStatus *error = new XRootDStatus( stError, errLocalError, -result );
+          AioCtx::QueueTask( error, 0, h, handler );
+          return;
         }
-        else
+
+        AnyObject *resp = 0;
+        if( opcode == AioCtx::Opcode::Read )
         {
-          JobManager *jmngr = DefaultEnv::GetPostMaster()->GetJobManager();
-          LocalFileTask *task = new LocalFileTask( status, resp, hosts, handler );
-          jmngr->QueueJob( task );
+          ChunkInfo *chunk = new ChunkInfo( offset, result, buffer );
+          resp = new AnyObject();
+          resp->Set( chunk );
         }
+        AioCtx::QueueTask( new XRootDStatus(), resp, h, handler );
       }
-      
-      std::unique_ptr<aiocb>  cb;
-      Opcode                  opcode;
+
+    private:
+
+      AioCtx::Opcode          opcode;
+      int                     fd;
+      uint64_t                offset;
+      uint32_t                size;
+      void                   *buffer;
       XrdCl::HostList        *hosts;
       XrdCl::ResponseHandler *handler;
   };
@@ -334,6 +433,14 @@ namespace XrdCl
     resp->Set( chunk );
     return QueueTask( new XRootDStatus(), resp, handler );
 #else
+    if( IoUring *ring = IoUring::Get() )
+    {
+      UringCtx *ctx = new UringCtx( pHostList, handler, AioCtx::Opcode::Read,
+                                    fd, offset, size, buffer );
+      if( ctx->Submit( ring ) ) return XRootDStatus();
+      delete ctx;
+    }
+
     AioCtx *ctx = new AioCtx( pHostList, handler );
     ctx->SetRead( fd, offset, size, buffer );
 
@@ -416,6 +523,14 @@ namespace XrdCl
     }
     return QueueTask( new XRootDStatus(), 0, handler );
 #else
+    if( IoUring *ring = IoUring::Get() )
+    {
+      UringCtx *ctx = new UringCtx( pHostList, handler, AioCtx::Opcode::Write,
+                                    fd, offset, size, buffer );
+      if( ctx->Submit( ring ) ) return XRootDStatus();
+      delete ctx;
+    }
+
     AioCtx *ctx = new AioCtx( pHostList, handler );
     ctx->SetWrite( fd, offset, size, buffer );
 
@@ -450,6 +565,14 @@ namespace XrdCl
     }
     return QueueTask( new XRootDStatus(), 0, handler );
 #else
+    if( IoUring *ring = IoUring::Get() )
+    {
+      UringCtx *ctx = new UringCtx( pHostList, handler, AioCtx::Opcode::Sync,
+                                    fd );
+      if( ctx->Submit( ring ) ) return XRootDStatus();
+      delete ctx;
+    }
+
     AioCtx *ctx = new AioCtx( pHostList, handler );
     ctx->SetFsync( fd );
     int rc = aio_fsync( O_SYNC, *ctx );
@@ -205,6 +205,38 @@ namespace XrdCl
         bool         isOK;      //!< True if checksum matched, false otherwise
       };
 
+      //------------------------------------------------------------------------
+      //! Describe the read-ahead activity of a file, reported when the file
+      //! is closed
+      //------------------------------------------------------------------------
+      struct ReadAheadInfo
+      {
+        ReadAheadInfo(): file(0), hits(0), misses(0), hitBytes(0),
+                         prefetched(0), wasted(0) {}
+        const URL *file;       //!< The file in question
+        uint64_t   hits;       //!< Reads served from the read-ahead cache
+        uint64_t   misses;     //!< Reads sent to the server
+        uint64_t   hitBytes;   //!< Bytes served from the read-ahead cache
+        uint64_t   prefetched; //!< Bytes requested by prefetches
+        uint64_t   wasted;     //!< Prefetched bytes that were never read
+      };
+
+      //------------------------------------------------------------------------
+      //! Describe how long the response callbacks wait in the job queue
+      //! before a worker picks them up, reported periodically. The latencies
+      //! are in microseconds and rounded up to a power of 2.
+      //------------------------------------------------------------------------
+      struct JobQueueInfo
+      {
+        JobQueueInfo(): workers(0), jobs(0), p50(0), p90(0), p99(0), max(0) {}
+        uint32_t workers; //!< Number of worker threads
+        uint64_t jobs;    //!< Number of jobs run since the last report
+        uint64_t p50;     //!< Median queue latency
+        uint64_t p90;     //!< 90th percentile of the queue latency
+        uint64_t p99;     //!< 99th percentile of the queue latency
+        uint64_t max;     //!< Maximum queue latency
+      };
+
       //------------------------------------------------------------------------
       //! Event codes passed to the Event() method. Event code values not
       //! listed here, if encountered, should be ignored.
@@ -218,7 +250,9 @@ namespace XrdCl
         EvClose,          //!< CloseInfo: File closed
         EvErrIO,          //!< ErrorInfo: An I/O error occurred
         EvConnect,        //!< ConnectInfo: Login  into a server
-        EvDisconnect      //!< DisconnectInfo: Logout from a server
+        EvDisconnect,     //!< DisconnectInfo: Logout from a server
+        EvReadAhead,      //!< ReadAheadInfo: Read-ahead statistics of a file
+        EvJobQueue        //!< JobQueueInfo: Callback queue latency
 
       };
 
@@ -62,9 +62,12 @@ namespace XrdCl
       Env *env = DefaultEnv::GetEnv();
       int workerThreads = DefaultWorkerThreads;
       env->GetInt( "WorkerThreads", workerThreads );
+      int workerThreadsMax = DefaultWorkerThreadsMax;
+      env->GetInt( "WorkerThreadsMax", workerThreadsMax );
+      if( workerThreadsMax < 0 ) workerThreadsMax = 0;
 
       pTaskManager = new TaskManager();
-      pJobManager  = new JobManager(workerThreads);
+      pJobManager  = new JobManager( workerThreads, workerThreadsMax );
     }
 
     ~PostMasterImpl()
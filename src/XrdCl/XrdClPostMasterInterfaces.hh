@@ -301,6 +301,17 @@ namespace XrdCl
       static const uint16_t IpAddr   = 2001;
       static const uint16_t IpStack  = 2002;
       static const uint16_t HostName = 2003;
+      static const uint16_t WriteStats = 2004; //!< returns WriteStatsInfo *
+
+      //------------------------------------------------------------------------
+      //! Statistics of the outgoing path of a stream
+      //------------------------------------------------------------------------
+      struct WriteStatsInfo
+      {
+        uint64_t messages; //!< number of messages written to the sockets
+        uint64_t writes;   //!< number of socket write calls used to do so
+        uint64_t batches;  //!< number of writes carrying several messages
+      };
   };
 
   //----------------------------------------------------------------------------
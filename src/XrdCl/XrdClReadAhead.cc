@@ -0,0 +1,578 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "XrdCl/XrdClReadAhead.hh"
+#include "XrdCl/XrdClFileStateHandler.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClLog.hh"
+#include "XrdCl/XrdClMonitor.hh"
+#include "XrdCl/XrdClPostMaster.hh"
+#include "XrdCl/XrdClJobManager.hh"
+#include "XrdCl/XrdClResponseJob.hh"
+#include "XrdCl/XrdClURL.hh"
+#include "XrdSys/XrdSysPageSize.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+
+namespace
+{
+  using namespace XrdCl;
+
+  struct Waiter;
+
+  //----------------------------------------------------------------------------
+  // A block of file data held by the cache
+  //----------------------------------------------------------------------------
+  struct Block
+  {
+    enum State { Pending, Ready, Failed };
+    typedef std::pair<uint64_t, uint64_t> Key; // file id, block index
+
+    Block( const Key &k, uint64_t off, uint32_t len,
+           const std::shared_ptr<ReadAhead::Stats> &st ):
+      key( k ), offset( off ), length( len ), size( 0 ), state( Pending ),
+      used( false ), cached( true ), data( new char[len] ), stats( st ) {}
+
+    Key                                  key;
+    uint64_t                             offset;
+    uint32_t                             length; // requested
+    uint32_t                             size;   // received
+    State                                state;
+    bool                                 used;
+    bool                                 cached;
+    std::unique_ptr<char[]>              data;
+    std::shared_ptr<ReadAhead::Stats>    stats;
+    std::vector<std::shared_ptr<Waiter>> waiters;
+    std::list<Key>::iterator             lru;
+  };
+
+  //----------------------------------------------------------------------------
+  // A user read waiting for in-flight prefetches
+  //----------------------------------------------------------------------------
+  struct Waiter
+  {
+    std::shared_ptr<FileStateHandler>   file;
+    uint64_t                            offset;
+    uint32_t                            size;
+    void                               *buffer;
+    ResponseHandler                    *handler;
+    uint16_t                            timeout;
+    std::vector<std::shared_ptr<Block>> blocks;
+    size_t                              pending;
+    bool                                failed;
+  };
+
+  //----------------------------------------------------------------------------
+  // Send a read that could not be served from the cache to the server. This
+  // is done from a job because a failed prefetch may be reported while the
+  // file state handler is locked.
+  //----------------------------------------------------------------------------
+  class DirectReadJob: public Job
+  {
+    public:
+      DirectReadJob( const std::shared_ptr<Waiter> &w ): pWaiter( w ) {}
+
+      virtual void Run( void* )
+      {
+        Waiter &w = *pWaiter;
+        XRootDStatus st = FileStateHandler::ReadImpl( w.file, w.offset, w.size,
+                                                      w.buffer, w.handler,
+                                                      w.timeout );
+        if( !st.IsOK() )
+          w.handler->HandleResponse( new XRootDStatus( st ), 0 );
+        delete this;
+      }
+
+    private:
+      std::shared_ptr<Waiter> pWaiter;
+  };
+
+  //----------------------------------------------------------------------------
+  // Complete a user read from the cached blocks
+  //----------------------------------------------------------------------------
+  void Serve( const std::shared_ptr<Waiter> &w )
+  {
+    JobManager *jobMan = DefaultEnv::GetPostMaster()->GetJobManager();
+
+    //--------------------------------------------------------------------------
+    // One of the prefetches the read depended on has failed
+    //--------------------------------------------------------------------------
+    if( w->failed )
+    {
+      jobMan->QueueJob( new DirectReadJob( w ) );
+      return;
+    }
+
+    //--------------------------------------------------------------------------
+    // Copy the data, a short block means we have hit the end of the file
+    //--------------------------------------------------------------------------
+    char     *buffer = static_cast<char*>( w->buffer );
+    uint64_t  pos    = w->offset;
+    uint64_t  end    = w->offset + w->size;
+    for( auto &blk : w->blocks )
+    {
+      uint64_t blkEnd = blk->offset + blk->size;
+      if( pos < blk->offset || pos >= blkEnd ) break;
+      uint64_t len = std::min( end, blkEnd ) - pos;
+      memcpy( buffer + ( pos - w->offset ), blk->data.get() + ( pos - blk->offset ),
+              len );
+      pos += len;
+      if( pos >= end || blk->size < blk->length ) break;
+    }
+
+    uint32_t done = pos - w->offset;
+    w->blocks.front()->stats->hitBytes += done;
+
+    AnyObject *obj = new AnyObject();
+    obj->Set( new ChunkInfo( w->offset, done, w->buffer ) );
+    jobMan->QueueJob( new ResponseJob( w->handler, new XRootDStatus(), obj,
+                                       new HostList() ) );
+  }
+
+  //----------------------------------------------------------------------------
+  // Bounded LRU cache of blocks shared by all the files
+  //----------------------------------------------------------------------------
+  class BlockCache
+  {
+    public:
+      //------------------------------------------------------------------------
+      // The cache is never deleted, prefetches may still be completing while
+      // the library is being finalized
+      //------------------------------------------------------------------------
+      static BlockCache &Instance()
+      {
+        static BlockCache *cache = new BlockCache();
+        return *cache;
+      }
+
+      //------------------------------------------------------------------------
+      // Attach a read to the blocks covering it, fails if any of them is not
+      // in the cache
+      //------------------------------------------------------------------------
+      bool Attach( uint64_t fileId, uint64_t first, uint64_t last,
+                   std::shared_ptr<Waiter> &w )
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        for( uint64_t i = first; i <= last; ++i )
+        {
+          auto it = pBlocks.find( Block::Key( fileId, i ) );
+          if( it == pBlocks.end() || it->second->state == Block::Failed )
+          {
+            w->blocks.clear();
+            return false;
+          }
+          w->blocks.push_back( it->second );
+        }
+
+        w->pending = 0;
+        w->failed  = false;
+        for( auto &blk : w->blocks )
+        {
+          blk->used = true;
+          pLRU.splice( pLRU.end(), pLRU, blk->lru );
+          if( blk->state == Block::Pending )
+          {
+            blk->waiters.push_back( w );
+            ++w->pending;
+          }
+        }
+        return true;
+      }
+
+      //------------------------------------------------------------------------
+      // Insert a pending block, fails if the block is already there or the
+      // cache is full of in-flight blocks
+      //------------------------------------------------------------------------
+      std::shared_ptr<Block> Insert( const Block::Key &key, uint64_t offset,
+                                     uint32_t length,
+                                     const std::shared_ptr<ReadAhead::Stats> &stats )
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        if( length > pCapacity || pBlocks.count( key ) )
+          return std::shared_ptr<Block>();
+
+        auto it = pLRU.begin();
+        while( pUsed + length > pCapacity && it != pLRU.end() )
+        {
+          std::shared_ptr<Block> &victim = pBlocks[*it];
+          ++it;
+          if( victim->state == Block::Pending ) continue;
+          Evict( victim );
+        }
+        if( pUsed + length > pCapacity )
+          return std::shared_ptr<Block>();
+
+        std::shared_ptr<Block> blk = std::make_shared<Block>( key, offset,
+                                                              length, stats );
+        blk->lru = pLRU.insert( pLRU.end(), key );
+        pBlocks[key] = blk;
+        pUsed += length;
+        return blk;
+      }
+
+      //------------------------------------------------------------------------
+      // Record the outcome of a prefetch and serve the reads waiting for it
+      //------------------------------------------------------------------------
+      void Complete( const std::shared_ptr<Block> &blk, bool ok, uint32_t size )
+      {
+        std::vector<std::shared_ptr<Waiter>> ready;
+        {
+          XrdSysMutexHelper scopedLock( pMutex );
+          blk->state = ok ? Block::Ready : Block::Failed;
+          blk->size  = ok ? size : 0;
+          --blk->stats->inFlight;
+          if( !ok )
+          {
+            blk->stats->prefetched -= blk->length;
+            if( blk->cached ) Remove( blk );
+          }
+
+          for( auto &w : blk->waiters )
+          {
+            if( !ok ) w->failed = true;
+            if( --w->pending == 0 ) ready.push_back( w );
+          }
+          blk->waiters.clear();
+        }
+
+        for( auto &w : ready )
+          Serve( w );
+      }
+
+      //------------------------------------------------------------------------
+      // Drop all the blocks of a file
+      //------------------------------------------------------------------------
+      void Drop( uint64_t fileId )
+      {
+        XrdSysMutexHelper scopedLock( pMutex );
+        auto it = pBlocks.lower_bound( Block::Key( fileId, 0 ) );
+        while( it != pBlocks.end() && it->first.first == fileId )
+        {
+          std::shared_ptr<Block> blk = it->second;
+          ++it;
+          Evict( blk );
+        }
+      }
+
+    private:
+      BlockCache(): pUsed( 0 )
+      {
+        int capacity = DefaultReadAheadCacheSize;
+        DefaultEnv::GetEnv()->GetInt( "ReadAheadCacheSize", capacity );
+        pCapacity = capacity > 0 ? capacity : 0;
+      }
+
+      //------------------------------------------------------------------------
+      // Remove a block from the cache accounting for the unused data
+      //------------------------------------------------------------------------
+      void Evict( std::shared_ptr<Block> blk )
+      {
+        if( !blk->used )
+        {
+          if( blk->state == Block::Ready )        blk->stats->wasted += blk->size;
+          else if( blk->state == Block::Pending ) blk->stats->wasted += blk->length;
+        }
+        Remove( blk );
+      }
+
+      void Remove( const std::shared_ptr<Block> &blk )
+      {
+        pLRU.erase( blk->lru );
+        pUsed -= blk->length;
+        blk->cached = false;
+        pBlocks.erase( blk->key );
+      }
+
+      XrdSysMutex                                   pMutex;
+      std::map<Block::Key, std::shared_ptr<Block>>  pBlocks;
+      std::list<Block::Key>                         pLRU;
+      uint64_t                                      pUsed;
+      uint64_t                                      pCapacity;
+  };
+
+  //----------------------------------------------------------------------------
+  // Handle the response to a prefetch
+  //----------------------------------------------------------------------------
+  class PrefetchHandler: public ResponseHandler
+  {
+    public:
+      PrefetchHandler( const std::shared_ptr<Block> &blk ): pBlock( blk ) {}
+
+      virtual void HandleResponse( XRootDStatus *status, AnyObject *response )
+      {
+        bool      ok   = status->IsOK() && response;
+        uint32_t  size = 0;
+        if( ok )
+        {
+          ChunkInfo *chunk = 0;
+          response->Get( chunk );
+          if( chunk ) size = chunk->length;
+          else ok = false;
+        }
+        BlockCache::Instance().Complete( pBlock, ok, size );
+        delete status;
+        delete response;
+        delete this;
+      }
+
+    private:
+      std::shared_ptr<Block> pBlock;
+  };
+
+  std::atomic<uint64_t> nextFileId( 1 );
+}
+
+namespace XrdCl
+{
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  ReadAhead::ReadAhead( uint64_t fileSize ):
+    pFileId( nextFileId++ ),
+    pFileSize( fileSize ),
+    pStats( std::make_shared<Stats>() ),
+    pLastOffset( 0 ),
+    pLastEnd( 0 ),
+    pStride( 0 ),
+    pLastSize( 0 ),
+    pConfidence( 0 ),
+    pWindow( 1 ),
+    pPrefetchEnd( 0 )
+  {
+    Env *env = DefaultEnv::GetEnv();
+    int blockSize = DefaultReadAheadBlockSize;
+    int window    = DefaultReadAheadWindow;
+    env->GetInt( "ReadAheadBlockSize", blockSize );
+    env->GetInt( "ReadAheadWindow",    window );
+    pBlockSize = std::max( blockSize, XrdSys::PageSize );
+    pMaxWindow = std::max( window, 1 );
+  }
+
+  //----------------------------------------------------------------------------
+  // Destructor
+  //----------------------------------------------------------------------------
+  ReadAhead::~ReadAhead()
+  {
+    BlockCache::Instance().Drop( pFileId );
+  }
+
+  //----------------------------------------------------------------------------
+  // Read a data chunk
+  //----------------------------------------------------------------------------
+  XRootDStatus ReadAhead::Read( std::shared_ptr<FileStateHandler> &self,
+                                uint64_t                           offset,
+                                uint32_t                           size,
+                                void                              *buffer,
+                                ResponseHandler                   *handler,
+                                uint16_t                           timeout )
+  {
+    if( !buffer || !size || ( pFileSize && offset >= pFileSize ) )
+      return FileStateHandler::ReadImpl( self, offset, size, buffer, handler,
+                                         timeout );
+
+    std::vector<uint64_t> blocks;
+    Detect( offset, size, blocks );
+
+    //--------------------------------------------------------------------------
+    // Try the cache first
+    //--------------------------------------------------------------------------
+    uint64_t end = offset + size;
+    if( pFileSize && end > pFileSize ) end = pFileSize;
+
+    std::shared_ptr<Waiter> w = std::make_shared<Waiter>();
+    w->file    = self;
+    w->offset  = offset;
+    w->size    = size;
+    w->buffer  = buffer;
+    w->handler = handler;
+    w->timeout = timeout;
+
+    XRootDStatus st;
+    if( BlockCache::Instance().Attach( pFileId, offset / pBlockSize,
+                                       ( end - 1 ) / pBlockSize, w ) )
+    {
+      ++pStats->hits;
+      if( !w->pending ) Serve( w );
+    }
+    else
+    {
+      ++pStats->misses;
+      st = FileStateHandler::ReadImpl( self, offset, size, buffer, handler,
+                                       timeout );
+      if( !st.IsOK() ) return st;
+    }
+
+    if( !blocks.empty() )
+      Prefetch( self, blocks, timeout );
+    return st;
+  }
+
+  //----------------------------------------------------------------------------
+  // Drop the cached blocks and report to the monitoring
+  //----------------------------------------------------------------------------
+  void ReadAhead::Close( const URL *file )
+  {
+    BlockCache::Instance().Drop( pFileId );
+
+    Log *log = DefaultEnv::GetLog();
+    log->Debug( FileMsg, "[%s] Read-ahead: %llu hits, %llu misses, %llu bytes "
+                "prefetched, %llu bytes wasted",
+                file ? file->GetURL().c_str() : "",
+                (unsigned long long)pStats->hits.load(),
+                (unsigned long long)pStats->misses.load(),
+                (unsigned long long)pStats->prefetched.load(),
+                (unsigned long long)pStats->wasted.load() );
+
+    Monitor *mon = DefaultEnv::GetMonitor();
+    if( mon )
+    {
+      Monitor::ReadAheadInfo i;
+      i.file       = file;
+      i.hits       = pStats->hits;
+      i.misses     = pStats->misses;
+      i.hitBytes   = pStats->hitBytes;
+      i.prefetched = pStats->prefetched;
+      i.wasted     = pStats->wasted;
+      mon->Event( Monitor::EvReadAhead, &i );
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Update the access pattern
+  //----------------------------------------------------------------------------
+  void ReadAhead::Detect( uint64_t               offset,
+                          uint32_t               size,
+                          std::vector<uint64_t> &blocks )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+
+    //--------------------------------------------------------------------------
+    // A read is sequential if it starts where the previous one ended, and
+    // strided if it is the same size and distance away from the previous
+    // one as the previous one was from its predecessor
+    //--------------------------------------------------------------------------
+    uint64_t end        = offset + size;
+    bool     sequential = ( offset == pLastEnd );
+    bool     strided    = !sequential && pStride && offset > pLastOffset &&
+                          offset - pLastOffset == pStride && size == pLastSize;
+
+    if( sequential || strided )
+      ++pConfidence;
+    else
+    {
+      pConfidence  = 0;
+      pWindow      = 1;
+      pPrefetchEnd = 0;
+    }
+
+    pStride     = offset > pLastOffset ? offset - pLastOffset : 0;
+    pLastOffset = offset;
+    pLastEnd    = end;
+    pLastSize   = size;
+
+    //--------------------------------------------------------------------------
+    // Wait until the pattern has been confirmed before prefetching anything,
+    // then double the window on every read that follows it
+    //--------------------------------------------------------------------------
+    if( pConfidence < 2 ) return;
+
+    if( sequential )
+    {
+      uint64_t from = std::max( end, pPrefetchEnd );
+      uint64_t to   = end + uint64_t( pWindow ) * pBlockSize;
+      if( from < to )
+      {
+        AddRange( from, to, blocks );
+        pPrefetchEnd = to;
+      }
+    }
+    else
+    {
+      for( uint32_t i = 1; i <= pWindow; ++i )
+      {
+        uint64_t next = offset + i * pStride;
+        if( next + size <= pPrefetchEnd ) continue;
+        AddRange( next, next + size, blocks );
+        pPrefetchEnd = next + size;
+      }
+    }
+
+    pWindow = std::min( pWindow * 2, pMaxWindow );
+  }
+
+  //----------------------------------------------------------------------------
+  // Add the blocks covering the range to the prefetch list
+  //----------------------------------------------------------------------------
+  void ReadAhead::AddRange( uint64_t               offset,
+                            uint64_t               end,
+                            std::vector<uint64_t> &blocks )
+  {
+    if( pFileSize && end > pFileSize ) end = pFileSize;
+    if( offset >= end ) return;
+
+    for( uint64_t i = offset / pBlockSize; i <= ( end - 1 ) / pBlockSize; ++i )
+    {
+      if( blocks.size() >= pMaxWindow ) return;
+      if( blocks.empty() || blocks.back() < i )
+        blocks.push_back( i );
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Send the prefetch requests
+  //----------------------------------------------------------------------------
+  void ReadAhead::Prefetch( std::shared_ptr<FileStateHandler> &self,
+                            const std::vector<uint64_t>       &blocks,
+                            uint16_t                           timeout )
+  {
+    BlockCache &cache = BlockCache::Instance();
+    for( uint64_t i : blocks )
+    {
+      if( pStats->inFlight >= pMaxWindow ) return;
+
+      uint64_t offset = i * pBlockSize;
+      uint32_t length = pBlockSize;
+      if( pFileSize )
+      {
+        if( offset >= pFileSize ) return;
+        length = std::min<uint64_t>( length, pFileSize - offset );
+      }
+
+      std::shared_ptr<Block> blk = cache.Insert( Block::Key( pFileId, i ),
+                                                 offset, length, pStats );
+      if( !blk ) continue;
+
+      ++pStats->inFlight;
+      pStats->prefetched += length;
+
+      PrefetchHandler *handler = new PrefetchHandler( blk );
+      XRootDStatus st = FileStateHandler::ReadImpl( self, offset, length,
+                                                    blk->data.get(), handler,
+                                                    timeout );
+      if( !st.IsOK() )
+      {
+        delete handler;
+        cache.Complete( blk, false, 0 );
+        return;
+      }
+    }
+  }
+}
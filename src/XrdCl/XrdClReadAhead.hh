@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#ifndef __XRD_CL_READ_AHEAD_HH__
+#define __XRD_CL_READ_AHEAD_HH__
+
+#include "XrdCl/XrdClXRootDResponses.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace XrdCl
+{
+  class FileStateHandler;
+  class URL;
+
+  //----------------------------------------------------------------------------
+  //! Per-file read-ahead engine.
+  //!
+  //! Watches the reads issued by the application and, once a sequential or a
+  //! strided access pattern has been established, prefetches the blocks the
+  //! application is about to ask for. The blocks are kept in an LRU cache of
+  //! bounded size that is shared by all the files with read-ahead enabled.
+  //! Reads that are fully covered by cached (or in-flight) blocks are served
+  //! from memory, everything else goes to the server as usual.
+  //----------------------------------------------------------------------------
+  class ReadAhead
+  {
+    public:
+      //------------------------------------------------------------------------
+      //! Read-ahead counters, shared with the cached blocks so that they can
+      //! be updated after the file has been closed
+      //------------------------------------------------------------------------
+      struct Stats
+      {
+        Stats(): hits( 0 ), misses( 0 ), hitBytes( 0 ), prefetched( 0 ),
+                 wasted( 0 ), inFlight( 0 ) {}
+        std::atomic<uint64_t> hits;       //!< reads served from the cache
+        std::atomic<uint64_t> misses;     //!< reads sent to the server
+        std::atomic<uint64_t> hitBytes;   //!< bytes served from the cache
+        std::atomic<uint64_t> prefetched; //!< bytes requested by prefetches
+        std::atomic<uint64_t> wasted;     //!< prefetched bytes never read
+        std::atomic<uint32_t> inFlight;   //!< outstanding prefetches
+      };
+
+      //------------------------------------------------------------------------
+      //! Constructor
+      //!
+      //! @param fileSize size of the file or 0 if not known
+      //------------------------------------------------------------------------
+      ReadAhead( uint64_t fileSize );
+
+      //------------------------------------------------------------------------
+      //! Destructor, drops all the cached blocks of the file
+      //------------------------------------------------------------------------
+      ~ReadAhead();
+
+      //------------------------------------------------------------------------
+      //! Read a data chunk, either from the cache or from the server, and
+      //! schedule the prefetches suggested by the access pattern
+      //!
+      //! @see FileStateHandler::Read for the parameters
+      //------------------------------------------------------------------------
+      XRootDStatus Read( std::shared_ptr<FileStateHandler> &self,
+                         uint64_t                           offset,
+                         uint32_t                           size,
+                         void                              *buffer,
+                         ResponseHandler                   *handler,
+                         uint16_t                           timeout );
+
+      //------------------------------------------------------------------------
+      //! Drop the cached blocks of the file and report the counters to the
+      //! monitoring
+      //------------------------------------------------------------------------
+      void Close( const URL *file );
+
+    private:
+      //------------------------------------------------------------------------
+      //! Update the access pattern with a new read and figure out which
+      //! blocks should be prefetched
+      //------------------------------------------------------------------------
+      void Detect( uint64_t offset, uint32_t size,
+                   std::vector<uint64_t> &blocks );
+
+      //------------------------------------------------------------------------
+      //! Add the blocks covering the given range to the prefetch list
+      //------------------------------------------------------------------------
+      void AddRange( uint64_t offset, uint64_t end,
+                     std::vector<uint64_t> &blocks );
+
+      //------------------------------------------------------------------------
+      //! Send the prefetch requests for the given blocks
+      //------------------------------------------------------------------------
+      void Prefetch( std::shared_ptr<FileStateHandler> &self,
+                     const std::vector<uint64_t>       &blocks,
+                     uint16_t                           timeout );
+
+      XrdSysMutex             pMutex;
+      uint64_t                pFileId;
+      uint64_t                pFileSize;
+      uint32_t                pBlockSize;
+      uint32_t                pMaxWindow;
+      std::shared_ptr<Stats>  pStats;
+
+      //------------------------------------------------------------------------
+      // Access pattern, protected by pMutex
+      //------------------------------------------------------------------------
+      uint64_t                pLastOffset;
+      uint64_t                pLastEnd;
+      uint64_t                pStride;
+      uint32_t                pLastSize;
+      uint32_t                pConfidence;
+      uint32_t                pWindow;
+      uint64_t                pPrefetchEnd;
+  };
+}
+
+#endif // __XRD_CL_READ_AHEAD_HH__
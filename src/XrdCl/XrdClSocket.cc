@@ -45,7 +45,8 @@ namespace XrdCl
     pSocket(socket), pStatus( status ),
     pProtocolFamily( AF_INET ),
     pChannelID( 0 ),
-    pCorked( false )
+    pCorked( false ),
+    pWriteCount( 0 )
   {
   };
 
@@ -460,6 +461,7 @@ namespace XrdCl
   //----------------------------------------------------------------------------
   XRootDStatus Socket::Send( const char *buffer, size_t size, int &bytesWritten )
   {
+    ++pWriteCount;
     if( pTls ) return pTls->Send( buffer, size, bytesWritten );
 
     //--------------------------------------------------------------------------
@@ -489,6 +491,7 @@ namespace XrdCl
     if( pTls ) return XRootDStatus( stError, errNotSupported, 0,
                                      "Cannot send a kernel-buffer over TLS." );
 
+    ++pWriteCount;
     ssize_t status = XrdSys::Send( pSocket, kbuff );
 
     if( status <= 0 )
@@ -288,6 +288,14 @@ namespace XrdCl
         return pCorked;
       }
 
+      //------------------------------------------------------------------------
+      // Get the number of write calls issued on the socket so far
+      //------------------------------------------------------------------------
+      inline uint64_t GetWriteCount() const
+      {
+        return pWriteCount;
+      }
+
       //------------------------------------------------------------------------
       // Do special event mapping if applicable
       //------------------------------------------------------------------------
@@ -333,6 +341,7 @@ namespace XrdCl
       int                          pProtocolFamily;
       AnyObject                   *pChannelID;
       bool                         pCorked;
+      uint64_t                     pWriteCount;
 
       std::unique_ptr<Tls>         pTls;
   };
@@ -86,6 +86,7 @@ namespace XrdCl
     AsyncSocketHandler   *socket;
     OutQueue             *outQueue;
     OutQueue::MsgHelper   outMsgHelper;
+    std::vector<std::pair<OutQueue::MsgHelper, uint32_t>> batchedMsgs;
     InMessageHelper       inMsgHelper;
     Socket::SocketStatus  status;
   };
@@ -108,7 +109,10 @@ namespace XrdCl
     pAddressType( Utils::IPAll ),
     pSessionId( 0 ),
     pBytesSent( 0 ),
-    pBytesReceived( 0 )
+    pBytesReceived( 0 ),
+    pMessagesWritten( 0 ),
+    pSocketWrites( 0 ),
+    pWriteBatches( 0 )
   {
     pConnectionStarted.tv_sec = 0; pConnectionStarted.tv_usec = 0;
     pConnectionDone.tv_sec = 0;    pConnectionDone.tv_usec = 0;
@@ -123,6 +127,8 @@ namespace XrdCl
                                                  DefaultConnectionRetry );
     pStreamErrorWindow = Utils::GetIntParameter( *url, "StreamErrorWindow",
                                                  DefaultStreamErrorWindow );
+    pInlineCallbacks   = Utils::GetIntParameter( *url, "InlineCallbacks",
+                                                 DefaultInlineCallbacks );
 
     std::string netStack = Utils::GetStringParameter( *url, "NetworkStack",
                                                       DefaultNetworkStack );
@@ -534,20 +540,32 @@ namespace XrdCl
       return;
     }
 
+    //--------------------------------------------------------------------------
+    // The job deletes itself so it's fine to run it from here. User callbacks
+    // always go through the job manager; only responses to our own handlers
+    // that never block may be processed in place.
+    //--------------------------------------------------------------------------
     Job *job = new HandleIncMsgJob( handler );
-    pJobManager->QueueJob( job );
+    XRootDMsgHandler *xrdHandler = nullptr;
+    if( pInlineCallbacks )
+      xrdHandler = dynamic_cast<XRootDMsgHandler*>( handler );
+    if( xrdHandler && xrdHandler->CanRunInline( *msg ) )
+      pJobManager->RunInline( job );
+    else
+      pJobManager->QueueJob( job );
   }
 
   //----------------------------------------------------------------------------
   // Call when one of the sockets is ready to accept a new message
   //----------------------------------------------------------------------------
   std::pair<Message *, MsgHandler *>
-    Stream::OnReadyToWrite( uint16_t subStream )
+    Stream::OnReadyToWrite( uint16_t subStream, bool disable )
   {
     XrdSysMutexHelper scopedLock( pMutex );
     Log *log = DefaultEnv::GetLog();
     if( pSubStreams[subStream]->outQueue->IsEmpty() )
     {
+      if( !disable ) return std::make_pair( (Message *)0, (MsgHandler *)0 );
       log->Dump( PostMasterMsg, "[%s] Nothing to write, disable uplink",
                  pSubStreams[subStream]->socket->GetStreamName().c_str() );
 
@@ -584,16 +602,53 @@ namespace XrdCl
   void Stream::OnMessageSent( uint16_t  subStream,
                               Message  *msg,
                               uint32_t  bytesSent )
+  {
+    OutQueue::MsgHelper &h = pSubStreams[subStream]->outMsgHelper;
+    MessageSent( subStream, msg, h.handler, bytesSent );
+    h.Reset();
+  }
+
+  //----------------------------------------------------------------------------
+  // Call when a message has been copied into a batch of messages
+  //----------------------------------------------------------------------------
+  void Stream::OnMessageBatched( uint16_t subStream, uint32_t bytes )
+  {
+    XrdSysMutexHelper scopedLock( pMutex );
+    SubStreamData *s = pSubStreams[subStream];
+    s->batchedMsgs.emplace_back( s->outMsgHelper, bytes );
+    s->outMsgHelper.Reset();
+  }
+
+  //----------------------------------------------------------------------------
+  // Call when all the batched messages have been written to the socket
+  //----------------------------------------------------------------------------
+  void Stream::OnBatchSent( uint16_t subStream )
+  {
+    std::vector<std::pair<OutQueue::MsgHelper, uint32_t>> batch;
+    {
+      XrdSysMutexHelper scopedLock( pMutex );
+      batch.swap( pSubStreams[subStream]->batchedMsgs );
+    }
+    for( auto &b : batch )
+      MessageSent( subStream, b.first.msg, b.first.handler, b.second );
+  }
+
+  //----------------------------------------------------------------------------
+  // Report a message as written to the socket
+  //----------------------------------------------------------------------------
+  void Stream::MessageSent( uint16_t    subStream,
+                            Message    *msg,
+                            MsgHandler *handler,
+                            uint32_t    bytesSent )
   {
     pTransport->MessageSent( msg, subStream, bytesSent,
                              *pChannelData );
-    OutQueue::MsgHelper &h = pSubStreams[subStream]->outMsgHelper;
     pBytesSent += bytesSent;
-    if( h.handler )
+    if( handler )
     {
-      h.handler->OnStatusReady( msg, XRootDStatus() );
+      handler->OnStatusReady( msg, XRootDStatus() );
       bool rmMsg = false;
-      pIncomingQueue->AddMessageHandler( h.handler, h.handler->GetExpiration(), rmMsg );
+      pIncomingQueue->AddMessageHandler( handler, handler->GetExpiration(), rmMsg );
       if( rmMsg )
       {
         Log *log = DefaultEnv::GetLog();
@@ -601,7 +656,29 @@ namespace XrdCl
                       pStreamName.c_str(), subStream );
       }
     }
-    pSubStreams[subStream]->outMsgHelper.Reset();
+  }
+
+  //----------------------------------------------------------------------------
+  // Put the messages that have not been written back in the queue
+  //----------------------------------------------------------------------------
+  void Stream::RequeueUnsent( uint16_t subStream )
+  {
+    SubStreamData *s = pSubStreams[subStream];
+    if( s->outMsgHelper.msg )
+    {
+      OutQueue::MsgHelper &h = s->outMsgHelper;
+      s->outQueue->PushFront( h.msg, h.handler, h.expires, h.stateful );
+      h.Reset();
+    }
+    //--------------------------------------------------------------------------
+    // The batched messages were taken out of the queue before the current one
+    //--------------------------------------------------------------------------
+    for( auto itr = s->batchedMsgs.rbegin(); itr != s->batchedMsgs.rend(); ++itr )
+    {
+      OutQueue::MsgHelper &h = itr->first;
+      s->outQueue->PushFront( h.msg, h.handler, h.expires, h.stateful );
+    }
+    s->batchedMsgs.clear();
   }
 
   //----------------------------------------------------------------------------
@@ -819,13 +896,7 @@ namespace XrdCl
     //--------------------------------------------------------------------------
     // Reinsert the stuff that we have failed to sent
     //--------------------------------------------------------------------------
-    if( pSubStreams[subStream]->outMsgHelper.msg )
-    {
-      OutQueue::MsgHelper &h = pSubStreams[subStream]->outMsgHelper;
-      pSubStreams[subStream]->outQueue->PushFront( h.msg, h.handler, h.expires,
-                                                   h.stateful );
-      pSubStreams[subStream]->outMsgHelper.Reset();
-    }
+    RequeueUnsent( subStream );
 
     //--------------------------------------------------------------------------
     // Reinsert the receiving handler and reset any partially read partial
@@ -925,13 +996,7 @@ namespace XrdCl
       //--------------------------------------------------------------------
       // Reinsert the stuff that we have failed to sent
       //--------------------------------------------------------------------
-      if( pSubStreams[substream]->outMsgHelper.msg )
-      {
-        OutQueue::MsgHelper &h = pSubStreams[substream]->outMsgHelper;
-        pSubStreams[substream]->outQueue->PushFront( h.msg, h.handler, h.expires,
-                                                     h.stateful );
-        pSubStreams[substream]->outMsgHelper.Reset();
-      }
+      RequeueUnsent( substream );
 
       //--------------------------------------------------------------------
       // Reinsert the receiving handler and reset any partially read partial
@@ -1235,6 +1300,16 @@ namespace XrdCl
         return Status();
       }
 
+      case StreamQuery::WriteStats:
+      {
+        StreamQuery::WriteStatsInfo *info = new StreamQuery::WriteStatsInfo();
+        info->messages = pMessagesWritten;
+        info->writes   = pSocketWrites;
+        info->batches  = pWriteBatches;
+        result.Set( info, false );
+        return Status();
+      }
+
       default:
         return Status( stError, errQueryNotSupported );
     }
@@ -70,7 +70,7 @@ namespace XrdCl
       //------------------------------------------------------------------------
       //! Destructor
       //------------------------------------------------------------------------
-      ~Stream();
+      virtual ~Stream();
 
       //------------------------------------------------------------------------
       //! Initializer
@@ -186,16 +186,46 @@ namespace XrdCl
 
       //------------------------------------------------------------------------
       // Call when one of the sockets is ready to accept a new message
+      //
+      //! @param subStream : the substream
+      //! @param disable   : if true and there is nothing to write the uplink
+      //!                    is disabled
       //------------------------------------------------------------------------
-      std::pair<Message *, MsgHandler *>
-        OnReadyToWrite( uint16_t subStream );
+      virtual std::pair<Message *, MsgHandler *>
+        OnReadyToWrite( uint16_t subStream, bool disable = true );
+
+      //------------------------------------------------------------------------
+      // Account for the socket writes used to send a number of messages
+      //------------------------------------------------------------------------
+      void OnWriteStats( uint32_t messages, uint64_t writes )
+      {
+        pMessagesWritten += messages;
+        pSocketWrites    += writes;
+        if( messages > 1 ) ++pWriteBatches;
+      }
 
       //------------------------------------------------------------------------
       // Call when a message is written to the socket
       //------------------------------------------------------------------------
-      void OnMessageSent( uint16_t  subStream,
-                          Message  *msg,
-                          uint32_t  bytesSent );
+      virtual void OnMessageSent( uint16_t  subStream,
+                                  Message  *msg,
+                                  uint32_t  bytesSent );
+
+      //------------------------------------------------------------------------
+      // Call when the message handed over by OnReadyToWrite has been copied
+      // into a batch of messages to be written at once. Until the batch is
+      // written the message is not sent, and it is requeued if the stream
+      // breaks.
+      //
+      //! @param subStream : the substream
+      //! @param bytes     : the size of the message, including its signature
+      //------------------------------------------------------------------------
+      virtual void OnMessageBatched( uint16_t subStream, uint32_t bytes );
+
+      //------------------------------------------------------------------------
+      // Call when all the batched messages have been written to the socket
+      //------------------------------------------------------------------------
+      virtual void OnBatchSent( uint16_t subStream );
 
       //------------------------------------------------------------------------
       //! Call back when a message has been reconstructed
@@ -284,6 +314,22 @@ namespace XrdCl
       //------------------------------------------------------------------------
       static bool IsPartial( Message &msg );
 
+      //------------------------------------------------------------------------
+      //! Report a message as written to the socket and hand its handler over
+      //! to the incoming queue
+      //------------------------------------------------------------------------
+      void MessageSent( uint16_t    subStream,
+                        Message    *msg,
+                        MsgHandler *handler,
+                        uint32_t    bytesSent );
+
+      //------------------------------------------------------------------------
+      //! Put the messages that have been taken out of the queue of the given
+      //! substream but not written back at its front (the stream mutex has
+      //! to be held)
+      //------------------------------------------------------------------------
+      void RequeueUnsent( uint16_t subStream );
+
       //------------------------------------------------------------------------
       //! Check if addresses contains given address
       //------------------------------------------------------------------------
@@ -355,6 +401,7 @@ namespace XrdCl
       uint16_t                       pConnectionRetry;
       time_t                         pConnectionInitTime;
       uint16_t                       pConnectionWindow;
+      bool                           pInlineCallbacks;
       SubStreamList                  pSubStreams;
       std::vector<XrdNetAddr>        pAddresses;
       Utils::AddressType             pAddressType;
@@ -368,6 +415,9 @@ namespace XrdCl
       timeval                        pConnectionDone;
       uint64_t                       pBytesSent;
       uint64_t                       pBytesReceived;
+      RAtomic_uint64_t               pMessagesWritten;
+      RAtomic_uint64_t               pSocketWrites;
+      RAtomic_uint64_t               pWriteBatches;
 
       //------------------------------------------------------------------------
       // Data stream on-connect handler
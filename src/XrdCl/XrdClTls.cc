@@ -22,16 +22,38 @@
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClPostMaster.hh"
+#include "XrdCl/XrdClJobManager.hh"
 
 #include "XrdTls/XrdTls.hh"
 #include "XrdTls/XrdTlsContext.hh"
 #include "XrdOuc/XrdOucUtils.hh"
+#include "XrdNet/XrdNetAddrInfo.hh"
+#include "XrdSys/XrdSysE2T.hh"
 
 #include <string>
 #include <stdexcept>
+#include <mutex>
+#include <unordered_map>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 static std::unique_ptr<XrdTlsContext> tlsContext = nullptr;
 
+//------------------------------------------------------------------------------
+// The settings the TLS context has been made with, part of the key of the
+// resumable sessions so that a session is only resumed by a context
+// trusting the same CAs and presenting the same credentials
+//------------------------------------------------------------------------------
+static std::string tlsContextId;
+
 namespace
 {
   //------------------------------------------------------------------------
@@ -88,6 +110,195 @@ namespace
         return XrdTls::dbgOFF;
       }
   };
+
+  //------------------------------------------------------------------------
+  // Store of the resumable TLS sessions, keyed by host:port, whether the
+  // server is verified and the TLS context settings. The sessions are kept
+  // in memory and, if a session cache directory has been configured, also
+  // on disk so that other processes of the same user can resume them. The
+  // session state contains the key material, so the files are only used if
+  // nobody else can access them. Each file starts with the full key, which
+  // is checked when the session is loaded.
+  //------------------------------------------------------------------------
+  class SessionStore
+  {
+    public:
+      //--------------------------------------------------------------------
+      // Get the store of the process
+      //--------------------------------------------------------------------
+      static SessionStore& Instance()
+      {
+        static SessionStore store;
+        return store;
+      }
+
+      //--------------------------------------------------------------------
+      // Is session resumption enabled
+      //--------------------------------------------------------------------
+      bool Enabled() const
+      {
+        return pEnabled;
+      }
+
+      //--------------------------------------------------------------------
+      // Get the session for given server
+      //--------------------------------------------------------------------
+      bool Get( const std::string &key, std::string &sess )
+      {
+        {
+          std::unique_lock<std::mutex> lck( pMutex );
+          auto itr = pSessions.find( key );
+          if( itr != pSessions.end() )
+          {
+            sess = itr->second;
+            return true;
+          }
+        }
+
+        if( pDir.empty() ) return false;
+        int fd = open( FileName( key ).c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC );
+        if( fd < 0 ) return false;
+        struct stat st;
+        bool ok = fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) &&
+                  st.st_uid == geteuid() && !( st.st_mode & ( S_IRWXG | S_IRWXO ) ) &&
+                  st.st_size > 0 && st.st_size <= MaxSessionSize;
+        std::string data;
+        if( ok )
+        {
+          data.resize( st.st_size );
+          ok = read( fd, &data[0], st.st_size ) == st.st_size;
+        }
+        close( fd );
+        if( !ok || data.size() <= key.size() ||
+            data.compare( 0, key.size(), key ) || data[key.size()] != '\n' )
+          return false;
+        sess = data.substr( key.size() + 1 );
+        return true;
+      }
+
+      //--------------------------------------------------------------------
+      // Save the session for given server, the file is written by a worker
+      // thread so that the event loop does not wait for the disk
+      //--------------------------------------------------------------------
+      void Put( const std::string &key, const std::string &sess )
+      {
+        {
+          std::unique_lock<std::mutex> lck( pMutex );
+          pSessions[key] = sess;
+        }
+
+        if( pDir.empty() || key.size() + sess.size() + 1 > MaxSessionSize )
+          return;
+        XrdCl::DefaultEnv::GetPostMaster()->GetJobManager()->QueueJob(
+            new SaveJob( FileName( key ), key + '\n' + sess ) );
+      }
+
+      //--------------------------------------------------------------------
+      // Forget the session for given server
+      //--------------------------------------------------------------------
+      void Drop( const std::string &key )
+      {
+        {
+          std::unique_lock<std::mutex> lck( pMutex );
+          pSessions.erase( key );
+        }
+        if( !pDir.empty() ) unlink( FileName( key ).c_str() );
+      }
+
+    private:
+      static const off_t MaxSessionSize = 65536;
+
+      //--------------------------------------------------------------------
+      // Writes a session file. The data goes to a temporary file renamed
+      // afterwards so that the other processes never see a partial session
+      //--------------------------------------------------------------------
+      class SaveJob : public XrdCl::Job
+      {
+        public:
+          SaveJob( const std::string &path, std::string &&data ) :
+            pPath( path ), pData( std::move( data ) )
+          {
+          }
+
+          void Run( void* )
+          {
+            std::string tmp = pPath + ".XXXXXX";
+            int fd = mkstemp( &tmp[0] );
+            if( fd >= 0 )
+            {
+              bool ok = write( fd, pData.data(), pData.size() ) == (ssize_t)pData.size();
+              close( fd );
+              if( !ok || rename( tmp.c_str(), pPath.c_str() ) )
+                unlink( tmp.c_str() );
+            }
+            delete this;
+          }
+
+        private:
+          std::string pPath;
+          std::string pData;
+      };
+
+      //--------------------------------------------------------------------
+      // Constructor, validates the session cache directory
+      //--------------------------------------------------------------------
+      SessionStore()
+      {
+        XrdCl::Env *env = XrdCl::DefaultEnv::GetEnv();
+        XrdCl::Log *log = XrdCl::DefaultEnv::GetLog();
+
+        int reuse = XrdCl::DefaultTlsSessionReuse;
+        env->GetInt( "TlsSessionReuse", reuse );
+        pEnabled = reuse;
+        if( !pEnabled ) return;
+
+        std::string dir = XrdCl::DefaultTlsSessionCache;
+        env->GetString( "TlsSessionCache", dir );
+        if( dir.empty() ) return;
+
+        if( mkdir( dir.c_str(), S_IRWXU ) && errno != EEXIST )
+        {
+          log->Warning( XrdCl::TlsMsg, "Unable to create TLS session cache "
+                        "%s: %s", dir.c_str(), XrdSysE2T( errno ) );
+          return;
+        }
+
+        struct stat st;
+        if( lstat( dir.c_str(), &st ) || !S_ISDIR( st.st_mode ) ||
+            st.st_uid != geteuid() || ( st.st_mode & ( S_IRWXG | S_IRWXO ) ) )
+        {
+          log->Warning( XrdCl::TlsMsg, "Not using TLS session cache %s: it has "
+                        "to be a directory accessible by its owner only",
+                        dir.c_str() );
+          return;
+        }
+
+        pDir = dir;
+        log->Debug( XrdCl::TlsMsg, "Using TLS session cache %s", pDir.c_str() );
+      }
+
+      //--------------------------------------------------------------------
+      // Name of the file holding the session for given key: the server
+      // followed by a hash of the whole key
+      //--------------------------------------------------------------------
+      std::string FileName( const std::string &key ) const
+      {
+        std::string name = key.substr( 0, key.find( ' ' ) );
+        for( auto &c : name )
+          if( !isalnum( c ) && c != '.' && c != '-' ) c = '_';
+        uint64_t hash = 14695981039346656037ULL; // FNV-1a
+        for( unsigned char c : key )
+          hash = ( hash ^ c ) * 1099511628211ULL;
+        char buff[20];
+        snprintf( buff, sizeof( buff ), ".%016llx", (unsigned long long)hash );
+        return pDir + "/" + name + buff;
+      }
+
+      bool                                          pEnabled;
+      std::string                                   pDir;
+      std::mutex                                    pMutex;
+      std::unordered_map<std::string, std::string>  pSessions;
+  };
 }
 
 namespace XrdCl
@@ -121,8 +332,18 @@ namespace XrdCl
       return false;
     }
 
+    //--------------------------------------------------------------------------
+    // The client presents no certificate of its own, the context is made of
+    // the trusted CAs only
+    //--------------------------------------------------------------------------
+    const char *cert = nullptr, *key = nullptr;
+    tlsContextId = std::string("cert=") + (cert ? cert : "") +
+                   " key=" + (key ? key : "") +
+                   " cadir=" + (cadir ? cadir : "") +
+                   " cafile=" + (cafile ? cafile : "");
+
     std::string emsg = "unknown error";
-    tlsContext = std::make_unique<XrdTlsContext>(nullptr, nullptr, cadir, cafile, 0ul, &emsg);
+    tlsContext = std::make_unique<XrdTlsContext>(cert, key, cadir, cafile, 0ul, &emsg);
 
     if (!tlsContext || !tlsContext->isOK()) {
       tlsContext.reset(nullptr);
@@ -137,7 +358,7 @@ namespace XrdCl
   //------------------------------------------------------------------------
   // Constructor
   //------------------------------------------------------------------------
-  Tls::Tls( Socket *socket, AsyncSocketHandler *socketHandler ) : pSocket( socket ), pTlsHSRevert( None ), pSocketHandler( socketHandler )
+  Tls::Tls( Socket *socket, AsyncSocketHandler *socketHandler ) : pSocket( socket ), pTlsHSRevert( None ), pSocketHandler( socketHandler ), pSessionProbes( 0 )
   {
     //----------------------------------------------------------------------
     // Set the message callback for TLS layer
@@ -161,6 +382,22 @@ namespace XrdCl
     const char *verhost = 0;
     if( thehost != "localhost" && thehost != "127.0.0.1" && thehost != "[::1]" )
       verhost = thehost.c_str();
+
+    //--------------------------------------------------------------------------
+    // Before starting the hand-shake offer the session we have from an
+    // earlier connection to this server, if any
+    //--------------------------------------------------------------------------
+    SessionStore &store = SessionStore::Instance();
+    if( pSessionKey.empty() && store.Enabled() )
+    {
+      pSessionKey = thehost + ":" + std::to_string( netInfo ? netInfo->Port() : 0 ) +
+                    ( verhost ? " verify " : " noverify " ) + tlsContextId;
+      pSessionProbes = MaxSessionProbes;
+      std::string sess;
+      if( store.Get( pSessionKey, sess ) && !pTls->SetSession( sess ) )
+        store.Drop( pSessionKey );
+    }
+
     XrdTls::RC error = pTls->Connect( verhost, &errmsg );
     XRootDStatus status = ToStatus( error );
     if( !status.IsOK() )
@@ -173,9 +410,17 @@ namespace XrdCl
     {
       XrdCl::Log *log = XrdCl::DefaultEnv::GetLog();
       log->Error( XrdCl::TlsMsg, "Failed to do TLS connect: %s", errmsg.c_str() );
+      if( !pSessionKey.empty() ) store.Drop( pSessionKey );
       return status;
     }
 
+    if( error == XrdTls::TLS_AOK && pTls->SessionReused() )
+    {
+      XrdCl::Log *log = XrdCl::DefaultEnv::GetLog();
+      log->Debug( XrdCl::TlsMsg, "Resumed TLS session with %s",
+                  pSessionKey.c_str() );
+    }
+
 
     if( pTls->NeedHandShake() )
     {
@@ -265,9 +510,24 @@ namespace XrdCl
     if( bytesRead == 0 )
       return XRootDStatus( stOK, suRetry );
 
+    if( pSessionProbes ) SaveSession();
     return status;
   }
 
+  //------------------------------------------------------------------------
+  // Save the TLS session for resumption. With TLS 1.3 the session becomes
+  // resumable only once the ticket sent by the server after the hand-shake
+  // has been read, so we check the first few reads.
+  //------------------------------------------------------------------------
+  void Tls::SaveSession()
+  {
+    --pSessionProbes;
+    std::string sess;
+    if( !pTls->GetSession( sess ) ) return;
+    SessionStore::Instance().Put( pSessionKey, sess );
+    pSessionProbes = 0;
+  }
+
   //------------------------------------------------------------------------
   //! (Fake) ReadV through the TLS layer from the socket
   //! If necessary, will establish a TLS/SSL session.
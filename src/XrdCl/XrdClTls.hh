@@ -19,7 +19,9 @@
 #ifndef __XRD_CL_TLS_HH__
 #define __XRD_CL_TLS_HH__
 
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "XrdTls/XrdTlsSocket.hh"
 
@@ -107,11 +109,22 @@ namespace XrdCl
       //------------------------------------------------------------------------
       enum TlsHSRevert{ None, ReadOnWrite, WriteOnRead };
 
+      //------------------------------------------------------------------------
+      //! Number of reads after the hand-shake in which we look for a
+      //! resumable session before giving up
+      //------------------------------------------------------------------------
+      static const uint8_t MaxSessionProbes = 16;
+
       //------------------------------------------------------------------------
       //! Translate OPEN SSL error code into XRootD Status
       //------------------------------------------------------------------------
       XRootDStatus ToStatus( XrdTls::RC rc );
 
+      //------------------------------------------------------------------------
+      //! Save the TLS session for resumption once it becomes resumable
+      //------------------------------------------------------------------------
+      void SaveSession();
+
       //------------------------------------------------------------------------
       //! The underlying vanilla socket
       //------------------------------------------------------------------------
@@ -136,6 +149,17 @@ namespace XrdCl
       //! Socket handler (for enabling/disabling write notification)
       //------------------------------------------------------------------------
       AsyncSocketHandler           *pSocketHandler;
+
+      //------------------------------------------------------------------------
+      //! Server the session is resumable with (host:port), empty until the
+      //! handshake has started or if session resumption is disabled
+      //------------------------------------------------------------------------
+      std::string                   pSessionKey;
+
+      //------------------------------------------------------------------------
+      //! Number of reads left to check for a resumable session
+      //------------------------------------------------------------------------
+      uint8_t                       pSessionProbes;
   };
 }
 
@@ -37,8 +37,11 @@ XCpCtx::XCpCtx( const std::vector<std::string> &urls, uint64_t blockSize, uint8_
       pUrls( std::deque<std::string>( urls.begin(), urls.end() ) ), pBlockSize( blockSize ),
       pParallelSrc( parallelSrc ), pChunkSize( chunkSize ), pParallelChunks( parallelChunks ),
       pOffset( 0 ), pFileSize( -1 ), pFileSizeCV( 0 ), pDataReceived( 0 ), pDone( false ),
-      pDoneCV( 0 ), pRefCount( 1 )
+      pDoneCV( 0 ), pRefCount( 1 ), pHedging( true )
 {
+  int hedging = DefaultXCpHedging;
+  DefaultEnv::GetEnv()->GetInt( "XCpHedging", hedging );
+  pHedging = hedging;
   SetFileSize( fileSize );
 }
 
@@ -84,23 +87,78 @@ XCpSrc* XCpCtx::WeakestLink( XCpSrc *exclude )
   return ret;
 }
 
-void XCpCtx::PutChunk( PageInfo* chunk )
+bool XCpCtx::PutChunk( PageInfo* chunk )
 {
+  if( chunk )
+  {
+    XrdSysMutexHelper lck( pMtx );
+    // the first copy of a hedged chunk wins
+    if( !pDelivered.insert( chunk->GetOffset() ).second )
+    {
+      lck.UnLock();
+      XCpSrc::DeleteChunk( chunk );
+      return false;
+    }
+  }
+
   pSink.Put( chunk );
+  return true;
+}
+
+bool XCpCtx::Hedge( uint64_t offset )
+{
+  XrdSysMutexHelper lck( pMtx );
+  if( pDelivered.count( offset ) ) return false;
+  return pHedged.insert( offset ).second;
 }
 
-std::pair<uint64_t, uint64_t> XCpCtx::GetBlock()
+std::pair<uint64_t, uint64_t> XCpCtx::GetBlock( uint64_t rate )
 {
   XrdSysMutexHelper lck( pMtx );
 
   uint64_t blkSize = pBlockSize, offset = pOffset;
-  if( pOffset + blkSize > uint64_t( pFileSize ) )
-    blkSize = pFileSize - pOffset;
+  uint64_t left    = uint64_t( pFileSize ) - pOffset;
+
+  if( rate > 0 )
+  {
+    // size the block according to the share of the source in the
+    // overall transfer rate, an average source gets the default
+    // block size, and no source gets more than its share of what is
+    // left so that the tail is spread evenly
+    uint64_t total   = 0;
+    size_t   running = 0;
+    std::list<XCpSrc*>::iterator itr;
+    for( itr = pSources.begin() ; itr != pSources.end() ; ++itr )
+    {
+      if( !(*itr)->IsRunning() ) continue;
+      total += (*itr)->TransferRate();
+      ++running;
+    }
+
+    blkSize = BlockSize( rate, total, running, left, pBlockSize, pChunkSize );
+  }
+
+  if( blkSize > left )
+    blkSize = left;
   pOffset += blkSize;
 
   return std::make_pair( offset, blkSize );
 }
 
+uint64_t XCpCtx::BlockSize( uint64_t rate, uint64_t total, size_t running,
+                            uint64_t left, uint64_t blockSize, uint64_t chunkSize )
+{
+  if( rate == 0 || total == 0 ) return blockSize;
+
+  double share = double( rate ) / double( total );
+  uint64_t blkSize = uint64_t( share * running * blockSize );
+  uint64_t fair = uint64_t( share * left );
+  if( blkSize > fair ) blkSize = fair;
+  if( blkSize > 4 * blockSize ) blkSize = 4 * blockSize;
+  if( blkSize < chunkSize ) blkSize = chunkSize;
+  return blkSize;
+}
+
 void XCpCtx::SetFileSize( int64_t size )
 {
   XrdSysMutexHelper lck( pMtx );
@@ -31,6 +31,7 @@
 
 #include <cstdint>
 #include <iostream>
+#include <set>
 
 namespace XrdCl
 {
@@ -100,18 +101,73 @@ class XCpCtx
     XCpSrc* WeakestLink( XCpSrc *exclude );
 
     /**
-     * Put a chunk into the sink
+     * Put a chunk into the sink. If the chunk has already been
+     * delivered by another source (hedged chunk) it is deleted
+     * instead.
      *
      * @param chunk : the chunk
+     * @return      : false if the chunk was a duplicate
      */
-    void PutChunk( PageInfo* chunk );
+    bool PutChunk( PageInfo* chunk );
 
     /**
-     * Get next block that has to be transferred
+     * Check if the chunk at given offset has already been delivered
      *
-     * @return : pair of offset and block size
+     * @param offset : offset of the chunk
      */
-    std::pair<uint64_t, uint64_t> GetBlock();
+    bool IsDelivered( uint64_t offset )
+    {
+      XrdSysMutexHelper lck( pMtx );
+      return pDelivered.count( offset );
+    }
+
+    /**
+     * Claim an ongoing chunk of another source for hedging, each
+     * chunk is hedged only once
+     *
+     * @param offset : offset of the chunk
+     * @return       : true if the chunk may be hedged
+     */
+    bool Hedge( uint64_t offset );
+
+    /**
+     * @return : true if the trailing chunks of slow sources should
+     *           be duplicated by the faster ones
+     */
+    bool HedgingEnabled()
+    {
+      return pHedging;
+    }
+
+    /**
+     * Get next block that has to be transferred. The block size
+     * is scaled by the share of the source in the total transfer
+     * rate.
+     *
+     * @param rate : transfer rate of the source asking [B/s],
+     *               0 if not known yet
+     * @return     : pair of offset and block size
+     */
+    std::pair<uint64_t, uint64_t> GetBlock( uint64_t rate = 0 );
+
+    /**
+     * Size a block according to the share of a source in the
+     * overall transfer rate: an average source gets the default
+     * block size, a source gets no more than its share of what is
+     * left (so that the tail is spread evenly), no more than four
+     * default blocks and no less than a chunk.
+     *
+     * @param rate      : transfer rate of the source [B/s]
+     * @param total     : sum of the rates of the running sources [B/s]
+     * @param running   : number of running sources
+     * @param left      : amount of data not yet allocated
+     * @param blockSize : the default block size
+     * @param chunkSize : the chunk size
+     * @return          : the block size (not capped by left)
+     */
+    static uint64_t BlockSize( uint64_t rate, uint64_t total, size_t running,
+                               uint64_t left, uint64_t blockSize,
+                               uint64_t chunkSize );
 
     /**
      * Set the file size (GetSize will block until
@@ -298,6 +354,21 @@ class XCpCtx
      * Reference counter
      */
     size_t                     pRefCount;
+
+    /**
+     * Offsets of the chunks that made it into the sink
+     */
+    std::set<uint64_t>         pDelivered;
+
+    /**
+     * Offsets of the chunks that have been hedged
+     */
+    std::set<uint64_t>         pHedged;
+
+    /**
+     * True if hedging is enabled
+     */
+    bool                       pHedging;
 };
 
 } /* namespace XrdCl */
@@ -29,6 +29,7 @@
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClUtils.hh"
 
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 
@@ -40,7 +41,8 @@ class ChunkHandler: public ResponseHandler
   public:
 
     ChunkHandler( XCpSrc *src, uint64_t offset, uint64_t size, char *buffer, File *handle, bool usepgrd ) :
-      pSrc( src->Self() ), pOffset( offset ), pSize( size ), pBuffer( buffer ), pHandle( handle ), pUsePgRead( usepgrd )
+      pSrc( src->Self() ), pOffset( offset ), pSize( size ), pBuffer( buffer ), pHandle( handle ), pUsePgRead( usepgrd ),
+      pIssued( std::chrono::steady_clock::now() )
     {
 
     }
@@ -76,7 +78,9 @@ class ChunkHandler: public ResponseHandler
         chunk = 0;
       }
 
-      pSrc->ReportResponse( status, chunk, pHandle );
+      using namespace std::chrono;
+      uint64_t latency = duration_cast<microseconds>( steady_clock::now() - pIssued ).count();
+      pSrc->ReportResponse( status, chunk, pHandle, latency );
 
       delete this;
     }
@@ -104,13 +108,14 @@ class ChunkHandler: public ResponseHandler
     char              *pBuffer;
     File              *pHandle;
     bool               pUsePgRead;
+    std::chrono::steady_clock::time_point pIssued;
 };
 
 
 XCpSrc::XCpSrc( uint32_t chunkSize, uint8_t parallel, int64_t fileSize, XCpCtx *ctx ) :
   pChunkSize( chunkSize ), pParallel( parallel ), pFileSize( fileSize ), pThread(),
   pCtx( ctx->Self() ), pFile( 0 ), pCurrentOffset( 0 ), pBlkEnd( 0 ), pDataTransfered( 0 ), pRefCount( 1 ),
-  pRunning( false ), pStartTime( 0 ), pTransferTime( 0 ), pUsePgRead( false )
+  pRunning( false ), pStartTime( 0 ), pTransferTime( 0 ), pUsePgRead( false ), pLatency( 0 )
 {
 }
 
@@ -356,8 +361,10 @@ XRootDStatus XCpSrc::ReadChunks()
     std::pair<uint64_t, uint64_t> p;
     std::map<uint64_t, uint64_t>::iterator itr = pRecovered.begin();
     p = *itr;
-    pOngoing.insert( p );
     pRecovered.erase( itr );
+    // someone else might have delivered it in the meanwhile
+    if( pCtx->IsDelivered( p.first ) ) continue;
+    pOngoing.insert( p );
 
     char *buffer = new char[p.second];
     ChunkHandler *handler = new ChunkHandler( this, p.first, p.second, buffer, pFile, pUsePgRead );
@@ -401,13 +408,16 @@ XRootDStatus XCpSrc::ReadChunks()
   return XRootDStatus( stOK, suContinue );
 }
 
-void XCpSrc::ReportResponse( XRootDStatus *status, PageInfo *chunk, File *handle )
+void XCpSrc::ReportResponse( XRootDStatus *status, PageInfo *chunk, File *handle, uint64_t latency )
 {
   XrdSysMutexHelper lck( pMtx );
   bool ignore = false;
 
   if( status->IsOK() )
   {
+    if( latency )
+      pLatency = pLatency ? ( 7 * pLatency + latency ) / 8 : latency;
+
     // if the status is OK remove it from
     // the list of ongoing transfers, if it
     // was not on the list we ignore the
@@ -457,8 +467,11 @@ void XCpSrc::ReportResponse( XRootDStatus *status, PageInfo *chunk, File *handle
 
   if( chunk )
   {
-    pDataTransfered += chunk->GetLength();
-    pCtx->PutChunk( chunk );
+    // only count the data that made it into the sink, the
+    // duplicate of a hedged chunk is dropped by the context
+    uint64_t length = chunk->GetLength();
+    if( pCtx->PutChunk( chunk ) )
+      pDataTransfered += length;
   }
 }
 
@@ -541,7 +554,9 @@ void XCpSrc::Steal( XCpSrc *src )
   //   rate (similarly, it doesn't make sense to steal)
   // * the source needs to be really faster (though, this is an arbitrary
   //   choice) to actually steal something
-  if( !src->pOngoing.empty() && fraction > 0.7 )
+  // * if hedging is enabled we rather duplicate the ongoing chunks, so
+  //   that the data are not lost if the slow source delivers first
+  if( !src->pOngoing.empty() && fraction > 0.7 && !pCtx->HedgingEnabled() )
   {
     size_t count = static_cast<size_t>( round( fraction * src->pOngoing.size() ) );
     while( count-- )
@@ -555,9 +570,41 @@ void XCpSrc::Steal( XCpSrc *src )
   }
 }
 
+void XCpSrc::Hedge( XCpSrc *src )
+{
+  if( !src || !pCtx->HedgingEnabled() ) return;
+
+  XrdSysMutexHelper lck1( pMtx ), lck2( src->pMtx );
+
+  // only hedge sources that take at least twice as long as we do
+  // to deliver a chunk, if we don't know our own latency yet we
+  // cannot tell
+  if( !pLatency || !src->pRunning ) return;
+  if( src->pLatency && src->pLatency < 2 * pLatency ) return;
+
+  size_t count = 0;
+  std::map<uint64_t, uint64_t>::iterator itr;
+  for( itr = src->pOngoing.begin() ; itr != src->pOngoing.end() ; ++itr )
+  {
+    if( pRecovered.size() + pOngoing.size() >= pParallel ) break;
+    if( !pCtx->Hedge( itr->first ) ) continue;
+    pRecovered.insert( *itr );
+    ++count;
+  }
+
+  if( count )
+  {
+    Log *log = DefaultEnv::GetLog();
+    std::string myHost = URL( pUrl ).GetHostName(), srcHost = URL( src->pUrl ).GetHostName();
+    log->Debug( UtilityMsg, "%s: Hedging %d ongoing chunks of %s (latency %llu us vs %llu us)",
+                myHost.c_str(), int( count ), srcHost.c_str(),
+                (unsigned long long)pLatency, (unsigned long long)src->pLatency );
+  }
+}
+
 XRootDStatus XCpSrc::GetWork()
 {
-  std::pair<uint64_t, uint64_t> p = pCtx->GetBlock();
+  std::pair<uint64_t, uint64_t> p = pCtx->GetBlock( TransferRate() );
 
   if( p.second > 0 )
   {
@@ -577,6 +624,10 @@ XRootDStatus XCpSrc::GetWork()
 
   // if we managed to steal something declare success
   if( pCurrentOffset < pBlkEnd || !pRecovered.empty() ) return XRootDStatus();
+
+  // otherwise help out with the trailing chunks of the slow source
+  Hedge( wLink );
+  if( !pRecovered.empty() ) return XRootDStatus();
   // otherwise return an error
   return XRootDStatus( stError, errInvalidOp );
 }
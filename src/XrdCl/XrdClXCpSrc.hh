@@ -118,6 +118,18 @@ class XCpSrc
      */
     uint64_t TransferRate();
 
+    /**
+     * Get the (moving average of the) time it takes this source
+     * to deliver a chunk, including the round trip
+     *
+     * @return : the chunk latency [us], 0 if not known yet
+     */
+    uint64_t Latency()
+    {
+      XrdSysMutexHelper lck( pMtx );
+      return pLatency;
+    }
+
     /**
      * Delete ChunkInfo object, and set the pointer to null.
      *
@@ -204,6 +216,15 @@ class XCpSrc
      */
     void Steal( XCpSrc *src );
 
+    /**
+     * Duplicate the ongoing chunks of given source if it is
+     * much slower than we are, whichever copy arrives first
+     * is used.
+     *
+     * @param src : the source whose chunks we are hedging
+     */
+    void Hedge( XCpSrc *src );
+
     /**
      * Get more work.
      * First try to get a new block.
@@ -221,8 +242,10 @@ class XCpSrc
      * @param status : operation status
      * @param chunk  : the read chunk (if operation failed, should be null)
      * @param handle : the file object used to read the chunk
+     * @param latency: time it took to get the response [us]
      */
-    void ReportResponse( XRootDStatus *status, PageInfo *chunk, File *handle );
+    void ReportResponse( XRootDStatus *status, PageInfo *chunk, File *handle,
+                         uint64_t latency = 0 );
 
     /**
      * Delets a pointer and sets it to null.
@@ -366,6 +389,11 @@ class XCpSrc
      * the restart
      */
     bool                          pUsePgRead;
+
+    /**
+     * Moving average of the chunk latency [us]
+     */
+    uint64_t                      pLatency;
 };
 
 } /* namespace XrdCl */
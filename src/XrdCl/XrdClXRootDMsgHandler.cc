@@ -921,6 +921,19 @@ namespace XrdCl
     HandleError( status );
   }
 
+  //----------------------------------------------------------------------------
+  // Check if the response may be processed by the thread that received it
+  //----------------------------------------------------------------------------
+  bool XRootDMsgHandler::CanRunInline( const Message &msg ) const
+  {
+    const ServerResponseHeader *rsp =
+        (const ServerResponseHeader*)msg.GetBuffer();
+    if( rsp->status != kXR_ok )
+      return false;
+    return dynamic_cast<SyncResponseHandler*>( pResponseHandler ) ||
+           dynamic_cast<NullResponseHandler*>( pResponseHandler );
+  }
+
   //----------------------------------------------------------------------------
   // Are we a raw writer or not?
   //----------------------------------------------------------------------------
@@ -295,6 +295,17 @@ namespace XrdCl
       //------------------------------------------------------------------------
       virtual bool IsRaw() const;
 
+      //------------------------------------------------------------------------
+      //! Check if the response may be processed by the thread that received
+      //! it rather than by a worker. This is only the case for a final
+      //! kXR_ok response going to one of our own handlers that never block
+      //! (the ones synchronous calls wait on); user handlers may block or
+      //! destroy the objects the event loop is using.
+      //!
+      //! @param msg the response
+      //------------------------------------------------------------------------
+      bool CanRunInline( const Message &msg ) const;
+
       //------------------------------------------------------------------------
       //! Write message body directly to a socket - called if IsRaw returns
       //! true - only socket related errors may be returned here
@@ -29,14 +29,322 @@
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClUtils.hh"
+#include "XrdCl/XrdClURL.hh"
 #include "XrdZip/XrdZipZIP64EOCDL.hh"
-
+#include "XrdOuc/XrdOucCRC.hh"
+#include "XrdSys/XrdSysE2T.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 namespace XrdCl
 {
   using namespace XrdZip;
 
+  namespace
+  {
+    //-------------------------------------------------------------------------
+    // On-disk cache of parsed central directories. The jobs of a workflow
+    // tend to open the same big archives over and over again, each time
+    // reading the EOCD and the whole central directory. With a cache
+    // directory configured the central directory is kept in a file named
+    // after the archive URL (without the CGI) and is only valid as long as
+    // the size and the modification time of the archive do not change and
+    // its checksum matches.
+    //-------------------------------------------------------------------------
+    class CDCache
+    {
+      public:
+        //---------------------------------------------------------------------
+        // Get the cache of the process
+        //---------------------------------------------------------------------
+        static CDCache& Instance()
+        {
+          static CDCache cache;
+          return cache;
+        }
+
+        //---------------------------------------------------------------------
+        // Is the cache enabled
+        //---------------------------------------------------------------------
+        bool Enabled() const
+        {
+          return !pDir.empty();
+        }
+
+        //---------------------------------------------------------------------
+        // Get the central directory for given archive
+        //---------------------------------------------------------------------
+        bool Get( const std::string &key, uint64_t size, uint64_t mtime,
+                  buffer_t &cd )
+        {
+          int fd = open( FileName( key ).c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC );
+          if( fd < 0 ) return false;
+          Header hdr;
+          struct stat st;
+          bool ok = fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) &&
+                    read( fd, &hdr, sizeof( hdr ) ) == sizeof( hdr ) &&
+                    !memcmp( hdr.magic, Magic, sizeof( hdr.magic ) ) &&
+                    hdr.size == size && hdr.mtime == mtime &&
+                    hdr.keylen == key.size() &&
+                    uint64_t( st.st_size ) == sizeof( hdr ) + hdr.keylen + hdr.cdlen;
+          if( ok )
+          {
+            std::string k( hdr.keylen, 0 );
+            cd.resize( hdr.cdlen );
+            ok = read( fd, &k[0], k.size() ) == ssize_t( k.size() ) && k == key &&
+                 read( fd, cd.data(), cd.size() ) == ssize_t( cd.size() ) &&
+                 XrdOucCRC::Calc32C( cd.data(), cd.size() ) == hdr.cdcrc;
+          }
+          close( fd );
+          return ok;
+        }
+
+        //---------------------------------------------------------------------
+        // Save the central directory of given archive
+        //---------------------------------------------------------------------
+        void Put( const std::string &key, uint64_t size, uint64_t mtime,
+                  const buffer_t &cd )
+        {
+          //-------------------------------------------------------------------
+          // Write to a temporary file and rename it so that the other
+          // processes never see a partial central directory
+          //-------------------------------------------------------------------
+          Header hdr;
+          memcpy( hdr.magic, Magic, sizeof( hdr.magic ) );
+          hdr.size   = size;
+          hdr.mtime  = mtime;
+          hdr.keylen = key.size();
+          hdr.cdlen  = cd.size();
+          hdr.cdcrc  = XrdOucCRC::Calc32C( cd.data(), cd.size() );
+          std::string path = FileName( key );
+          std::string tmp  = path + ".XXXXXX";
+          int fd = mkstemp( &tmp[0] );
+          if( fd < 0 ) return;
+          bool ok = write( fd, &hdr, sizeof( hdr ) ) == sizeof( hdr ) &&
+                    write( fd, key.data(), key.size() ) == ssize_t( key.size() ) &&
+                    write( fd, cd.data(), cd.size() ) == ssize_t( cd.size() );
+          close( fd );
+          if( !ok || rename( tmp.c_str(), path.c_str() ) )
+            unlink( tmp.c_str() );
+        }
+
+      private:
+
+        //---------------------------------------------------------------------
+        // Header of a cache file, followed by the key and the central
+        // directory
+        //---------------------------------------------------------------------
+        struct Header
+        {
+          char     magic[8];
+          uint64_t size;
+          uint64_t mtime;
+          uint32_t keylen;
+          uint32_t cdlen;
+          uint32_t cdcrc;
+          uint32_t reserved = 0;
+        };
+
+        static constexpr const char Magic[8] = { 'X', 'r', 'd', 'Z', 'C', 'D', '1', 0 };
+
+        //---------------------------------------------------------------------
+        // Constructor, validates the cache directory. The central directory
+        // tells where the data of each file are, so we only trust a directory
+        // nobody else can write to.
+        //---------------------------------------------------------------------
+        CDCache()
+        {
+          Env *env = DefaultEnv::GetEnv();
+          Log *log = DefaultEnv::GetLog();
+
+          std::string dir = DefaultZipCDCache;
+          env->GetString( "ZipCDCache", dir );
+          if( dir.empty() ) return;
+
+          if( mkdir( dir.c_str(), S_IRWXU ) && errno != EEXIST )
+          {
+            log->Warning( ZipMsg, "Unable to create ZIP central directory cache "
+                          "%s: %s", dir.c_str(), XrdSysE2T( errno ) );
+            return;
+          }
+
+          struct stat st;
+          if( lstat( dir.c_str(), &st ) || !S_ISDIR( st.st_mode ) ||
+              st.st_uid != geteuid() || ( st.st_mode & ( S_IWGRP | S_IWOTH ) ) )
+          {
+            log->Warning( ZipMsg, "Not using ZIP central directory cache %s: it "
+                          "has to be a directory writable by its owner only",
+                          dir.c_str() );
+            return;
+          }
+
+          pDir = dir;
+          log->Debug( ZipMsg, "Using ZIP central directory cache %s", pDir.c_str() );
+        }
+
+        //---------------------------------------------------------------------
+        // Name of the file holding the central directory of given archive
+        // (FNV-1a hash of the key, the key itself is kept in the file)
+        //---------------------------------------------------------------------
+        std::string FileName( const std::string &key ) const
+        {
+          uint64_t hash = 0xcbf29ce484222325ULL;
+          for( unsigned char c : key )
+          {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+          }
+          char name[24];
+          snprintf( name, sizeof( name ), "%016llx.zcd", (unsigned long long)hash );
+          return pDir + "/" + name;
+        }
+
+        std::string pDir;
+    };
+
+    constexpr const char CDCache::Magic[8];
+
+    //-------------------------------------------------------------------------
+    // A file read with ZipArchive::ReadFiles
+    //-------------------------------------------------------------------------
+    struct Member
+    {
+      uint64_t                offset;   //< offset of the (compressed) data in the archive
+      uint32_t                rawsize;  //< size of the (compressed) data
+      uint32_t                size;     //< size of the file
+      bool                    deflated; //< true if the data have to be inflated
+      void                   *usrbuff;  //< user buffer for the file
+      const char             *input;    //< the (compressed) data
+      std::unique_ptr<char[]> rawbuff;  //< buffer for the compressed data
+    };
+
+    //-------------------------------------------------------------------------
+    // State of a ZipArchive::ReadFiles request, shared by the vector read and
+    // the inflate jobs
+    //-------------------------------------------------------------------------
+    struct MultiRead
+    {
+      MultiRead( ResponseHandler *handler ) : handler( handler ), pending( 0 )
+      {
+      }
+
+      //-----------------------------------------------------------------------
+      // Inflate a file in the calling thread
+      //-----------------------------------------------------------------------
+      XRootDStatus Inflate( const Member &m )
+      {
+        z_stream strm;
+        memset( &strm, 0, sizeof( strm ) );
+        // make sure zlib doesn't look for gzip headers
+        if( inflateInit2( &strm, -MAX_WBITS ) != Z_OK )
+          return XRootDStatus( stError, errInternal, 0, "[zlib] inflateInit2 failed." );
+        strm.next_in   = (Bytef*)m.input;
+        strm.avail_in  = m.rawsize;
+        strm.next_out  = (Bytef*)m.usrbuff;
+        strm.avail_out = m.size;
+        int rc = inflate( &strm, Z_FINISH );
+        bool ok = rc == Z_STREAM_END && strm.total_out == m.size;
+        inflateEnd( &strm );
+        if( !ok )
+          return XRootDStatus( stError, errDataError, Z_DATA_ERROR,
+                               "[zlib] inflate : corrupted data." );
+        return XRootDStatus();
+      }
+
+      //-----------------------------------------------------------------------
+      // Account for a finished inflate job, the last one calls the user
+      //-----------------------------------------------------------------------
+      void Done( const XRootDStatus &st )
+      {
+        if( !st.IsOK() )
+        {
+          std::unique_lock<std::mutex> lck( mtx );
+          if( status.IsOK() ) status = st;
+        }
+        if( --pending == 0 ) Finish();
+      }
+
+      //-----------------------------------------------------------------------
+      // Call the user handler
+      //-----------------------------------------------------------------------
+      void Finish()
+      {
+        VectorReadInfo *info = nullptr;
+        if( status.IsOK() )
+        {
+          info = new VectorReadInfo();
+          uint32_t total = 0;
+          for( auto &m : members )
+          {
+            info->GetChunks().emplace_back( 0, m.size, m.usrbuff );
+            total += m.size;
+          }
+          info->SetSize( total );
+        }
+        AnyObject *rsp = nullptr;
+        if( info )
+        {
+          rsp = new AnyObject();
+          rsp->Set( info );
+        }
+        handler->HandleResponse( new XRootDStatus( status ), rsp );
+      }
+
+      ResponseHandler     *handler;
+      std::vector<Member>  members;
+      std::atomic<size_t>  pending;
+      std::mutex           mtx;
+      XRootDStatus         status;
+    };
+
+    //-------------------------------------------------------------------------
+    // Job inflating a file in the thread-pool
+    //-------------------------------------------------------------------------
+    class InflateJob : public Job
+    {
+      public:
+        InflateJob( std::shared_ptr<MultiRead> &rd, size_t index ) : rd( rd ),
+                                                                     index( index )
+        {
+        }
+
+        void Run( void* )
+        {
+          rd->Done( rd->Inflate( rd->members[index] ) );
+          delete this;
+        }
+
+      private:
+        std::shared_ptr<MultiRead> rd;
+        size_t                     index;
+    };
+
+    //-------------------------------------------------------------------------
+    // Inflate all the compressed files once we have their data, each one in
+    // its own job so that the files are inflated in parallel
+    //-------------------------------------------------------------------------
+    void InflateAll( std::shared_ptr<MultiRead> rd )
+    {
+      std::vector<size_t> todo;
+      for( size_t i = 0; i < rd->members.size(); ++i )
+        if( rd->members[i].deflated && rd->members[i].size ) todo.push_back( i );
+      if( todo.empty() ) return rd->Finish();
+
+      // the last one is inflated in the calling thread
+      rd->pending = todo.size();
+      JobManager *jobMgr = DefaultEnv::GetPostMaster()->GetJobManager();
+      for( size_t i = 0; i + 1 < todo.size(); ++i )
+        jobMgr->QueueJob( new InflateJob( rd, todo[i] ) );
+      rd->Done( rd->Inflate( rd->members[todo.back()] ) );
+    }
+  }
+
   //---------------------------------------------------------------------------
   // Read data from a given file
   //---------------------------------------------------------------------------
@@ -274,6 +582,14 @@ namespace XrdCl
     Fwd<void*>    rdbuff; // buffer for data to be read
     uint32_t      maxrdsz = EOCD::maxCommentLength + EOCD::eocdBaseSize +
                             ZIP64_EOCDL::zip64EocdlSize;
+    Fwd<uint64_t> mtime;  // modification time of the archive
+
+    // the central directory of an archive opened read-only can be cached
+    std::string cdkey;
+    OpenFlags::Flags wrtflags = OpenFlags::Update | OpenFlags::Write |
+                                OpenFlags::New | OpenFlags::Delete;
+    if( !( flags & wrtflags ) && CDCache::Instance().Enabled() )
+      cdkey = URL( url ).GetLocation();
 
     Pipeline open_archive = // open the archive
                             XrdCl::Open( archive, url, flags ) >>
@@ -291,6 +607,16 @@ namespace XrdCl
                                    log->Dump( ZipMsg, "[0x%x] Opened a ZIP archive (file empty).", this );
                                    Pipeline::Stop();
                                  }
+                                 // an archive small enough is read in one go anyway,
+                                 // otherwise we may not need to read the CD at all
+                                 mtime = info.GetModTime();
+                                 if( !cdkey.empty() && archsize > maxrdsz && *mtime &&
+                                     GetCachedCD( cdkey, *mtime ) )
+                                 {
+                                   log->Dump( ZipMsg, "[0x%x] Opened a ZIP archive, Central "
+                                                      "Directory found in the cache.", this );
+                                   Pipeline::Stop();
+                                 }
                                  // prepare the arguments for the subsequent read
                                  rdsize = ( archsize <= maxrdsz ? archsize : maxrdsz );
                                  rdoff  = archsize - *rdsize;
@@ -458,6 +784,8 @@ namespace XrdCl
                                       if( chunk.length != archsize ) buffer.reset();
                                       openstage = Done;
                                       cdexists  = true;
+                                      if( !cdkey.empty() && !buffer && *mtime )
+                                        PutCachedCD( cdkey, *mtime );
                                       break;
                                     }
 
@@ -563,6 +891,54 @@ namespace XrdCl
     return metadata;
   }
 
+  //---------------------------------------------------------------------------
+  // Get the central directory from the on-disk cache
+  //---------------------------------------------------------------------------
+  bool ZipArchive::GetCachedCD( const std::string &key, uint64_t mtime )
+  {
+    buffer_t cd;
+    if( !CDCache::Instance().Get( key, archsize, mtime, cd ) ) return false;
+
+    try
+    {
+      if( cd.size() < EOCD::eocdBaseSize ) throw bad_data();
+      openstage = NotParsed;
+      SetCD( cd );
+      // the records have to agree with the (ZIP64) EOCD and fit in the archive
+      uint64_t nbrec  = zip64eocd ? zip64eocd->nbCdRec  : eocd->nbCdRec;
+      uint64_t cdsize = zip64eocd ? zip64eocd->cdSize   : eocd->cdSize;
+      cdoff           = zip64eocd ? zip64eocd->cdOffset : eocd->cdOffset;
+      if( nbrec != cdvec.size() || cdsize != orgcdsz || cdoff + cdsize > archsize )
+        throw bad_data();
+      return true;
+    }
+    catch( const bad_data &ex )
+    {
+      Log *log = DefaultEnv::GetLog();
+      log->Warning( ZipMsg, "[0x%x] Ignoring corrupted cached Central Directory.", this );
+      Clear();
+      orgcdbuf.clear();
+      cdexists = false;
+      return false;
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Save the central directory in the on-disk cache
+  //---------------------------------------------------------------------------
+  void ZipArchive::PutCachedCD( const std::string &key, uint64_t mtime )
+  {
+    // the original records followed by the (ZIP64) EOCD, as SetCD expects
+    buffer_t cd;
+    cd.reserve( orgcdbuf.size() + eocd->eocdSize +
+                ( zip64eocd ? zip64eocd->zip64EocdTotalSize : 0 ) );
+    cd.insert( cd.end(), orgcdbuf.begin(), orgcdbuf.end() );
+    if( zip64eocd )
+      zip64eocd->Serialize( cd );
+    eocd->Serialize( cd );
+    CDCache::Instance().Put( key, archsize, mtime, cd );
+  }
+
   //---------------------------------------------------------------------------
   // Set central directory for the ZIP archive
   //---------------------------------------------------------------------------
@@ -714,6 +1090,96 @@ namespace XrdCl
     return ReadFromImpl<PageInfo>( *this, fn, offset, size, buffer, handler, timeout );
   }
 
+  //---------------------------------------------------------------------------
+  // Read several files from the ZIP archive at once
+  //---------------------------------------------------------------------------
+  XRootDStatus ZipArchive::ReadFiles( const std::vector<std::string> &fns,
+                                      const std::vector<void*>       &buffers,
+                                      ResponseHandler                *handler,
+                                      uint16_t                        timeout )
+  {
+    if( openstage != Done || !archive.IsOpen() )
+      return XRootDStatus( stError, errInvalidOp );
+    if( fns.size() != buffers.size() || !handler )
+      return XRootDStatus( stError, errInvalidArgs );
+
+    Log *log = DefaultEnv::GetLog();
+
+    //-------------------------------------------------------------------------
+    // Figure out where the data of each file are
+    //-------------------------------------------------------------------------
+    std::shared_ptr<MultiRead> rd = std::make_shared<MultiRead>( handler );
+    rd->members.resize( fns.size() );
+    ChunkList chunks;
+    for( size_t i = 0; i < fns.size(); ++i )
+    {
+      uint64_t offset = 0;
+      XRootDStatus st = GetOffset( fns[i], offset );
+      if( !st.IsOK() ) return st;
+
+      CDFH *cdfh = cdvec[cdmap[fns[i]]].get();
+      uint64_t rawsize = cdfh->compressedSize;
+      if( rawsize == std::numeric_limits<uint32_t>::max() && cdfh->extra )
+        rawsize = cdfh->extra->compressedSize;
+      uint64_t size = cdfh->uncompressedSize;
+      if( size == std::numeric_limits<uint32_t>::max() && cdfh->extra )
+        size = cdfh->extra->uncompressedSize;
+      if( rawsize >= std::numeric_limits<uint32_t>::max() ||
+          size >= std::numeric_limits<uint32_t>::max() )
+        return XRootDStatus( stError, errNotSupported, 0,
+                             "The file is too big to be read at once." );
+
+      Member &m  = rd->members[i];
+      m.offset   = offset;
+      m.rawsize  = rawsize;
+      m.size     = size;
+      m.deflated = cdfh->compressionMethod == Z_DEFLATED;
+      m.usrbuff  = buffers[i];
+
+      // if we have the whole ZIP archive there is nothing to read
+      if( buffer )
+      {
+        m.input = buffer.get() + offset;
+        if( !m.deflated ) memcpy( m.usrbuff, m.input, m.size );
+        continue;
+      }
+
+      // stored files are read straight into the user buffer
+      if( !m.deflated ) m.input = (char*)m.usrbuff;
+      else
+      {
+        m.rawbuff.reset( new char[m.rawsize] );
+        m.input = m.rawbuff.get();
+      }
+      if( m.rawsize )
+        chunks.emplace_back( m.offset, m.rawsize, (void*)m.input );
+    }
+
+    if( chunks.empty() )
+    {
+      InflateAll( rd );
+      return XRootDStatus();
+    }
+
+    //-------------------------------------------------------------------------
+    // Read the data of all the files with a single vector read
+    //-------------------------------------------------------------------------
+    log->Dump( ZipMsg, "[0x%x] Reading %zu files with a vector read of %zu chunks.",
+                       this, fns.size(), chunks.size() );
+    auto rdhandler = ResponseHandler::Wrap( [rd]( XRootDStatus &st, AnyObject& )
+                     {
+                       if( !st.IsOK() )
+                       {
+                         rd->status = st;
+                         return rd->Finish();
+                       }
+                       InflateAll( rd );
+                     } );
+    XRootDStatus st = archive.VectorRead( chunks, nullptr, rdhandler, timeout );
+    if( !st.IsOK() ) delete rdhandler;
+    return st;
+  }
+
   //---------------------------------------------------------------------------
   // List files in the ZIP archive
   //---------------------------------------------------------------------------
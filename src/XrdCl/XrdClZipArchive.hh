@@ -38,6 +38,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 //-----------------------------------------------------------------------------
 // Forward declaration needed for friendship
@@ -186,6 +187,24 @@ namespace XrdCl
                                ResponseHandler   *handler,
                                uint16_t           timeout = 0 );
 
+      //-----------------------------------------------------------------------
+      //! Read several files from the ZIP archive at once. The data of all the
+      //! files are fetched with a single vector read and the compressed files
+      //! are then inflated in parallel in the thread-pool.
+      //!
+      //! @param fns     : the names of the files to be read
+      //! @param buffers : the buffers for the data, one per file, each big
+      //!                  enough to hold the whole (uncompressed) file
+      //! @param handler : user callback, the response is a VectorReadInfo
+      //!                  object with one chunk per file
+      //! @param timeout : operation timeout
+      //! @return        : the status of the operation
+      //-----------------------------------------------------------------------
+      XRootDStatus ReadFiles( const std::vector<std::string> &fns,
+                              const std::vector<void*>       &buffers,
+                              ResponseHandler                *handler,
+                              uint16_t                        timeout = 0 );
+
       //-----------------------------------------------------------------------
       //! Append data to a new file
       //!
@@ -436,6 +455,24 @@ namespace XrdCl
       //-----------------------------------------------------------------------
       void SetCD( const buffer_t &buffer );
 
+      //-----------------------------------------------------------------------
+      //! Get the central directory from the on-disk cache
+      //!
+      //! @param key   : the cache key of the ZIP archive
+      //! @param mtime : the modification time of the ZIP archive
+      //! @return      : true if the central directory has been set
+      //-----------------------------------------------------------------------
+      bool GetCachedCD( const std::string &key, uint64_t mtime );
+
+      //-----------------------------------------------------------------------
+      //! Save the central directory that has just been parsed in the on-disk
+      //! cache
+      //!
+      //! @param key   : the cache key of the ZIP archive
+      //! @param mtime : the modification time of the ZIP archive
+      //-----------------------------------------------------------------------
+      void PutCachedCD( const std::string &key, uint64_t mtime );
+
       //-----------------------------------------------------------------------
       //! Package a response into AnyObject (erase the type)
       //!
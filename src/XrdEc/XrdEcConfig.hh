@@ -76,6 +76,35 @@ namespace XrdEc
 
       bool enable_plugins;
 
+      //-----------------------------------------------------------------------
+      //! Percentile of the recent stripe read latencies after which a read
+      //! that is still outstanding is hedged by reading parity stripes
+      //! (0 disables hedged reads)
+      //-----------------------------------------------------------------------
+      uint8_t hedge_percentile;
+
+      //-----------------------------------------------------------------------
+      //! Never hedge a read earlier than this number of milliseconds
+      //-----------------------------------------------------------------------
+      uint32_t hedge_minwait;
+
+      //-----------------------------------------------------------------------
+      //! Number of reconstructed blocks a reader keeps for subsequent reads
+      //-----------------------------------------------------------------------
+      size_t cache_blocks;
+
+      //-----------------------------------------------------------------------
+      //! Number of consecutive failures to reach a data server after which
+      //! reads from it are skipped
+      //-----------------------------------------------------------------------
+      uint32_t dead_failures;
+
+      //-----------------------------------------------------------------------
+      //! Maximum number of seconds between the probe reads of a data server
+      //! whose reads are skipped
+      //-----------------------------------------------------------------------
+      uint32_t dead_period;
+
     private:
 
       std::unordered_map<std::string, RedundancyProvider> redundancies;
@@ -84,7 +113,12 @@ namespace XrdEc
       //-----------------------------------------------------------------------
       //! Constructor
       //-----------------------------------------------------------------------
-      Config() : enable_plugins( true )
+      Config() : enable_plugins( true ),
+                 hedge_percentile( 95 ),
+                 hedge_minwait( 10 ),
+                 cache_blocks( 4 ),
+                 dead_failures( 3 ),
+                 dead_period( 60 )
       {
       }
 
@@ -27,6 +27,7 @@
 #include "XrdEc/XrdEcConfig.hh"
 #include "XrdEc/XrdEcObjCfg.hh"
 #include "XrdEc/XrdEcThreadPool.hh"
+#include "XrdEc/XrdEcSrvHealth.hh"
 
 #include "XrdZip/XrdZipLFH.hh"
 #include "XrdZip/XrdZipCDFH.hh"
@@ -41,10 +42,16 @@
 
 #include "XrdCl/XrdClLog.hh"
 #include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClURL.hh"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iterator>
 #include <numeric>
+#include <queue>
+#include <thread>
 #include <tuple>
 #include <set>
 
@@ -111,6 +118,94 @@ namespace XrdEc
                                 std::move( updt ) ).Timeout( timeout );
   }
 
+  //---------------------------------------------------------------------------
+  // Runs the hedging tasks once their deadline is reached. The client task
+  // manager only has a resolution of a second, which is far too coarse for
+  // this purpose, hence this simple timer.
+  //---------------------------------------------------------------------------
+  class HedgeTimer
+  {
+    public:
+
+      typedef std::chrono::steady_clock::time_point time_point;
+      typedef std::function<void()>                 task_t;
+
+      //-----------------------------------------------------------------------
+      // Singleton access
+      //-----------------------------------------------------------------------
+      static HedgeTimer& Instance()
+      {
+        static HedgeTimer instance;
+        return instance;
+      }
+
+      //-----------------------------------------------------------------------
+      // Run the task at (or shortly after) the given time
+      //-----------------------------------------------------------------------
+      void Schedule( time_point when, task_t task )
+      {
+        std::unique_lock<std::mutex> lck( mtx );
+        bool first = tasks.empty() || when < tasks.top().when;
+        tasks.push( entry_t{ when, std::move( task ) } );
+        if( first ) cv.notify_one();
+      }
+
+      //-----------------------------------------------------------------------
+      // Destructor
+      //-----------------------------------------------------------------------
+      ~HedgeTimer()
+      {
+        {
+          std::unique_lock<std::mutex> lck( mtx );
+          stop = true;
+        }
+        cv.notify_one();
+        timer.join();
+      }
+
+    private:
+
+      struct entry_t
+      {
+        time_point when;
+        task_t     task;
+        bool operator>( const entry_t &e ) const { return when > e.when; }
+      };
+
+      HedgeTimer() : stop( false ), timer( &HedgeTimer::Run, this )
+      {
+      }
+
+      void Run()
+      {
+        std::unique_lock<std::mutex> lck( mtx );
+        while( !stop )
+        {
+          if( tasks.empty() )
+          {
+            cv.wait( lck );
+            continue;
+          }
+          if( tasks.top().when > std::chrono::steady_clock::now() )
+          {
+            cv.wait_until( lck, tasks.top().when );
+            continue;
+          }
+          task_t task = std::move( const_cast<entry_t&>( tasks.top() ).task );
+          tasks.pop();
+          lck.unlock();
+          task();
+          lck.lock();
+        }
+      }
+
+      std::mutex                                                           mtx;
+      std::condition_variable                                              cv;
+      std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>> tasks;
+      bool                                                                 stop;
+      std::thread                                                          timer;
+  };
+
   //-------------------------------------------------------------------------
   // A single data block
   //-------------------------------------------------------------------------
@@ -133,10 +228,99 @@ namespace XrdEc
                                                               state( objcfg.nbchunks, Empty ),
                                                               pending( objcfg.nbchunks ),
                                                               blkid( blkid ),
-                                                              recovering( 0 )
+                                                              recovering( 0 ),
+                                                              recovered( false ),
+                                                              orphans( objcfg.nbchunks ),
+                                                              hedged( objcfg.nbchunks, false ),
+                                                              loadseq( objcfg.nbchunks, 0 )
     {
     }
 
+    //-----------------------------------------------------------------------
+    // Start loading a stripe and, if we know how long reads usually take,
+    // arm the timer that will hedge the read should it take much longer
+    //
+    // @param self     : the block_t object
+    // @param strpid   : stripe ID
+    // @param timeout  : operation timeout
+    //-----------------------------------------------------------------------
+    static void load( std::shared_ptr<block_t> &self,
+                      size_t                    strpid,
+                      uint16_t                  timeout = 0 )
+    {
+      self->reader.Read( self->blkid, strpid, self->stripes[strpid],
+                         read_callback( self, strpid ), timeout );
+      self->state[strpid] = Loading;
+
+      std::chrono::microseconds wait = SrvHealth::Instance().HedgeAfter();
+      if( !wait.count() ) return;
+      uint32_t seq = ++self->loadseq[strpid];
+      std::weak_ptr<block_t> wself( self );
+      HedgeTimer::Instance().Schedule( std::chrono::steady_clock::now() + wait,
+                                       [wself, strpid, seq]()
+                                       {
+                                         std::shared_ptr<block_t> self = wself.lock();
+                                         if( self ) hedge( self, strpid, seq );
+                                       } );
+    }
+
+    //-----------------------------------------------------------------------
+    // The read of a stripe is taking much longer than reads usually do,
+    // rather than waiting for it reconstruct the stripe from parity (if
+    // there is enough of it left). The read in flight keeps its buffer and
+    // if it completes before the reconstruction its data is used after all.
+    //
+    // @param self     : the block_t object
+    // @param strpid   : stripe ID
+    // @param seq      : the sequence number of the load that armed the timer
+    //-----------------------------------------------------------------------
+    static void hedge( std::shared_ptr<block_t> &self, size_t strpid, uint32_t seq )
+    {
+      std::unique_lock<std::mutex> lck( self->mtx );
+      if( self->state[strpid] != Loading || self->hedged[strpid] ||
+          self->loadseq[strpid] != seq ) return;
+      //---------------------------------------------------------------------
+      // We must stay within what the parity can make up for, and either have
+      // enough valid stripes to reconstruct right away or a stripe we have
+      // not tried yet
+      //---------------------------------------------------------------------
+      size_t lostcnt = 0, emptycnt = 0, validcnt = 0;
+      for( auto s : self->state )
+      {
+        if( s == Missing || s == Recovering ) ++lostcnt;
+        else if( s == Empty ) ++emptycnt;
+        else if( s == Valid ) ++validcnt;
+      }
+      if( lostcnt + 1 > self->objcfg.nbparity ) return;
+      if( !emptycnt && validcnt < self->objcfg.nbdata ) return;
+
+      XrdCl::DefaultEnv::GetLog()->Debug( XrdCl::XRootDMsg, "EC Read: hedging slow "
+                                          "read of block %lu stripe %lu.",
+                                          (unsigned long)self->blkid, (unsigned long)strpid );
+      self->hedged[strpid] = true;
+      self->orphans[strpid].swap( self->stripes[strpid] );
+      self->state[strpid] = Missing;
+      if( !error_correction( self ) ) self->fail_missing();
+    }
+
+    //-----------------------------------------------------------------------
+    // A hedged read has completed after all
+    //-----------------------------------------------------------------------
+    void hedge_done( size_t strpid, const XrdCl::XRootDStatus &st )
+    {
+      hedged[strpid] = false;
+      //---------------------------------------------------------------------
+      // If the stripe has not been reconstructed yet use the data we got
+      //---------------------------------------------------------------------
+      if( st.IsOK() && ( state[strpid] == Recovering || state[strpid] == Missing ) )
+      {
+        stripes[strpid].swap( orphans[strpid] );
+        state[strpid] = Valid;
+        carryout( pending[strpid], stripes[strpid] );
+      }
+      buffer_t().swap( orphans[strpid] );
+    }
+
     //-----------------------------------------------------------------------
     // Read data from stripe
     //
@@ -163,11 +347,7 @@ namespace XrdEc
       // The cache is empty, we need to load the data
       //---------------------------------------------------------------------
       if( self->state[strpid] == Empty )
-      {
-        self->reader.Read( self->blkid, strpid, self->stripes[strpid],
-                           read_callback( self, strpid ), timeout );
-        self->state[strpid] = Loading;
-      }
+        load( self, strpid, timeout );
       //---------------------------------------------------------------------
       // The stripe is either corrupted or unreachable
       //---------------------------------------------------------------------
@@ -269,11 +449,14 @@ namespace XrdEc
         }
         //-------------------------------------------------------------------
         // Now when we recovered the data we need to mark every stripe as
-        // valid and execute the pending reads
+        // valid and execute the pending reads (this includes stripes that
+        // only just went missing)
         //-------------------------------------------------------------------
+        self->recovered = true;
         for( size_t strpid = 0; strpid < self->objcfg.nbchunks; ++strpid )
         {
-          if( self->state[strpid] != Recovering ) continue;
+          if( self->state[strpid] != Recovering &&
+              self->state[strpid] != Missing ) continue;
           self->state[strpid] = Valid;
           self->carryout( self->pending[strpid], self->stripes[strpid] );
         }
@@ -287,9 +470,7 @@ namespace XrdEc
       {
         size_t strpid = i++;
         if( self->state[strpid] != Empty ) continue;
-        self->reader.Read( self->blkid, strpid, self->stripes[strpid],
-                           read_callback( self, strpid ) );
-        self->state[strpid] = Loading;
+        load( self, strpid );
         ++loadingcnt;
       }
 
@@ -311,6 +492,15 @@ namespace XrdEc
       return [self, strpid]( const XrdCl::XRootDStatus &st, uint32_t ) mutable
              {
                std::unique_lock<std::mutex> lck( self->mtx );
+               //------------------------------------------------------------
+               // A read we hedged has completed, the stripe is being taken
+               // care of already
+               //------------------------------------------------------------
+               if( self->hedged[strpid] )
+               {
+                 self->hedge_done( strpid, st );
+                 return;
+               }
                self->state[strpid] = st.IsOK() ? Valid : Missing;
                //------------------------------------------------------------
                // Check if we need to do any error correction (either for
@@ -417,6 +607,10 @@ namespace XrdEc
     std::vector<pending_t>  pending;    //< pending reads per stripe
     size_t                  blkid;      //< block ID
     bool                    recovering; //< true if we are in the process of recovering data, false otherwise
+    std::atomic<bool>       recovered;  //< true if any stripe had to be reconstructed
+    std::vector<buffer_t>   orphans;    //< buffers of hedged reads still in flight
+    std::vector<bool>       hedged;     //< true if the read of the stripe was hedged
+    std::vector<uint32_t>   loadseq;    //< number of loads of every stripe
     std::mutex              mtx;
   };
 
@@ -428,6 +622,36 @@ namespace XrdEc
   {
   }
 
+  //---------------------------------------------------------------------------
+  // Get the block to read from (the caller must hold blkmtx)
+  //---------------------------------------------------------------------------
+  std::shared_ptr<block_t> Reader::GetBlock( size_t blkid )
+  {
+    //-------------------------------------------------------------------------
+    // Keep the block we are leaving if we had to reconstruct any of it, a
+    // neighbouring read may well need it again
+    //-------------------------------------------------------------------------
+    size_t maxcache = Config::Instance().cache_blocks;
+    if( block && block->recovered && maxcache )
+    {
+      rcvblks.push_front( block );
+      while( rcvblks.size() > maxcache ) rcvblks.pop_back();
+    }
+    //-------------------------------------------------------------------------
+    // Check if we have the block we want in the cache
+    //-------------------------------------------------------------------------
+    auto itr = std::find_if( rcvblks.begin(), rcvblks.end(),
+                             [blkid]( const std::shared_ptr<block_t> &blk )
+                             { return blk->blkid == blkid; } );
+    if( itr != rcvblks.end() )
+    {
+      std::shared_ptr<block_t> blk = *itr;
+      rcvblks.erase( itr );
+      return blk;
+    }
+    return std::make_shared<block_t>( blkid, *this, objcfg );
+  }
+
   //---------------------------------------------------------------------------
   // Open the erasure coded / striped object
   //---------------------------------------------------------------------------
@@ -440,6 +664,7 @@ namespace XrdEc
       // generate the URL
       std::string url = objcfg.GetDataUrl( i );
       archiveIndices.emplace(url, i);
+      hostids.emplace( url, XrdCl::URL( url ).GetHostId() );
       // create the file object
       dataarchs.emplace( url, std::make_shared<XrdCl::ZipArchive>(
           Config::Instance().enable_plugins ) );
@@ -529,7 +754,7 @@ namespace XrdEc
       //-------------------------------------------------------------------
       std::unique_lock<std::mutex> lck( blkmtx );
       if( !block || block->blkid != blkid )
-        block = std::make_shared<block_t>( blkid, *this, objcfg );
+        block = GetBlock( blkid );
       //-------------------------------------------------------------------
       // Prepare the callback for reading from single stripe
       //-------------------------------------------------------------------
@@ -628,6 +853,15 @@ namespace XrdEc
     }
     // get the URL of the ZIP archive with the respective data
     const std::string &url = itr->second;
+    // don't bother with a data server we know we cannot reach
+    const std::string &host = hostids[url];
+    if( SrvHealth::Instance().IsDead( host ) )
+    {
+      XrdCl::XRootDStatus st( XrdCl::stError, XrdCl::errNoMoreReplicas, 0,
+                              "Data server is unreachable." );
+      ThreadPool::Instance().Execute( cb, st, 0 );
+      return;
+    }
     // get the ZipArchive object
     auto &zipptr = dataarchs[url];
     // check the size of the data to be read
@@ -643,18 +877,24 @@ namespace XrdEc
     // create a buffer for the data
     buffer.resize( objcfg.chunksize );
     // issue the read request
+    auto start = std::chrono::steady_clock::now();
     XrdCl::Async( XrdCl::ReadFrom( *zipptr, fn, 0, rdsize, buffer.data() ) >>
-                    [zipptr, fn, cb, this]( XrdCl::XRootDStatus &st, XrdCl::ChunkInfo &ch )
+                    [zipptr, fn, cb, host, start, this]( XrdCl::XRootDStatus &st, XrdCl::ChunkInfo &ch )
                     {
                       //---------------------------------------------------
                       // If read failed there's nothing to do, just pass the
-                      // status to user callback
+                      // status to user callback (and remember the server
+                      // if we could not reach it)
                       //---------------------------------------------------
                       if( !st.IsOK() )
                       {
+                        if( SrvHealth::IsUnreachable( st ) )
+                          SrvHealth::Instance().Failed( host );
                         cb( st, 0 );
                         return;
                       }
+                      SrvHealth::Instance().Alive( host );
+                      SrvHealth::Instance().AddLatency( std::chrono::steady_clock::now() - start );
                       //---------------------------------------------------
                       // Get the checksum for the read data
                       //---------------------------------------------------
@@ -885,6 +1125,8 @@ namespace XrdEc
 	  std::set<std::tuple<size_t, size_t, size_t>> requestedChunks;
 	  // create block_ts for any requested block index
 	  std::map<size_t, std::shared_ptr<block_t>> blockMap;
+	  // blkid, strpid of chunks on data servers known to be unreachable
+	  std::set<std::tuple<size_t, size_t>> deadChunks;
 
 	  // go through the requested lists of chunks and assign them to fitting hosts
 	  for(size_t index = 0; index < chunks.size(); index++){
@@ -934,7 +1176,9 @@ namespace XrdEc
 				blockMap[blkid]->stripes[strpid].resize( info ->GetSize() );
 
 		      auto requestChunk = std::make_tuple(indexOfArchive, blkid, strpid);
-		      if(requestedChunks.find(requestChunk) == requestedChunks.end())
+		      if(SrvHealth::Instance().IsDead(hostids[url]))
+		    	  deadChunks.emplace(blkid, strpid);
+		      else if(requestedChunks.find(requestChunk) == requestedChunks.end())
 		    	  {
 		    	  uint64_t off = 0;
 		    	  dataarchs[url]->GetOffset(objcfg.GetFileName(blkid, strpid), off);
@@ -953,6 +1197,15 @@ namespace XrdEc
 		  }
 	  }
 
+	  // reconstruct chunks on unreachable servers right away rather than
+	  // waiting for their reads to fail
+	  for(auto &dead : deadChunks){
+		  size_t blkid = std::get<0>(dead);
+		  size_t strpid = std::get<1>(dead);
+		  log->Dump(XrdCl::XRootDMsg, "EC Vector Read: Skipping unreachable server for block %lu stripe %lu.", (unsigned long)blkid, (unsigned long)strpid);
+		  MissingVectorRead(blockMap[blkid], blkid, strpid, timeout);
+	  }
+
 	  std::vector<XrdCl::Pipeline> hostPipes;
 	  hostPipes.reserve(hostLists.size());
 	  for(size_t i = 0; i < hostLists.size(); i++){
@@ -965,6 +1218,11 @@ namespace XrdEc
 						partList, nullptr, timeout)
 						>> [=](const XrdCl::XRootDStatus &st, XrdCl::VectorReadInfo ch) mutable
 						{
+								const std::string &hostid = hostids[objcfg.GetDataUrl(i)];
+								if(st.IsOK())
+									SrvHealth::Instance().Alive(hostid);
+								else if(SrvHealth::IsUnreachable(st))
+									SrvHealth::Instance().Failed(hostid);
 								auto it = requestedChunks.begin();
 								while(it!=requestedChunks.end())
 								{
@@ -30,6 +30,7 @@
 #include "XrdCl/XrdClZipArchive.hh"
 #include "XrdCl/XrdClOperations.hh"
 
+#include <list>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -136,6 +137,14 @@ namespace XrdEc
       //-----------------------------------------------------------------------
       void Read( size_t blknb, size_t strpnb, buffer_t &buffer, callback_t cb, uint16_t timeout = 0 );
 
+      //-----------------------------------------------------------------------
+      //! Get the block to read from, either a new one or a reconstructed
+      //! block from the cache (the caller must hold blkmtx)
+      //!
+      //! @param blkid : number of the block
+      //-----------------------------------------------------------------------
+      std::shared_ptr<block_t> GetBlock( size_t blkid );
+
       //-----------------------------------------------------------------------
       //! Read metadata for the object
       //!
@@ -177,6 +186,7 @@ namespace XrdEc
       typedef std::unordered_map<std::string, buffer_t> metadata_t;
       typedef std::unordered_map<std::string, std::string> urlmap_t;
       typedef std::unordered_set<std::string> missing_t;
+      typedef std::list<std::shared_ptr<block_t>> blkcache_t;
 
       ObjCfg                   &objcfg;
       dataarchs_t               dataarchs; //> map URL to ZipArchive object
@@ -184,10 +194,12 @@ namespace XrdEc
       urlmap_t                  urlmap;    //> map blknb/strpnb (data chunk) to URL
       missing_t                 missing;   //> set of missing stripes
       std::shared_ptr<block_t>  block;     //> cache for the block we are reading from
-      std::mutex                blkmtx;    //> mutex guarding the block from parallel access
+      blkcache_t                rcvblks;   //> cache of reconstructed blocks (most recent first)
+      std::mutex                blkmtx;    //> mutex guarding the blocks from parallel access
       size_t                    lstblk;    //> last block number
       uint64_t                  filesize;  //> file size (obtained from xattr)
       std::map<std::string, size_t>  archiveIndices;
+      std::unordered_map<std::string, std::string> hostids; //> map URL to host identifier
 
       std::mutex	missingChunksMutex;
       std::vector<std::tuple<size_t, size_t>> missingChunksVectorRead;
@@ -154,6 +154,11 @@ RedundancyProvider::RedundancyProvider( const ObjCfg &objcfg ) :
   // k = data
   // m = data + parity
   gf_gen_cauchy1_matrix( encode_matrix.data(), static_cast<int>( objcfg.nbchunks ), static_cast<int>( objcfg.nbdata ) );
+  // the first nData rows are the identity, the remaining ones generate parity
+  encode_table.resize( objcfg.nbdata * objcfg.nbparity * 32 );
+  if( objcfg.nbparity )
+    ec_init_tables( static_cast<int>( objcfg.nbdata ), static_cast<int>( objcfg.nbparity ),
+                    &encode_matrix[objcfg.nbdata * objcfg.nbdata], encode_table.data() );
 }
 
 
@@ -244,12 +249,13 @@ void RedundancyProvider::compute( stripes_t &stripes )
   for( uint8_t i = 0; i < objcfg.nbdata; i++ )
     inbuf[i] = reinterpret_cast<unsigned char*>( stripes[dd.blockIndices[i]].buffer );
 
-  std::vector<unsigned char> memory( dd.nErrors * objcfg.chunksize );
-
-  unsigned char* outbuf[dd.nErrors];
-  for (int i = 0; i < dd.nErrors; i++)
+  /* the missing blocks are decoded in place, in the order of the pattern */
+  unsigned char* outbuf[objcfg.nbparity];
+  int e = 0;
+  for (size_t i = 0; i < objcfg.nbchunks && e < dd.nErrors; i++)
   {
-    outbuf[i] = &memory[i * objcfg.chunksize];
+    if( pattern[i] )
+      outbuf[e++] = reinterpret_cast<unsigned char*>( stripes[i].buffer );
   }
 
   ec_encode_data(
@@ -260,16 +266,31 @@ void RedundancyProvider::compute( stripes_t &stripes )
       inbuf,          // Array of pointers to source input buffers
       outbuf          // Array of pointers to coded output buffers
   );
+}
 
-  int e = 0;
-  for (size_t i = 0; i < objcfg.nbchunks; i++)
+void RedundancyProvider::encode( stripes_t &stripes, uint64_t offset, uint64_t length )
+{
+  /* nothing to do if there are no parity blocks or nothing to encode */
+  if ( !objcfg.nbparity || !length ) return;
+
+  /* in case of a single data block use replication */
+  if ( objcfg.nbdata == 1 )
   {
-    if( pattern[i] )
-    {
-      memcpy( stripes[i].buffer, outbuf[e], objcfg.chunksize );
-      e++;
-    }
+    for( uint8_t i = 1; i < objcfg.nbchunks; ++i )
+      memcpy( stripes[i].buffer + offset, stripes[0].buffer + offset, length );
+    return;
   }
+
+  unsigned char* inbuf[objcfg.nbdata];
+  for( uint8_t i = 0; i < objcfg.nbdata; i++ )
+    inbuf[i] = reinterpret_cast<unsigned char*>( stripes[i].buffer + offset );
+
+  unsigned char* outbuf[objcfg.nbparity];
+  for( uint8_t i = 0; i < objcfg.nbparity; i++ )
+    outbuf[i] = reinterpret_cast<unsigned char*>( stripes[objcfg.nbdata + i].buffer + offset );
+
+  ec_encode_data( static_cast<int>( length ), static_cast<int>( objcfg.nbdata ),
+                  static_cast<int>( objcfg.nbparity ), encode_table.data(), inbuf, outbuf );
 }
 
 
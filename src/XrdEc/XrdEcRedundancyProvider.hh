@@ -50,6 +50,19 @@ namespace XrdEc
     //--------------------------------------------------------------------------
     void compute( stripes_t &stripes );
 
+    //--------------------------------------------------------------------------
+    //! Compute the parity blocks of a stripe with all data blocks present, for
+    //! the given byte range of every block. The encoding tables are computed
+    //! once, so unlike compute() this does not need to look up the cache and
+    //! can be called for successive slices of the blocks, e.g. to process
+    //! them while they are still in the CPU cache.
+    //!
+    //! @param stripes nData+nParity blocks, the parity blocks will be computed
+    //! @param offset  offset of the range within each block
+    //! @param length  length of the range
+    //--------------------------------------------------------------------------
+    void encode( stripes_t &stripes, uint64_t offset, uint64_t length );
+
     //--------------------------------------------------------------------------
     //! Constructor.
     //! Stripe parameters (number of data and parity blocks) are constant per
@@ -103,6 +116,8 @@ namespace XrdEc
 
     //! the encoding matrix, required to compute any decode matrix
     std::vector<unsigned char> encode_matrix;
+    //! the coding tables for the parity blocks
+    std::vector<unsigned char> encode_table;
     //! a cache of previously used coding tables
     std::unordered_map<std::string, CodingTable> cache;
     //! concurrency control
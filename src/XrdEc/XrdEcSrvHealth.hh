@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In applying this licence, CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//------------------------------------------------------------------------------
+
+#ifndef SRC_XRDEC_XRDECSRVHEALTH_HH_
+#define SRC_XRDEC_XRDECSRVHEALTH_HH_
+
+#include "XrdEc/XrdEcConfig.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace XrdEc
+{
+  //---------------------------------------------------------------------------
+  // Health and read latency of the data servers, shared by all readers so
+  // that what was learned while reading one object benefits the next one.
+  //
+  // A data server is only skipped after Config::dead_failures consecutive
+  // failures to reach it. While it is skipped a single read is let through
+  // every now and then to probe it; the interval starts at one second and
+  // doubles with every failed probe up to Config::dead_period seconds. A
+  // successful read clears the record.
+  //---------------------------------------------------------------------------
+  class SrvHealth
+  {
+    public:
+
+      typedef std::chrono::steady_clock clock_t;
+
+      //-----------------------------------------------------------------------
+      // Singleton access
+      //-----------------------------------------------------------------------
+      static SrvHealth& Instance()
+      {
+        static SrvHealth instance;
+        return instance;
+      }
+
+      //-----------------------------------------------------------------------
+      // Record the latency of a successful stripe read
+      //-----------------------------------------------------------------------
+      void AddLatency( clock_t::duration latency )
+      {
+        std::unique_lock<std::mutex> lck( mtx );
+        samples[next++ % samples.size()] =
+            std::chrono::duration_cast<std::chrono::microseconds>( latency ).count();
+        if( count < samples.size() ) ++count;
+        //---------------------------------------------------------------------
+        // Recompute the threshold every now and then, once we have enough
+        // samples for the percentile to be meaningful
+        //---------------------------------------------------------------------
+        if( count >= minsamples && next % updtfreq == 0 )
+        {
+          uint8_t pct = Config::Instance().hedge_percentile;
+          if( !pct || pct > 100 ) { threshold = 0; return; }
+          std::vector<uint64_t> sorted( samples.begin(), samples.begin() + count );
+          size_t idx = ( count - 1 ) * pct / 100;
+          std::nth_element( sorted.begin(), sorted.begin() + idx, sorted.end() );
+          uint64_t minwait = uint64_t( Config::Instance().hedge_minwait ) * 1000;
+          threshold = std::max( sorted[idx], minwait );
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      // @return : how long to wait for a stripe before hedging the read,
+      //           zero if hedging is disabled or we did not learn it yet
+      //-----------------------------------------------------------------------
+      std::chrono::microseconds HedgeAfter()
+      {
+        std::unique_lock<std::mutex> lck( mtx );
+        if( !Config::Instance().hedge_percentile ) return std::chrono::microseconds( 0 );
+        return std::chrono::microseconds( threshold );
+      }
+
+      //-----------------------------------------------------------------------
+      // Record a failure to reach a data server
+      //-----------------------------------------------------------------------
+      void Failed( const std::string &host )
+      {
+        std::unique_lock<std::mutex> lck( mtx );
+        health_t &h = hosts[host];
+        if( ++h.failures < Config::Instance().dead_failures ) return;
+        //---------------------------------------------------------------------
+        // Either the server just crossed the threshold or a probe failed
+        //---------------------------------------------------------------------
+        std::chrono::milliseconds maxbackoff( uint64_t( Config::Instance().dead_period ) * 1000 );
+        if( h.backoff.count() == 0 ) h.backoff = std::chrono::milliseconds( 1000 );
+        else h.backoff *= 2;
+        if( h.backoff > maxbackoff ) h.backoff = maxbackoff;
+        h.until = clock_t::now() + h.backoff;
+      }
+
+      //-----------------------------------------------------------------------
+      // Record a successful read from a data server
+      //-----------------------------------------------------------------------
+      void Alive( const std::string &host )
+      {
+        std::unique_lock<std::mutex> lck( mtx );
+        if( !hosts.empty() ) hosts.erase( host );
+      }
+
+      //-----------------------------------------------------------------------
+      // @return : true if reads from the data server should be skipped; once
+      //           the backoff expired a single caller gets false, so that it
+      //           probes the server, and the others keep skipping it
+      //-----------------------------------------------------------------------
+      bool IsDead( const std::string &host )
+      {
+        std::unique_lock<std::mutex> lck( mtx );
+        auto itr = hosts.find( host );
+        if( itr == hosts.end() ) return false;
+        health_t &h = itr->second;
+        if( h.failures < Config::Instance().dead_failures ) return false;
+        clock_t::time_point now = clock_t::now();
+        if( now < h.until ) return true;
+        h.until = now + h.backoff;
+        return false;
+      }
+
+      //-----------------------------------------------------------------------
+      // @return : true if the error means the server could not be reached
+      //-----------------------------------------------------------------------
+      static bool IsUnreachable( const XrdCl::XRootDStatus &st )
+      {
+        return ( st.code > 100 && st.code < 200 ) ||
+               st.code == XrdCl::errOperationExpired;
+      }
+
+    private:
+
+      SrvHealth() : samples( 256, 0 ), next( 0 ), count( 0 ), threshold( 0 )
+      {
+      }
+
+      struct health_t
+      {
+        health_t() : failures( 0 ), backoff( 0 ) { }
+        uint32_t                  failures; //< consecutive failures
+        std::chrono::milliseconds backoff;  //< current probe interval
+        clock_t::time_point       until;    //< skip the server until then
+      };
+
+      static const size_t minsamples = 32; //< samples needed before hedging
+      static const size_t updtfreq   = 16; //< recompute after that many samples
+
+      std::mutex                                 mtx;
+      std::vector<uint64_t>                      samples;   //< recent latencies (us)
+      size_t                                     next;      //< next sample slot
+      size_t                                     count;     //< number of samples
+      uint64_t                                   threshold; //< hedge after (us)
+      std::unordered_map<std::string, health_t>  hosts;     //< servers that failed
+  };
+}
+
+#endif // SRC_XRDEC_XRDECSRVHEALTH_HH_
@@ -35,6 +35,7 @@
 
 #include "XrdOuc/XrdOucCRC32C.hh"
 
+#include <algorithm>
 #include <vector>
 #include <condition_variable>
 #include <mutex>
@@ -141,7 +142,6 @@ namespace XrdEc
                                         wrtbuff( BufferPool::Instance().Create( objcfg ) )
       {
         stripes.reserve( objcfg.nbchunks );
-        memset( wrtbuff.GetBuffer(), 0, wrtbuff.GetSize() );
       }
       //-----------------------------------------------------------------------
       //! Move constructor
@@ -182,9 +182,11 @@ namespace XrdEc
       //-----------------------------------------------------------------------
       void Pad( uint32_t size )
       {
-        // if the buffer exist we only need to move the cursor
+        // if the buffer exist we only need to zero the data and move the
+        // cursor (the buffer may have been recycled)
         if( wrtbuff.GetSize() != 0 )
         {
+          memset( wrtbuff.GetBufferAtCursor(), 0, size );
           wrtbuff.AdvanceCursor( size );
           return;
         }
@@ -256,19 +258,31 @@ namespace XrdEc
       //-----------------------------------------------------------------------
       inline void Encode()
       {
-        // first calculate the parity
+        // the data past the cursor is not ours (the buffer may have been
+        // recycled), parity of a partial block is computed over zeros
+        if( wrtbuff.GetCursor() < objcfg.datasize )
+          memset( wrtbuff.GetBufferAtCursor(), 0, objcfg.datasize - wrtbuff.GetCursor() );
         uint8_t i ;
         for( i = 0; i < objcfg.nbchunks; ++i )
           stripes.emplace_back( wrtbuff.GetBuffer( i * objcfg.chunksize ), i < objcfg.nbdata );
-        Config &cfg = Config::Instance();
-        cfg.GetRedundancy( objcfg ).compute( stripes );
-        // then calculate the checksums
-        cksums.reserve( objcfg.nbchunks );
-        for( uint8_t strpnb = 0; strpnb < objcfg.nbchunks; ++strpnb )
+        // calculate the parity and the checksums slice by slice so the data
+        // is still in the CPU cache when the checksums are calculated; only
+        // as much as the first (largest) stripe holds needs to be encoded
+        RedundancyProvider &redundancy = Config::Instance().GetRedundancy( objcfg );
+        std::vector<uint32_t> strpsize( objcfg.nbchunks );
+        for( i = 0; i < objcfg.nbchunks; ++i )
+          strpsize[i] = GetStrpSize( i );
+        cksums.assign( objcfg.nbchunks, 0 );
+        for( uint64_t offset = 0; offset < strpsize[0]; offset += slicesize )
         {
-          size_t chunksize = GetStrpSize( strpnb );
-          std::future<uint32_t> ftr = ThreadPool::Instance().Execute( objcfg.digest, 0, stripes[strpnb].buffer, chunksize );
-          cksums.emplace_back( std::move( ftr ) );
+          uint64_t length = std::min<uint64_t>( slicesize, strpsize[0] - offset );
+          redundancy.encode( stripes, offset, length );
+          for( i = 0; i < objcfg.nbchunks; ++i )
+          {
+            if( offset >= strpsize[i] ) continue;
+            uint64_t len = std::min<uint64_t>( length, strpsize[i] - offset );
+            cksums[i] = objcfg.digest( cksums[i], stripes[i].buffer + offset, len );
+          }
         }
       }
       //-----------------------------------------------------------------------
@@ -279,15 +293,20 @@ namespace XrdEc
       //-----------------------------------------------------------------------
       inline uint32_t GetCrc32c( size_t strpnb )
       {
-        return cksums[strpnb].get();
+        return cksums[strpnb];
       }
 
     private:
 
+      //-----------------------------------------------------------------------
+      //! Number of bytes of each stripe encoded and checksummed at a time
+      //-----------------------------------------------------------------------
+      static const uint64_t slicesize = 64 * 1024;
+
       ObjCfg                             objcfg;  //< configuration for the data object
       XrdCl::Buffer                      wrtbuff; //< the buffer for the data
       stripes_t                          stripes; //< data stripes
-      std::vector<std::future<uint32_t>> cksums;  //< crc32cs for the data stripes
+      std::vector<uint32_t>              cksums;  //< crc32cs for the data stripes
   };
 
 
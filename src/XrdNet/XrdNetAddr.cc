@@ -498,14 +498,22 @@ const char *XrdNetAddr::Set(struct addrinfo *rP, int Port, bool mapit)
   
 void XrdNetAddr::SetCache(int keeptime)
 {
-   static XrdNetCache theCache;
+// The cache is never deleted as its resolver threads may be using it at exit
+//
+   static XrdNetCache *theCache = new XrdNetCache;
 
 // Set the cache keep time
 //
-   theCache.SetKT(keeptime);
-   dnsCache = (keeptime > 0 ? &theCache : 0);
+   theCache->SetKT(keeptime);
+   dnsCache = (keeptime > 0 ? theCache : 0);
 }
 
+/******************************************************************************/
+/*                          S e t C a c h e W a i t                           */
+/******************************************************************************/
+  
+void XrdNetAddr::SetCacheWait(int waittime) {XrdNetCache::SetWT(waittime);}
+
 /******************************************************************************/
 /*                             S e t D y n D N S                              */
 /******************************************************************************/
@@ -196,6 +196,19 @@ const char *Set(struct addrinfo *rP, int port, bool mapit=false);
 
 static void SetCache(int keeptime);
 
+//------------------------------------------------------------------------------
+//! Set the maximum time to wait for an address to name resolution when the
+//! cache is used. Should the name not be resolved in time, the address is used
+//! as the name while the resolution continues in the background. The object
+//! keeps the numeric name; only later lookups of the address get the resolved
+//! name from the cache. This method should only be called during
+//! initialization time. The default is 5 seconds.
+//!
+//! @param  waittime Seconds to wait; zero never waits for a name not cached.
+//------------------------------------------------------------------------------
+
+static void SetCacheWait(int waittime);
+
 //------------------------------------------------------------------------------
 //! Set the dialect being spoken on this network link.
 //!
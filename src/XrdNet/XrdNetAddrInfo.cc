@@ -174,6 +174,39 @@ int XrdNetAddrInfo::Format(char *bAddr, int bLen, fmtUse theFmt, int fmtOpts)
    return totLen+n;
 }
 
+/******************************************************************************/
+/* Private:                      G e t N a m e                                */
+/******************************************************************************/
+
+int XrdNetAddrInfo::GetName(char *hBuff, int hBlen)
+{
+   int n, rc;
+
+// Determine the actual size of the address structure
+//
+        if (IP.Addr.sa_family == AF_INET ) n = sizeof(IP.v4);
+   else if (IP.Addr.sa_family == AF_INET6) n = sizeof(IP.v6);
+   else return EAI_FAMILY;
+
+// Do lookup of canonical name
+//
+   if ((rc = getnameinfo(&IP.Addr, n, hBuff+1, hBlen-2, 0, 0, 0))) return rc;
+
+// Handle the case when the mapping returned an actual name or an address
+// We always want numeric ipv6 addresses surrounded by brackets. Additionally,
+// some implementations of getnameinfo() return the scopeid when a numeric
+// address is returned. We check and remove it.
+//
+        if (!index(hBuff+1, ':')) memmove(hBuff, LowCase(hBuff+1),
+                                          strlen(hBuff+1)+1);
+   else {char *perCent = index(hBuff+1, '%');
+         if (perCent) *perCent = 0;
+         n = strlen(hBuff+1);
+         hBuff[0] = '['; hBuff[n+1] = ']'; hBuff[n+2] = 0;
+        }
+   return 0;
+}
+
 /******************************************************************************/
 /*                            i s L o o p b a c k                             */
 /******************************************************************************/
@@ -373,50 +406,41 @@ int XrdNetAddrInfo::QFill(char *bAddr, int bLen)
 int XrdNetAddrInfo::Resolve()
 {
    char hBuff[NI_MAXHOST];
-   int n, rc;
+   int rc;
 
 // Free up hostname here
 //
    if (hostName) {free(hostName); hostName = 0;}
 
-// Determine the actual size of the address structure
+// Make sure we have an address that can actually be resolved
 //
-        if (IP.Addr.sa_family == AF_INET ) n = sizeof(IP.v4);
-   else if (IP.Addr.sa_family == AF_INET6) n = sizeof(IP.v6);
-   else if (IP.Addr.sa_family == AF_UNIX )
+        if (IP.Addr.sa_family == AF_UNIX)
            {hostName = strdup("localhost");
             return 0;
            }
-   else return EAI_FAMILY;
-
-// Do lookup of canonical name. If an error is returned we simply assume that
-// the name is not resolvable and return the address as the host name.
-//
-   if ((rc = getnameinfo(&IP.Addr, n, hBuff+1, sizeof(hBuff)-2, 0, 0, 0)))
-      {int ec = errno;
-       if (Format(hBuff, sizeof(hBuff), fmtAddr, noPort))
+   else if (IP.Addr.sa_family != AF_INET && IP.Addr.sa_family != AF_INET6)
+           return EAI_FAMILY;
+
+// When names are cached, the cache resolves the name on its own threads so
+// that a slow name server holds us up no longer than the configured wait
+// time. If the name was not resolved in time we use the address for now.
+//
+   if (dnsCache)
+      {if ((hostName = dnsCache->Resolve(this))) return 0;
+       rc = EAI_AGAIN;
+      } else {
+       if (!(rc = GetName(hBuff, sizeof(hBuff))))
           {hostName = strdup(hBuff); return 0;}
-       errno = ec;
-       return rc;
       }
 
-// Handle the case when the mapping returned an actual name or an address
-// We always want numeric ipv6 addresses surrounded by brackets. Additionally,
-// some implementations of getnameinfo() return the scopeid when a numeric
-// address is returned. We check and remove it.
+// If an error is returned we simply assume that the name is not resolvable
+// and return the address as the host name.
 //
-        if (!index(hBuff+1, ':')) hostName = strdup(LowCase(hBuff+1));
-   else {char *perCent = index(hBuff+1, '%');
-         if (perCent) *perCent = 0;
-         n = strlen(hBuff+1);
-         hBuff[0] = '['; hBuff[n+1] = ']'; hBuff[n+2] = 0;
-         hostName = strdup(hBuff);
-        }
-
-// Add the entry to the cache and return success
-//
-   if (dnsCache) dnsCache->Add(this, hostName);
-   return 0;
+   int ec = errno;
+   if (Format(hBuff, sizeof(hBuff), fmtAddr, noPort))
+      {hostName = strdup(hBuff); return 0;}
+   errno = ec;
+   return rc;
 }
   
 /******************************************************************************/
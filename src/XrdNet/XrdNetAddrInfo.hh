@@ -350,6 +350,9 @@ XrdNetAddrInfo &operator=(XrdNetAddrInfo const &rhs)
                          }
 
 protected:
+friend class XrdNetCache;
+
+       int                 GetName(char *hBuff, int hBlen);
        char               *LowCase(char *str);
        int                 QFill(char *bAddr, int bLen);
        int                 Resolve();
@@ -30,6 +30,7 @@
 
 #include <cstdlib>
 #include <ctime>
+#include <netdb.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -41,66 +42,117 @@
 /******************************************************************************/
   
 int XrdNetCache::keepTime = 0;
+int XrdNetCache::negTime  = 0;
+int XrdNetCache::waitTime = 5;
 
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
   
 XrdNetCache::XrdNetCache(int psize, int csize)
+                        : qCV(0), qFirst(0), qLast(0), thCount(-1)
 {
-     prevtablesize = psize;
-     nashtablesize = csize;
-     Threshold     = (csize * LoadMax) / 100;
-     nashnum       = 0;
-     nashtable     = (anItem **)malloc( (size_t)(csize*sizeof(anItem *)) );
-     memset((void *)nashtable, 0, (size_t)(csize*sizeof(anItem *)));
+   for (int i = 0; i < numShards; i++)
+       {aShard &shard = theShards[i];
+        shard.prevtablesize = psize;
+        shard.nashtablesize = csize;
+        shard.Threshold     = (csize * LoadMax) / 100;
+        shard.nashnum       = 0;
+        shard.nashtable = (anItem **)malloc( (size_t)(csize*sizeof(anItem *)) );
+        memset((void *)shard.nashtable, 0, (size_t)(csize*sizeof(anItem *)));
+       }
 }
 
 /******************************************************************************/
 /* public                            A d d                                    */
 /******************************************************************************/
   
-void XrdNetCache::Add(XrdNetAddrInfo *hAddr, const char *hName)
+void XrdNetCache::Add(XrdNetAddrInfo *hAddr, const char *hName, bool isNeg)
 {
    anItem Item, *hip;
-   int    kent;
+   int    kent, kt = (isNeg ? negTime : keepTime);
 
 // Get the key and make sure this is a valid address (should be)
 //
    if (!GenKey(Item, hAddr)) return;
+   aShard &shard = ShardOf(Item);
 
-// We may be in a race condition, check we have this item
+// We may be in a race condition, check we have this item. A failed lookup
+// does not replace a name that is still valid; a refresh may fail because
+// the name server is temporarily unavailable.
 //
-   myMutex.Lock();
-   if ((hip = Locate(Item)))
-      {if (hip->hName) free(hip->hName);
+   shard.myMutex.Lock();
+   if ((hip = shard.Locate(Item)))
+      {hip->inRefresh = false;
+       if (isNeg && !hip->isNeg && hip->expTime > time(0))
+          {shard.myMutex.UnLock();
+           return;
+          }
+       if (hip->hName) free(hip->hName);
        hip->hName = strdup(hName);
-       hip->expTime = time(0) + keepTime;
-       myMutex.UnLock();
+       hip->expTime = time(0) + kt;
+       hip->isNeg = isNeg;
+       shard.myMutex.UnLock();
        return;
       }
 
 // Check if we should expand the table
 //
-   if (++nashnum > Threshold) Expand();
+   if (++shard.nashnum > shard.Threshold) shard.Expand();
 
 // Allocate a new entry
 //
-   hip = new anItem(Item, hName, keepTime);
+   hip = new anItem(Item, hName, kt, isNeg);
 
 // Add the entry to the table
 //
-   kent = hip->aHash % nashtablesize;
-   hip->Next = nashtable[kent];
-   nashtable[kent] = hip;
-   myMutex.UnLock();
+   kent = hip->aHash % shard.nashtablesize;
+   hip->Next = shard.nashtable[kent];
+   shard.nashtable[kent] = hip;
+   shard.myMutex.UnLock();
+}
+
+/******************************************************************************/
+/* Private:                     D o L o o k u p                               */
+/******************************************************************************/
+
+void XrdNetCache::DoLookup(aLookup *lP)
+{
+   char hBuff[NI_MAXHOST];
+   bool isNeg = false;
+
+// Resolve the address. If it cannot be resolved, the address becomes the name.
+//
+   if (GetName(&lP->Addr, hBuff, sizeof(hBuff)))
+      {isNeg = true;
+       if (!lP->Addr.Format(hBuff, sizeof(hBuff), XrdNetAddrInfo::fmtAddr,
+                            XrdNetAddrInfo::noPort)) *hBuff = 0;
+      }
+
+// Add the result to the cache before anyone is told about it so that a new
+// request for this address either finds it there or joins this lookup.
+//
+   if (*hBuff) Add(&lP->Addr, hBuff, isNeg);
+
+// Remove the lookup from the pending list and wake up all of the waiters
+//
+   aShard &shard = ShardOf(lP->Key);
+   shard.myMutex.Lock();
+   aLookup **pP = &shard.pending;
+   while(*pP != lP) pP = &((*pP)->Next);
+   *pP = lP->Next;
+   if (*hBuff) lP->hName = strdup(hBuff);
+   lP->isDone = true;
+   shard.lkpCV.Broadcast();
+   if (!(--lP->Refs)) delete lP;
+   shard.myMutex.UnLock();
 }
   
 /******************************************************************************/
 /* private                        E x p a n d                                 */
 /******************************************************************************/
   
-void XrdNetCache::Expand()
+void XrdNetCache::aShard::Expand()
 {
    int newsize, newent, i;
    size_t memlen;
@@ -148,36 +200,46 @@ void XrdNetCache::Expand()
 char *XrdNetCache::Find(XrdNetAddrInfo *hAddr)
 {
   anItem Item, *nip, *pip = 0;
+  time_t nowTime;
   int kent;
 
 // Get the hash for this address
 //
    if (!GenKey(Item, hAddr)) return 0;
+   aShard &shard = ShardOf(Item);
 
 // Compute position of the hash table entry
 //
-   myMutex.Lock();
-   kent = Item.aHash%nashtablesize;
+   shard.myMutex.Lock();
+   kent = Item.aHash%shard.nashtablesize;
 
 // Find the entry
 //
-   nip = nashtable[kent];
+   nip = shard.nashtable[kent];
    while(nip && *nip != Item) {pip = nip; nip = nip->Next;}
-   if (!nip) {myMutex.UnLock(); return 0;}
+   if (!nip) {shard.myMutex.UnLock(); return 0;}
 
-// Make sure entry has not expired
+// Make sure entry has not expired. If it is about to, refresh it in the
+// background so that the next lookup does not need to wait for the name.
 //
-   if (nip->expTime > time(0))
+   nowTime = time(0);
+   if (nip->expTime > nowTime)
       {char *hName = strdup(nip->hName);
-       myMutex.UnLock();
+       if (!nip->isNeg && !nip->inRefresh
+       &&  nip->expTime - nowTime <= keepTime/8 && Threads())
+          {nip->inRefresh = true;
+           Start(shard, Item, hAddr);
+          }
+       shard.myMutex.UnLock();
        return hName;
       }
 
 // Remove the entry and return not found
 //
-   if (pip) pip->Next       = nip->Next;
-      else  nashtable[kent] = nip->Next;
-   myMutex.UnLock();
+   if (pip) pip->Next             = nip->Next;
+      else  shard.nashtable[kent] = nip->Next;
+   shard.nashnum--;
+   shard.myMutex.UnLock();
    delete nip;
    return 0;
 }
@@ -221,7 +283,7 @@ int XrdNetCache::GenKey(XrdNetCache::anItem &Item, XrdNetAddrInfo *hAddr)
 /* Private:                       L o c a t e                                 */
 /******************************************************************************/
   
-XrdNetCache::anItem *XrdNetCache::Locate(XrdNetCache::anItem &Item)
+XrdNetCache::anItem *XrdNetCache::aShard::Locate(XrdNetCache::anItem &Item)
 {
   anItem *nip;
   unsigned int kent;
@@ -233,3 +295,133 @@ XrdNetCache::anItem *XrdNetCache::Locate(XrdNetCache::anItem &Item)
    while(nip && *nip != Item) nip = nip->Next;
    return nip;
 }
+
+/******************************************************************************/
+/* public                        R e s o l v e                                */
+/******************************************************************************/
+  
+char *XrdNetCache::Resolve(XrdNetAddrInfo *hAddr)
+{
+   anItem   Item;
+   aLookup *lP;
+   char    *hName = 0;
+   time_t   endTime;
+   int      waitLeft;
+
+// Get the key and make sure this is a valid address (should be)
+//
+   if (!GenKey(Item, hAddr)) return 0;
+
+// If we have no resolver threads, we must resolve the name ourselves
+//
+   if (!Threads())
+      {char hBuff[NI_MAXHOST];
+       if (GetName(hAddr, hBuff, sizeof(hBuff)))
+          {if (!hAddr->Format(hBuff, sizeof(hBuff), XrdNetAddrInfo::fmtAddr,
+                              XrdNetAddrInfo::noPort)) return 0;
+           Add(hAddr, hBuff, true);
+          } else Add(hAddr, hBuff);
+       return strdup(hBuff);
+      }
+
+// Start the lookup or join the one already in progress for this address
+//
+   aShard &shard = ShardOf(Item);
+   shard.myMutex.Lock();
+   lP = Start(shard, Item, hAddr);
+
+// Wait for the name to be resolved, but only for so long
+//
+   if (waitTime > 0)
+      {lP->Refs++;
+       endTime = time(0) + waitTime;
+       while(!lP->isDone)
+            {if ((waitLeft = endTime - time(0)) <= 0
+             ||  shard.lkpCV.Wait(waitLeft)) break;
+            }
+       if (lP->isDone && lP->hName) hName = strdup(lP->hName);
+       if (!(--lP->Refs)) delete lP;
+      }
+
+// All done
+//
+   shard.myMutex.UnLock();
+   return hName;
+}
+
+/******************************************************************************/
+/* Private:                     R e s o l v e r                               */
+/******************************************************************************/
+
+void *XrdNetCache::Resolver(void *carg)
+{
+   XrdNetCache *cP = (XrdNetCache *)carg;
+   aLookup     *lP;
+
+// Simply process lookups as they are queued
+//
+   while(1)
+        {cP->qCV.Lock();
+         while(!(lP = cP->qFirst)) cP->qCV.Wait();
+         if (!(cP->qFirst = lP->qNext)) cP->qLast = 0;
+         cP->qCV.UnLock();
+         cP->DoLookup(lP);
+        }
+   return (void *)0;
+}
+
+/******************************************************************************/
+/* Private:                        S t a r t                                  */
+/******************************************************************************/
+
+XrdNetCache::aLookup *XrdNetCache::Start(aShard &shard, anItem &Item,
+                                         XrdNetAddrInfo *hAddr)
+{
+   aLookup *lP;
+
+// The shard lock must be held. If there is a lookup in progress for this
+// address, we simply join it.
+//
+   for (lP = shard.pending; lP; lP = lP->Next)
+       if (!(lP->Key != Item)) return lP;
+
+// Create a new lookup and place it on the pending list
+//
+   lP = new aLookup(Item, hAddr);
+   lP->Next = shard.pending;
+   shard.pending = lP;
+
+// Hand it over to the resolver threads
+//
+   qCV.Lock();
+   if (qLast) qLast->qNext = lP;
+      else    qFirst       = lP;
+   qLast = lP;
+   qCV.Signal();
+   qCV.UnLock();
+   return lP;
+}
+
+/******************************************************************************/
+/* Private:                      T h r e a d s                                */
+/******************************************************************************/
+
+bool XrdNetCache::Threads()
+{
+   pthread_t tid;
+   int n;
+
+// Start the resolver threads the first time they are needed
+//
+   qCV.Lock();
+   if (thCount < 0)
+      {thCount = 0;
+       for (n = 0; n < numThreads; n++)
+           if (!XrdSysThread::Run(&tid, Resolver, (void *)this,
+                                  XRDSYSTHREAD_BIND, "DNS resolver"))
+              thCount++;
+      }
+   n = thCount;
+   qCV.UnLock();
+   return n > 0;
+}
@@ -34,9 +34,18 @@
 #include <ctime>
 #include <sys/types.h>
 
+#include "XrdNet/XrdNetAddrInfo.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
-class XrdNetAddrInfo;
+//------------------------------------------------------------------------------
+//! The address to name cache is split into shards, each with its own lock, so
+//! that concurrent lookups of different addresses do not contend. Names that
+//! cannot be resolved are cached as well, for a shorter time. Names that are
+//! about to expire are refreshed in the background so that a frequently seen
+//! address never misses. Names that are not cached are resolved by a small
+//! pool of resolver threads. The caller waits for the name for a limited time
+//! and concurrent callers for the same address share a single lookup.
+//------------------------------------------------------------------------------
   
 class XrdNetCache
 {
@@ -48,12 +57,15 @@ public:
 //!
 //! @param  hAddr  points to the address of the name.
 //! @param  hName  points to the name to be associated with the address.
+//! @param  isNeg  when true, the address could not be resolved and hName is
+//!                the address itself. The entry is kept for a shorter time.
 //------------------------------------------------------------------------------
 
-void   Add(XrdNetAddrInfo *hAddr, const char *hName);
+void   Add(XrdNetAddrInfo *hAddr, const char *hName, bool isNeg=false);
 
 //------------------------------------------------------------------------------
-//! Locate an address-hostname association in the cache.
+//! Locate an address-hostname association in the cache. If the entry is about
+//! to expire, a background refresh of the entry is started.
 //!
 //! @param  hAddr  points to the address of the name.
 //!
@@ -63,34 +75,79 @@ void   Add(XrdNetAddrInfo *hAddr, const char *hName);
 
 char  *Find(XrdNetAddrInfo *hAddr);
 
+//------------------------------------------------------------------------------
+//! Resolve an address to a name using the resolver threads. The result is
+//! added to the cache. Should the lookup take longer than the wait time, the
+//! lookup continues in the background and a nil pointer is returned.
+//!
+//! @param  hAddr  points to the address to resolve.
+//!
+//! @return Success: an strdup'd string of the corresponding name. If the
+//!                  address cannot be resolved, this is the address itself.
+//!         Failure: 0, the name was not resolved in time.
+//------------------------------------------------------------------------------
+
+char  *Resolve(XrdNetAddrInfo *hAddr);
+
 //------------------------------------------------------------------------------
 //! Set the default keep time for entries in the cache during initialization.
 //!
 //! @param  ktval  the number of seconds to keep an entry in the cache.
 //------------------------------------------------------------------------------
 static
-void   SetKT(int ktval) {keepTime = ktval;}
+void   SetKT(int ktval) {keepTime = ktval;
+                         negTime  = (ktval < negTimeMax ? ktval : negTimeMax);
+                        }
+
+//------------------------------------------------------------------------------
+//! Set the maximum time to wait for a name during initialization.
+//!
+//! @param  wtval  the number of seconds to wait for a name to be resolved.
+//!                When zero, a name that is not cached is never waited for.
+//------------------------------------------------------------------------------
+static
+void   SetWT(int wtval) {waitTime = wtval;}
 
 //------------------------------------------------------------------------------
 //! Constructor. When allocateing a new hash, two adjacent Fibonocci numbers.
 //! The series is simply n[j] = n[j-1] + n[j-2].
 //!
 //! @param  psize  the correct Fibonocci antecedent to csize.
-//! @param  csize  the initial size of the table.
+//! @param  csize  the initial size of the table of each shard.
 //------------------------------------------------------------------------------
 
-       XrdNetCache(int psize = 987, int csize = 1597);
+       XrdNetCache(int psize = 89, int csize = 144);
 
 //------------------------------------------------------------------------------
 //! Destructor. The XrdNetCache object is not designed to be deleted. Doing
 //! so will cause memory to be lost.
 //------------------------------------------------------------------------------
 
-      ~XrdNetCache() {} // Never gets deleted
+virtual ~XrdNetCache() {} // Never gets deleted
+
+protected:
+
+//------------------------------------------------------------------------------
+//! Resolve an address to a name; this is what the resolver threads run. It is
+//! only meant to be replaced by tests that need a slow or failing name server.
+//!
+//! @param  hAddr  points to the address to resolve.
+//! @param  hBuff  where the name is to be placed.
+//! @param  hBlen  the length of the buffer.
+//!
+//! @return Success: 0.
+//!         Failure: a non-zero getnameinfo() error code.
+//------------------------------------------------------------------------------
+
+virtual int GetName(XrdNetAddrInfo *hAddr, char *hBuff, int hBlen)
+                   {return hAddr->GetName(hBuff, hBlen);}
 
 private:
 
-static const int LoadMax = 80;
+static const int LoadMax    = 80;
+static const int negTimeMax = 60;  // Max seconds to keep an unresolved name
+static const int numShards  = 16;  // Must be a power of 2
+static const int numThreads =  4;  // Number of resolver threads
 
 struct anItem
       {union    {long long aV6[2];
@@ -102,32 +159,80 @@ struct anItem
        time_t    expTime;   // Expiration time
 unsigned int     aHash;     // Hash value
        int       aLen;      // Actual length 4 or 16
+       bool      isNeg;     // Name is the address, it could not be resolved
+       bool      inRefresh; // A background refresh has been started
 
 inline int       operator!=(const anItem &oth)
                            {return aLen != oth.aLen || aHash != oth.aHash
                                 || memcmp(aVal, oth.aVal, aLen);
                            }
 
-                 anItem() : Next(0), hName(0), aLen(0) {}
+                 anItem() : Next(0), hName(0), aLen(0), isNeg(false),
+                            inRefresh(false) {}
 
-                 anItem(anItem &Item, const char *hn, int kt)
+                 anItem(anItem &Item, const char *hn, int kt, bool neg)
                          : Next(0), hName(strdup(hn)), expTime(time(0)+kt),
-                           aHash(Item.aHash), aLen(Item.aLen)
+                           aHash(Item.aHash), aLen(Item.aLen), isNeg(neg),
+                           inRefresh(false)
                          {memcpy(aVal, Item.aVal, Item.aLen);}
                 ~anItem() {if (hName) free(hName);}
       };
 
-void             Expand();
+// A name lookup handed to the resolver threads. It is shared by all of the
+// threads waiting for the same address and is protected by the shard lock.
+//
+struct aLookup
+      {anItem          Key;
+       XrdNetAddrInfo  Addr;
+       aLookup        *Next;      // Next pending lookup in the shard
+       aLookup        *qNext;     // Next lookup in the resolver queue
+       char           *hName;     // Result, valid when isDone
+       int             Refs;      // Waiters plus one for the resolver
+       bool            isDone;
+
+                       aLookup(anItem &Item, XrdNetAddrInfo *hAddr)
+                              : Key(Item), Addr(*hAddr), Next(0), qNext(0),
+                                hName(0), Refs(1), isDone(false)
+                              {Key.hName = 0;}
+                      ~aLookup() {if (hName) free(hName);}
+      };
+
+struct alignas(64) aShard
+      {XrdSysMutex      myMutex;
+       XrdSysCondVar2   lkpCV;
+       anItem         **nashtable;
+       aLookup         *pending;
+       int              prevtablesize;
+       int              nashtablesize;
+       int              nashnum;
+       int              Threshold;
+
+       void             Expand();
+       anItem          *Locate(anItem &Item);
+
+                        aShard() : lkpCV(myMutex), nashtable(0), pending(0) {}
+      };
+
+void             DoLookup(aLookup *lP);
 int              GenKey(anItem &Item, XrdNetAddrInfo *hAddr);
-anItem          *Locate(anItem &Item);
+aShard          &ShardOf(anItem &Item)
+                        {return theShards[(Item.aHash ^ (Item.aHash >> 16))
+                                          & (numShards-1)];
+                        }
+aLookup         *Start(aShard &shard, anItem &Item, XrdNetAddrInfo *hAddr);
+bool             Threads();
+
+static void     *Resolver(void *carg);
 
 static int       keepTime;
+static int       negTime;
+static int       waitTime;
+
+aShard           theShards[numShards];
 
-XrdSysMutex      myMutex;
-anItem         **nashtable;
-int              prevtablesize;
-int              nashtablesize;
-int              nashnum;
-int              Threshold;
+XrdSysCondVar    qCV;           // Protects the resolver queue
+aLookup         *qFirst;
+aLookup         *qLast;
+int              thCount;       // Resolver threads, -1 if not yet started
 };
 #endif
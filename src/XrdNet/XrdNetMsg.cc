@@ -134,6 +134,51 @@ int XrdNetMsg::Send(const struct iovec iov[], int iovcnt,
    return Send(buff, (int)(bp-buff), dest, -1);
 }
   
+/******************************************************************************/
+/*                             S e n d B a t c h                              */
+/******************************************************************************/
+
+int XrdNetMsg::SendBatch(const struct iovec msgs[], int msgcnt)
+{
+   int retc;
+
+   if (!destOK)
+      {eDest->Emsg("Msg", "Destination not specified."); return -1;}
+
+#ifdef __linux__
+   static const int maxBatch = 64;
+   struct mmsghdr mVec[maxBatch];
+   int j, n, sent = 0;
+
+   while(sent < msgcnt)
+        {n = msgcnt - sent;
+         if (n > maxBatch) n = maxBatch;
+         memset(mVec, 0, sizeof(struct mmsghdr)*n);
+         for (j = 0; j < n; j++)
+             {mVec[j].msg_hdr.msg_name    = (void *)dfltDest.SockAddr();
+              mVec[j].msg_hdr.msg_namelen = dfltDest.SockSize();
+              mVec[j].msg_hdr.msg_iov     = (struct iovec *)&msgs[sent+j];
+              mVec[j].msg_hdr.msg_iovlen  = 1;
+             }
+         do {retc = sendmmsg(FD, mVec, n, 0);}
+            while (retc < 0 && errno == EINTR);
+         if (retc <= 0)
+            {if (sent) return sent;
+             retErr(errno, &dfltDest);
+             return -1;
+            }
+         sent += retc;
+        }
+   return sent;
+#else
+   for (int i = 0; i < msgcnt; i++)
+       {if ((retc = Send((const char *)msgs[i].iov_base, msgs[i].iov_len)))
+           return (i ? i : -1);
+       }
+   return msgcnt;
+#endif
+}
+
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
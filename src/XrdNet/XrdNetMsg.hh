@@ -109,6 +109,19 @@ int           Send(const struct  iovec iov[], // Remaining parms as above
                          int     iovcnt,      // Number of elements in iovec
                    const char   *dest=0,      // Hostname to send UDP datagram
                          int     tmo=-1);     // Timeout in ms (-1 = none)
+//------------------------------------------------------------------------------
+//! Send several UDP messages to the default endpoint using as few system calls
+//! as possible (sendmmsg() where available). Each element of the vector is a
+//! separate datagram.
+//!
+//! @param  msgs     The vector of messages to send.
+//! @param  msgcnt   The number of elements in the vector.
+//! @return <0       Messages not sent due to error.
+//! @return >=0      The number of messages sent (well as defined by UDP).
+//------------------------------------------------------------------------------
+
+int           SendBatch(const struct iovec msgs[], int msgcnt);
+
 //------------------------------------------------------------------------------
 //! Constructor
 //!
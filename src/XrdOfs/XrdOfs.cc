@@ -55,6 +55,7 @@
 
 #include "XrdOfs/XrdOfs.hh"
 #include "XrdOfs/XrdOfsChkPnt.hh"
+#include "XrdOfs/XrdOfsCksWrt.hh"
 #include "XrdOfs/XrdOfsConfigCP.hh"
 #include "XrdOfs/XrdOfsEvs.hh"
 #include "XrdOfs/XrdOfsHandle.hh"
@@ -208,6 +209,8 @@ XrdOfs::XrdOfs() : dMask{0000,0775}, fMask{0000,0775}, // Legacy
    Cks       = 0;
    CksPfn    = true;
    CksRdr    = true;
+   CksWrt    = 0;
+   CksWrtRC  = true;
 
 // Prepare handling
 //
@@ -698,6 +701,7 @@ int XrdOfsFile::open(const char          *path,      // In
       {dorawio = (oh->isCompressed && open_mode & SFS_O_RAWIO ? 1 : 0);
        if (tpcKey && isRW)
           return XrdOfsFS->Emsg(epname, error, EALREADY, "tpc", path);
+       if (oP.hP->cksWrt && (open_flag & O_TRUNC)) oP.hP->cksWrt->Truncate(0);
        XrdOfsFS->ocMutex.Lock(); oh = oP.hP; XrdOfsFS->ocMutex.UnLock();
        FTRACE(open, "attach use=" <<oh->Usage());
        if (oP.poscNum > 0) XrdOfsFS->poscQ->Commit(path, oP.poscNum);
@@ -756,6 +760,12 @@ int XrdOfsFile::open(const char          *path,      // In
        dorawio = (open_mode & SFS_O_RAWIO ? 1 : 0);
       }
    oP.hP->Activate(oP.fP);
+
+// A file that starts out empty can have its checksums computed as it is
+// written, provided this has been enabled.
+//
+   if (isRW && (open_flag & (O_TRUNC | O_EXCL)) && !oP.hP->isCompressed)
+      oP.hP->cksWrt = XrdOfsCksWrt::Alloc();
    oP.hP->UnLock();
 
 // Send an open event if we must
@@ -861,6 +871,15 @@ int XrdOfsFile::close()  // In
        if (retc) XrdOfsFS->Emsg(epname,error,retc,"restore chkpnt",hP->Name());
        myCKP->Finished();
        myCKP = 0;
+       if (hP->cksWrt) hP->cksWrt->Reset();
+      }
+
+// Record any checksums accumulated while the file was written. This is done
+// by the last writer while the file is still open.
+//
+   if (hP->cksWrt && hP->Usage() == 1)
+      {hP->cksWrt->Done(hP->Select(), hP->Name());
+       delete hP->cksWrt; hP->cksWrt = 0;
       }
 
 // We need to handle the cunudrum that an event may have to be sent upon
@@ -915,6 +934,13 @@ int XrdOfsFile::checkpoint(XrdSfsFile::cpAct act, struct iov *range, int n)
       return XrdOfsFS->Emsg(epname, error, EIDRM, "extend checkpoint "
              "(only delete or restore possible) for", oh->Name());
 
+// Any checkpoint operation that modifies the file invalidates the checksums
+// being accumulated as the file is written.
+//
+   if (oh->cksWrt && (act == XrdSfsFile::cpRestore
+                  ||  act == XrdSfsFile::cpTrunc
+                  ||  act == XrdSfsFile::cpWrite)) oh->cksWrt->Reset();
+
 // Handle the request
 //
    switch(act)
@@ -1215,6 +1241,7 @@ XrdSfsXferSize XrdOfsFile::pgWrite(XrdSfsFileOffset   offset,
                             (off_t)offset, (size_t)wrlen, csvec, pgOpts));
    if (nbytes < 0)
       return XrdOfsFS->Emsg(epname, error, (int)nbytes, "pgwrite", oh);
+   if (oh->cksWrt) oh->cksWrt->Update(offset, buffer, nbytes);
 
 // Return number of bytes written
 //
@@ -1242,8 +1269,10 @@ XrdSfsXferSize XrdOfsFile::pgWrite(XrdSfsAio *aioparm, uint64_t opts)
 
 // If this is a POSC file, we must convert the async call to a sync call as we
 // must trap any errors that unpersist the file. We can't do that via aio i/f.
+// The same applies when checksums are computed as the file is written as the
+// data must be seen in the order it was successfully written.
 //
-   if (oh->isRW == XrdOfsHandle::opPC)
+   if (oh->isRW == XrdOfsHandle::opPC || oh->cksWrt)
       {aioparm->Result = XrdOfsFile::pgWrite(aioparm->sfsAio.aio_offset,
                                      (char *)aioparm->sfsAio.aio_buf,
                                              aioparm->sfsAio.aio_nbytes,
@@ -1497,6 +1526,7 @@ XrdSfsXferSize XrdOfsFile::write(XrdSfsFileOffset  offset,    // In
                             (off_t)offset, (size_t)blen));
    if (nbytes < 0)
       return XrdOfsFS->Emsg(epname, error, (int)nbytes, "write", oh);
+   if (oh->cksWrt) oh->cksWrt->Update(offset, buff, nbytes);
 
 // Return number of bytes written
 //
@@ -1520,8 +1550,9 @@ int XrdOfsFile::write(XrdSfsAio *aiop)
 
 // If this is a POSC file, we must convert the async call to a sync call as we
 // must trap any errors that unpersist the file. We can't do that via aio i/f.
+// The same applies when checksums are computed as the file is written.
 //
-   if (oh->isRW == XrdOfsHandle::opPC)
+   if (oh->isRW == XrdOfsHandle::opPC || oh->cksWrt)
       {aiop->Result = this->write(aiop->sfsAio.aio_offset,
                                   (const char *)aiop->sfsAio.aio_buf,
                                   aiop->sfsAio.aio_nbytes);
@@ -1703,6 +1734,7 @@ int XrdOfsFile::truncate(XrdSfsFileOffset  flen)  // In
    oh->isPending = 1;
    if ((retc = oh->Select().Ftruncate(flen)))
       return XrdOfsFS->Emsg(epname, error, retc, "truncate", oh);
+   if (oh->cksWrt) oh->cksWrt->Truncate(flen);
 
 // Indicate Success
 //
@@ -0,0 +1,267 @@
+/******************************************************************************/
+/*                                                                            */
+/*                       X r d O f s C k s W r t . c c                        */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "Xrd/XrdJob.hh"
+#include "Xrd/XrdScheduler.hh"
+#include "XrdCks/XrdCks.hh"
+#include "XrdCks/XrdCksCalc.hh"
+#include "XrdCks/XrdCksData.hh"
+#include "XrdOfs/XrdOfsCksWrt.hh"
+#include "XrdOss/XrdOss.hh"
+#include "XrdSys/XrdSysError.hh"
+
+/******************************************************************************/
+/*                         L o c a l   S t a t i c s                          */
+/******************************************************************************/
+
+extern XrdSysError   OfsEroute;
+extern XrdOss       *XrdOfsOss;
+extern XrdScheduler *ofsSchedP;
+
+namespace
+{
+XrdCks *Cks = 0;
+char   *csName[XrdOfsCksWrt::maxCks];
+int     csNum    = 0;
+bool    csPfn    = false;
+bool    csReCalc = true;
+}
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+// Recalculate the checksums of a file that was not written sequentially. Any
+// checksum that has become current in the meantime (e.g. because it was
+// computed in the same pass as a previous one) is not computed again.
+//
+class CksReCalc : public XrdJob
+{
+public:
+
+void DoIt() override
+           {XrdCksData cksData;
+            for (int i = 0; i < csNum; i++)
+                {cksData.Reset(); cksData.Set(csName[i]);
+                 if (Cks->Get(Path, cksData) <= 0)
+                    {cksData.Reset(); cksData.Set(csName[i]);
+                     Cks->Calc(Path, cksData, 1);
+                    }
+                }
+            delete this;
+           }
+
+     CksReCalc(const char *path) : XrdJob("ofs checksum recalc"),
+                                   Path(strdup(path)) {}
+    ~CksReCalc() {free(Path);}
+
+private:
+char *Path;
+};
+}
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdOfsCksWrt::XrdOfsCksWrt() : nextOff(0), isValid(true)
+{
+   memset(csCalc, 0, sizeof(csCalc));
+}
+
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdOfsCksWrt::~XrdOfsCksWrt()
+{
+   for (int i = 0; i < csNum; i++) if (csCalc[i]) csCalc[i]->Recycle();
+}
+
+/******************************************************************************/
+/*                                 A l l o c                                  */
+/******************************************************************************/
+
+XrdOfsCksWrt *XrdOfsCksWrt::Alloc()
+{
+   XrdOfsCksWrt *cwP;
+
+// Check if we are enabled at all
+//
+   if (!csNum) return 0;
+
+// Get a calculator for each checksum. The manager hands out new instances.
+//
+   cwP = new XrdOfsCksWrt;
+   for (int i = 0; i < csNum; i++)
+       {if (!(cwP->csCalc[i] = Cks->Object(csName[i])))
+           {delete cwP; return 0;}
+        cwP->csCalc[i]->Init();
+       }
+   return cwP;
+}
+
+/******************************************************************************/
+/*                                C o n f i g                                 */
+/******************************************************************************/
+
+bool XrdOfsCksWrt::Config(XrdCks *cksP, const char *names, bool reCalc,
+                          bool usePfn, XrdSysError &eDest)
+{
+   XrdCksCalc *csP;
+   const char *csN;
+   char *nList, *val, *comma;
+   bool aOK = true;
+
+// Record the common settings
+//
+   Cks = cksP; csPfn = usePfn; csReCalc = reCalc;
+
+// The special name "all" means every checksum the manager knows about
+//
+   if (!strcmp(names, "all"))
+      {for (int i = 0; (csN = Cks->Name(i)) && csNum < maxCks; i++)
+           csName[csNum++] = strdup(csN);
+      } else {
+       nList = strdup(names); val = nList;
+       while(val && *val)
+            {if ((comma = strchr(val, ','))) *comma++ = 0;
+             if (*val)
+                {if (csNum >= maxCks)
+                    {eDest.Emsg("Config", "too many ckswrite checksums");
+                     aOK = false; break;
+                    }
+                 csName[csNum++] = strdup(val);
+                }
+             val = comma;
+            }
+       free(nList);
+      }
+
+// Verify that we can actually calculate each checksum on the fly
+//
+   for (int i = 0; aOK && i < csNum; i++)
+       {if (!(csP = Cks->Object(csName[i])))
+           {eDest.Emsg("Config", csName[i], "checksum cannot be streamed.");
+            aOK = false;
+           } else csP->Recycle();
+       }
+
+// Disable ourselves on failure
+//
+   if (!aOK || !csNum)
+      {while(csNum) free(csName[--csNum]);
+       if (aOK) eDest.Emsg("Config", "no ckswrite checksums specified.");
+       return false;
+      }
+   return true;
+}
+
+/******************************************************************************/
+/*                                  D o n e                                   */
+/******************************************************************************/
+
+void XrdOfsCksWrt::Done(XrdOssDF &ossFile, const char *lfn)
+{
+   struct stat Stat;
+   XrdCksData  cksData;
+   const char *path = lfn;
+   char pBuff[MAXPATHLEN+8];
+   int  csSize, rc;
+   bool aOK;
+
+// Get the path the checksum manager wants
+//
+   if (csPfn && !(path = XrdOfsOss->Lfn2Pfn(lfn, pBuff, MAXPATHLEN, rc)))
+      {OfsEroute.Emsg("CksWrt", rc, "record checksums for", lfn);
+       return;
+      }
+
+// The accumulated checksums are only good if what we have seen is exactly
+// what is in the file. A failed write or a truncation would tell otherwise.
+//
+   cwMutex.Lock();
+   aOK = isValid && !ossFile.Fstat(&Stat) && Stat.st_size == nextOff;
+
+// Record each checksum. The manager records the file's current mtime along
+// with the value so that any subsequent modification makes it stale.
+//
+   if (aOK)
+      {for (int i = 0; i < csNum; i++)
+           {cksData.Reset(); cksData.Set(csName[i]);
+            csCalc[i]->Type(csSize);
+            cksData.Set((const void *)csCalc[i]->Final(), csSize);
+            if ((rc = Cks->Set(path, cksData)))
+               OfsEroute.Emsg("CksWrt", rc, "record checksum for", lfn);
+           }
+      }
+   cwMutex.UnLock();
+
+// Schedule a recalculation when the file was not written sequentially
+//
+   if (!aOK && csReCalc && ofsSchedP)
+      ofsSchedP->Schedule((XrdJob *)new CksReCalc(path));
+}
+
+/******************************************************************************/
+/*                              T r u n c a t e                               */
+/******************************************************************************/
+
+void XrdOfsCksWrt::Truncate(long long fsize)
+{
+// Truncating to anything other than what has been written so far means the
+// data we have seen is no longer the data in the file.
+//
+   cwMutex.Lock();
+   if (fsize != nextOff) isValid = false;
+   cwMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                U p d a t e                                 */
+/******************************************************************************/
+
+void XrdOfsCksWrt::Update(long long offset, const char *buff, int blen)
+{
+   cwMutex.Lock();
+   if (isValid)
+      {if (offset != nextOff) isValid = false;
+          else {for (int i = 0; i < csNum; i++) csCalc[i]->Update(buff, blen);
+                nextOff += blen;
+               }
+      }
+   cwMutex.UnLock();
+}
@@ -0,0 +1,122 @@
+#ifndef __XRDOFSCKSWRT_HH__
+#define __XRDOFSCKSWRT_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                       X r d O f s C k s W r t . h h                        */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdSys/XrdSysPthread.hh"
+
+//-----------------------------------------------------------------------------
+//! The XrdOfsCksWrt class accumulates checksums while a new file is written.
+//! One object is attached to the handle of a file that was created or
+//! truncated on open. As long as all of the writes are strictly sequential,
+//! the data is fed to the configured checksum calculators and the results
+//! are recorded in the file's extended attributes when the last writer closes
+//! the file. Otherwise, the checksums are recalculated from the file.
+//-----------------------------------------------------------------------------
+
+class XrdCks;
+class XrdCksCalc;
+class XrdOssDF;
+class XrdSysError;
+
+class XrdOfsCksWrt
+{
+public:
+
+static const int     maxCks = 8;  // Maximum number of checksums per file
+
+//-----------------------------------------------------------------------------
+//! Get an object for a newly created or truncated file.
+//!
+//! @return Pointer to the object or nil if streaming checksums are not
+//!         enabled or a calculator could not be obtained.
+//-----------------------------------------------------------------------------
+
+static XrdOfsCksWrt *Alloc();
+
+//-----------------------------------------------------------------------------
+//! Configure streaming checksums.
+//!
+//! @param  cksP    - pointer to the checksum manager.
+//! @param  names   - comma separated list of checksum names or "all".
+//! @param  reCalc  - when true, recalculate checksums in the background
+//!                   should the file not be written sequentially.
+//! @param  usePfn  - when true, the checksum manager needs a physical path.
+//! @param  eDest   - reference to the error object for messages.
+//!
+//! @return true upon success and false otherwise.
+//-----------------------------------------------------------------------------
+
+static bool          Config(XrdCks *cksP, const char *names, bool reCalc,
+                            bool usePfn, XrdSysError &eDest);
+
+//-----------------------------------------------------------------------------
+//! Record the checksums of the file. This is called when the last writer
+//! closes the file and before the file is actually closed.
+//!
+//! @param  ossFile - reference to the still open storage system file.
+//! @param  lfn     - pointer to the logical file name.
+//-----------------------------------------------------------------------------
+
+       void          Done(XrdOssDF &ossFile, const char *lfn);
+
+//-----------------------------------------------------------------------------
+//! Stop accumulating checksums, the file has been modified out of order.
+//-----------------------------------------------------------------------------
+
+       void          Reset() {cwMutex.Lock(); isValid = false; cwMutex.UnLock();}
+
+//-----------------------------------------------------------------------------
+//! Note that the file has been truncated.
+//!
+//! @param  fsize   - the new size of the file.
+//-----------------------------------------------------------------------------
+
+       void          Truncate(long long fsize);
+
+//-----------------------------------------------------------------------------
+//! Feed the data that was just successfully written to the calculators.
+//!
+//! @param  offset  - the offset the data was written at.
+//! @param  buff    - pointer to the data.
+//! @param  blen    - number of bytes written.
+//-----------------------------------------------------------------------------
+
+       void          Update(long long offset, const char *buff, int blen);
+
+                    ~XrdOfsCksWrt();
+
+private:
+                     XrdOfsCksWrt();
+
+XrdSysMutex          cwMutex;
+XrdCksCalc          *csCalc[maxCks];
+long long            nextOff;
+bool                 isValid;
+};
+#endif
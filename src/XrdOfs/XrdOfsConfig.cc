@@ -50,6 +50,7 @@
 #include "XrdSfs/XrdSfsFlags.hh"
 
 #include "XrdOfs/XrdOfs.hh"
+#include "XrdOfs/XrdOfsCksWrt.hh"
 #include "XrdOfs/XrdOfsConfigCP.hh"
 #include "XrdOfs/XrdOfsConfigPI.hh"
 #include "XrdOfs/XrdOfsEvs.hh"
@@ -379,6 +380,17 @@ int XrdOfs::Configure(XrdSysError &Eroute, XrdOucEnv *EnvInfo) {
 //
    OssHasPGrw = (ossFeatures & XRDOSS_HASPGRW) != 0;
 
+// Configure checksums computed while files are written. This is only possible
+// when the data is local and we actually have a checksum manager.
+//
+   if (CksWrt && !NoGo)
+      {if (OssIsProxy || !Cks)
+          Eroute.Say("Config warning: ckswrite ignored; checksums are ",
+                     (Cks ? "not local." : "not configured."));
+          else if (!XrdOfsCksWrt::Config(Cks, CksWrt, CksWrtRC, CksPfn, Eroute))
+                  NoGo = 1;
+      }
+
 // If POSC processing is enabled (as by default) do it. Warning! This must be
 // the last item in the configuration list as we need a working filesystem.
 // Note that in proxy mode we always disable posc!
@@ -804,6 +816,8 @@ int XrdOfs::ConfigXeq(char *var, XrdOucStream &Config,
     //
     TS_Bit("authorize",     Options, Authorize);
     TS_XPI("authlib",       theAutLib);
+    TS_Xeq("ckscalc",       xcksc);
+    TS_Xeq("ckswrite",      xcksw);
     TS_XPI("ckslib",        theCksLib);
     TS_Xeq("cksrdsz",       xcrds);
     TS_XPI("cmslib",        theCmsLib);
@@ -844,6 +858,85 @@ int XrdOfs::ConfigXeq(char *var, XrdOucStream &Config,
     return 0;
 }
 
+/******************************************************************************/
+/*                                 x c k s c                                  */
+/******************************************************************************/
+  
+/* Function: xcksc
+
+   Purpose:  To parse the directive: ckscalc [onepass {all | <digest>[,...]}]
+                                             [parallel <n>]
+
+             onepass   the digests to calculate in a single pass over the file
+                       whenever one of them needs to be calculated.
+             parallel  the maximum number of threads used to checksum a large
+                       file when the digest allows it.
+
+             The options are validated by the checksum manager.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOfs::xcksc(XrdOucStream &Config, XrdSysError &Eroute)
+{
+   char buff[1024];
+
+// Get the options
+//
+   if (!Config.GetRest(buff, sizeof(buff)))
+      {Eroute.Emsg("Config", "ckscalc options too long"); return 1;}
+   if (!*buff)
+      {Eroute.Emsg("Config", "ckscalc options not specified"); return 1;}
+
+// Record them
+//
+   ofsConfig->SetCksCalc(buff);
+   return 0;
+}
+
+/******************************************************************************/
+/*                                 x c k s w                                  */
+/******************************************************************************/
+  
+/* Function: xcksw
+
+   Purpose:  To parse the directive: ckswrite {all | <digest>[,<digest>]}
+                                              [norecalc]
+
+             <digest>  the checksum to compute as a new file is sequentially
+                       written. The value is recorded when the file is closed.
+                       Specify all to compute every supported checksum.
+             norecalc  do not recalculate the checksums when the file was not
+                       written sequentially. They will be calculated when
+                       first requested. By default, they are recalculated in
+                       the background after the file is closed.
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOfs::xcksw(XrdOucStream &Config, XrdSysError &Eroute)
+{
+   char *val;
+
+// Get the checksum list
+//
+   if (!(val = Config.GetWord()) || !val[0])
+      {Eroute.Emsg("Config", "ckswrite checksum not specified"); return 1;}
+   if (CksWrt) free(CksWrt);
+   CksWrt = strdup(val);
+   CksWrtRC = true;
+
+// Get the options
+//
+   while((val = Config.GetWord()))
+        {if (!strcmp(val, "norecalc")) CksWrtRC = false;
+            else {Eroute.Emsg("Config", "invalid ckswrite option -", val);
+                  return 1;
+                 }
+        }
+   return 0;
+}
+
 /******************************************************************************/
 /*                                 x c r d s                                  */
 /******************************************************************************/
@@ -93,7 +93,7 @@ XrdOfsConfigPI::XrdOfsConfigPI(const char  *cfn,  XrdOucStream     *cfgP,
                  : autPI(0), cksPI(0), cmsPI(0), ctlPI(0), prpPI(0), ossPI(0),
                    sfsPI(sfsP), urVer(verP),
                    Config(cfgP),  Eroute(errP), CksConfig(0), ConfigFN(cfn),
-                   CksAlg(0), CksRdsz(0), ossXAttr(false), ossCksio(0),
+                   CksAlg(0), CksCalc(0), CksRdsz(0), ossXAttr(false), ossCksio(0),
                    prpAuth(true), Loaded(false), LoadOK(false), cksLcl(false)
 {
    int rc;
@@ -130,6 +130,7 @@ XrdOfsConfigPI::~XrdOfsConfigPI()
 {
    if (CksConfig) delete CksConfig;
    if (CksAlg)    free(CksAlg);
+   if (CksCalc)   free(CksCalc);
 }
   
 /******************************************************************************/
@@ -437,7 +438,7 @@ bool XrdOfsConfigPI::Load(int loadLib, XrdOucEnv *envP)
            return false;
           }
        cksPI = CksConfig->Configure(CksAlg, CksRdsz,
-                                    (ossCksio > 0 ? ossPI : 0), envP);
+                                    (ossCksio > 0 ? ossPI : 0), envP, CksCalc);
        if (!cksPI) return false;
       }
 
@@ -778,6 +779,16 @@ bool XrdOfsConfigPI::RepLib(XrdOfsConfigPI::TheLib what,
    return true;
 }
 
+/******************************************************************************/
+/*                            S e t C k s C a l c                             */
+/******************************************************************************/
+
+void   XrdOfsConfigPI::SetCksCalc(const char *opts)
+{
+   if (CksCalc) free(CksCalc);
+   CksCalc = (opts && *opts ? strdup(opts) : 0);
+}
+
 /******************************************************************************/
 /*                            S e t C k s R d S z                             */
 /******************************************************************************/
@@ -220,6 +220,14 @@ bool   PrepAuth();
 
 bool   Push(TheLib what, const char *plugP, const char *parmP=0);
 
+//-----------------------------------------------------------------------------
+//! Set the checksum calculation options
+//!
+//! @param   opts    The options of the ckscalc directive.
+//-----------------------------------------------------------------------------
+
+void   SetCksCalc(const char *opts);
+
 //-----------------------------------------------------------------------------
 //! Set the checksum read size
 //!
@@ -309,6 +317,7 @@ struct ctlLP {XrdOfsFSctl_PI *ctlPI; const char *parms;};
 std::vector<ctlLP> ctlVec;
 
 char         *CksAlg;
+char         *CksCalc;
 int           CksRdsz;
 bool          pushOK[maxXXXLib];
 bool          defLib[maxXXXLib];
@@ -258,7 +258,7 @@ int XrdOssCsiFile::createPageUpdater(const int Oflag, XrdOucEnv &Env)
 
    std::unique_ptr<XrdOssDF> integFile(parentOss_->newFile(tident));
    std::unique_ptr<XrdOssCsiTagstore> ts(new
-      XrdOssCsiTagstoreFile(pmi_->dpath, std::move(integFile), tident));
+      XrdOssCsiTagstoreFile(pmi_->dpath, std::move(integFile), tident, config_.tagCachePages()));
    std::unique_ptr<XrdOssCsiPages> pages(new
       XrdOssCsiPages(pmi_->dpath, std::move(ts), config_.fillFileHole(), config_.allowMissingTags(),
                      config_.disablePgExtend(), config_.disableLooseWrite(), tident));
@@ -278,6 +278,12 @@ int XrdOssCsiFile::createPageUpdater(const int Oflag, XrdOucEnv &Env)
       return puret;
    }
 
+   puret = pages->Recover(successor_);
+   if (puret<0)
+   {
+      return puret;
+   }
+
    pages->BasicConsistencyCheck(successor_);
    pmi_->pages = std::move(pages);
    return XrdOssOK;
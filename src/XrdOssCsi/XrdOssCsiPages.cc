@@ -85,6 +85,27 @@ int XrdOssCsiPages::Open(const char *path, off_t dsize, int flags, XrdOucEnv &en
    return 0;
 }
 
+//
+// Have the tags recalculated if they were left incomplete, e.g. after a crash
+// while modified tags were held in the tag cache. If that is not possible
+// treat the file as one without tags, if that is allowed.
+//
+int XrdOssCsiPages::Recover(XrdOssDF *fd)
+{
+   EPNAME("Pages::Recover");
+   if (hasMissingTags_) return 0;
+
+   const int ret = ts_->Recover(fd);
+   if (ret<0)
+   {
+      TRACE(Warn, "Could not recalculate crc32c values for " << fn_ << " error " << ret);
+      if (!allowMissingTags_) return -EDOM;
+      (void)ts_->Close();
+      hasMissingTags_ = true;
+   }
+   return 0;
+}
+
 int XrdOssCsiPages::Close()
 {
    if (hasMissingTags_)
@@ -60,6 +60,7 @@ public:
    int Fsync();
 
    void BasicConsistencyCheck(XrdOssDF *);
+   int Recover(XrdOssDF *);
 
    int FetchRange(XrdOssDF *, const void *, off_t, size_t, uint32_t *, uint64_t, XrdOssCsiRangeGuard&);
    int StoreRange(XrdOssDF *, const void *, off_t, size_t, uint32_t *, uint64_t, XrdOssCsiRangeGuard&);
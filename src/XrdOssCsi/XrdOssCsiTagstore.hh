@@ -57,10 +57,18 @@ public:
    virtual int ResetSizes(off_t)=0;
    virtual int Truncate(off_t,bool)=0;
 
+   // recalculate the tags from the data file if they are not known to be
+   // complete, as when the tagfile was not closed after being modified
+   virtual int Recover(XrdOssDF *)=0;
+
    // if this flag is set in the header, it indicates the tags
    // are for verified checksums.
    // if it is unset it means the tags are unverified
    static const uint32_t csVer = 0x00000001;
+
+   // if this flag is set in the header, it indicates some tags
+   // may not have been written and must be recalculated
+   static const uint32_t csDirty = 0x00000002;
 };
 
 #endif
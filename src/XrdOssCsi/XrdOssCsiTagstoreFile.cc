@@ -36,6 +36,10 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
 extern XrdOucTrace  OssCsiTrace;
 
 int XrdOssCsiTagstoreFile::Open(const char *path, const off_t dsize, const int Oflag, XrdOucEnv &Env)
@@ -108,6 +112,9 @@ int XrdOssCsiTagstoreFile::Open(const char *path, const off_t dsize, const int O
       {
          hflags_ = bswap_32(hflags_);
       }
+      // some tags were outstanding when the file was last used; they
+      // have to be recalculated before any can be trusted (see Recover)
+      stale_ = (hflags_ & XrdOssCsiTagstore::csDirty) ? true : false;
       const uint32_t cv = XrdOucCRC::Calc32C(header_, 16, 0U);
       uint32_t rv;
       memcpy(&rv, &header_[16], 4);
@@ -133,7 +140,14 @@ int XrdOssCsiTagstoreFile::Open(const char *path, const off_t dsize, const int O
 int XrdOssCsiTagstoreFile::ResetSizes(const off_t size)
 {
    EPNAME("ResetSizes");
+   std::lock_guard<std::mutex> guard(cmtx_);
    if (!isOpen) return -EBADF;
+   if (cachemax_ > 0)
+   {
+      const int fret = FlushCache();
+      if (fret<0) return fret;
+      DropCache();
+   }
    actualsize_ = size;
    struct stat sb;
    const int ssret = fd_->Fstat(&sb);
@@ -163,26 +177,65 @@ int XrdOssCsiTagstoreFile::ResetSizes(const off_t size)
 
 int XrdOssCsiTagstoreFile::Fsync()
 {
+   std::lock_guard<std::mutex> guard(cmtx_);
    if (!isOpen) return -EBADF;
+   const int fret = FlushCache();
+   if (fret<0) return fret;
    return fd_->Fsync();
 }
 
 void XrdOssCsiTagstoreFile::Flush()
 {
+   std::lock_guard<std::mutex> guard(cmtx_);
    if (!isOpen) return;
+   (void)FlushCache();
    fd_->Flush();
 }
 
 int XrdOssCsiTagstoreFile::Close()
 {
+   EPNAME("TagstoreFile::Close");
+   std::lock_guard<std::mutex> guard(cmtx_);
    if (!isOpen) return -EBADF;
+   const int fret = FlushCache();
+   if (cachemax_ > 0 && (chits_ || cmisses_))
+   {
+      TRACE(Info, "Tag cache for " << fn_ << " hits " << chits_ << " misses " << cmisses_ <<
+         " hit rate " << (100*chits_/(chits_+cmisses_)) << "% flushes " << cflushes_ <<
+         " tags written " << cflushtags_ << " mean flush " <<
+         (cflushes_ ? cflushus_/cflushes_ : 0) << "us");
+   }
+   DropCache();
    isOpen = false;
-   return fd_->Close();
+   const int cret = fd_->Close();
+   if (fret<0) return fret;
+   return cret;
 }
 
 ssize_t XrdOssCsiTagstoreFile::WriteTags(const uint32_t *const buf, const off_t off, const size_t n)
 {
    if (!isOpen) return -EBADF;
+   if (cachemax_ > 0)
+   {
+      std::lock_guard<std::mutex> guard(cmtx_);
+      return WriteTags_cached(buf, off, n);
+   }
+   return WriteTags_direct(buf, off, n);
+}
+
+ssize_t XrdOssCsiTagstoreFile::ReadTags(uint32_t *const buf, const off_t off, const size_t n)
+{
+   if (!isOpen) return -EBADF;
+   if (cachemax_ > 0)
+   {
+      std::lock_guard<std::mutex> guard(cmtx_);
+      return ReadTags_cached(buf, off, n);
+   }
+   return ReadTags_direct(buf, off, n);
+}
+
+ssize_t XrdOssCsiTagstoreFile::WriteTags_direct(const uint32_t *const buf, const off_t off, const size_t n)
+{
    if (machineIsBige_ != fileIsBige_) return WriteTags_swap(buf, off, n);
 
    const ssize_t nwritten = XrdOssCsiTagstoreFile::fullwrite(*fd_, buf, 20LL+4*off, 4*n);
@@ -190,9 +243,8 @@ ssize_t XrdOssCsiTagstoreFile::WriteTags(const uint32_t *const buf, const off_t
    return nwritten/4;
 }
 
-ssize_t XrdOssCsiTagstoreFile::ReadTags(uint32_t *const buf, const off_t off, const size_t n)
+ssize_t XrdOssCsiTagstoreFile::ReadTags_direct(uint32_t *const buf, const off_t off, const size_t n)
 {
-   if (!isOpen) return -EBADF;
    if (machineIsBige_ != fileIsBige_) return ReadTags_swap(buf, off, n);
 
    const ssize_t nread = XrdOssCsiTagstoreFile::fullread(*fd_, buf, 20LL+4*off, 4*n);
@@ -200,13 +252,310 @@ ssize_t XrdOssCsiTagstoreFile::ReadTags(uint32_t *const buf, const off_t off, co
    return nread/4;
 }
 
+//
+// Return the cached page of tags with number pg, reading it from the tagfile
+// if needed and requested. The least recently used page is evicted, writing it
+// out if modified, once the cache is full. Called with cmtx_ held.
+//
+XrdOssCsiTagstoreFile::CachePage *XrdOssCsiTagstoreFile::GetPage(const off_t pg, const bool load, int &ret)
+{
+   auto it = cache_.find(pg);
+   if (it != cache_.end())
+   {
+      CachePage *cp = it->second.get();
+      chits_++;
+      lru_.splice(lru_.begin(), lru_, cp->lru);
+      return cp;
+   }
+   cmisses_++;
+
+   if (cache_.size() >= cachemax_)
+   {
+      CachePage *victim = lru_.back();
+      if (victim->dhi > victim->dlo)
+      {
+         ret = WritePages(&victim, 1);
+         if (ret<0) return NULL;
+      }
+      lru_.pop_back();
+      cache_.erase(victim->pgnum);
+   }
+
+   std::unique_ptr<CachePage> np(new CachePage);
+   np->pgnum = pg;
+   np->nvalid = 0;
+   np->dlo = np->dhi = 0;
+   if (load)
+   {
+      // the tagfile may end within the page, only what is there is valid
+      uint8_t *p = (uint8_t*)np->tags;
+      const off_t off = 20LL+4*pg*cpTags;
+      size_t nread = 0;
+      while(nread < sizeof(np->tags))
+      {
+         const ssize_t rret = fd_->Read(&p[nread], off+nread, sizeof(np->tags)-nread);
+         if (rret<0) { ret = rret; return NULL; }
+         if (rret==0) break;
+         nread += rret;
+      }
+      np->nvalid = nread/4;
+      if (machineIsBige_ != fileIsBige_)
+      {
+         for(size_t i=0;i<np->nvalid;i++) np->tags[i] = bswap_32(np->tags[i]);
+      }
+   }
+
+   CachePage *cp = np.get();
+   cp->lru = lru_.insert(lru_.begin(), cp);
+   cache_.insert(std::make_pair(pg, std::move(np)));
+   return cp;
+}
+
+//
+// Write out the modified tags of n consecutive cached pages with a single
+// write. Called with cmtx_ held.
+//
+int XrdOssCsiTagstoreFile::WritePages(CachePage **pages, const size_t n)
+{
+   const off_t start = pages[0]->pgnum*cpTags + pages[0]->dlo;
+   ssize_t wret;
+   size_t ntags;
+
+   if (n == 1)
+   {
+      ntags = pages[0]->dhi - pages[0]->dlo;
+      wret = WriteTags_direct(&pages[0]->tags[pages[0]->dlo], start, ntags);
+   }
+   else
+   {
+      std::vector<uint32_t> buf;
+      buf.reserve(n*cpTags);
+      for(size_t i=0;i<n;i++)
+      {
+         buf.insert(buf.end(), &pages[i]->tags[pages[i]->dlo], &pages[i]->tags[pages[i]->dhi]);
+      }
+      ntags = buf.size();
+      wret = WriteTags_direct(buf.data(), start, ntags);
+   }
+   if (wret<0) return wret;
+
+   for(size_t i=0;i<n;i++) pages[i]->dlo = pages[i]->dhi = 0;
+   cflushtags_ += ntags;
+   return 0;
+}
+
+//
+// Write out all modified tags, coalescing adjacent pages, and sync them before
+// the header which then no longer needs the csDirty flag. Called with cmtx_
+// held.
+//
+int XrdOssCsiTagstoreFile::FlushCache()
+{
+   EPNAME("TagstoreFile::FlushCache");
+   const auto t0 = std::chrono::steady_clock::now();
+
+   std::vector<CachePage*> dirty;
+   for(auto &e : cache_)
+   {
+      if (e.second->dhi > e.second->dlo) dirty.push_back(e.second.get());
+   }
+   std::sort(dirty.begin(), dirty.end(),
+             [](const CachePage *a, const CachePage *b) { return a->pgnum < b->pgnum; });
+
+   const uint64_t ntags = cflushtags_;
+   size_t i = 0;
+   while(i<dirty.size())
+   {
+      size_t j = i+1;
+      while(j<dirty.size() && dirty[j]->pgnum == dirty[j-1]->pgnum+1 &&
+            dirty[j-1]->dhi == cpTags && dirty[j]->dlo == 0)
+      {
+         j++;
+      }
+      const int wret = WritePages(&dirty[i], j-i);
+      if (wret<0) return wret;
+      i = j;
+   }
+
+   // tags recovered from a previous use are only complete after Recover()
+   if (!stale_ && ((hflags_ & XrdOssCsiTagstore::csDirty) || hdrpending_))
+   {
+      // the tags must be on disk before the header that no longer says they
+      // are outstanding, or after a crash nothing would trigger Recover()
+      if ((hflags_ & XrdOssCsiTagstore::csDirty))
+      {
+         const int sret = fd_->Fsync();
+         if (sret<0) return sret;
+      }
+      hflags_ &= ~XrdOssCsiTagstore::csDirty;
+      hdrpending_ = false;
+      const int mret = MarshallAndWriteHeader();
+      if (mret<0) return mret;
+   }
+
+   if (!dirty.empty())
+   {
+      const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - t0).count();
+      cflushes_++;
+      cflushus_ += us;
+      TRACE(Debug, "Flushed " << (cflushtags_-ntags) << " tags from " << dirty.size() <<
+         " pages in " << us << "us for " << fn_);
+   }
+   return 0;
+}
+
+//
+// Forget all cached pages; any modified ones must have been written out.
+// Called with cmtx_ held.
+//
+void XrdOssCsiTagstoreFile::DropCache()
+{
+   lru_.clear();
+   cache_.clear();
+}
+
+ssize_t XrdOssCsiTagstoreFile::WriteTags_cached(const uint32_t *const buf, const off_t off, const size_t n)
+{
+   // the header must say that tags are outstanding before the data they
+   // describe is written, which follows this call. It is synced once, here,
+   // since the flag stays set until FlushCache() has synced the tags.
+   if (!(hflags_ & XrdOssCsiTagstore::csDirty))
+   {
+      hflags_ |= XrdOssCsiTagstore::csDirty;
+      const int mret = MarshallAndWriteHeader();
+      if (mret<0)
+      {
+         hflags_ &= ~XrdOssCsiTagstore::csDirty;
+         return mret;
+      }
+      // the header on disk may already say dirty, which is harmless
+      const int sret = fd_->Fsync();
+      if (sret<0) return sret;
+   }
+
+   size_t done = 0;
+   while(done<n)
+   {
+      const off_t t = off+done;
+      const off_t pg = t / cpTags;
+      const size_t idx = t % cpTags;
+      const size_t cnt = std::min(n-done, cpTags-idx);
+      int ret = 0;
+
+      // a page that is completely overwritten need not be read first
+      CachePage *cp = GetPage(pg, !(idx==0 && cnt==cpTags), ret);
+      if (!cp) return ret;
+
+      // tags skipped over will read as zero once the tagfile is extended
+      if (idx > cp->nvalid) memset(&cp->tags[cp->nvalid], 0, 4*(idx-cp->nvalid));
+      memcpy(&cp->tags[idx], &buf[done], 4*cnt);
+      if (cp->dhi > cp->dlo)
+      {
+         cp->dlo = std::min(cp->dlo, idx);
+         cp->dhi = std::max(cp->dhi, idx+cnt);
+      }
+      else
+      {
+         cp->dlo = idx;
+         cp->dhi = idx+cnt;
+      }
+      cp->nvalid = std::max(cp->nvalid, idx+cnt);
+      done += cnt;
+   }
+   return n;
+}
+
+ssize_t XrdOssCsiTagstoreFile::ReadTags_cached(uint32_t *const buf, const off_t off, const size_t n)
+{
+   size_t done = 0;
+   while(done<n)
+   {
+      const off_t t = off+done;
+      const off_t pg = t / cpTags;
+      const size_t idx = t % cpTags;
+      const size_t cnt = std::min(n-done, cpTags-idx);
+      int ret = 0;
+
+      CachePage *cp = GetPage(pg, true, ret);
+      if (!cp) return ret;
+
+      // same as a short read of the tagfile
+      if (idx+cnt > cp->nvalid) return -EDOM;
+      memcpy(&buf[done], &cp->tags[idx], 4*cnt);
+      done += cnt;
+   }
+   return n;
+}
+
+//
+// If the tagfile was not closed after tags were last modified, some may not
+// have been written. Recalculate all of them from the data. Until that is
+// complete the header keeps the csDirty flag, so an interruption results in
+// the same being done again. The recalculated tags are unverified.
+//
+int XrdOssCsiTagstoreFile::Recover(XrdOssDF *datafd)
+{
+   EPNAME("TagstoreFile::Recover");
+   std::lock_guard<std::mutex> guard(cmtx_);
+   if (!isOpen) return -EBADF;
+   if (!stale_) return 0;
+
+   struct stat sb;
+   const int sret = datafd->Fstat(&sb);
+   if (sret<0) return sret;
+
+   TRACE(Warn, "Tagfile was not closed after being modified, recalculating crc32c values for " <<
+      sb.st_size << " bytes of " << fn_);
+
+   DropCache();
+   std::vector<uint8_t> dbuf(cpTags*XrdSys::PageSize);
+   std::vector<uint32_t> tbuf(cpTags);
+   off_t off = 0;
+   while(off < sb.st_size)
+   {
+      const size_t toread = std::min(static_cast<off_t>(dbuf.size()), sb.st_size-off);
+      const ssize_t rret = fullread(*datafd, dbuf.data(), off, toread);
+      if (rret<0) return rret;
+      const size_t np = (toread+XrdSys::PageSize-1)/XrdSys::PageSize;
+      XrdOucCRC::Calc32C(dbuf.data(), toread, tbuf.data());
+      const ssize_t wret = WriteTags_direct(tbuf.data(), off/XrdSys::PageSize, np);
+      if (wret<0) return wret;
+      off += toread;
+   }
+
+   const int tret = fd_->Ftruncate(20LL + 4*((sb.st_size+XrdSys::PageSize-1)/XrdSys::PageSize));
+   if (tret<0) return tret;
+   const int fret = fd_->Fsync();
+   if (fret<0) return fret;
+
+   trackinglen_ = sb.st_size;
+   actualsize_ = sb.st_size;
+   hflags_ &= ~(XrdOssCsiTagstore::csVer | XrdOssCsiTagstore::csDirty);
+   hdrpending_ = false;
+   const int mret = MarshallAndWriteHeader();
+   if (mret<0) return mret;
+   stale_ = false;
+   return 0;
+}
+
 int XrdOssCsiTagstoreFile::Truncate(const off_t size, bool datatoo)
 {
+   std::lock_guard<std::mutex> guard(cmtx_);
    if (!isOpen)
    {
       return -EBADF;
    }
 
+   // write out any outstanding tags and empty the cache, so nothing past
+   // the new end is written back later
+   if (cachemax_ > 0)
+   {
+      const int fret = FlushCache();
+      if (fret<0) return fret;
+      DropCache();
+   }
+
    // set tag file to correct length for value of size
    const off_t expected_tagfile_size = 20LL + 4*((size+XrdSys::PageSize-1)/XrdSys::PageSize);
    const int tret = fd_->Ftruncate(expected_tagfile_size);
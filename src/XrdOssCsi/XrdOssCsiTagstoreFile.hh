@@ -36,13 +36,15 @@
 #include "XrdOuc/XrdOucCRC.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 
+#include <list>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 class XrdOssCsiTagstoreFile : public XrdOssCsiTagstore
 {
 public:
-   XrdOssCsiTagstoreFile(const std::string &fn, std::unique_ptr<XrdOssDF> fd, const char *tid) : fn_(fn), fd_(std::move(fd)), trackinglen_(0), isOpen(false), tident_(tid), tident(tident_.c_str()) { }
+   XrdOssCsiTagstoreFile(const std::string &fn, std::unique_ptr<XrdOssDF> fd, const char *tid, size_t cachepages=0) : fn_(fn), fd_(std::move(fd)), trackinglen_(0), isOpen(false), tident_(tid), tident(tident_.c_str()), cachemax_(cachepages), hdrpending_(false), stale_(false), chits_(0), cmisses_(0), cflushes_(0), cflushtags_(0), cflushus_(0) { }
    virtual ~XrdOssCsiTagstoreFile() { if (isOpen) { (void)Close(); } }
 
    virtual int Open(const char *, off_t, int, XrdOucEnv &) /* override */;
@@ -56,6 +58,8 @@ public:
 
    virtual int Truncate(off_t, bool) /* override */;
 
+   virtual int Recover(XrdOssDF *) /* override */;
+
    virtual off_t GetTrackedTagSize() const /* override */
    {
       if (!isOpen) return 0;
@@ -72,6 +76,7 @@ public:
 
    virtual int SetTrackedSize(const off_t size) /* override */
    {
+      std::lock_guard<std::mutex> guard(cmtx_);
       if (!isOpen) return -EBADF;
       if (size > actualsize_)
       {
@@ -94,6 +99,7 @@ public:
 
    virtual int SetUnverified()
    {
+      std::lock_guard<std::mutex> guard(cmtx_);
       if (!isOpen) return -EBADF;
      if ((hflags_ & XrdOssCsiTagstore::csVer))
      {
@@ -146,13 +152,57 @@ private:
    uint8_t header_[20];
    uint32_t hflags_;
 
+   // The tags are cached in pages of cpTags values, which is one page of the
+   // tagfile and covers cpTags pages of data. Modified tags are written back
+   // when the page is evicted or on Flush(), Fsync() and Close(). While any
+   // are outstanding the csDirty flag is set in the header so that the tags
+   // are recalculated from the data should we not get to write them.
+   static const size_t cpTags = XrdSys::PageSize/4;
+
+   struct CachePage
+   {
+      off_t pgnum;
+      size_t nvalid;      // number of tags in the tagfile or written since
+      size_t dlo, dhi;    // range of tags not yet written to the tagfile
+      std::list<CachePage*>::iterator lru;
+      uint32_t tags[cpTags];
+   };
+
+   std::mutex cmtx_;
+   std::unordered_map<off_t, std::unique_ptr<CachePage>> cache_;
+   std::list<CachePage*> lru_;
+   const size_t cachemax_;
+   bool hdrpending_;
+   bool stale_;
+
+   uint64_t chits_;
+   uint64_t cmisses_;
+   uint64_t cflushes_;
+   uint64_t cflushtags_;
+   uint64_t cflushus_;
+
+   ssize_t WriteTags_direct(const uint32_t *, off_t, size_t);
+   ssize_t ReadTags_direct(uint32_t *, off_t, size_t);
    ssize_t WriteTags_swap(const uint32_t *, off_t, size_t);
    ssize_t ReadTags_swap(uint32_t *, off_t, size_t);
 
+   ssize_t WriteTags_cached(const uint32_t *, off_t, size_t);
+   ssize_t ReadTags_cached(uint32_t *, off_t, size_t);
+   CachePage *GetPage(off_t, bool, int &);
+   int WritePages(CachePage **, size_t);
+   int FlushCache();
+   void DropCache();
+
    int WriteTrackedTagSize(const off_t size)
    {
       if (!isOpen) return -EBADF;
       trackinglen_ = size;
+      // the header will be written once the outstanding tags are
+      if ((hflags_ & XrdOssCsiTagstore::csDirty))
+      {
+         hdrpending_ = true;
+         return 0;
+      }
       return MarshallAndWriteHeader();
    }
 
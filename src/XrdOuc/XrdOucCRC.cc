@@ -48,6 +48,39 @@
 #include "XrdOuc/XrdOucCRC.hh"
 #include "XrdOuc/XrdOucCRC32C.hh"
 
+/******************************************************************************/
+/*                         L o c a l   S t a t i c s                          */
+/******************************************************************************/
+
+namespace
+{
+// Number of page checksums handed to the batch kernel at a time. This bounds
+// the stack space used while still keeping all of the crc streams busy.
+//
+static const int pgBatch = 64;
+
+// Compute the checksum of each page, the last one may be short, in batches.
+//
+void pgCalc(const uint8_t* dataP, size_t count, uint32_t* csval)
+{
+   const void* pgAddr[pgBatch];
+   size_t      pgSize[pgBatch];
+   int n;
+
+   while(count)
+        {for (n = 0; n < pgBatch && count; n++)
+             {pgAddr[n] = dataP;
+              pgSize[n] = (count < (size_t)XrdSys::PageSize
+                        ?  count : (size_t)XrdSys::PageSize);
+              dataP += pgSize[n];
+              count -= pgSize[n];
+             }
+         crc32c_batch(pgAddr, pgSize, csval, n);
+         csval += n;
+        }
+}
+}
+
 /*****************************************************************/
 /*                                                               */
 /* CRC LOOKUP TABLE                                              */
@@ -199,20 +232,21 @@ uint32_t XrdOucCRC::Calc32C(const void* data, size_t count, uint32_t prevcs)
   
 void XrdOucCRC::Calc32C(const void* data, size_t count, uint32_t* csval)
 {
-   int i, numpages = count/XrdSys::PageSize;
-   const uint8_t* dataP = (const uint8_t*)data;
 
-// Calculate the CRC32C for each page
+// Calculate the CRC32C for each page, several pages at a time
 //
-   for (i = 0; i < numpages; i++)
-       {csval[i] = crc32c(0, dataP, XrdSys::PageSize);
-        count -= XrdSys::PageSize;
-        dataP += XrdSys::PageSize;
-       }
+   pgCalc((const uint8_t*)data, count, csval);
+}
 
-// if there is anything left, calculate that as well
+/******************************************************************************/
+
+void XrdOucCRC::Calc32C(const void* const* data, const size_t* count, int num,
+                        uint32_t* csval)
+{
+
+// Calculate the CRC32C of each segment, several segments at a time
 //
-   if (count > 0) csval[i] = crc32c(0, dataP, count);
+   if (num > 0) crc32c_batch(data, count, csval, num);
 }
 
 /******************************************************************************/
@@ -236,33 +270,27 @@ bool XrdOucCRC::Ver32C(const void*    data,  size_t    count,
 int  XrdOucCRC::Ver32C(const void*     data,  size_t    count,
                        const uint32_t* csval, uint32_t& valcs)
 {
-   int i, numpages = count/XrdSys::PageSize;
    const uint8_t* dataP = (const uint8_t*)data;
-   uint32_t actualCS;
+   const size_t bSize = (size_t)pgBatch * XrdSys::PageSize;
+   uint32_t actualCS[pgBatch];
+   size_t chkLen;
+   int i, n, k = 0;
 
-// Calculate the CRC32C for each page and make sure it is the same.
+// Calculate the CRC32C for a batch of pages at a time and make sure each one
+// is the same. Stop at the batch holding the first mismatch.
 //
-   for (i = 0; i < numpages; i++)
-       {
-        actualCS = crc32c(0, dataP, XrdSys::PageSize);
-        if (csval[i] != actualCS)
-           {valcs = actualCS;
-            return i;
-           }
-        count -= XrdSys::PageSize;
-        dataP += XrdSys::PageSize;
-       }
-
-// if there is anything left, verify that as well
-//
-   if (count > 0)
-      {
-       actualCS = crc32c(0, dataP, count);
-       if (csval[i] != actualCS)
-          {valcs = actualCS;
-           return i;
-          }
-      }
+   while(count)
+        {chkLen = (count < bSize ? count : bSize);
+         pgCalc(dataP, chkLen, actualCS);
+         n = chkLen/XrdSys::PageSize + (chkLen%XrdSys::PageSize != 0);
+         for (i = 0; i < n; i++)
+             {if (csval[k+i] != actualCS[i])
+                 {valcs = actualCS[i];
+                  return k+i;
+                 }
+             }
+         k += n; dataP += chkLen; count -= chkLen;
+        }
 
 // Everything matched.
 //
@@ -274,30 +302,26 @@ int  XrdOucCRC::Ver32C(const void*     data,  size_t    count,
 bool XrdOucCRC::Ver32C(const void*     data,  size_t count,
                        const uint32_t* csval, bool*  valok)
 {
-   int i, numpages = count/XrdSys::PageSize;
    const uint8_t* dataP = (const uint8_t*)data;
-   uint32_t actualCS;
+   const size_t bSize = (size_t)pgBatch * XrdSys::PageSize;
+   uint32_t actualCS[pgBatch];
+   size_t chkLen;
+   int i, n;
    bool retval = true;
 
-// Calculate the CRC32C for each page and make sure it is the same.
+// Calculate the CRC32C for a batch of pages at a time and record whether
+// each one is the same.
 //
-   for (i = 0; i < numpages; i++)
-       {
-        actualCS = crc32c(0, dataP, XrdSys::PageSize);
-        if (csval[i] == actualCS) valok[i] = true;
-           else valok[i] = retval = false;
-        count -= XrdSys::PageSize;
-        dataP += XrdSys::PageSize;
-       }
-
-// if there is anything left, verify that as well
-//
-   if (count > 0)
-      {
-       actualCS = crc32c(0, dataP, count);
-       if (csval[i] == actualCS) valok[i] = true;
-           else valok[i] = retval = false;
-      }
+   while(count)
+        {chkLen = (count < bSize ? count : bSize);
+         pgCalc(dataP, chkLen, actualCS);
+         n = chkLen/XrdSys::PageSize + (chkLen%XrdSys::PageSize != 0);
+         for (i = 0; i < n; i++)
+             {if (csval[i] == actualCS[i]) valok[i] = true;
+                 else valok[i] = retval = false;
+             }
+         csval += n; valok += n; dataP += chkLen; count -= chkLen;
+        }
 
 // All done.
 //
@@ -309,27 +333,13 @@ bool XrdOucCRC::Ver32C(const void*     data,  size_t count,
 bool XrdOucCRC::Ver32C(const void*     data,  size_t    count,
                        const uint32_t* csval, uint32_t* valcs)
 {
-   int i, numpages = count/XrdSys::PageSize;
-   const uint8_t* dataP = (const uint8_t*)data;
+   int i, numpages = count/XrdSys::PageSize + (count%XrdSys::PageSize != 0);
    bool retval = true;
 
 // Calculate the CRC32C for each page and make sure it is the same.
 //
-   for (i = 0; i < numpages; i++)
-       {
-        valcs[i] = crc32c(0, dataP, XrdSys::PageSize);
-        if (csval[i] != valcs[i]) retval = false;
-        count -= XrdSys::PageSize;
-        dataP += XrdSys::PageSize;
-       }
-
-// if there is anything left, verify that as well
-//
-   if (count > 0)
-      {
-       valcs[i] = crc32c(0, dataP, count);
-       if (csval[i] != valcs[i]) retval = false;
-      }
+   pgCalc((const uint8_t*)data, count, valcs);
+   for (i = 0; i < numpages; i++) if (csval[i] != valcs[i]) retval = false;
 
 // All done.
 //
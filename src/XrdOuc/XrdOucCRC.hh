@@ -80,6 +80,21 @@ static uint32_t Calc32C(const void* data, size_t count, uint32_t prevcs=0);
 
 static void Calc32C(const void* data, size_t count, uint32_t* csval);
 
+//------------------------------------------------------------------------------
+//! Compute the CRC32C checksums of many independent segments using hardware
+//! assist if available. Several segments are processed at the same time so
+//! this is much faster than computing each checksum in turn.
+//!
+//! @param  data   Pointer to a vector of num pointers to each segment.
+//! @param  count  Pointer to a vector of num lengths of each segment.
+//! @param  num    The number of segments.
+//! @param  csval  Pointer to a vector of num elements to hold the checksum of
+//!                the associated segment.
+//------------------------------------------------------------------------------
+
+static void Calc32C(const void* const* data, const size_t* count, int num,
+                    uint32_t* csval);
+
 //------------------------------------------------------------------------------
 //! Verify a CRC32C checksum using hardware assist if available.
 //!
@@ -13,6 +13,13 @@
 // crc == 0.  crc32c() uses the Intel crc32 hardware instruction if available.
 uint32_t crc32c(uint32_t crc, void const *buf, size_t len);
 
+// crc32c_batch() computes the CRC-32C of each of num independent buffers,
+// buf[i][0..len[i]-1], starting with a crc of zero and places it in crc[i].
+// When the crc32 instruction is available several buffers are processed at
+// the same time which is considerably faster than calling crc32c() for each.
+void crc32c_batch(void const * const *buf, size_t const *len, uint32_t *crc,
+                  size_t num);
+
 // crc32c_sw() is the same, but does not use the hardware instruction, even if
 // available.
 uint32_t crc32c_sw(uint32_t crc, void const *buf, size_t len);
@@ -125,6 +125,7 @@ add_library(
   XrdThrottle/XrdThrottleFileSystemConfig.cc
   XrdThrottle/XrdThrottleFile.cc
   XrdThrottle/XrdThrottleManager.cc    XrdThrottle/XrdThrottleManager.hh
+  XrdThrottle/XrdThrottleDevice.cc     XrdThrottle/XrdThrottleDevice.hh
 )
 
 target_link_libraries(
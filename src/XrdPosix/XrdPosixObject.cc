@@ -29,7 +29,10 @@
 /******************************************************************************/
 
 #include <cerrno>
+#include <cstdint>
 #include <fcntl.h>
+#include <new>
+#include <sched.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
 
@@ -43,7 +46,7 @@
 /******************************************************************************/
 
 XrdSysMutex      XrdPosixObject::fdMutex;
-XrdPosixObject **XrdPosixObject::myFiles  =  0;
+std::atomic<XrdPosixObject *> *XrdPosixObject::myFiles = 0;
 int              XrdPosixObject::highFD   = -1;
 int              XrdPosixObject::lastFD   = -1;
 int              XrdPosixObject::baseFD   =  0;
@@ -51,6 +54,72 @@ int              XrdPosixObject::freeFD   =  0;
 int              XrdPosixObject::posxFD   =  0;
 int              XrdPosixObject::devNull  = -1;
 
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+// Lookups do not take fdMutex. A thread that picked up an object pointer from
+// the table may therefore still be looking at the object after it has been
+// removed. To keep the object alive until then each thread announces, in its
+// own slot, the epoch in which it entered a lookup (zero means it is not in a
+// lookup). Removing an object advances the epoch and then waits until no slot
+// shows an older epoch. Slots are never freed; those of exited threads are
+// reused by new threads.
+//
+namespace
+{
+struct alignas(64) EpochSlot
+      {std::atomic<uint64_t>  epoch;
+       std::atomic<bool>      inUse;
+       EpochSlot             *next;
+
+       EpochSlot() : epoch(0), inUse(true), next(0) {}
+      };
+
+std::atomic<uint64_t>    curEpoch(1);
+std::atomic<EpochSlot *> slotList(0);
+
+EpochSlot *GetSlot()
+{
+   EpochSlot *sP;
+
+// Reuse a slot left behind by a thread that has exited
+//
+   for (sP = slotList.load(); sP; sP = sP->next)
+       {bool isFree = false;
+        if (sP->inUse.compare_exchange_strong(isFree, true)) return sP;
+       }
+
+// Add a new slot to the list. Slots are only ever added at the head.
+//
+   sP = new EpochSlot;
+   sP->next = slotList.load();
+   while(!slotList.compare_exchange_weak(sP->next, sP)) {}
+   return sP;
+}
+
+struct SlotOwner
+      {EpochSlot *slot;
+
+       SlotOwner() : slot(GetSlot()) {}
+      ~SlotOwner() {slot->inUse.store(false);}
+      };
+
+class EpochGuard
+{
+public:
+
+     EpochGuard() : slot(mySlot().slot) {slot->epoch.store(curEpoch.load());}
+    ~EpochGuard() {slot->epoch.store(0, std::memory_order_release);}
+
+private:
+
+static SlotOwner &mySlot() {thread_local SlotOwner owner; return owner;}
+
+EpochSlot *slot;
+};
+}
+
 /******************************************************************************/
 /*                              A s s i g n F D                               */
 /******************************************************************************/
@@ -65,21 +134,21 @@ bool XrdPosixObject::AssignFD(bool isStream)
 //
    if (baseFD)
       { if (isStream) return 0;
-        for (fd = freeFD; fd < posxFD && myFiles[fd]; fd++) {}
+        for (fd = freeFD; fd < posxFD && myFiles[fd].load(); fd++) {}
         if (fd >= posxFD) return 0;
         freeFD = fd+1;
       } else {
         do{if ((fd = dup(devNull)) < 0) return false;
            if (fd >= lastFD || (isStream && fd > 255))
               {close(fd); return 0;}
-           if (!myFiles[fd]) break;
+           if (!myFiles[fd].load()) break;
            DMSG("AssignFD", "FD " <<fd <<" closed outside of XrdPosix!");
           } while(1);
       }
 
 // Enter object in out vector of objects and assign it the FD
 //
-   myFiles[fd] = this;
+   myFiles[fd].store(this);
    if (fd > highFD) highFD = fd;
    fdNum  = fd + baseFD;
 
@@ -104,32 +173,44 @@ XrdPosixDir *XrdPosixObject::Dir(int fd, bool glk)
 do{if (fd >= lastFD || fd < baseFD)
       {errno = EBADF; return (XrdPosixDir *)0;}
 
-// Obtain the file object, if any
+// Obtain the file object, if any. When the object is to be destroyed we need
+// the global lock. Otherwise, the object is looked up without it and the epoch
+// guard keeps the object from being deleted while we try to lock it.
 //
-   fdMutex.Lock();
-   if (!(oP = myFiles[fd - baseFD]) || !(oP->Who(&dP)))
-      {fdMutex.UnLock(); errno = EBADF; return (XrdPosixDir *)0;}
+   if (glk)
+      {fdMutex.Lock();
+       if (!(oP = myFiles[fd - baseFD].load()) || !(oP->Who(&dP)))
+          {fdMutex.UnLock(); errno = EBADF; return (XrdPosixDir *)0;}
+       haveLock = oP->objMutex.CondWriteLock();
+       if (!haveLock) fdMutex.UnLock();
+      } else {
+       EpochGuard eGuard;
+       if (!(oP = myFiles[fd - baseFD].load()) || !(oP->Who(&dP)))
+          {errno = EBADF; return (XrdPosixDir *)0;}
+       haveLock = oP->objMutex.CondReadLock();
 
-// Attempt to lock the object in the appropriate mode. If we fail, then we need
-// to retry this after dropping the global lock. We pause a bit to let the
-// current lock holder a chance to unlock the lock. We only do this a limited
-// amount of time (1 minute) so that we don't get stuck here forever.
+// The object may have been released before we locked it. Once locked, it
+// cannot be released until we unlock it.
+//
+       if (haveLock && myFiles[fd - baseFD].load() != oP)
+          {oP->UnLock(); errno = EBADF; return (XrdPosixDir *)0;}
+      }
+
+// If we could not lock the object in the appropriate mode then we need to
+// retry this. We pause a bit to let the current lock holder a chance to
+// unlock the lock. We only do this a limited amount of time (1 minute) so
+// that we don't get stuck here forever.
 //
-   if (glk) haveLock = oP->objMutex.CondWriteLock();
-      else  haveLock = oP->objMutex.CondReadLock();
    if (!haveLock)
-      {fdMutex.UnLock();
-       waitCount++;
+      {waitCount++;
        if (waitCount > 120) break;
        XrdSysTimer::Wait(500); // We wait 500 milliseconds
        continue;
       }
 
-// If the global lock is to be held, then release the object lock as this
-// is a call to destroy the object and there is no need for the local lock.
+// If the global lock is to be held, then the object stays write locked until
+// it has been removed from the table so that no lookup can lock it meanwhile.
 //
-   if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
    return dP;
   } while(1);
 
@@ -155,32 +236,44 @@ XrdPosixFile *XrdPosixObject::File(int fd, bool glk)
 do{if (fd >= lastFD || fd < baseFD)
       {errno = EBADF; return (XrdPosixFile *)0;}
 
-// Obtain the file object, if any
+// Obtain the file object, if any. When the object is to be destroyed we need
+// the global lock. Otherwise, the object is looked up without it and the epoch
+// guard keeps the object from being deleted while we try to lock it.
 //
-   fdMutex.Lock();
-   if (!(oP = myFiles[fd - baseFD]) || !(oP->Who(&fP)))
-      {fdMutex.UnLock(); errno = EBADF; return (XrdPosixFile *)0;}
+   if (glk)
+      {fdMutex.Lock();
+       if (!(oP = myFiles[fd - baseFD].load()) || !(oP->Who(&fP)))
+          {fdMutex.UnLock(); errno = EBADF; return (XrdPosixFile *)0;}
+       haveLock = oP->objMutex.CondWriteLock();
+       if (!haveLock) fdMutex.UnLock();
+      } else {
+       EpochGuard eGuard;
+       if (!(oP = myFiles[fd - baseFD].load()) || !(oP->Who(&fP)))
+          {errno = EBADF; return (XrdPosixFile *)0;}
+       haveLock = oP->objMutex.CondReadLock();
+
+// The object may have been released before we locked it. Once locked, it
+// cannot be released until we unlock it.
+//
+       if (haveLock && myFiles[fd - baseFD].load() != oP)
+          {oP->UnLock(); errno = EBADF; return (XrdPosixFile *)0;}
+      }
 
-// Attempt to lock the object in the appropriate mode. If we fail, then we need
-// to retry this after dropping the global lock. We pause a bit to let the
-// current lock holder a chance to unlock the lock. We only do this a limited
-// amount of time (1 minute) so that we don't get stuck here forever.
+// If we could not lock the object in the appropriate mode then we need to
+// retry this. We pause a bit to let the current lock holder a chance to
+// unlock the lock. We only do this a limited amount of time (1 minute) so
+// that we don't get stuck here forever.
 //
-   if (glk) haveLock = oP->objMutex.CondWriteLock();
-      else  haveLock = oP->objMutex.CondReadLock();
    if (!haveLock)
-      {fdMutex.UnLock();
-       waitCount++;
+      {waitCount++;
        if (waitCount > 120) break;
        XrdSysTimer::Wait(500); // We wait 500 milliseconds
        continue;
       }
 
-// If the global lock is to be held, then release the object lock as this
-// is a call to destroy the object and there is no need for the local lock.
+// If the global lock is to be held, then the object stays write locked until
+// it has been removed from the table so that no lookup can lock it meanwhile.
 //
-   if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
    return fP;
   } while(1);
 
@@ -190,6 +283,24 @@ do{if (fd >= lastFD || fd < baseFD)
    return (XrdPosixFile *)0;
 }
 
+/******************************************************************************/
+/* Private:                        D r a i n                                  */
+/******************************************************************************/
+
+void XrdPosixObject::Drain()
+{
+   uint64_t newEpoch = curEpoch.fetch_add(1) + 1;
+   uint64_t slotEpoch;
+
+// Any lookup that started before the object was removed from the table shows
+// an older epoch. Wait for all of them to finish. Lookups never block, so
+// this is a very short wait.
+//
+   for (EpochSlot *sP = slotList.load(); sP; sP = sP->next)
+       while((slotEpoch = sP->epoch.load()) && slotEpoch < newEpoch)
+            sched_yield();
+}
+
 /******************************************************************************/
 /*                                  I n i t                                   */
 /******************************************************************************/
@@ -198,7 +309,7 @@ int XrdPosixObject::Init(int fdnum)
 {
    static const int maxFD = 1048576;
    struct rlimit rlim;
-   int isize, limfd;
+   int limfd;
 
 // Initialize the /dev/null file descriptors, bail if we cannot
 //
@@ -226,12 +337,12 @@ int XrdPosixObject::Init(int fdnum)
 //
    if (fdnum < 0) {posxFD = fdnum = -fdnum; baseFD = limfd;}
       else         fdnum = limfd;
-   isize = fdnum * sizeof(XrdPosixFile *);
 
 // Allocate the table for fd-type pointers
 //
-   if (!(myFiles = (XrdPosixObject **)malloc(isize))) lastFD = -1;
-      else {memset((void *)myFiles, 0, isize); lastFD = fdnum+baseFD;}
+   if (!(myFiles = new (std::nothrow) std::atomic<XrdPosixObject *>[fdnum]()))
+      lastFD = -1;
+      else lastFD = fdnum+baseFD;
 
 // All done
 //
@@ -253,9 +364,9 @@ void XrdPosixObject::Release(XrdPosixObject *oP, bool needlk)
    if (baseFD)
       {int myFD = oP->fdNum - baseFD;
        if (myFD < freeFD) freeFD = myFD;
-       myFiles[myFD] = 0;
+       myFiles[myFD].store(0);
       } else {
-       myFiles[oP->fdNum] = 0;
+       myFiles[oP->fdNum].store(0);
        close(oP->fdNum);
       }
 
@@ -263,6 +374,10 @@ void XrdPosixObject::Release(XrdPosixObject *oP, bool needlk)
 //
    oP->fdNum = -1;
    fdMutex.UnLock();
+
+// Wait for any lookup that may still be looking at the object
+//
+   Drain();
 }
 
 /******************************************************************************/
@@ -280,6 +395,7 @@ XrdPosixDir *XrdPosixObject::ReleaseDir(int fd)
 // Release it and return the underlying object
 //
    Release((XrdPosixObject *)dP, false);
+   ((XrdPosixObject *)dP)->UnLock();
    return dP;
 }
 
@@ -298,6 +414,7 @@ XrdPosixFile *XrdPosixObject::ReleaseFile(int fd)
 // Release it and return the underlying object
 //
    Release((XrdPosixObject *)fP, false);
+   ((XrdPosixObject *)fP)->UnLock();
    return fP;
 }
   
@@ -315,13 +432,14 @@ void XrdPosixObject::Shutdown()
    fdMutex.Lock();
    if (myFiles)
       {for (i = 0; i <= highFD; i++) 
-           if ((oP = myFiles[i]))
-              {myFiles[i] = 0;
+           if ((oP = myFiles[i].load()))
+              {myFiles[i].store(0);
                if (oP->fdNum >= 0) close(oP->fdNum);
                oP->fdNum = -1;
+               Drain();
                delete oP;
               };
-       free(myFiles); myFiles = 0;
+       delete [] myFiles; myFiles = 0;
       }
    fdMutex.UnLock();
 }
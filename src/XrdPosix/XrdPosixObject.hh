@@ -30,6 +30,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <atomic>
 #include <sys/types.h>
 
 #include "XrdSys/XrdSysAtomics.hh"
@@ -59,15 +60,9 @@ static  int           Init(int numfd);
                               else objMutex.ReadLock();
                           }
 
-        void          Ref()    {AtomicBeg(updMutex);
-                                AtomicInc(refCnt);
-                                AtomicEnd(updMutex);
-                               }
-        int           Refs()   {AtomicRet(updMutex, refCnt);}
-        void          unRef()  {AtomicBeg(updMutex);
-                                AtomicDec(refCnt);
-                                AtomicEnd(updMutex);
-                               }
+        void          Ref()    {refCnt.fetch_add(1);}
+        int           Refs()   {return refCnt.load();}
+        void          unRef()  {refCnt.fetch_sub(1);}
 
 static  void          Release(XrdPosixObject *oP, bool needlk=true);
 
@@ -81,7 +76,7 @@ static  void          Shutdown();
 
 static  bool          Valid(int fd)
                            {return fd >= baseFD && fd <= (highFD+baseFD)
-                                   && myFiles && myFiles[fd-baseFD];}
+                                   && myFiles && myFiles[fd-baseFD].load();}
 
 virtual bool          Who(XrdPosixDir  **dirP)  {return false;}
 
@@ -94,12 +89,14 @@ protected:
        XrdSysRecMutex   updMutex;
        XrdSysRWLock     objMutex;
        int              fdNum;
-       int              refCnt;
+       std::atomic<int> refCnt;
 
 private:
 
+static void             Drain();
+
 static XrdSysMutex      fdMutex;
-static XrdPosixObject **myFiles;
+static std::atomic<XrdPosixObject *> *myFiles;
 static int              lastFD;
 static int              highFD;
 static int              baseFD;
@@ -49,6 +49,10 @@ if (BUILD_S3)
             XrdS3/XrdS3Response.hh
             XrdS3/XrdS3ObjectStore.cc
             XrdS3/XrdS3ObjectStore.hh
+            XrdS3/XrdS3Index.cc
+            XrdS3/XrdS3Index.hh
+            XrdS3/XrdS3UploadPipeline.cc
+            XrdS3/XrdS3UploadPipeline.hh
             XrdS3/XrdS3Action.hh
     )
 
@@ -0,0 +1,161 @@
+//
+// Sorted index of the object keys of each bucket.
+//
+
+#include "XrdS3Index.hh"
+
+#include <sys/stat.h>
+
+#include "XrdPosix/XrdPosixExtern.hh"
+#include "XrdS3Utils.hh"
+
+namespace S3 {
+
+std::shared_ptr<S3Index::BucketIndex> S3Index::Get(
+    const std::string &bucket, const std::filesystem::path &root) {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  auto it = buckets.find(bucket);
+  if (it != buckets.end()) {
+    return it->second;
+  }
+
+  // Build the index from the bucket directory. Other requests for the same
+  // bucket wait on the index lock until it is loaded.
+  auto index = std::make_shared<BucketIndex>();
+  std::unique_lock<std::shared_mutex> ilock(index->mutex);
+  buckets.emplace(bucket, index);
+  lock.unlock();
+
+  Load(root, "", index->keys);
+  return index;
+}
+
+void S3Index::Load(const std::filesystem::path &root, const std::string &base,
+                   std::set<std::string> &keys) {
+  std::vector<std::string> dirs;
+
+  S3Utils::DirIterator(root / base, [&](dirent *entry) {
+    // Skip ".", ".." and the temporary files of uploads in progress.
+    if (entry->d_name[0] == '.') {
+      return;
+    }
+    std::string name = entry->d_name;
+
+    auto type = entry->d_type;
+    if (type == DT_UNKNOWN) {
+      struct stat buf;
+      if (XrdPosix_Stat((root / base / name).c_str(), &buf)) {
+        return;
+      }
+      type = S_ISDIR(buf.st_mode) ? DT_DIR : DT_REG;
+    }
+
+    if (type == DT_DIR) {
+      dirs.push_back(base + name + '/');
+    } else if (type == DT_REG) {
+      keys.insert(base + name);
+    }
+  });
+
+  for (const auto &dir : dirs) {
+    Load(root, dir, keys);
+  }
+}
+
+// A bucket that is not indexed yet needs nothing, its index will be built from
+// the bucket directory as it is then.
+std::shared_ptr<S3Index::BucketIndex> S3Index::Find(const std::string &bucket) {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  auto it = buckets.find(bucket);
+  return it == buckets.end() ? nullptr : it->second;
+}
+
+void S3Index::Add(const std::string &bucket, const std::string &key) {
+  auto index = Find(bucket);
+  if (index) {
+    std::unique_lock<std::shared_mutex> lock(index->mutex);
+    index->keys.insert(key);
+  }
+}
+
+void S3Index::Remove(const std::string &bucket, const std::string &key) {
+  auto index = Find(bucket);
+  if (index) {
+    std::unique_lock<std::shared_mutex> lock(index->mutex);
+    index->keys.erase(key);
+  }
+}
+
+void S3Index::Drop(const std::string &bucket) {
+  std::unique_lock<std::mutex> lock(mutex);
+  buckets.erase(bucket);
+}
+
+// Smallest string greater than every string starting with prefix, or an empty
+// string if there is none.
+std::string S3Index::PrefixEnd(const std::string &prefix) {
+  std::string end = prefix;
+  while (!end.empty()) {
+    auto c = static_cast<unsigned char>(end.back());
+    if (c != 0xff) {
+      end.back() = static_cast<char>(c + 1);
+      return end;
+    }
+    end.pop_back();
+  }
+  return end;
+}
+
+S3Index::Page S3Index::List(const std::string &bucket,
+                            const std::filesystem::path &root,
+                            const std::string &prefix,
+                            const std::string &marker, char delimiter,
+                            int max_keys, bool inclusive) {
+  Page page;
+
+  auto index = Get(bucket, root);
+  std::shared_lock<std::shared_mutex> lock(index->mutex);
+  const auto &keys = index->keys;
+
+  auto upto = [&keys](const std::string &p) {
+    auto end = PrefixEnd(p);
+    return end.empty() ? keys.end() : keys.lower_bound(end);
+  };
+
+  // Seek to the first key to be listed. A marker that is a common prefix
+  // skips all the keys rolled up into it.
+  auto it = keys.lower_bound(prefix);
+  if (marker > prefix) {
+    it = inclusive ? keys.lower_bound(marker) : keys.upper_bound(marker);
+    if (!inclusive && delimiter && !marker.empty() &&
+        marker.back() == delimiter &&
+        marker.compare(0, prefix.size(), prefix) == 0) {
+      it = upto(marker);
+    }
+  }
+
+  while (it != keys.end() && it->compare(0, prefix.size(), prefix) == 0) {
+    Entry entry{*it, false};
+
+    size_t pos;
+    if (delimiter &&
+        (pos = it->find(delimiter, prefix.size())) != std::string::npos) {
+      entry = {it->substr(0, pos + 1), true};
+    }
+
+    if (page.entries.size() >= static_cast<size_t>(max_keys)) {
+      page.is_truncated = true;
+      page.next_marker = entry.key;
+      break;
+    }
+
+    it = entry.common_prefix ? upto(entry.key) : std::next(it);
+    page.entries.push_back(std::move(entry));
+  }
+
+  return page;
+}
+
+}  // namespace S3
@@ -0,0 +1,82 @@
+//
+// Sorted index of the object keys of each bucket.
+//
+
+#ifndef XROOTD_XRDS3INDEX_HH
+#define XROOTD_XRDS3INDEX_HH
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace S3 {
+
+//! Keeps the keys of every bucket in a sorted set, so that listing a bucket
+//! seeks straight to the prefix or marker instead of scanning the directory
+//! tree. The index of a bucket is built from the bucket directory the first
+//! time it is used and is then kept up to date by the object store whenever
+//! an object is created or deleted.
+class S3Index {
+ public:
+  S3Index() = default;
+  ~S3Index() = default;
+
+  struct Entry {
+    std::string key;
+    bool common_prefix;
+  };
+
+  struct Page {
+    std::vector<Entry> entries;
+    bool is_truncated{};
+    std::string next_marker;
+  };
+
+  //! Record that an object has been created. Must be called once the object
+  //! is in place.
+  void Add(const std::string &bucket, const std::string &key);
+
+  //! Record that an object has been deleted. Must be called once the object
+  //! is gone.
+  void Remove(const std::string &bucket, const std::string &key);
+
+  //! Forget the index of a bucket (e.g. when the bucket is deleted).
+  void Drop(const std::string &bucket);
+
+  //! List the keys starting with prefix, in lexicographic order, rolling up
+  //! the keys containing the delimiter after the prefix into common prefixes.
+  //! The listing starts after the marker, or at the marker when inclusive is
+  //! true. At most max_keys entries are returned; when there are more, the
+  //! page is truncated and next_marker is the first entry not returned.
+  Page List(const std::string &bucket, const std::filesystem::path &root,
+            const std::string &prefix, const std::string &marker,
+            char delimiter, int max_keys, bool inclusive);
+
+ private:
+  struct BucketIndex {
+    std::shared_mutex mutex;
+    std::set<std::string> keys;
+  };
+
+  std::shared_ptr<BucketIndex> Find(const std::string &bucket);
+
+  std::shared_ptr<BucketIndex> Get(const std::string &bucket,
+                                   const std::filesystem::path &root);
+
+  static void Load(const std::filesystem::path &root, const std::string &base,
+                   std::set<std::string> &keys);
+
+  static std::string PrefixEnd(const std::string &prefix);
+
+  std::mutex mutex;
+  std::map<std::string, std::shared_ptr<BucketIndex>> buckets;
+};
+
+}  // namespace S3
+
+#endif  // XROOTD_XRDS3INDEX_HH
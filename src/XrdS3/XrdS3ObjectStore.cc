@@ -8,24 +8,170 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/xattr.h>
+#include <unistd.h>
 
 #include <XrdOuc/XrdOucTUtils.hh>
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <deque>
 #include <filesystem>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <stack>
+#include <thread>
 #include <utility>
 
 #include "XrdCks/XrdCksCalcmd5.hh"
 #include "XrdPosix/XrdPosixExtern.hh"
 #include "XrdS3Auth.hh"
 #include "XrdS3Req.hh"
+#include "XrdS3UploadPipeline.hh"
 
 namespace S3 {
 
+namespace {
+
+// The manifest of a composite object lists its extents, one per line, as
+// "<offset> <length> <path>".
+bool ReadManifest(const std::filesystem::path &composite,
+                  std::vector<S3ObjectStore::Object::Extent> &extents) {
+  auto fd = XrdPosix_Open((composite / "manifest").c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  std::string data;
+  char buf[65536];
+  ssize_t n;
+  while ((n = XrdPosix_Read(fd, buf, sizeof(buf))) > 0) {
+    data.append(buf, n);
+  }
+  XrdPosix_Close(fd);
+  if (n < 0) {
+    return false;
+  }
+
+  std::istringstream manifest(data);
+  S3ObjectStore::Object::Extent extent{};
+  size_t start = 0;
+  extents.clear();
+  while (manifest >> extent.offset >> extent.length >> extent.path) {
+    extent.start = start;
+    start += extent.length;
+    extents.push_back(extent);
+  }
+  return manifest.eof();
+}
+
+bool WriteManifest(const std::filesystem::path &composite,
+                   const std::vector<S3ObjectStore::Object::Extent> &extents) {
+  std::ostringstream manifest;
+  for (const auto &extent : extents) {
+    manifest << extent.offset << ' ' << extent.length << ' ' << extent.path
+             << '\n';
+  }
+  auto data = manifest.str();
+
+  auto fd = XrdPosix_Open((composite / "manifest").c_str(),
+                          O_CREAT | O_TRUNC | O_WRONLY, S_IRWXU | S_IRWXG);
+  if (fd < 0) {
+    return false;
+  }
+  auto ok = XrdPosix_Write(fd, data.data(), data.size()) ==
+                static_cast<ssize_t>(data.size()) &&
+            !XrdPosix_Fsync(fd);
+  XrdPosix_Close(fd);
+  return ok;
+}
+
+// The composite directory of an object is recorded relative to the multipart
+// upload directory, so that the latter can be moved. Absolute paths, as
+// recorded before, are used as they are.
+std::filesystem::path CompositePath(const std::filesystem::path &mtpu_path,
+                                    const std::string &composite) {
+  return composite.empty() ? std::filesystem::path() : mtpu_path / composite;
+}
+
+// Binary MD5 of a part from its quoted hex ETag, or an empty string if the
+// ETag is not an MD5.
+std::string PartMD5(const std::string &etag) {
+  if (etag.size() != 34 || etag.front() != '"' || etag.back() != '"') {
+    return {};
+  }
+
+  std::string md5;
+  for (size_t i = 1; i < 33; i += 2) {
+    unsigned int byte;
+    if (sscanf(etag.c_str() + i, "%2x", &byte) != 1 ||
+        !isxdigit(etag[i]) || !isxdigit(etag[i + 1])) {
+      return {};
+    }
+    md5.push_back(static_cast<char>(byte));
+  }
+  return md5;
+}
+
+}  // namespace
+
+class S3ObjectStore::Compactor {
+ public:
+  explicit Compactor(const std::filesystem::path &mtpu)
+      : mtpu_path(mtpu), thread(&Compactor::Run, this) {}
+
+  ~Compactor() {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cond.notify_all();
+    thread.join();
+  }
+
+  void Schedule(const std::filesystem::path &path) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (pending.insert(path).second) {
+      jobs.push_back(path);
+      cond.notify_all();
+    }
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (stopping) {
+        return;
+      }
+
+      auto path = jobs.front();
+      jobs.pop_front();
+      lock.unlock();
+      CompactObject(mtpu_path, path);
+      lock.lock();
+      pending.erase(path);
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<std::filesystem::path> jobs;
+  std::set<std::filesystem::path> pending;
+  bool stopping = false;
+  const std::filesystem::path mtpu_path;
+  std::thread thread;
+};
+
 S3ObjectStore::S3ObjectStore(const std::string &config, const std::string &mtpu)
     : config_path(config), mtpu_path(mtpu) {
   user_map = config_path / "users";
+  compactor = std::make_shared<Compactor>(mtpu_path);
 
   XrdPosix_Mkdir(user_map.c_str(), S_IRWXU | S_IRWXG);
   XrdPosix_Mkdir(mtpu_path.c_str(), S_IRWXU | S_IRWXG);
@@ -145,17 +291,6 @@ S3Error S3ObjectStore::CreateBucket(S3Auth &auth, S3Auth::Bucket bucket,
   return S3Error::None;
 }
 
-std::pair<std::string, std::string> BaseDir(std::string p) {
-  std::string basedir;
-  auto pos = p.rfind('/');
-  if (pos != std::string::npos) {
-    basedir = p.substr(0, pos);
-    p.erase(0, pos + 1);
-  }
-
-  return {basedir, p};
-}
-
 S3Error S3ObjectStore::DeleteBucket(S3Auth &auth,
                                     const S3Auth::Bucket &bucket) {
   if (!S3Utils::IsDirEmpty(bucket.path)) {
@@ -186,6 +321,7 @@ S3Error S3ObjectStore::DeleteBucket(S3Auth &auth,
 
   XrdPosix_Rmdir(bucket.path.c_str());
   XrdPosix_Rmdir(upload_path.c_str());
+  index->Drop(bucket.name);
   auth.DeleteBucketInfo(bucket);
   XrdPosix_Unlink((user_map / bucket.owner.id / bucket.name).c_str());
 
@@ -201,7 +337,8 @@ S3ObjectStore::Object::~Object() {
 // TODO: Replace with the real XrdPosix_Listxattr once implemented.
 #define XrdPosix_Listxattr listxattr
 
-S3Error S3ObjectStore::Object::Init(const std::filesystem::path &p) {
+S3Error S3ObjectStore::Object::Init(const std::filesystem::path &p,
+                                    const std::filesystem::path &mtpu_path) {
   struct stat buf;
 
   if (XrdPosix_Stat(p.c_str(), &buf) || S_ISDIR(buf.st_mode)) {
@@ -222,9 +359,27 @@ S3Error S3ObjectStore::Object::Init(const std::filesystem::path &p) {
   std::vector<char> value;
   for (const auto &attr : attrnames) {
     if (attr.substr(0, 8) != "user.s3.") continue;
+    if (attr == "user.s3.composite") {
+      composite = CompositePath(mtpu_path, S3Utils::GetXattr(p, "composite"));
+      continue;
+    }
     attributes.insert({attr.substr(8), S3Utils::GetXattr(p, attr.substr(8))});
   }
 
+  // The object file of a composite object only has the size of the object, its
+  // data is read from the parts. If the manifest is gone, the object has just
+  // been compacted.
+  if (!composite.empty() && !ReadManifest(composite, extents)) {
+    if (!S3Utils::GetXattr(p, "composite").empty()) {
+      return S3Error::InternalError;
+    }
+    composite.clear();
+  }
+  if (!extents.empty() && extents.back().start + extents.back().length !=
+                              static_cast<size_t>(buf.st_size)) {
+    return S3Error::InternalError;
+  }
+
   this->init = true;
   this->name = p;
   this->size = buf.st_size;
@@ -239,6 +394,10 @@ ssize_t S3ObjectStore::Object::Read(size_t length, char **ptr) {
     return 0;
   }
 
+  if (!extents.empty()) {
+    return ReadComposite(length, ptr);
+  }
+
   if (fd == 0) {
     this->buffer.resize(this->buffer_size);
     this->fd = XrdPosix_Open(name.c_str(), O_RDONLY);
@@ -253,11 +412,98 @@ ssize_t S3ObjectStore::Object::Read(size_t length, char **ptr) {
   return ret;
 }
 
+// Fill the buffer from as many parts as needed.
+ssize_t S3ObjectStore::Object::ReadComposite(size_t length, char **ptr) {
+  buffer.resize(buffer_size);
+  length = std::min({length, buffer.size(), pos < size ? size - pos : 0});
+
+  size_t total = 0;
+  while (total < length) {
+    size_t l = length - total;
+    off_t offset = pos;
+
+    if (!extents.empty()) {
+      auto it = std::upper_bound(
+          extents.begin(), extents.end(), pos,
+          [](size_t p, const Extent &extent) { return p < extent.start; });
+      size_t n = std::distance(extents.begin(), it) - 1;
+      const auto &extent = extents[n];
+
+      if (fd == 0 || current != n) {
+        if (fd > 0) {
+          XrdPosix_Close(fd);
+        }
+        fd = XrdPosix_Open((composite / extent.path).c_str(), O_RDONLY);
+        current = n;
+
+        if (fd < 0) {
+          fd = 0;
+          // If the object has been compacted in the meantime, its data is now
+          // in the object file. Otherwise the part cannot be read, and the
+          // object file only holds zeros.
+          if (!S3Utils::GetXattr(name, "composite").empty()) {
+            return -1;
+          }
+          extents.clear();
+          fd = XrdPosix_Open(name.c_str(), O_RDONLY);
+          if (fd < 0 || XrdPosix_Lseek(fd, pos, SEEK_SET) == -1) {
+            return -1;
+          }
+          continue;
+        }
+      }
+
+      l = std::min(l, extent.start + extent.length - pos);
+      offset = extent.offset + (pos - extent.start);
+    }
+
+    auto ret = XrdPosix_Pread(fd, buffer.data() + total, l, offset);
+    if (ret < 0) {
+      return -1;
+    }
+    if (ret == 0) {
+      break;
+    }
+    total += ret;
+    pos += ret;
+  }
+
+  if (extents.empty()) {
+    XrdPosix_Lseek(fd, pos, SEEK_SET);
+  }
+
+  *ptr = buffer.data();
+
+  return total;
+}
+
 off_t S3ObjectStore::Object::Lseek(off_t offset, int whence) {
   if (!init) {
     return -1;
   }
 
+  if (!extents.empty()) {
+    off_t base;
+    switch (whence) {
+      case SEEK_SET:
+        base = 0;
+        break;
+      case SEEK_CUR:
+        base = pos;
+        break;
+      case SEEK_END:
+        base = size;
+        break;
+      default:
+        return -1;
+    }
+    if (base + offset < 0) {
+      return -1;
+    }
+    pos = base + offset;
+    return pos;
+  }
+
   if (fd == 0) {
     this->buffer.resize(this->buffer_size);
     this->fd = XrdPosix_Open(name.c_str(), O_RDONLY);
@@ -268,7 +514,14 @@ off_t S3ObjectStore::Object::Lseek(off_t offset, int whence) {
 
 S3Error S3ObjectStore::GetObject(const S3Auth::Bucket &bucket,
                                  const std::string &object, Object &obj) {
-  return obj.Init(bucket.path / object);
+  auto error = obj.Init(bucket.path / object, mtpu_path);
+
+  // Compactions are lost on restart, catch up with them when the object is
+  // used.
+  if (error == S3Error::None && obj.NeedsCompaction() && compactor) {
+    compactor->Schedule(bucket.path / object);
+  }
+  return error;
 }
 
 S3Error S3ObjectStore::DeleteObject(const S3Auth::Bucket &bucket,
@@ -276,10 +529,14 @@ S3Error S3ObjectStore::DeleteObject(const S3Auth::Bucket &bucket,
   std::string base, obj;
 
   auto full_path = bucket.path / key;
+  auto composite =
+      CompositePath(mtpu_path, S3Utils::GetXattr(full_path, "composite"));
 
   if (XrdPosix_Unlink(full_path.c_str())) {
     return S3Error::NoSuchKey;
   }
+  index->Remove(bucket.name, key);
+  RemoveComposite(composite);
 
   do {
     full_path = full_path.parent_path();
@@ -405,7 +662,8 @@ S3Error S3ObjectStore::CopyObject(const S3Auth::Bucket &bucket,
     return error;
   }
 
-  XrdPosix_Rename(tmp_path.c_str(), final_path.c_str());
+  ReplaceObject(tmp_path, final_path);
+  index->Add(bucket.name, key);
 
   return error;
 }
@@ -474,8 +732,9 @@ bool S3ObjectStore::KeepOptimize(const std::filesystem::path &upload_path,
   return true;
 }
 
-S3Error ReadBufferAt(XrdS3Req &req, XrdCksCalcmd5 &md5XS,
-                     S3Crypt::S3SHA256 &sha256XS, int fd,
+namespace {
+
+S3Error ReadBufferAt(XrdS3Req &req, S3UploadPipeline &pipeline,
                      unsigned long length) {
   int buflen = 0;
   unsigned long readlen = 0;
@@ -489,10 +748,8 @@ S3Error ReadBufferAt(XrdS3Req &req, XrdCksCalcmd5 &md5XS,
       return S3Error::IncompleteBody;
     }
     length -= readlen;
-    md5XS.Update(ptr, buflen);
-    sha256XS.Update(ptr, buflen);
 
-    if (XrdPosix_Write(fd, ptr, buflen) == -1) {
+    if (!pipeline.Append(ptr, buflen)) {
       return S3Error::InternalError;
     }
   }
@@ -502,18 +759,28 @@ S3Error ReadBufferAt(XrdS3Req &req, XrdCksCalcmd5 &md5XS,
   return S3Error::None;
 }
 
+}  // namespace
+
 std::pair<S3Error, size_t> ReadBufferIntoFile(XrdS3Req &req,
                                               XrdCksCalcmd5 &md5XS,
                                               S3Crypt::S3SHA256 &sha256XS,
                                               int fd, bool chunked,
                                               unsigned long size) {
 #define PUT_LIMIT 5000000000
-  auto reader = [&req, &md5XS, &sha256XS, fd](unsigned long length) {
-    return ReadBufferAt(req, md5XS, sha256XS, fd, length);
+  S3UploadPipeline pipeline(md5XS, sha256XS, fd);
+
+  auto reader = [&req, &pipeline](unsigned long length) {
+    return ReadBufferAt(req, pipeline, length);
+  };
+  auto finish = [&pipeline](S3Error error) {
+    if (error == S3Error::None && !pipeline.Finish()) {
+      return S3Error::InternalError;
+    }
+    return error;
   };
 
   if (!chunked) {
-    return {reader(size), size};
+    return {finish(reader(size)), size};
   }
 
   int length;
@@ -539,7 +806,7 @@ std::pair<S3Error, size_t> ReadBufferIntoFile(XrdS3Req &req,
     req.BuffgetLine(chunk_header);
   } while (error == S3Error::None && length != 0);
 
-  return {error, final_size};
+  return {finish(error), final_size};
 #undef PUT_LIMIT
 }
 
@@ -769,7 +1036,8 @@ S3Error S3ObjectStore::PutObject(XrdS3Req &req, const S3Auth::Bucket &bucket,
     return error;
   }
 
-  XrdPosix_Rename(tmp_path.c_str(), final_path.c_str());
+  ReplaceObject(tmp_path, final_path);
+  index->Add(bucket.name, req.object);
 
   return error;
 }
@@ -836,124 +1104,42 @@ ListObjectsInfo S3ObjectStore::ListObjects(const S3Auth::Bucket &bucket,
                            f);
 }
 
-// TODO: Replace with real XrdPosix_Scandir once implemented, or replace with
-//  custom function.
-#define XrdPosix_Scandir scandir
-
 ListObjectsInfo S3ObjectStore::ListObjectsCommon(
     const S3Auth::Bucket &bucket, std::string prefix, const std::string &marker,
     char delimiter, int max_keys, bool get_versions,
     const std::function<ObjectInfo(const std::filesystem::path &,
                                    const std::string &)> &f) {
-  std::string basedir;
-
   if (prefix == "/" || max_keys == 0) {
     return {};
   }
 
-  std::tie(basedir, prefix) = BaseDir(prefix);
-
-  if (!basedir.empty()) {
-    basedir += '/';
-  }
-
-  auto fullpath = bucket.path;
-
-  struct BasicPath {
-    std::string base;
-    std::string name;
-    unsigned char d_type;
-  };
-
-  std::deque<BasicPath> entries;
-
-  struct dirent **ent = nullptr;
-  int n;
-  if ((n = XrdPosix_Scandir((fullpath / basedir).c_str(), &ent, nullptr,
-                            alphasort)) < 0) {
-    return {};
-  }
-  for (auto i = 0; i < n; i++) {
-    if (prefix.compare(0, prefix.size(), std::string(ent[i]->d_name), 0,
-                       prefix.size()) == 0) {
-      entries.push_back({basedir, ent[i]->d_name, ent[i]->d_type});
-    }
-    free(ent[i]);
-  }
-  free(ent);
-  ent = nullptr;
+  // When listing versions, the marker indicated the key to start with, and
+  // not the last key to skip
+  auto page = index->List(bucket.name, bucket.path, prefix, marker, delimiter,
+                          max_keys, get_versions);
 
   ListObjectsInfo list{};
 
-  while (!entries.empty()) {
-    auto entry = entries.front();
-    entries.pop_front();
-
-    if (entry.name == "." || entry.name == "..") {
-      continue;
-    }
-
-    auto entry_path = entry.base + entry.name;
-
-    // Skip to marker
-    if (entry_path.compare(0, marker.size(), marker) < 0) {
-      continue;
-    }
-    // When listing versions, the marker indicated the key to start with, and
-    // not the last key to skip
-    if (!get_versions) {
-      if (!marker.empty() && entry_path == marker) {
-        continue;
-      }
-    }
-
-    if (list.objects.size() + list.common_prefixes.size() >= (size_t)max_keys) {
-      list.is_truncated = true;
-      list.next_marker = entry_path;
-      list.next_vid_marker = "1";
-      return list;
-    }
-
-    size_t m;
-    if ((m = entry_path.find(delimiter, prefix.length() + basedir.length() +
-                                            1)) != std::string::npos) {
-      list.common_prefixes.insert(entry_path.substr(0, m + 1));
-      list.key_marker = entry_path.substr(0, m + 1);
-      list.vid_marker = "1";
-      continue;
-    }
-
-    if (entry.d_type == DT_UNKNOWN) {
-      continue;
-    }
-
-    if (entry.d_type == DT_DIR) {
-      if (delimiter == '/') {
-        list.common_prefixes.insert(entry_path + '/');
-        list.key_marker = entry_path + '/';
-        list.vid_marker = "1";
+  for (const auto &entry : page.entries) {
+    if (entry.common_prefix) {
+      list.common_prefixes.insert(entry.key);
+    } else {
+      auto info = f(bucket.path, entry.key);
+      if (info.name.empty()) {
+        // The object is gone, e.g. it has just been deleted.
         continue;
       }
-
-      if ((n = scandir((fullpath / entry_path).c_str(), &ent, nullptr,
-                       alphasort)) < 0) {
-        return {};
-      }
-      for (size_t i = n; i > 0; i--) {
-        entries.push_front(
-            {entry_path + '/', ent[i - 1]->d_name, ent[i - 1]->d_type});
-        free(ent[i - 1]);
-      }
-      free(ent);
-      continue;
+      list.objects.push_back(std::move(info));
     }
-
-    list.objects.push_back(f(fullpath, entry_path));
-    list.key_marker = entry_path;
+    list.key_marker = entry.key;
     list.vid_marker = "1";
   }
-  list.next_marker = "";
-  list.next_vid_marker = "";
+
+  if (page.is_truncated) {
+    list.is_truncated = true;
+    list.next_marker = page.next_marker;
+    list.next_vid_marker = "1";
+  }
   return list;
 }
 
@@ -1115,7 +1301,8 @@ S3ObjectStore::ListParts(const std::string &bucket, const std::string &key,
 
 bool S3ObjectStore::CompleteOptimizedMultipartUpload(
     const std::filesystem::path &final_path,
-    const std::filesystem::path &tmp_path, const std::vector<PartInfo> &parts) {
+    const std::filesystem::path &tmp_path,
+    const std::vector<PartInfo> &parts) const {
   size_t e = 1;
   for (const auto &[etag, _, n, __] : parts) {
     if (e != n) {
@@ -1133,10 +1320,246 @@ bool S3ObjectStore::CompleteOptimizedMultipartUpload(
     }
   }
 
-  XrdPosix_Rename(tmp_path.c_str(), final_path.c_str());
+  ReplaceObject(tmp_path, final_path);
   return true;
 }
 
+// Move an object into place, dropping the parts of the object it replaces if
+// that one was a composite object.
+int S3ObjectStore::ReplaceObject(const std::filesystem::path &tmp_path,
+                                 const std::filesystem::path &final_path) const {
+  auto composite =
+      CompositePath(mtpu_path, S3Utils::GetXattr(final_path, "composite"));
+
+  auto ret = XrdPosix_Rename(tmp_path.c_str(), final_path.c_str());
+  if (!ret) {
+    RemoveComposite(composite);
+  }
+  return ret;
+}
+
+void S3ObjectStore::RemoveComposite(const std::filesystem::path &composite) {
+  if (composite.empty()) {
+    return;
+  }
+
+  auto rm_files = [&composite](dirent *entry) {
+    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+      return;
+    }
+
+    XrdPosix_Unlink((composite / entry->d_name).c_str());
+  };
+
+  S3Utils::DirIterator(composite, rm_files);
+
+  XrdPosix_Rmdir(composite.c_str());
+}
+
+// Write the data of a composite object into its object file, which already has
+// the right size, and then drop the parts. The object file is written in place
+// so that an object that is deleted or replaced meanwhile is left alone, and
+// readers keep using the parts until the object stops being composite.
+void S3ObjectStore::CompactObject(const std::filesystem::path &mtpu_path,
+                                  const std::filesystem::path &path) {
+  auto fd = XrdPosix_Open(path.c_str(), O_WRONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  char value[PATH_MAX];
+  auto len = fgetxattr(fd, "user.s3.composite", value, sizeof(value));
+  auto composite =
+      CompositePath(mtpu_path, len > 0 ? std::string(value, len) : "");
+
+  std::vector<Object::Extent> extents;
+  struct stat buf;
+  if (composite.empty() || !ReadManifest(composite, extents) ||
+      XrdPosix_Fstat(fd, &buf)) {
+    XrdPosix_Close(fd);
+    return;
+  }
+
+  std::vector<char> data(COMPACT_PART_SIZE);
+  auto ok = true;
+  for (const auto &extent : extents) {
+    auto part = XrdPosix_Open((composite / extent.path).c_str(), O_RDONLY);
+    ok = part >= 0;
+
+    for (size_t done = 0; ok && done < extent.length;) {
+      auto n = XrdPosix_Pread(part, data.data(),
+                              std::min(data.size(), extent.length - done),
+                              extent.offset + done);
+      ok = n > 0 && XrdPosix_Pwrite(fd, data.data(), n,
+                                    extent.start + done) == n;
+      done += n;
+    }
+
+    if (part >= 0) {
+      XrdPosix_Close(part);
+    }
+    if (!ok) {
+      break;
+    }
+  }
+
+  // Keep the modification time, the object did not change.
+  if (ok && !XrdPosix_Fsync(fd)) {
+    struct timespec times[2] = {buf.st_atim, buf.st_mtim};
+    futimens(fd, times);
+    ok = !fremovexattr(fd, "user.s3.composite");
+  }
+  XrdPosix_Close(fd);
+
+  if (ok) {
+    RemoveComposite(composite);
+  }
+}
+
+// Complete a multipart upload without copying any data: the upload directory
+// is kept as the composite directory and the object file is a sparse file of
+// the size of the object. If this cannot be done, nothing is returned.
+std::optional<S3Error> S3ObjectStore::CompleteCompositeMultipartUpload(
+    const S3Auth::Bucket &bucket, const std::string &key,
+    const std::filesystem::path &upload_path, const std::string &opt_path,
+    const std::vector<PartInfo> &parts) {
+  size_t part_size = 0;
+  try {
+    part_size = std::stoul(S3Utils::GetXattr(upload_path, "part_size"));
+  } catch (std::exception &) {
+  }
+
+  struct stat buf;
+  size_t opt_size = 0;
+  if (!opt_path.empty() && !XrdPosix_Stat(opt_path.c_str(), &buf)) {
+    opt_size = buf.st_size;
+  }
+
+  std::vector<Object::Extent> extents;
+  std::string md5s;
+  size_t size = 0;
+  bool use_opt = false;
+
+  for (const auto &part : parts) {
+    auto n = std::to_string(part.part_number);
+    Object::Extent extent{n, 0, 0, size};
+
+    if (!XrdPosix_Stat((upload_path / n).c_str(), &buf)) {
+      extent.length = buf.st_size;
+    } else {
+      // The part was written in place into the optimized upload file.
+      try {
+        extent.offset =
+            std::stol(S3Utils::GetXattr(opt_path, "part" + n + ".start"));
+      } catch (std::exception &) {
+        return std::nullopt;
+      }
+      if (part_size == 0 || extent.offset < 0 ||
+          static_cast<size_t>(extent.offset) > opt_size) {
+        return std::nullopt;
+      }
+      extent.path = "opt";
+      extent.length = std::min(part_size, opt_size - extent.offset);
+      use_opt = true;
+    }
+
+    auto md5 = PartMD5(part.etag);
+    if (md5.empty()) {
+      return std::nullopt;
+    }
+    md5s += md5;
+
+    if (extent.length) {
+      size += extent.length;
+      extents.push_back(extent);
+    }
+  }
+
+  auto composite = upload_path.parent_path() /
+                   ("." + upload_path.filename().string());
+  if (XrdPosix_Rename(upload_path.c_str(), composite.c_str())) {
+    return std::nullopt;
+  }
+  if (use_opt &&
+      XrdPosix_Rename(opt_path.c_str(), (composite / "opt").c_str())) {
+    // Most likely not on the same file system.
+    XrdPosix_Rename(composite.c_str(), upload_path.c_str());
+    return std::nullopt;
+  }
+
+  auto undo = [&]() {
+    if (use_opt) {
+      XrdPosix_Rename((composite / "opt").c_str(), opt_path.c_str());
+    }
+    XrdPosix_Unlink((composite / "manifest").c_str());
+    XrdPosix_Rename(composite.c_str(), upload_path.c_str());
+  };
+
+  if (!WriteManifest(composite, extents)) {
+    undo();
+    return S3Error::InternalError;
+  }
+
+  auto final_path = bucket.path / key;
+  auto tmp_path =
+      final_path.parent_path() /
+      ("." + final_path.filename().string() + "." +
+       std::to_string(std::time(nullptr)) + std::to_string(std::rand()));
+
+  auto fd = XrdPosix_Open(tmp_path.c_str(), O_CREAT | O_EXCL | O_WRONLY,
+                          S_IRWXU | S_IRWXG);
+  if (fd < 0) {
+    undo();
+    return S3Error::InternalError;
+  }
+  auto ret = XrdPosix_Ftruncate(fd, size);
+  XrdPosix_Close(fd);
+
+  // Same ETag as S3 gives to multipart uploads: the MD5 of the MD5s of the
+  // parts, followed by the number of parts.
+  XrdCksCalcmd5 xs;
+  xs.Init();
+  xs.Update(md5s.data(), md5s.size());
+  char *fxs = xs.Final();
+  std::vector<unsigned char> md5(fxs, fxs + 16);
+
+  std::map<std::string, std::string> metadata;
+  metadata.insert({"etag", '"' + S3Utils::HexEncode(md5) + '-' +
+                               std::to_string(parts.size()) + '"'});
+  metadata.insert(
+      {"composite", composite.lexically_relative(mtpu_path).string()});
+
+  if (ret || SetMetadata(tmp_path, metadata) != S3Error::None ||
+      ReplaceObject(tmp_path, final_path)) {
+    XrdPosix_Unlink(tmp_path.c_str());
+    undo();
+    return S3Error::InternalError;
+  }
+  index->Add(bucket.name, key);
+
+  // Drop the parts that were uploaded but left out of the object.
+  std::set<std::string> keep{"manifest"};
+  for (const auto &extent : extents) {
+    keep.insert(extent.path);
+  }
+  S3Utils::DirIterator(composite, [&](dirent *entry) {
+    if (!keep.count(entry->d_name) && strcmp(entry->d_name, ".") &&
+        strcmp(entry->d_name, "..")) {
+      XrdPosix_Unlink((composite / entry->d_name).c_str());
+    }
+  });
+
+  if (!use_opt && !opt_path.empty()) {
+    XrdPosix_Unlink(opt_path.c_str());
+  }
+
+  if (Fragmented(size, extents.size()) && compactor) {
+    compactor->Schedule(final_path);
+  }
+
+  return S3Error::None;
+}
+
 S3Error S3ObjectStore::CompleteMultipartUpload(
     XrdS3Req &req, const S3Auth::Bucket &bucket, const std::string &key,
     const std::string &upload_id, const std::vector<PartInfo> &parts) {
@@ -1155,6 +1578,7 @@ S3Error S3ObjectStore::CompleteMultipartUpload(
   // operation.
   if (!optimized.empty() &&
       CompleteOptimizedMultipartUpload(final_path, opt_path, parts)) {
+    index->Add(bucket.name, req.object);
     return DeleteMultipartUpload(bucket, key, upload_id);
   }
   // Otherwise we will need to concatenate parts
@@ -1190,8 +1614,15 @@ S3Error S3ObjectStore::CompleteMultipartUpload(
     return S3Error::ObjectExistAsDir;
   }
 
-  // Then we copy all the parts into a tmp file, which will be renamed to the
-  // final file.
+  // Then we make the parts into a composite object. Only if this is not
+  // possible, we copy all the parts into a tmp file, which will be renamed to
+  // the final file.
+  if (auto error = CompleteCompositeMultipartUpload(bucket, req.object,
+                                                    upload_path, opt_path,
+                                                    parts)) {
+    return *error;
+  }
+
   auto tmp_path = bucket.path /
                   ("." + req.object + "." + std::to_string(std::time(nullptr)) +
                    std::to_string(std::rand()));
@@ -1281,7 +1712,8 @@ S3Error S3ObjectStore::CompleteMultipartUpload(
     return error;
   }
 
-  XrdPosix_Rename(tmp_path.c_str(), final_path.c_str());
+  ReplaceObject(tmp_path, final_path);
+  index->Add(bucket.name, req.object);
 
   XrdPosix_Unlink(opt_path.c_str());
   DeleteMultipartUpload(bucket, key, upload_id);
@@ -8,6 +8,8 @@
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <set>
 #include <tuple>
 #include <vector>
@@ -15,6 +17,7 @@
 #include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdS3Auth.hh"
 #include "XrdS3ErrorResponse.hh"
+#include "XrdS3Index.hh"
 #include "XrdS3Req.hh"
 
 namespace S3 {
@@ -73,7 +76,19 @@ class S3ObjectStore {
     Object() = default;
     ~Object();
 
-    S3Error Init(const std::filesystem::path &path);
+    //! A range of a composite object, stored at offset in the file at path
+    //! (relative to the composite directory).
+    struct Extent {
+      std::string path;
+      off_t offset;
+      size_t length;
+      size_t start;  // offset of the range in the object
+    };
+
+    //! mtpu_path is the multipart upload directory, the composite directory
+    //! of the object is recorded relative to it.
+    S3Error Init(const std::filesystem::path &path,
+                 const std::filesystem::path &mtpu_path = {});
 
     [[nodiscard]] ssize_t GetSize() const { return size; };
     [[nodiscard]] size_t BufferSize() const { return buffer_size; };
@@ -81,12 +96,21 @@ class S3ObjectStore {
     ssize_t Read(size_t length, char **data);
     off_t Lseek(off_t offset, int whence);
 
+    //! Whether the object is a composite object made of so many small parts
+    //! that it should be rewritten as a plain file.
+    [[nodiscard]] bool NeedsCompaction() const {
+      return Fragmented(size, extents.size());
+    }
+
     const std::map<std::string, std::string> &GetAttributes() const {
       return attributes;
     };
 
    private:
     static constexpr size_t MAX_BUFFSIZE = 32000000;
+
+    ssize_t ReadComposite(size_t length, char **data);
+
     bool init{};
     std::vector<char> buffer{};
     std::string name{};
@@ -95,6 +119,12 @@ class S3ObjectStore {
     time_t last_modified{};
     int fd{};
     std::map<std::string, std::string> attributes{};
+    // Composite objects only: the directory holding the parts, the parts
+    // themselves, the current position and the extent open on fd.
+    std::filesystem::path composite{};
+    std::vector<Extent> extents{};
+    size_t pos{};
+    size_t current{};
   };
 
   S3Error CreateBucket(S3Auth &auth, S3Auth::Bucket bucket,
@@ -183,11 +213,32 @@ class S3ObjectStore {
  private:
   static bool ValidateBucketName(const std::string &name);
 
+  // Composite objects made of parts smaller than this on average are
+  // compacted.
+  static constexpr size_t COMPACT_PART_SIZE = 8 * 1024 * 1024;
+
+  static bool Fragmented(size_t size, size_t parts) {
+    return parts > 1 && size / parts < COMPACT_PART_SIZE;
+  }
+
+  int ReplaceObject(const std::filesystem::path &tmp_path,
+                    const std::filesystem::path &final_path) const;
+  static void RemoveComposite(const std::filesystem::path &composite);
+  static void CompactObject(const std::filesystem::path &mtpu_path,
+                            const std::filesystem::path &path);
+
+  // Rewrites fragmented composite objects as plain files in the background.
+  class Compactor;
+
   std::filesystem::path config_path;
   std::filesystem::path user_map;
 
   std::filesystem::path mtpu_path;
 
+  // Shared so that copies of the store (see S3Api) use the same index.
+  std::shared_ptr<S3Index> index = std::make_shared<S3Index>();
+  std::shared_ptr<Compactor> compactor;
+
   ListObjectsInfo ListObjectsCommon(
       const S3Auth::Bucket &bucket, std::string prefix,
       const std::string &marker, char delimiter, int max_keys,
@@ -217,10 +268,14 @@ class S3ObjectStore {
                                 const std::string &key,
                                 const std::string &upload_id);
 
-  static bool CompleteOptimizedMultipartUpload(
+  std::optional<S3Error> CompleteCompositeMultipartUpload(
+      const S3Auth::Bucket &bucket, const std::string &key,
+      const std::filesystem::path &upload_path, const std::string &opt_path,
+      const std::vector<PartInfo> &parts);
+  bool CompleteOptimizedMultipartUpload(
       const std::filesystem::path &final_path,
       const std::filesystem::path &tmp_path,
-      const std::vector<PartInfo> &parts);
+      const std::vector<PartInfo> &parts) const;
 };
 
 }  // namespace S3
@@ -0,0 +1,215 @@
+//
+// Hashing and writing of the uploaded objects.
+//
+
+#include "XrdS3UploadPipeline.hh"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "XrdCks/XrdCksCalcmd5.hh"
+#include "XrdPosix/XrdPosixExtern.hh"
+
+namespace S3 {
+
+namespace {
+
+// The threads running the stages of all the uploads. Their number is fixed, so
+// that it does not grow with the number of concurrent uploads. A job never
+// waits for another one, so the uploads always make progress.
+class UploadWorkers {
+ public:
+  static UploadWorkers &Instance() {
+    static UploadWorkers workers;
+    return workers;
+  }
+
+  void Schedule(std::function<void()> job) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      jobs.push_back(std::move(job));
+    }
+    cond.notify_one();
+  }
+
+  unsigned Size() const { return threads.size(); }
+
+ private:
+  // At least one thread per stage, so that the stages of an upload overlap.
+  static constexpr unsigned kMinWorkers = 3;
+  static constexpr unsigned kMaxWorkers = 16;
+
+  UploadWorkers() {
+    auto n = std::clamp(std::thread::hardware_concurrency(), kMinWorkers,
+                        kMaxWorkers);
+    for (unsigned i = 0; i < n; i++) {
+      threads.emplace_back(&UploadWorkers::Run, this);
+    }
+  }
+
+  ~UploadWorkers() {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cond.notify_all();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+
+      auto job = std::move(jobs.front());
+      jobs.pop_front();
+      lock.unlock();
+      job();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<std::function<void()>> jobs;
+  bool stopping = false;
+  std::vector<std::thread> threads;
+};
+
+}  // namespace
+
+S3UploadPipeline::~S3UploadPipeline() {
+  // The upload failed, there is no point in writing what is left.
+  failed = true;
+  Wait();
+}
+
+unsigned S3UploadPipeline::Workers() {
+  return UploadWorkers::Instance().Size();
+}
+
+bool S3UploadPipeline::Append(const char *data, size_t len) {
+  while (len > 0 && !failed) {
+    auto &buf = buffers[submitted % kBuffers];
+    if (!buf.data) {
+      void *ptr;
+      if (posix_memalign(&ptr, sysconf(_SC_PAGESIZE), kBufferSize)) {
+        return false;
+      }
+      buf.data.reset(static_cast<char *>(ptr));
+    }
+
+    auto n = std::min(len, kBufferSize - buf.len);
+    memcpy(buf.data.get() + buf.len, data, n);
+    buf.len += n;
+    data += n;
+    len -= n;
+
+    if (buf.len == kBufferSize) {
+      Submit(true);
+    }
+  }
+  return !failed;
+}
+
+bool S3UploadPipeline::Finish() {
+  auto &buf = buffers[submitted % kBuffers];
+
+  if (!submitted) {
+    if (buf.len) {
+      for (int stage = 0; stage < kStages; stage++) {
+        Process(static_cast<Stage>(stage), buf);
+      }
+    }
+  } else {
+    if (buf.len) {
+      Submit(false);
+    }
+    Wait();
+  }
+  return !failed;
+}
+
+void S3UploadPipeline::Process(Stage stage, const Buffer &buf) {
+  switch (stage) {
+    case kMD5:
+      md5XS.Update(buf.data.get(), buf.len);
+      break;
+    case kSHA256:
+      sha256XS.Update(buf.data.get(), buf.len);
+      break;
+    default:
+      for (size_t off = 0; off < buf.len && !failed;) {
+        auto n = XrdPosix_Write(fd, buf.data.get() + off, buf.len - off);
+        if (n <= 0) {
+          failed = true;
+        } else {
+          off += n;
+        }
+      }
+  }
+}
+
+// Process the submitted buffers through the stage, in order.
+void S3UploadPipeline::Run(Stage stage) {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (processed[stage] < submitted) {
+    auto n = processed[stage];
+    lock.unlock();
+
+    // The buffer is not reused until every stage has processed it.
+    Process(stage, buffers[n % kBuffers]);
+
+    lock.lock();
+    processed[stage] = n + 1;
+    cond.notify_all();
+  }
+
+  // The pipeline may be gone as soon as the lock is released.
+  running[stage] = false;
+  cond.notify_all();
+}
+
+// Hand the current buffer to the stages, and optionally wait for the next one
+// to be free.
+void S3UploadPipeline::Submit(bool wait) {
+  std::unique_lock<std::mutex> lock(mutex);
+  submitted++;
+  for (int stage = 0; stage < kStages; stage++) {
+    if (!running[stage]) {
+      running[stage] = true;
+      UploadWorkers::Instance().Schedule(
+          [this, stage] { Run(static_cast<Stage>(stage)); });
+    }
+  }
+
+  if (wait) {
+    cond.wait(lock, [this] {
+      return *std::min_element(processed, processed + kStages) + kBuffers >
+             submitted;
+    });
+    buffers[submitted % kBuffers].len = 0;
+  }
+}
+
+// Wait for the workers to be done with the pipeline.
+void S3UploadPipeline::Wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  cond.wait(lock, [this] {
+    return std::none_of(running, running + kStages,
+                        [](bool r) { return r; });
+  });
+}
+
+}  // namespace S3
@@ -0,0 +1,77 @@
+//
+// Hashing and writing of the uploaded objects.
+//
+
+#ifndef XROOTD_XRDS3UPLOADPIPELINE_HH
+#define XROOTD_XRDS3UPLOADPIPELINE_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+#include "XrdS3Crypt.hh"
+
+class XrdCksCalcmd5;
+
+namespace S3 {
+
+//! The body of an upload on its way from the HTTP link to the file. The data
+//! must be copied out of the link buffer, which is reused by the next read, so
+//! it is copied into a ring of page-aligned buffers. Each full buffer is then
+//! hashed (MD5 and SHA256) and written to disk by a set of worker threads
+//! shared by all the uploads, while the request thread receives the next one.
+//! Uploads that fit in a single buffer are entirely processed on the request
+//! thread.
+class S3UploadPipeline {
+ public:
+  S3UploadPipeline(XrdCksCalcmd5 &md5XS, S3Crypt::S3SHA256 &sha256XS, int fd)
+      : md5XS(md5XS), sha256XS(sha256XS), fd(fd) {}
+
+  ~S3UploadPipeline();
+
+  //! Append data to the upload. Returns false if the data cannot be stored.
+  bool Append(const char *data, size_t len);
+
+  //! Wait for all the appended data to be processed. Returns false if it could
+  //! not all be written.
+  bool Finish();
+
+  //! Number of worker threads shared by the uploads.
+  static unsigned Workers();
+
+  static constexpr size_t kBufferSize = 4 * 1024 * 1024;
+  static constexpr size_t kBuffers = 4;
+
+ private:
+  enum Stage { kMD5, kSHA256, kWrite, kStages };
+
+  struct Buffer {
+    std::unique_ptr<char, decltype(&free)> data{nullptr, &free};
+    size_t len = 0;
+  };
+
+  void Process(Stage stage, const Buffer &buf);
+  void Run(Stage stage);
+  void Submit(bool wait);
+  void Wait();
+
+  XrdCksCalcmd5 &md5XS;
+  S3Crypt::S3SHA256 &sha256XS;
+  int fd;
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  Buffer buffers[kBuffers];
+  // Number of buffers handed to the stages, and processed by each stage.
+  size_t submitted = 0;
+  size_t processed[kStages] = {};
+  // Whether a worker is running the stage, or is about to.
+  bool running[kStages] = {};
+  std::atomic<bool> failed{false};
+};
+
+}  // namespace S3
+
+#endif  // XROOTD_XRDS3UPLOADPIPELINE_HH
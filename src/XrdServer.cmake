@@ -68,6 +68,7 @@ add_library(
 #-------------------------------------------------------------------------------
   XrdOfs/XrdOfs.cc              XrdOfs/XrdOfs.hh
   XrdOfs/XrdOfsChkPnt.cc        XrdOfs/XrdOfsChkPnt.hh
+  XrdOfs/XrdOfsCksWrt.cc        XrdOfs/XrdOfsCksWrt.hh
   XrdOfs/XrdOfsConfig.cc
   XrdOfs/XrdOfsConfigCP.cc      XrdOfs/XrdOfsConfigCP.hh
   XrdOfs/XrdOfsConfigPI.cc      XrdOfs/XrdOfsConfigPI.hh
@@ -30,6 +30,7 @@ XrdSsi/XrdSsiErrInfo.cc                XrdSsi/XrdSsiErrInfo.hh
 XrdSsi/XrdSsiEvent.cc                  XrdSsi/XrdSsiEvent.hh
 XrdSsi/XrdSsiFileResource.cc           XrdSsi/XrdSsiFileResource.hh
 XrdSsi/XrdSsiLogger.cc                 XrdSsi/XrdSsiLogger.hh
+                                       XrdSsi/XrdSsiPool.hh
                                        XrdSsi/XrdSsiProvider.hh
                                        XrdSsi/XrdSsiRRAgent.hh
                                        XrdSsi/XrdSsiRRInfo.hh
@@ -92,10 +92,7 @@ const char     *reqstID[XrdSsiFileReq::rsEnd] =
 /*                        S t a t i c   M e m b e r s                         */
 /******************************************************************************/
   
-XrdSysMutex     XrdSsiFileReq::aqMutex;
-XrdSsiFileReq  *XrdSsiFileReq::freeReq = 0;
-int             XrdSsiFileReq::freeCnt = 0;
-int             XrdSsiFileReq::freeMax = 256;
+XrdSsiPool<XrdSsiFileReq> XrdSsiFileReq::freePool(256);
 
 /******************************************************************************/
 /*                              A c t i v a t e                               */
@@ -199,18 +196,10 @@ XrdSsiFileReq *XrdSsiFileReq::Alloc(XrdOucErrInfo      *eiP,
 {
    XrdSsiFileReq *nP;
 
-// Check if we can grab this from out queue
+// Check if we can grab this from our pool, preferably the one for this thread
 //
-   aqMutex.Lock();
-   if ((nP = freeReq))
-      {freeCnt--;
-       freeReq = nP->nextReq;
-       aqMutex.UnLock();
-       nP->Init(cID);
-      } else {
-       aqMutex.UnLock();
-       nP = new XrdSsiFileReq(cID);
-      }
+   if ((nP = freePool.Get())) nP->Init(cID);
+      else nP = new XrdSsiFileReq(cID);
 
 // Initialize for processing
 //
@@ -546,7 +535,7 @@ void XrdSsiFileReq::Init(const char *cID)
 {
    tident     = (cID ? strdup(cID) : strdup("???"));
    finWait    = 0;
-   nextReq    = 0;
+   poolNext   = 0;
    cbInfo     = 0;
    respCB     = 0;
    respCBarg  = 0;
@@ -557,6 +546,8 @@ void XrdSsiFileReq::Init(const char *cID)
    oucBuff    = 0;
    sfsBref    = 0;
    strBuff    = 0;
+   strmFD     = -1;
+   strmErr.Clr();
    reqSize    = 0;
    respBuf    = 0;
    respOff    = 0;
@@ -615,7 +606,7 @@ bool XrdSsiFileReq::ProcessResponse(const XrdSsiErrInfo  &eInfo,
                break;
           case XrdSsiRespInfo::isStream:
                DEBUGXQ("Resp strm");
-               respLen = 0;
+               fileSz  = 0; // Also does respLen = 0;
                Stats.Bump(Stats.RspStrm);
                break;
           default:
@@ -693,6 +684,12 @@ XrdSfsXferSize XrdSsiFileReq::Read(bool           &done,      // Out
                return nbytes;
                break;
           case XrdSsiRespInfo::isStream:
+               if (Resp->strmP->Type() == XrdSsiStream::isFile)
+                  {nbytes = readStrmF((XrdSsiFileStream *)Resp->strmP,
+                                      buff, blen);
+                   done = strmEOF && fileSz <= 0;
+                   return nbytes;
+                  }
                nbytes = (Resp->strmP->Type() == XrdSsiStream::isActive ?
                          readStrmA(Resp->strmP, buff, blen)
                       :  readStrmP(Resp->strmP, buff, blen));
@@ -752,6 +749,67 @@ do{if (strBuff)
    return Emsg(epname, eObj, "read stream");
 }
 
+/******************************************************************************/
+/* Private:                    r e a d S t r m F                              */
+/******************************************************************************/
+
+XrdSfsXferSize XrdSsiFileReq::readStrmF(XrdSsiFileStream *strmP,
+                                        char *buff, XrdSfsXferSize blen)
+{
+   static const char *epname = "readStrmF";
+   XrdSsiErrInfo  eObj;
+   XrdSfsXferSize xlen = 0;
+   ssize_t nbytes;
+
+// Report the error held back by the previous call as it had data to return
+//
+   if (strmErr.hasError())
+      {myState = erRsp; strmEOF = true;
+       return Emsg(epname, strmErr, "read stream");
+      }
+
+// This path is only taken when the data cannot be sent directly from the file
+// (e.g. the connection is encrypted). Copy out data from successive file
+// regions to fill the buffer.
+//
+   while(blen)
+        {if (fileSz <= 0)
+            {if (strmEOF
+             || !strmP->GetFile(eObj, strmFD, respOff, fileSz, strmEOF)) break;
+             if (fileSz <= 0)
+                {fileSz = 0;
+                 if (strmEOF) break;
+                 eObj.Set("Invalid file region", EINVAL);
+                 break;
+                }
+            }
+         nbytes = pread(strmFD, buff, (fileSz < blen ? fileSz : blen), respOff);
+         if (nbytes <= 0)
+            {if (xlen) return xlen; // The next call gets the error again
+             myState = erRsp; strmEOF = true; fileSz = 0;
+             return Emsg(epname, (nbytes ? errno : ENODATA), "read");
+            }
+         respOff += nbytes; fileSz -= nbytes;
+         xlen    += nbytes; buff   += nbytes; blen -= nbytes;
+        }
+
+// Check if we have data to return
+//
+   if (!blen) return xlen;
+   if (strmEOF) {myState = odRsp; return xlen;}
+
+// The stream failed. The data already copied is returned and the error is
+// reported by the next call.
+//
+   if (!eObj.hasError()) eObj.Set("Invalid file stream", EFAULT);
+   if (xlen) {strmErr = eObj; return xlen;}
+
+// Report the error
+//
+   myState = erRsp; strmEOF = true;
+   return Emsg(epname, eObj, "read stream");
+}
+
 /******************************************************************************/
 /* Private:                    r e a d S t r m P                              */
 /******************************************************************************/
@@ -797,18 +855,12 @@ void XrdSsiFileReq::Recycle()
    else if (sfsBref) {XrdSfsXio::Reclaim(sfsBref); sfsBref = 0;}
    reqSize = 0;
 
-// Add to queue unless we have too many of these. If we add it back to the
-// queue; make sure it's a cleaned up object!
+// Add to the pool which deletes the object if it has too many of these. If we
+// add it back to the pool; make sure it's a cleaned up object!
 //
-   aqMutex.Lock();
    if (tident) {free(tident); tident = 0;}
-   if (freeCnt >= freeMax) {aqMutex.UnLock(); delete this;}
-      else {XrdSsiRRAgent::CleanUp(*this);
-            nextReq = freeReq;
-            freeReq = this;
-            freeCnt++;
-            aqMutex.UnLock();
-           }
+   XrdSsiRRAgent::CleanUp(*this);
+   freePool.Put(this);
 }
 
 /******************************************************************************/
@@ -875,6 +927,9 @@ int XrdSsiFileReq::Send(XrdSfsDio *sfDio, XrdSfsXferSize blen)
                break;
           case XrdSsiRespInfo::isStream:
                if (Resp->strmP->Type() == XrdSsiStream::isPassive) return 1;
+               if (Resp->strmP->Type() == XrdSsiStream::isFile)
+                  return sendStrmF((XrdSsiFileStream *)Resp->strmP,
+                                   sfDio, blen);
                return sendStrmA(Resp->strmP, sfDio, blen);
                break;
           default: myState = erRsp;
@@ -954,6 +1009,61 @@ int XrdSsiFileReq::sendStrmA(XrdSsiStream *strmP,
    return Emsg(epname, rc, "send");
 }
   
+/******************************************************************************/
+/* Private:                    s e n d S t r m F                              */
+/******************************************************************************/
+
+int XrdSsiFileReq::sendStrmF(XrdSsiFileStream *strmP,
+                             XrdSfsDio *sfDio, XrdSfsXferSize blen)
+{
+   static const char *epname = "sendStrmF";
+   XrdSsiErrInfo  eObj;
+   XrdOucSFVec    sfVec[2];
+   int rc;
+
+// Check if we need another file region. At the end of the stream we return a
+// continuation so that Read() reports the end of the response.
+//
+   if (fileSz <= 0)
+      {if (strmEOF
+       || !strmP->GetFile(eObj, strmFD, respOff, fileSz, strmEOF)
+       || fileSz <= 0)
+          {fileSz = 0;
+           if (strmEOF) {myState = odRsp; return 1;}
+           if (!eObj.hasError()) eObj.Set("Invalid file region", EINVAL);
+           myState = erRsp; strmEOF = true;
+           return Emsg(epname, eObj, "read stream");
+          }
+      }
+
+// Complete the sendfile vector. The data goes directly from the file to the
+// network without passing through any of our buffers.
+//
+   sfVec[1].offset = respOff;
+   sfVec[1].fdnum  = strmFD;
+   if (fileSz > blen)
+      {sfVec[1].sendsz = blen;
+       fileSz -= blen; respOff += blen;
+      } else {
+       sfVec[1].sendsz = fileSz;
+       respOff += fileSz; fileSz = 0;
+      }
+
+// Send off the data
+//
+   rc = sfDio->SendFile(sfVec, 2);
+
+// If send succeeded, indicate the action to be taken
+//
+   if (!rc) return myState != odRsp;
+
+// The send failed, diagnose the problem
+//
+   rc = (rc < 0 ? EIO : EFAULT);
+   myState = erRsp; strmEOF = true;
+   return Emsg(epname, rc, "send");
+}
+  
 /******************************************************************************/
 /*                          W a n t R e s p o n s e                           */
 /******************************************************************************/
@@ -36,6 +36,7 @@
 #include "Xrd/XrdScheduler.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
 #include "XrdSfs/XrdSfsXio.hh"
+#include "XrdSsi/XrdSsiPool.hh"
 #include "XrdSsi/XrdSsiRequest.hh"
 #include "XrdSsi/XrdSsiResponder.hh"
 #include "XrdSsi/XrdSsiStream.hh"
@@ -52,6 +53,8 @@ class  XrdSsiStream;
 
 class XrdSsiFileReq : public XrdSsiRequest, public XrdOucEICB, public XrdJob
 {
+friend class XrdSsiPool<XrdSsiFileReq>;
+
 public:
 
 
@@ -86,7 +89,7 @@ static  XrdSsiFileReq *Alloc(XrdOucErrInfo  *eP, XrdSsiFileResource *rP,
 
         int            Send(XrdSfsDio *sfDio, XrdSfsXferSize size);
 
-static  void           SetMax(int mVal) {freeMax = mVal;}
+static  void           SetMax(int mVal) {freePool.SetMax(mVal);}
 
         bool           WantResponse(XrdOucErrInfo &eInfo);
 
@@ -122,20 +125,21 @@ int                    Emsg(const char *pfx, XrdSsiErrInfo &eObj,
 void                   Init(const char *cID=0);
 XrdSfsXferSize         readStrmA(XrdSsiStream *strmP, char *buff,
                                  XrdSfsXferSize blen);
+XrdSfsXferSize         readStrmF(XrdSsiFileStream *strmP, char *buff,
+                                 XrdSfsXferSize blen);
 XrdSfsXferSize         readStrmP(XrdSsiStream *strmP, char *buff,
                                  XrdSfsXferSize blen);
 int                    sendStrmA(XrdSsiStream *strmP, XrdSfsDio *sfDio,
                                  XrdSfsXferSize blen);
+int                    sendStrmF(XrdSsiFileStream *strmP, XrdSfsDio *sfDio,
+                                 XrdSfsXferSize blen);
 void                   Recycle();
 void                   WakeUp(XrdSsiAlert *aP=0);
 
-static XrdSysMutex     aqMutex;
-static XrdSsiFileReq  *freeReq;
-static int             freeCnt;
-static int             freeMax;
+static XrdSsiPool<XrdSsiFileReq> freePool;
 
 XrdSsiMutex            frqMutex;
-XrdSsiFileReq         *nextReq;
+XrdSsiFileReq         *poolNext;
 XrdSysSemaphore       *finWait;
 XrdOucEICB            *respCB;
 unsigned long long     respCBarg;
@@ -157,6 +161,8 @@ union {long long       fileSz;
 XrdSfsXioHandle        sfsBref;
 XrdOucBuffer          *oucBuff;
 XrdSsiStream::Buffer  *strBuff;
+XrdSsiErrInfo          strmErr;
+int                    strmFD;
 reqState               myState;
 rspState               urState;
 int                    reqSize;
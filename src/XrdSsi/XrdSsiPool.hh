@@ -0,0 +1,157 @@
+#ifndef __XRDSSIPOOL_HH__
+#define __XRDSSIPOOL_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d S s i P o o l . h h                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdSys/XrdSysPthread.hh"
+
+//-----------------------------------------------------------------------------
+//! The XrdSsiPool class keeps a free list of objects for reuse. Freed objects
+//! first go to a small cache owned by the calling thread, which is used without
+//! any locking. Only when a thread cache overflows or runs dry are objects
+//! moved, in batches, to or from a global list protected by a mutex. Objects
+//! are linked through the member pointer given as the second template argument.
+//! There should be a single pool for each object type as the thread caches are
+//! shared by all pools of the same type.
+//!
+//! The thread caches are not counted against the maximum of the global list,
+//! so the pool may hold up to freeMax + lclMax objects per thread that uses it.
+//-----------------------------------------------------------------------------
+
+template<class T>
+class XrdSsiPool
+{
+public:
+
+//-----------------------------------------------------------------------------
+//! Obtain a free object.
+//!
+//! @return !0    Pointer to a previously freed object.
+//! @return =0    No object is available; the caller must allocate one.
+//-----------------------------------------------------------------------------
+
+T      *Get()
+           {Cache &lc = lclCache;
+            T *item;
+            if (!lc.head) Refill(lc);
+            if ((item = lc.head)) {lc.head = item->poolNext; lc.num--;}
+            return item;
+           }
+
+//-----------------------------------------------------------------------------
+//! Return an object to the pool. It is kept in the thread cache; when the
+//! cache overflows, half of it moves to the global list and the objects that
+//! do not fit there are deleted.
+//!
+//! @param  item  Pointer to the object being freed.
+//-----------------------------------------------------------------------------
+
+void    Put(T *item)
+           {Cache &lc = lclCache;
+            if (freeMax <= 0) {delete item; return;}
+            lc.pool    = this;
+            item->poolNext = lc.head; lc.head = item; lc.num++;
+            if (lc.num > lclMax) Drain(lc, lclMax/2);
+           }
+
+//-----------------------------------------------------------------------------
+//! Set the maximum number of objects held in the global list.
+//!
+//! @param  mval  The maximum. A value of zero or less disables pooling. The
+//!               thread caches come on top of it (see the class description).
+//-----------------------------------------------------------------------------
+
+void    SetMax(int mval) {freeMax = mval;}
+
+//-----------------------------------------------------------------------------
+//! Constructor
+//!
+//! @param  fmax  The maximum number of objects held in the global list.
+//! @param  lmax  The maximum number of objects cached by each thread, in
+//!               addition to the global list.
+//-----------------------------------------------------------------------------
+
+        XrdSsiPool(int fmax, int lmax=16)
+                  : freeList(0), freeCnt(0), freeMax(fmax),
+                    lclMax(lmax > 1 ? lmax : 2) {}
+
+//-----------------------------------------------------------------------------
+//! Destructor. Objects still in the pool are intentionally not deleted as the
+//! pool is expected to live until the process exits.
+//-----------------------------------------------------------------------------
+
+       ~XrdSsiPool() {}
+
+private:
+
+struct Cache {XrdSsiPool *pool; T *head; int num;
+
+              Cache() : pool(0), head(0), num(0) {}
+             ~Cache() {if (pool && num) pool->Drain(*this, 0);}
+             };
+
+// Move objects from the thread cache to the global list leaving at most keep
+// objects in the cache. Objects that do not fit are deleted.
+//
+void    Drain(Cache &lc, int keep)
+             {T *item, *zList = 0;
+              freeMutex.Lock();
+              while(lc.num > keep)
+                   {item = lc.head; lc.head = item->poolNext; lc.num--;
+                    if (freeCnt < freeMax)
+                       {item->poolNext = freeList; freeList = item; freeCnt++;}
+                       else {item->poolNext = zList; zList = item;}
+                   }
+              freeMutex.UnLock();
+              while((item = zList)) {zList = item->poolNext; delete item;}
+             }
+
+// Move a batch of objects from the global list to an empty thread cache.
+//
+void    Refill(Cache &lc)
+              {T *item;
+               freeMutex.Lock();
+               while(lc.num < lclMax/2 && (item = freeList))
+                    {freeList = item->poolNext; freeCnt--;
+                     item->poolNext = lc.head; lc.head = item; lc.num++;
+                    }
+               freeMutex.UnLock();
+              }
+
+static thread_local Cache lclCache;
+
+XrdSysMutex  freeMutex;
+T           *freeList;
+int          freeCnt;
+int          freeMax;
+int          lclMax;
+};
+
+template<class T>
+thread_local typename XrdSsiPool<T>::Cache XrdSsiPool<T>::lclCache;
+#endif
@@ -29,10 +29,20 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
-#include <map>
+#include <atomic>
 #include <cstdint>
 
 #include "XrdSsi/XrdSsiAtomics.hh"
+
+//-----------------------------------------------------------------------------
+//! The request table maps request ID's to the request object in a session.
+//! The first request added to an empty table is kept apart from the others so
+//! that the common case of a single request per session can be looked up
+//! without taking the table lock. This slot is published using a sequence
+//! counter (i.e. a seqlock); a reader that races with an update simply falls
+//! back to the locked path. All other requests are kept in a flat, open
+//! addressed hash table using linear probing and backward shift deletion.
+//-----------------------------------------------------------------------------
   
 template<class T>
 class XrdSsiRRTable
@@ -40,61 +50,155 @@ class XrdSsiRRTable
 public:
 
 void  Add(T *item, uint64_t itemID)
-         {rrtMutex.Lock();
-          if (baseItem != 0) theMap[itemID] = item;
-             else {baseKey  = itemID;
-                   baseItem = item;
-                  }
-          rrtMutex.UnLock();
+         {XrdSsiMutexMon lck(rrtMutex);
+          if (baseItem.load(std::memory_order_relaxed) != 0) Insert(item, itemID);
+             else SetBase(item, itemID);
          }
 
-void  Clear() {rrtMutex.Lock(); theMap.clear(); rrtMutex.UnLock();}
+void  Clear() {XrdSsiMutexMon lck(rrtMutex); Zap();}
 
 void  Del(uint64_t itemID, bool finit=false)
          {XrdSsiMutexMon lck(rrtMutex);
-          if (baseItem && baseKey == itemID)
-             {if (finit) baseItem->Finalize();
-              baseItem = 0;
+          T *item = baseItem.load(std::memory_order_relaxed);
+          if (item && baseKey.load(std::memory_order_relaxed) == itemID)
+             {if (finit) item->Finalize();
+              SetBase(0, 0);
              } else {
-              if (!finit) theMap.erase(itemID);
-                 else {typename std::map<uint64_t,T*>::iterator it = theMap.find(itemID);
-                       if (it != theMap.end()) it->second->Finalize();
-                       theMap.erase(it);
-                      }
+              int slot = Find(itemID);
+              if (slot >= 0)
+                 {if (finit) theTab[slot].item->Finalize();
+                  Remove(slot);
+                 }
              }
          }
 
 T    *LookUp(uint64_t itemID)
-            {XrdSsiMutexMon lck(rrtMutex);
-             if (baseItem && baseKey == itemID) return baseItem;
-             typename std::map<uint64_t,T*>::iterator it = theMap.find(itemID);
-             return (it == theMap.end() ? 0 : it->second);
+            {unsigned int seq = baseSeq.load(std::memory_order_acquire);
+             if (!(seq & 1))
+                {T       *item = baseItem.load(std::memory_order_relaxed);
+                 uint64_t bKey = baseKey.load(std::memory_order_relaxed);
+                 unsigned int tNum = tabNum.load(std::memory_order_relaxed);
+                 std::atomic_thread_fence(std::memory_order_acquire);
+                 if (baseSeq.load(std::memory_order_relaxed) == seq)
+                    {if (item && bKey == itemID) return item;
+                     if (!tNum) return 0;
+                    }
+                }
+             XrdSsiMutexMon lck(rrtMutex);
+             T *item = baseItem.load(std::memory_order_relaxed);
+             if (item && baseKey.load(std::memory_order_relaxed) == itemID)
+                return item;
+             int slot = Find(itemID);
+             return (slot < 0 ? 0 : theTab[slot].item);
             }
 
-int   Num() {return theMap.size() + (baseItem ? 1 : 0);}
+int   Num() {return static_cast<int>(tabNum.load(std::memory_order_relaxed))
+                  + (baseItem.load(std::memory_order_relaxed) ? 1 : 0);
+            }
 
 void  Reset()
            {XrdSsiMutexMon lck(rrtMutex);
-            typename std::map<uint64_t, T*>::iterator it = theMap.begin();
-            while(it != theMap.end())
-                 {it->second->Finalize();
-                  it++;
-                 }
-            theMap.clear();
-            if (baseItem)
-               {baseItem->Finalize();
-                baseItem = 0;
+            for (unsigned int i = 0; i < tabSize; i++)
+                if (theTab[i].item) theTab[i].item->Finalize();
+            Zap();
+            T *item = baseItem.load(std::memory_order_relaxed);
+            if (item)
+               {item->Finalize();
+                SetBase(0, 0);
                }
            }
 
-      XrdSsiRRTable() : baseItem(0), baseKey(0) {}
+      XrdSsiRRTable() : baseSeq(0), baseItem(0), baseKey(0), theTab(0),
+                        tabSize(0), tabNum(0) {}
 
-     ~XrdSsiRRTable() {Reset();}
+     ~XrdSsiRRTable() {Reset(); delete [] theTab;}
 
 private:
-XrdSsiMutex              rrtMutex;
-T                       *baseItem;
-uint64_t                 baseKey;
-std::map<uint64_t, T*>   theMap;
+
+struct TabEnt {uint64_t key; T *item;};
+
+// All of the following methods must be called with rrtMutex held.
+//
+int   Find(uint64_t itemID)
+          {if (!tabNum.load(std::memory_order_relaxed)) return -1;
+           unsigned int i = Hash(itemID);
+           while(theTab[i].item)
+                {if (theTab[i].key == itemID) return static_cast<int>(i);
+                 i = (i + 1) & (tabSize - 1);
+                }
+           return -1;
+          }
+
+unsigned int Hash(uint64_t itemID)
+                 {return static_cast<unsigned int>
+                         ((itemID * 0x9e3779b97f4a7c15ULL) >> 32) & (tabSize-1);
+                 }
+
+void  Insert(T *item, uint64_t itemID)
+            {int slot = Find(itemID);
+             if (slot >= 0) {theTab[slot].item = item; return;}
+             if ((tabNum.load(std::memory_order_relaxed) + 1) * 4 > tabSize * 3)
+                Resize(tabSize ? tabSize * 2 : minSize);
+             Place(item, itemID);
+             tabNum.fetch_add(1, std::memory_order_relaxed);
+            }
+
+void  Place(T *item, uint64_t itemID)
+           {unsigned int i = Hash(itemID);
+            while(theTab[i].item) i = (i + 1) & (tabSize - 1);
+            theTab[i].key = itemID; theTab[i].item = item;
+           }
+
+// Delete an entry by shifting back any following entries in the probe
+// sequence that would otherwise become unreachable. This avoids tombstones.
+//
+void  Remove(int slot)
+            {unsigned int i = slot, j = slot, k;
+             while(true)
+                  {j = (j + 1) & (tabSize - 1);
+                   if (!theTab[j].item) break;
+                   k = Hash(theTab[j].key);
+                   if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+                      continue;
+                   theTab[i] = theTab[j];
+                   i = j;
+                  }
+             theTab[i].item = 0;
+             tabNum.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+void  Resize(unsigned int newSize)
+            {TabEnt *oldTab = theTab;
+             unsigned int oldSize = tabSize;
+             theTab  = new TabEnt[newSize]();
+             tabSize = newSize;
+             for (unsigned int i = 0; i < oldSize; i++)
+                 if (oldTab[i].item) Place(oldTab[i].item, oldTab[i].key);
+             delete [] oldTab;
+            }
+
+void  SetBase(T *item, uint64_t itemID)
+             {unsigned int seq = baseSeq.load(std::memory_order_relaxed);
+              baseSeq.store(seq+1, std::memory_order_relaxed);
+              std::atomic_thread_fence(std::memory_order_release);
+              baseKey.store(itemID, std::memory_order_relaxed);
+              baseItem.store(item,  std::memory_order_relaxed);
+              baseSeq.store(seq+2, std::memory_order_release);
+             }
+
+void  Zap()
+         {for (unsigned int i = 0; i < tabSize; i++) theTab[i].item = 0;
+          tabNum.store(0, std::memory_order_relaxed);
+         }
+
+static const unsigned int minSize = 16;
+
+XrdSsiMutex                rrtMutex;
+std::atomic<unsigned int>  baseSeq;
+std::atomic<T *>           baseItem;
+std::atomic<uint64_t>      baseKey;
+TabEnt                    *theTab;
+unsigned int               tabSize;
+std::atomic<unsigned int>  tabNum;
 };
 #endif
@@ -45,6 +45,14 @@
 //!         will be placed. Only passive streams are created on the client-side.
 //!         Passive streams can also work in asynchronous mode. However, async
 //!         mode is never used server-side but may be requested client-side.
+//! File    the stream supplies the response as a sequence of regions of one or
+//!         more open files. When the connection allows it, each region is sent
+//!         directly from the file using sendfile() and never copied into an
+//!         intermediate buffer. File streams are supported only server-side.
+//!
+//! Active stream buffers are likewise handed to the network layer as is, so
+//! large in-memory results should be supplied by an active stream rather than
+//! by a passive one which must copy the data into a server buffer.
 //!
 //! The type of stream must be declared at the time the stream is created. You
 //! must supply an implementation for the associated stream type.
@@ -139,14 +147,17 @@ virtual int     SetBuff(XrdSsiErrInfo &eRef, char *buff, int blen, bool &last)
 //!
 //! isPassive - Passive stream that provides data via a supplied buffer.
 //!             SetBuff() must be used.
+//!
+//! isFile    - Active stream that supplies data as file regions. It must be
+//!             an XrdSsiFileStream and GetFile() must be used.
 //-----------------------------------------------------------------------------
 
-        enum    StreamType {isActive = 0, isPassive};
+        enum    StreamType {isActive = 0, isPassive, isFile};
 
 //-----------------------------------------------------------------------------
 //! Get the stream type descriptor.
 //!
-//! @return The stream type, isActive or isPassive.
+//! @return The stream type, isActive, isPassive or isFile.
 //-----------------------------------------------------------------------------
 
 StreamType      Type() {return SType;}
@@ -159,4 +170,41 @@ protected:
 
 const StreamType SType;
 };
+
+//-----------------------------------------------------------------------------
+//! The XrdSsiFileStream class describes a file stream (server-side only). It
+//! is a separate class so that adding file streams left the virtual table of
+//! XrdSsiStream, and thus of existing stream implementations, unchanged.
+//-----------------------------------------------------------------------------
+
+class XrdSsiFileStream : public XrdSsiStream
+{
+public:
+
+//-----------------------------------------------------------------------------
+//! Synchronously obtain the next file region. The file descriptor must remain
+//! valid until the region has been fully sent, which is assured once GetFile()
+//! is called again or when XrdSsiResponder::Finished() is called.
+//!
+//! @param  eRef  The object to receive any error description.
+//! @param  fdnum output: the file descriptor of the file holding the data.
+//! @param  foffs output: the offset in the file where the region starts.
+//! @param  flen  output: the length of the region; it must be positive.
+//! @param  last  input:  should be set to false.
+//!               output: if true it indicates that no more data remains to be
+//!                       returned either for this call or on the next call.
+//!
+//! @return true  A region has been returned.
+//! @return false No more data remains or an error occurred:
+//!               last = true:  No more data remains.
+//!               last = false: A fatal error occurred, eRef has the reason.
+//-----------------------------------------------------------------------------
+
+virtual bool    GetFile(XrdSsiErrInfo &eRef, int &fdnum, long long &foffs,
+                        long long &flen, bool &last) = 0;
+
+                XrdSsiFileStream() : XrdSsiStream(isFile) {}
+
+virtual        ~XrdSsiFileStream() {}
+};
 #endif
@@ -122,6 +122,9 @@ private:
    virtual
    ~File();
 
+   int
+   SetDevice(const char *fileName);
+
    bool m_is_open{false};
    unique_sfs_ptr m_sfs;
    int m_uid; // A unique identifier for this user; has no meaning except for the fairshare.
@@ -130,6 +133,7 @@ private:
    std::string m_user;
    XrdThrottleManager &m_throttle;
    XrdSysError &m_eroute;
+   XrdThrottleDevice *m_device{nullptr}; // Backing device; null when not scheduling per-device
 };
 
 class FileSystem : public XrdSfsFileSystem
@@ -289,6 +293,9 @@ private:
    int
    xmaxconn(XrdOucStream &Config);
 
+   int
+   xdevice(XrdOucStream &Config);
+
    static FileSystem  *m_instance;
    XrdSysError         m_eroute;
    XrdOucTrace         m_trace;
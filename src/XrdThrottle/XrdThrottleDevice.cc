@@ -0,0 +1,91 @@
+#include "XrdThrottle/XrdThrottleDevice.hh"
+
+// Weight given to the newest sample in the service time average, as 1/N.
+static const long long svc_weight = 8;
+
+XrdThrottleDevice::XrdThrottleDevice(dev_t dev, int concurrency, long long max_wait_ms) :
+   m_dev(dev),
+   m_concurrency_limit(concurrency > 0 ? concurrency : 1),
+   m_max_wait_ns(max_wait_ms * 1000000LL)
+{
+}
+
+/*
+ * Wait until the device has a free slot.  Only requests against this device
+ * are held up; other devices have their own queue.
+ */
+void
+XrdThrottleDevice::Acquire()
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+   m_ops++;
+   if (m_active < m_concurrency_limit)
+   {
+      m_active++;
+      return;
+   }
+   m_waits++;
+   m_waiting++;
+   m_cv.wait(lock, [&]{return m_active < m_concurrency_limit;});
+   m_waiting--;
+   m_active++;
+}
+
+/*
+ * Release a slot and fold the measured service time into the average.
+ */
+void
+XrdThrottleDevice::Release(std::chrono::steady_clock::duration service)
+{
+   long long sample = std::chrono::duration_cast<std::chrono::nanoseconds>(service).count();
+   long long avg = m_service_ns.load(std::memory_order_relaxed);
+   long long next = avg ? avg + (sample - avg) / svc_weight : sample;
+   m_service_ns.store(next > 0 ? next : 1, std::memory_order_relaxed);
+
+   bool wake;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_active--;
+      wake = m_waiting > 0;
+   }
+   if (wake) m_cv.notify_one();
+}
+
+/*
+ * The number of waiting requests the device can absorb while still
+ * draining the queue within the maximum wait time.  Without a service time
+ * estimate (or a maximum wait), the queue is unbounded.
+ */
+int
+XrdThrottleDevice::MaxQueue() const
+{
+   long long svc = m_service_ns.load(std::memory_order_relaxed);
+   if (m_max_wait_ns <= 0 || svc <= 0) return -1;
+   long long depth = (m_max_wait_ns / svc) * m_concurrency_limit;
+   if (depth < m_concurrency_limit) depth = m_concurrency_limit;
+   return depth > 0x7fffffff ? 0x7fffffff : static_cast<int>(depth);
+}
+
+bool
+XrdThrottleDevice::Overloaded() const
+{
+   int max_queue = MaxQueue();
+   if (max_queue < 0) return false;
+   return m_waiting >= max_queue;
+}
+
+void
+XrdThrottleDevice::Snapshot(int &active, int &waiting, long long &svc_us,
+                            unsigned long long &ops, unsigned long long &waits,
+                            unsigned long long &refused)
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      active = m_active;
+      waiting = m_waiting;
+   }
+   svc_us = m_service_ns.load(std::memory_order_relaxed) / 1000;
+   ops = m_ops.exchange(0);
+   waits = m_waits.exchange(0);
+   refused = m_refused.exchange(0);
+}
@@ -0,0 +1,98 @@
+
+/*
+ * XrdThrottleDevice
+ *
+ * This class tracks the I/O load placed on a single backing device (as
+ * identified by st_dev; this is the same identifier the OSS layer uses for
+ * its cache filesystems in XrdOssCache_FSData::fsid).
+ *
+ * Each device has its own concurrency limit and its own wait queue.  When a
+ * device is saturated, only requests against files on that device block;
+ * requests against other devices proceed without waiting.
+ *
+ * The service time of each request is measured and kept as an exponentially
+ * weighted moving average.  It is used to bound the queue depth: if the
+ * expected time to drain the queue exceeds the configured maximum wait, the
+ * device is considered overloaded and new opens on it are refused.
+ */
+
+#ifndef __XrdThrottleDevice_hh_
+#define __XrdThrottleDevice_hh_
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+class XrdThrottleDevice
+{
+public:
+
+void        Acquire();
+
+void        Release(std::chrono::steady_clock::duration service);
+
+dev_t       Device() const {return m_dev;}
+
+int         MaxQueue() const;
+
+bool        Overloaded() const;
+
+void        Snapshot(int &active, int &waiting, long long &svc_us,
+                     unsigned long long &ops, unsigned long long &waits,
+                     unsigned long long &refused);
+
+void        Refused() {m_refused++;}
+
+            XrdThrottleDevice(dev_t dev, int concurrency, long long max_wait_ms);
+
+           ~XrdThrottleDevice() {}
+
+/*
+ * A guard object that holds a device slot for the duration of one I/O.  A
+ * null device is allowed, in which case the guard does nothing.
+ */
+class Guard
+{
+public:
+
+      Guard(XrdThrottleDevice *dev) : m_dev(dev)
+      {if (m_dev)
+          {m_dev->Acquire();
+           m_start = std::chrono::steady_clock::now();
+          }
+      }
+
+     ~Guard()
+      {if (m_dev) m_dev->Release(std::chrono::steady_clock::now() - m_start);}
+
+private:
+XrdThrottleDevice *m_dev;
+std::chrono::steady_clock::time_point m_start;
+};
+
+private:
+
+dev_t                   m_dev;
+int                     m_concurrency_limit;
+long long               m_max_wait_ns;
+
+std::mutex              m_mutex;
+std::condition_variable m_cv;
+int                     m_active{0};
+std::atomic<int>        m_waiting{0};   // Updated under m_mutex
+
+// Service time moving average, in nanoseconds.  Zero until the first
+// request completes.
+std::atomic<long long>  m_service_ns{0};
+
+// Counters for reporting; reset on each snapshot.
+std::atomic<unsigned long long> m_ops{0};
+std::atomic<unsigned long long> m_waits{0};
+std::atomic<unsigned long long> m_refused{0};
+};
+
+#endif
@@ -20,6 +20,7 @@ using namespace XrdThrottle;
 #define DO_THROTTLE(amount) \
 DO_LOADSHED \
 m_throttle.Apply(amount, 1, m_uid); \
+XrdThrottleDevice::Guard dguard(m_device); \
 XrdThrottleTimer xtimer = m_throttle.StartIOTimer();
 
 File::File(const char                     *user,
@@ -74,9 +75,35 @@ File::open(const char                *fileName,
    } else {
       m_throttle.CloseFile(m_user);
    }
+   if (retval == SFS_OK && m_throttle.IsDeviceThrottling()) {
+      retval = SetDevice(fileName);
+   }
    return retval;
 }
 
+/*
+ * Determine the device backing the open file so its I/O can be scheduled
+ * against that device's queue.  If the device is already saturated beyond
+ * what it can drain within the configured wait time, refuse the open as
+ * overloaded rather than adding to the queue.
+ */
+int
+File::SetDevice(const char *fileName)
+{
+   struct stat sbuf;
+   if (m_sfs->stat(&sbuf)) return SFS_OK;
+
+   m_device = m_throttle.GetDevice(sbuf.st_dev);
+   if (!m_device->Overloaded()) return SFS_OK;
+
+   m_device->Refused();
+   m_eroute.Emsg("File", "Backing device overloaded; refusing open of", fileName);
+   close();
+   m_device = nullptr;
+   error.setErrInfo(EUSERS, "Backing device for file is overloaded");
+   return SFS_ERROR;
+}
+
 int
 File::close()
 {
@@ -149,6 +149,7 @@ FileSystem::Configure(XrdSysError & log, XrdSfsFileSystem *native_fs)
       }
       TS_Xeq("throttle.max_open_files", xmaxopen);
       TS_Xeq("throttle.max_active_connections", xmaxconn);
+      TS_Xeq("throttle.device", xdevice);
       TS_Xeq("throttle.throttle", xthrottle);
       TS_Xeq("throttle.loadshed", xloadshed);
       TS_Xeq("throttle.trace", xtrace);
@@ -277,6 +278,58 @@ FileSystem::xthrottle(XrdOucStream &Config)
     return 0;
 }
 
+/******************************************************************************/
+/*                              x d e v i c e                                 */
+/******************************************************************************/
+
+/* Function: xdevice
+
+   Purpose:  To parse the directive: device concurrency <climit> [maxwait <ms>]
+
+             <climit>   maximum number of concurrent IO requests per backing device.
+             <ms>       maximum time, in milliseconds, a device's queue may take to
+                        drain (estimated from measured service times).  When
+                        exceeded, new opens on that device are refused as
+                        overloaded.  Zero (the default) leaves queues unbounded.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+int
+FileSystem::xdevice(XrdOucStream &Config)
+{
+    long long climit = -1, maxwait = 0;
+    char *val;
+
+    while ((val = Config.GetWord()))
+    {
+       if (strcmp("concurrency", val) == 0)
+       {
+          if (!(val = Config.GetWord()))
+             {m_eroute.Emsg("Config", "device concurrency limit not specified."); return 1;}
+          if (XrdOuca2x::a2sz(m_eroute,"device concurrency limit value",val,&climit,1)) return 1;
+       }
+       else if (strcmp("maxwait", val) == 0)
+       {
+          if (!(val = Config.GetWord()))
+             {m_eroute.Emsg("Config", "device maximum wait not specified."); return 1;}
+          if (XrdOuca2x::a2ll(m_eroute,"device maximum wait value",val,&maxwait,0)) return 1;
+       }
+       else
+       {
+          m_eroute.Emsg("Config", "Warning - unknown device option specified", val, ".");
+       }
+    }
+
+    if (climit < 0)
+    {
+        m_eroute.Emsg("Config", "must specify concurrency for device parameter.");
+        return 1;
+    }
+
+    m_throttle.SetDeviceThrottle(static_cast<int>(climit), maxwait);
+    return 0;
+}
+
 /******************************************************************************/
 /*                            x l o a d s h e d                               */
 /******************************************************************************/
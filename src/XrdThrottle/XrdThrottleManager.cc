@@ -12,6 +12,10 @@
 
 #include <sstream>
 
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
+
 const char *
 XrdThrottleManager::TraceID = "ThrottleManager";
 
@@ -354,6 +358,7 @@ XrdThrottleManager::Recompute()
 
       TRACE(DEBUG, "Recomputing fairshares for throttle.");
       RecomputeInternal();
+      if (IsDeviceThrottling() && (TRACING(TRACE_IOLOAD))) ReportDevices();
       TRACE(DEBUG, "Finished recomputing fairshares for throttle; sleeping for " << m_interval_length_seconds << " seconds.");
       XrdSysTimer::Wait(static_cast<int>(1000*m_interval_length_seconds));
    }
@@ -445,6 +450,43 @@ XrdThrottleManager::RecomputeInternal()
    m_compute_var.Broadcast();
 }
 
+/*
+ * Find (or create) the scheduling state for a backing device.
+ */
+XrdThrottleDevice *
+XrdThrottleManager::GetDevice(dev_t dev)
+{
+   const std::lock_guard<std::mutex> lock(m_device_mutex);
+   auto iter = m_devices.find(dev);
+   if (iter != m_devices.end()) return iter->second.get();
+
+   TRACE(IOLOAD, "Tracking new device " << major(dev) << ":" << minor(dev) <<
+                 " with concurrency limit " << m_dev_concurrency_limit);
+   XrdThrottleDevice *device = new XrdThrottleDevice(dev, m_dev_concurrency_limit, m_dev_max_wait_ms);
+   m_devices[dev].reset(device);
+   return device;
+}
+
+/*
+ * Log the state of each device's queue for the last interval.
+ */
+void
+XrdThrottleManager::ReportDevices()
+{
+   const std::lock_guard<std::mutex> lock(m_device_mutex);
+   for (auto &entry : m_devices)
+   {
+      int active, waiting;
+      long long svc_us;
+      unsigned long long ops, waits, refused;
+      entry.second->Snapshot(active, waiting, svc_us, ops, waits, refused);
+      TRACE(IOLOAD, "Device " << major(entry.first) << ":" << minor(entry.first) <<
+                    " active=" << active << " queued=" << waiting <<
+                    " maxqueue=" << entry.second->MaxQueue() << " svctime=" << svc_us <<
+                    "us ops=" << ops << " waited=" << waits << " refused=" << refused);
+   }
+}
+
 /*
  * Do a simple hash across the username.
  */
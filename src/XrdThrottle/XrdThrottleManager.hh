@@ -36,6 +36,7 @@
 #include <memory>
 
 #include "XrdSys/XrdSysPthread.hh"
+#include "XrdThrottle/XrdThrottleDevice.hh"
 
 class XrdSysError;
 class XrdOucTrace;
@@ -68,6 +69,13 @@ void        SetMaxOpen(unsigned long max_open) {m_max_open = max_open;}
 
 void        SetMaxConns(unsigned long max_conns) {m_max_conns = max_conns;}
 
+void        SetDeviceThrottle(int concurrency, long long max_wait_ms)
+            {m_dev_concurrency_limit = concurrency; m_dev_max_wait_ms = max_wait_ms;}
+
+bool        IsDeviceThrottling() {return m_dev_concurrency_limit > 0;}
+
+XrdThrottleDevice *GetDevice(dev_t dev);
+
 //int         Stats(char *buff, int blen, int do_sync=0) {return m_pool.Stats(buff, blen, do_sync);}
 
 static
@@ -95,6 +103,8 @@ void        Recompute();
 
 void        RecomputeInternal();
 
+void        ReportDevices();
+
 static
 void *      RecomputeBootstrap(void *pp);
 
@@ -145,6 +155,13 @@ std::unordered_map<std::string, unsigned long> m_conn_counters;
 std::unordered_map<std::string, std::unique_ptr<std::unordered_map<pid_t, unsigned long>>> m_active_conns;
 std::mutex m_file_mutex;
 
+// Per-device scheduling.  Device objects are never deleted so that open
+// files may hold on to a bare pointer.
+int         m_dev_concurrency_limit{-1};
+long long   m_dev_max_wait_ms{0};
+std::unordered_map<dev_t, std::unique_ptr<XrdThrottleDevice>> m_devices;
+std::mutex  m_device_mutex;
+
 static const char *TraceID;
 
 };
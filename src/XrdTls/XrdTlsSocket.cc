@@ -418,6 +418,38 @@ XrdTlsPeerCerts *XrdTlsSocket::getCerts(bool ver)
    return new XrdTlsPeerCerts(pcert, SSL_get_peer_cert_chain(pImpl->ssl));
 }
   
+/******************************************************************************/
+/*                            G e t S e s s i o n                             */
+/******************************************************************************/
+
+bool XrdTlsSocket::GetSession(std::string &sess)
+{
+   XrdSysMutexHelper mHelper;
+
+// Serialize call if need be
+//
+   if (pImpl->isSerial) mHelper.Lock(&(pImpl->sslMutex));
+
+// Only clients resume sessions and only sessions that are fully established
+//
+   if (!pImpl->isClient || pImpl->fatal || !SSL_is_init_finished(pImpl->ssl))
+      return false;
+
+   SSL_SESSION *session = SSL_get_session(pImpl->ssl);
+   if (!session) return false;
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+   if (!SSL_SESSION_is_resumable(session)) return false;
+#endif
+
+// Serialize the session
+//
+   int len = i2d_SSL_SESSION(session, 0);
+   if (len <= 0) return false;
+   sess.resize(len);
+   unsigned char *buff = (unsigned char *)&sess[0];
+   return i2d_SSL_SESSION(session, &buff) == len;
+}
+
 /******************************************************************************/
 /*                                  I n i t                                   */
 /******************************************************************************/
@@ -698,6 +730,45 @@ XrdTls::RC XrdTlsSocket::Read( char *buffer, size_t size, int &bytesRead )
     return XrdTls::TLS_SYS_Error;
   }
 
+/******************************************************************************/
+/*                         S e s s i o n R e u s e d                          */
+/******************************************************************************/
+
+bool XrdTlsSocket::SessionReused()
+{
+// This call modifies nothing nor does it depend on modified data once the
+// connection is esablished and doesn't need serialization.
+//
+   return SSL_session_reused(pImpl->ssl) == 1;
+}
+
+/******************************************************************************/
+/*                            S e t S e s s i o n                             */
+/******************************************************************************/
+
+bool XrdTlsSocket::SetSession(const std::string &sess)
+{
+   XrdSysMutexHelper mHelper;
+
+// Serialize call if need be
+//
+   if (pImpl->isSerial) mHelper.Lock(&(pImpl->sslMutex));
+
+   if (!pImpl->isClient || pImpl->hsDone || sess.empty()) return false;
+
+// Deserialize the session and make sure it has not expired
+//
+   const unsigned char *buff = (const unsigned char *)sess.data();
+   SSL_SESSION *session = d2i_SSL_SESSION(0, &buff, sess.size());
+   if (!session) {ERR_clear_error(); return false;}
+
+   bool aOK = SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session)
+            > time(0) && SSL_set_session(pImpl->ssl, session) == 1;
+   SSL_SESSION_free(session);
+   if (!aOK) ERR_clear_error();
+   return aOK;
+}
+
 /******************************************************************************/
 /*                            S e t T r a c e I D                             */
 /******************************************************************************/
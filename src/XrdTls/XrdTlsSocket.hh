@@ -136,6 +136,18 @@ enum HS_Mode
 
 XrdTlsPeerCerts *getCerts(bool ver=true);
 
+//------------------------------------------------------------------------
+//! Get the TLS session so that it can be resumed by a later connection to
+//! the same server (client only). With TLS 1.3 the session only becomes
+//! resumable once the server's session ticket has been read.
+//!
+//! @param  sess     - Receives the serialized session.
+//!
+//! @return True if the session can be resumed and false otherwise.
+//------------------------------------------------------------------------
+
+bool GetSession(std::string &sess);
+
 //------------------------------------------------------------------------
 //! Initialize this object to handle the specified TLS I/O mode for the
 //! given file descriptor. Should an error occur, messages are automatically
@@ -205,6 +217,25 @@ XrdTlsPeerCerts *getCerts(bool ver=true);
 
   XrdTls::RC Read( char *buffer, size_t size, int &bytesRead );
 
+//------------------------------------------------------------------------
+//! @return  :  true if the handshake resumed an earlier TLS session,
+//!             false otherwise
+//------------------------------------------------------------------------
+
+  bool SessionReused();
+
+//------------------------------------------------------------------------
+//! Offer an earlier TLS session for resumption, must be called before
+//! Connect(). The server may still decide to do a full handshake.
+//!
+//! @param  sess     - The session as obtained from GetSession().
+//!
+//! @return True if the session is valid and has not expired, false
+//!         otherwise in which case a full handshake will be done.
+//------------------------------------------------------------------------
+
+  bool SetSession(const std::string &sess);
+
 //------------------------------------------------------------------------
 //! Set the trace identifier (used when it's updated).
 //!
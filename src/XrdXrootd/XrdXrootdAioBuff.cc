@@ -94,6 +94,7 @@ XrdXrootdAioBuff *XrdXrootdAioBuff::Alloc(XrdXrootdAioTask* arp)
             aiobuff->buffP  = bP;
            }
     aiobuff->cksVec = 0;
+    aiobuff->tBeg   = 0;
     aiobuff->sfsAio.aio_buf = bP->buff;
     aiobuff->sfsAio.aio_nbytes = bP->bsize;
 
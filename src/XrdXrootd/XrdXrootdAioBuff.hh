@@ -52,14 +52,16 @@ virtual void            Recycle() override;
 
 XrdXrootdAioBuff*       next;
 
+long long               tBeg;   // Start of a timed read or 0 (see FileStats)
+
 XrdXrootdAioPgrw* const pgrwP;  // -> Derived type is of this type or 0
 
                   XrdXrootdAioBuff(XrdXrootdAioTask* tP, XrdBuffer* bP)
-                                  : pgrwP(0),     reqP(tP), buffP(bP) {}
+                                  : tBeg(0), pgrwP(0),     reqP(tP), buffP(bP) {}
 
                   XrdXrootdAioBuff(XrdXrootdAioPgrw* pgrwP,
                                    XrdXrootdAioTask* tP, XrdBuffer* bP)
-                                  : pgrwP(pgrwP), reqP(tP), buffP(bP) {}
+                                  : tBeg(0), pgrwP(pgrwP), reqP(tP), buffP(bP) {}
 protected:
 
 static const char* TraceID;
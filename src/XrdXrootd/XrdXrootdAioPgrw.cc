@@ -138,6 +138,7 @@ XrdXrootdAioPgrw *XrdXrootdAioPgrw::Alloc(XrdXrootdAioTask* arp)
        aiobuff = new XrdXrootdAioPgrw(arp, bP);
       } else {
        aiobuff->Result = 0;
+       aiobuff->tBeg   = 0;
        aiobuff->cksVec = aiobuff->pgrwP->csVec;
        aiobuff->pgrwP->reqP = arp;
       }
@@ -76,6 +76,10 @@ void XrdXrootdAioTask::Completed(XrdXrootdAioBuff *aioP)
 //
    aioMutex.Lock();
 
+// Record the service time of a timed read
+//
+   if (aioP->tBeg) {dataFile->Stats.rdTime(aioP->tBeg); aioP->tBeg = 0;}
+
 // If this request is not running and completed then take a shortcut.
 //
    if (Status == Offline && isDone)
@@ -65,13 +65,15 @@ struct MonParms
        int   monFSint;
        int   monFSopt;
        int   monFSion;
+       int   monSendQ;
 
        void  Exported() {monDest[0] = monDest[1] = 0;}
 
              MonParms() : monDest{0,0}, monMode{0,0},  monFlash(0), monFlush(0),
                           monGBval(0),  monMBval(0),   monRBval(0), monWWval(0),
                           monFbsz(0),   monIdent(3600),monRnums(0),
-                          monFSint(0),  monFSopt(0),   monFSion(0) {}
+                          monFSint(0),  monFSopt(0),   monFSion(0),
+                          monSendQ(0) {}
             ~MonParms() {if (monDest[0]) free(monDest[0]);
                          if (monDest[1]) free(monDest[1]);
                         }
@@ -147,7 +149,8 @@ bool XrdXrootdProtocol::ConfigMon(XrdProtocol_Config *pi, XrdOucEnv &xrootdEnv)
    XrdXrootdMonitor::Defaults(MP->monMBval, MP->monRBval, MP->monWWval,
                               MP->monFlush, MP->monFlash, MP->monIdent,
                               MP->monRnums, MP->monFbsz,
-                              MP->monFSint, MP->monFSopt, MP->monFSion);
+                              MP->monFSint, MP->monFSopt, MP->monFSion,
+                              MP->monSendQ);
 
 // Complete destination dependent setup
 //
@@ -184,10 +187,11 @@ bool XrdXrootdProtocol::ConfigMon(XrdProtocol_Config *pi, XrdOucEnv &xrootdEnv)
 /* Function: xmon
 
    Purpose:  Parse directive: monitor [...] [all] [auth]  [flush [io] <sec>]
-                                      [fstat <sec> [lfn] [ops] [ssq] [xfr <n>]
+                                      [fstat <sec> [hist] [lfn] [ops] [ssq] [xfr <n>]
                                       [{fbuff | fbsz} <sz>] [gbuff <sz>]
                                       [ident {<sec>|off}] [mbuff <sz>]
-                                      [rbuff <sz>] [rnums <cnt>] [window <sec>]
+                                      [rbuff <sz>] [rnums <cnt>] [sendq <cnt>]
+                                      [window <sec>]
                                       [dest [Events] <host:port>]
 
    Events: [ccm] [files] [fstat] [info] [io] [iov] [pfc] [redir] [tcpmon] [user]
@@ -198,6 +202,11 @@ bool XrdXrootdProtocol::ConfigMon(XrdProtocol_Config *pi, XrdOucEnv &xrootdEnv)
                             io is given applies only to i/o events.
          fstat  <sec>       produces an "f" stream for open & close events
                             <sec> specifies the flush interval (also see xfr)
+                            hist   - reports request size, read latency and
+                                     readv fan-out histograms along with
+                                     sequential vs random counts for open
+                                     files (every <sec>*<n> if xfr is given)
+                                     and at close.
                             lfn    - adds lfn to the open event
                             ops    - adds the ops record when the file is closed
                             ssq    - computes the sum of squares for the ops rec
@@ -210,6 +219,10 @@ bool XrdXrootdProtocol::ConfigMon(XrdProtocol_Config *pi, XrdOucEnv &xrootdEnv)
          mbuff  <sz>        size of message buffer for event trace monitoring.
          rbuff  <sz>        size of message buffer for redirection monitoring.
          rnums  <cnt>       bumber of redirections monitoring streams.
+         sendq  <cnt>       number of i/o event buffers that may be queued for
+                            sending by a dedicated thread. Buffers are sent in
+                            batches off the i/o path. Zero (the default) sends
+                            each buffer inline.
          window <sec>       time (seconds, M, H) between timing marks.
          dest               specified routing information. Up to two dests
                             may be specified.
@@ -278,7 +291,8 @@ int XrdXrootdProtocol::xmon(XrdOucStream &Config)
                    if (XrdOuca2x::a2tm(eDest,"monitor fstat",val,
                                              &MP->monFSint,0)) return 1;
                    while((val = Config.GetWord()))
-                        if (!strcmp("lfn", val)) MP->monFSopt |=  XROOTD_MON_FSLFN;
+                        if (!strcmp("hist",val)) MP->monFSopt |=  XROOTD_MON_FSHST;
+                   else if (!strcmp("lfn", val)) MP->monFSopt |=  XROOTD_MON_FSLFN;
                    else if (!strcmp("ops", val)) MP->monFSopt |=  XROOTD_MON_FSOPS;
                    else if (!strcmp("ssq", val)) MP->monFSopt |=  XROOTD_MON_FSSSQ;
                    else if (!strcmp("xfr", val))
@@ -327,6 +341,14 @@ int XrdXrootdProtocol::xmon(XrdOucStream &Config)
                  if (XrdOuca2x::a2i(eDest,"monitor rnums",val, &MP->monRnums,1,
                                     XrdXrootdMonitor::rdrMax)) return 1;
                 }
+          else if (!strcmp("sendq", val))
+                {if (!(val = Config.GetWord()))
+                    {eDest.Emsg("Config", "monitor sendq value not specified");
+                     return 1;
+                    }
+                 if (XrdOuca2x::a2i(eDest,"monitor sendq",val, &MP->monSendQ,
+                                    0, 65536)) return 1;
+                }
           else if (!strcmp("window", val))
                 {if (!(val = Config.GetWord()))
                     {eDest.Emsg("Config", "monitor window value not specified");
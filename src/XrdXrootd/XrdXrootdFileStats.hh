@@ -30,6 +30,9 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <chrono>
+
+#include "XrdSys/XrdSysPthread.hh"
 #include "XrdXrootd/XrdXrootdMonData.hh"
 
 class XrdXrootdFileStats
@@ -49,6 +52,10 @@ struct {double      read;     // sum(read_size[i] **2) i = 1 to Ops.read
         double      rsegs;    // sum(readv_segs[i]**2) i = 1 to Ops.readv
         double      write;    // sum(write_size[i]**2) i = 1 to Ops.write
        }            ssq;
+XrdXrootdMonStatHST *hst = 0; // Set by mon: histograms (host order) or nil
+long long           rdNext;   // Offset just past the last read  (histograms)
+long long           wrNext;   // Offset just past the last write (histograms)
+XrdSysMutex         hstMutex; // Serializes the histogram updates (see below)
 
 enum monLevel {monOff = 0, monOn = 1, monOps = 2, monSsq = 3};
 
@@ -60,19 +67,83 @@ enum monLevel {monOff = 0, monOn = 1, monOps = 2, monSsq = 3};
                  ops.rsMin = 0x7fff;
                  ops.rdMin = ops.rvMin = ops.wrMin = 0x7fffffff;
                  ssq.read  = ssq.readv = ssq.write = ssq.rsegs = 0.0;
+                 if (hst) {delete hst; hst = 0;}
+                 rdNext = wrNext = -1;
                 };
 
-inline void pgrOps(int rsz, bool isRetry=false)
+static inline int  hstBin(long long val, int shft, int nbins)
+                         {int bin = -shft;
+                          while(val > 1 && bin < nbins-1) {val >>= 1; bin++;}
+                          return (bin < 0 ? 0 : bin);
+                         }
+
+static inline long long hstClock()
+                        {return std::chrono::duration_cast<std::chrono::microseconds>
+                                (std::chrono::steady_clock::now()
+                                   .time_since_epoch()).count();
+                        }
+
+// Service times are only measured when histograms are being kept. hstStart()
+// returns zero otherwise and rdTime() then does nothing.
+//
+inline long long hstStart() {return (hst ? hstClock() : 0);}
+
+// The histograms are updated by the threads issuing the requests as well as
+// by the threads completing asynchronous requests, so every update is done
+// under hstMutex. Reads and writes are classified as sequential or random
+// when they are issued, in the order they are handed to the file system.
+//
+inline void rdTime(long long tBeg)
+                  {if (tBeg)
+                      {int bin = hstBin(hstClock()-tBeg, 3, XROOTD_MON_HSTSZ);
+                       XrdSysMutexHelper hstHelp(hstMutex);
+                       hst->rdTime[bin]++;
+                      }
+                  }
+
+inline void hstRead(int rsz, long long offs)
+                   {XrdSysMutexHelper hstHelp(hstMutex);
+                    hst->rdSize[hstBin(rsz, 9, XROOTD_MON_HSTSZ)]++;
+                    if (offs == rdNext) hst->rdSeq++;
+                       else hst->rdRnd++;
+                    rdNext = offs + rsz;
+                   }
+
+inline void hstReadV(int esz)
+                    {if (hst)
+                        {XrdSysMutexHelper hstHelp(hstMutex);
+                         hst->rvSize[hstBin(esz, 9, XROOTD_MON_HSTSZ)]++;
+                        }
+                    }
+
+inline void hstWrite(int wsz, long long offs)
+                    {XrdSysMutexHelper hstHelp(hstMutex);
+                     hst->wrSize[hstBin(wsz, 9, XROOTD_MON_HSTSZ)]++;
+                     if (offs == wrNext) hst->wrSeq++;
+                        else hst->wrRnd++;
+                     wrNext = offs + wsz;
+                    }
+
+// Take a consistent copy of the histograms for reporting.
+//
+inline void hstCopy(XrdXrootdMonStatHST &hCopy)
+                   {XrdSysMutexHelper hstHelp(hstMutex);
+                    hCopy = *hst;
+                   }
+
+inline void pgrOps(int rsz, long long offs, bool isRetry=false)
                   {if (monLvl)
-                      {prw.rBytes += rsz;
+                      {if (hst) hstRead(rsz, offs);
+                       prw.rBytes += rsz;
                        prw.rCount++;
                        if(isRetry) prw.rRetry++;
                       }
                    }
 
-inline void pgwOps(int wsz, bool isRetry=false)
+inline void pgwOps(int wsz, long long offs, bool isRetry=false)
                   {if (monLvl)
-                      {prw.wBytes += wsz;
+                      {if (hst) hstWrite(wsz, offs);
+                       prw.wBytes += wsz;
                        prw.wCount++;
                        if(isRetry) prw.wRetry++;
                       }
@@ -86,9 +157,10 @@ inline void pgUpdt(int wErrs, int wFixd, int wUnc)
                       }
                   }
 
-inline void rdOps(int rsz)
+inline void rdOps(int rsz, long long offs)
                  {if (monLvl)
                      {xfr.read += rsz; ops.read++; xfrXeq = 1;
+                      if (hst) hstRead(rsz, offs);
                       if (monLvl > 1)
                          {if (rsz < ops.rdMin) ops.rdMin = rsz;
                           if (rsz > ops.rdMax) ops.rdMax = rsz;
@@ -102,6 +174,11 @@ inline void rdOps(int rsz)
 inline void rvOps(int rsz, int ssz)
                  {if (monLvl)
                      {xfr.readv += rsz; ops.readv++; ops.rsegs += ssz; xfrXeq=1;
+                      if (hst)
+                         {int bin = hstBin(ssz, 0, XROOTD_MON_HSTRV);
+                          XrdSysMutexHelper hstHelp(hstMutex);
+                          hst->rvSegs[bin]++;
+                         }
                       if (monLvl > 1)
                          {if (rsz < ops.rvMin) ops.rvMin = rsz;
                           if (rsz > ops.rvMax) ops.rvMax = rsz;
@@ -117,9 +194,12 @@ inline void rvOps(int rsz, int ssz)
                      }
                  }
 
-inline void wrOps(int wsz)
+// A negative offset (writev) is counted but kept out of the histograms.
+//
+inline void wrOps(int wsz, long long offs)
                  {if (monLvl)
                      {xfr.write += wsz; ops.write++; xfrXeq = 1;
+                      if (hst && offs >= 0) hstWrite(wsz, offs);
                       if (monLvl > 1)
                          {if (wsz < ops.wrMin) ops.wrMin = wsz;
                           if (wsz > ops.wrMax) ops.wrMax = wsz;
@@ -130,7 +210,7 @@ inline void wrOps(int wsz)
                      }
                  }
 
-inline void wvOps(int wsz, int ssz) {wrOps(wsz);}
+inline void wvOps(int wsz, int ssz) {wrOps(wsz, -1);}
 /* !!! When we start reporting detail of writev's we will uncomment this
    !!! For now writev's are treated as single write, not correct but at least
    !!! the data gets counted.
@@ -152,6 +232,12 @@ inline void wvOps(int wsz, int ssz) {wrOps(wsz);}
                  }
 */
        XrdXrootdFileStats() {Init();}
-      ~XrdXrootdFileStats() {}
+      ~XrdXrootdFileStats() {if (hst) delete hst;}
+
+private:
+// The histograms are owned by this object and are never shared.
+//
+       XrdXrootdFileStats(const XrdXrootdFileStats&) = delete;
+       XrdXrootdFileStats& operator=(const XrdXrootdFileStats&) = delete;
 };
 #endif
@@ -174,7 +174,8 @@ enum  recTval {isClose = 0,   // Record for close
                isOpen,        // Record for open
                isTime,        // Record for time
                isXfr,         // Record for transfers
-               isDisc         // Record for disconnection
+               isDisc,        // Record for disconnection
+               isHist         // Record for i/o histograms
               };
 
 enum  recFval {forced  =0x01, // If recFlag == isClose close due to disconnect
@@ -186,7 +187,7 @@ enum  recFval {forced  =0x01, // If recFlag == isClose close due to disconnect
                hasSID  =0x01  // if recFlag == isTime sID is present (new rec)
               };
 
-char      recType;  // RecTval: isClose | isOpen | isTime | isXfr
+char      recType;  // RecTval: isClose | isOpen | isTime | isXfr | isHist
 char      recFlag;  // RecFval: Record type-specific flags
 short     recSize;  // Size of this record in bytes
 union
@@ -313,4 +314,44 @@ struct XrdXrootdMonFileXFR    // 32 Bytes
 XrdXrootdMonFileHdr Hdr;      // Always present with recType == isXFR
 XrdXrootdMonStatXFR Xfr;      // Always present
 };
+
+// The following histograms are collected for each open file when "hist" is
+// specified. All buckets are powers of two and the first and last buckets
+// also count everything below and above them. Counts are cumulative since
+// the file was opened.
+//
+// rdSize, rvSize, wrSize: bucket 0 is < 1KB,
+//                         bucket i is [2**(i+9), 2**(i+10)) bytes
+// rdTime:                 bucket 0 is < 16us, bucket i is [2**(i+3), 2**(i+4)) us
+// rvSegs:                 bucket 0 is 1 segment,
+//                         bucket i is [2**i, 2**(i+1)) segments
+//
+// A read or write is sequential if it starts where the previous one issued
+// ended. The elements of a readv() are not classified.
+//
+const int      XROOTD_MON_HSTSZ         = 16;
+const int      XROOTD_MON_HSTRV         =  8;
+
+struct XrdXrootdMonStatHST    // 304 Bytes
+{
+kXR_unt32           rdSize[XROOTD_MON_HSTSZ]; // read() and pgread() request sizes
+kXR_unt32           rdTime[XROOTD_MON_HSTSZ]; // read(), pgread() and readv() service times
+kXR_unt32           wrSize[XROOTD_MON_HSTSZ]; // write() and pgwrite() request sizes
+kXR_unt32           rvSize[XROOTD_MON_HSTSZ]; // readv() element sizes
+kXR_unt32           rvSegs[XROOTD_MON_HSTRV]; // readv() segment counts
+kXR_unt32           rdSeq;    // Number of sequential read()  calls
+kXR_unt32           rdRnd;    // Number of random     read()  calls
+kXR_unt32           wrSeq;    // Number of sequential write() calls
+kXR_unt32           wrRnd;    // Number of random     write() calls
+};
+
+// The following is reported each interval*count for each open file with i/o
+// activity when "hist" is specified, as well as just before the file's close
+// record. These records may be interspersed with other records.
+//
+struct XrdXrootdMonFileHST    // 312 Bytes
+{
+XrdXrootdMonFileHdr Hdr;      // Always present with recType == isHist
+XrdXrootdMonStatHST Hst;      // Always present
+};
 #endif
@@ -81,6 +81,7 @@ char                 XrdXrootdMonFile::fsLVL    = 0;
 char                 XrdXrootdMonFile::fsOPS    = 0;
 char                 XrdXrootdMonFile::fsSSQ    = 0;
 char                 XrdXrootdMonFile::fsXFR    = 0;
+char                 XrdXrootdMonFile::fsHST    = 0;
 char                 XrdXrootdMonFile::crecFlag = 0;
   
 /******************************************************************************/
@@ -106,6 +107,10 @@ void XrdXrootdMonFile::Close(XrdXrootdFileStats *fsP, bool isDisc)
        fmMutex.UnLock();
       }
 
+// Report the final histograms, if we have them, ahead of the close record
+//
+   if (fsP->hst) DoHST(fsP);
+
 // Insert a close record header (mostly precomputed)
 //
    cRec.Hdr.recType = XrdXrootdMonFileHdr::isClose;
@@ -188,15 +193,21 @@ void XrdXrootdMonFile::Defaults(int intv, int opts, int xfrcnt, int fbsz)
 // Expand out the options
 //
    fsXFR  = (opts &  XROOTD_MON_FSXFR) != 0;
+   fsHST  = (opts &  XROOTD_MON_FSHST) != 0;
    fsLFN  = (opts &  XROOTD_MON_FSLFN) != 0;
    fsOPS  = (opts & (XROOTD_MON_FSOPS  | XROOTD_MON_FSSSQ)) != 0;
    fsSSQ  = (opts &  XROOTD_MON_FSSSQ) != 0;
 
+// Histograms for open files are reported along with the i/o records. If those
+// were not asked for, report histograms every interval.
+//
+   if (fsHST && !fsXFR) xfrCnt = xfrRem = 1;
+
 // Set monitoring level
 //
         if (fsSSQ) fsLVL = XrdXrootdFileStats::monSsq;
    else if (fsOPS) fsLVL = XrdXrootdFileStats::monOps;
-   else if (intv)  fsLVL = XrdXrootdFileStats::monOn;
+   else if (intv || fsHST) fsLVL = XrdXrootdFileStats::monOn;
    else            fsLVL = XrdXrootdFileStats::monOff;
 }
 
@@ -296,6 +307,11 @@ void XrdXrootdMonFile::DoXFR(XrdXrootdFileStats *fsP)
 //
    fsP->xfrXeq = 0;
 
+// Report histograms if we are collecting them
+//
+   if (fsP->hst) DoHST(fsP);
+   if (!fsXFR) return;
+
 // Grab the I/O bytes to get a somewhat consistent image here
 //
    xfrRead  = fsP->xfr.read;
@@ -317,6 +333,49 @@ void XrdXrootdMonFile::DoXFR(XrdXrootdFileStats *fsP)
    bfMutex.UnLock();
 }
 
+/******************************************************************************/
+/* Private:                        D o H S T                                  */
+/******************************************************************************/
+
+void XrdXrootdMonFile::DoHST(XrdXrootdFileStats *fsP)
+{
+   static const short hrecSize = htons(static_cast<short>
+                                       (sizeof(XrdXrootdMonFileHST)));
+   XrdXrootdMonStatHST  hst;
+   XrdXrootdMonStatHST *hP = &hst;
+   XrdXrootdMonFileHST *rP;
+   int i;
+
+// Copy the histograms as they may be updated while we report them
+//
+   fsP->hstCopy(hst);
+
+// Get a pointer to the next slot (the buffer gets locked)
+//
+   rP = (XrdXrootdMonFileHST *)GetSlot(sizeof(XrdXrootdMonFileHST));
+
+// Fill out the record converting each counter to network order as we go. The
+// counts are cumulative so a lost packet only delays the information.
+//
+   rP->Hdr.recType = XrdXrootdMonFileHdr::isHist;
+   rP->Hdr.recFlag = 0;
+   rP->Hdr.recSize = hrecSize;
+   rP->Hdr.fileID  = fsP->FileID;
+   for (i = 0; i < XROOTD_MON_HSTSZ; i++)
+       {rP->Hst.rdSize[i] = htonl(hP->rdSize[i]);
+        rP->Hst.rdTime[i] = htonl(hP->rdTime[i]);
+        rP->Hst.wrSize[i] = htonl(hP->wrSize[i]);
+        rP->Hst.rvSize[i] = htonl(hP->rvSize[i]);
+       }
+   for (i = 0; i < XROOTD_MON_HSTRV; i++)
+       rP->Hst.rvSegs[i] = htonl(hP->rvSegs[i]);
+   rP->Hst.rdSeq = htonl(hP->rdSeq);
+   rP->Hst.rdRnd = htonl(hP->rdRnd);
+   rP->Hst.wrSeq = htonl(hP->wrSeq);
+   rP->Hst.wrRnd = htonl(hP->wrRnd);
+   bfMutex.UnLock();
+}
+
 /******************************************************************************/
 /*                                  I n i t                                   */
 /******************************************************************************/
@@ -473,9 +532,9 @@ void XrdXrootdMonFile::Open(XrdXrootdFileStats *fsP, const char *Path,
 //
    if (fsP->FileID == 0) fsP->FileID = XrdXrootdMonitor::GetDictID();
 
-// Add this open to the map table if we are doing I/O stats.
+// Add this open to the map table if we are doing I/O stats or histograms.
 //
-   if (fsXFR)
+   if (fsXFR || fsHST)
       {fmMutex.Lock();
        for (i = 0; i < XrdXrootdMonFMap::mapNum; i++)
            if (fmUse[i] < XrdXrootdMonFMap::fmSize)
@@ -495,6 +554,13 @@ void XrdXrootdMonFile::Open(XrdXrootdFileStats *fsP, const char *Path,
    fsP->monLvl = fsLVL;
    fsP->xfrXeq = 0;
 
+// Allocate the histograms if so wanted
+//
+   if (fsHST && !fsP->hst)
+      {fsP->hst = new XrdXrootdMonStatHST;
+       memset(fsP->hst, 0, sizeof(XrdXrootdMonStatHST));
+      }
+
 // Compute the size of this record
 //
    rLen = minRecSz;
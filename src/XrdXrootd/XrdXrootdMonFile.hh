@@ -63,6 +63,7 @@ private:
 
 static void                 DoXFR();
 static void                 DoXFR(XrdXrootdFileStats *fsP);
+static void                 DoHST(XrdXrootdFileStats *fsP);
 static void                 Flush();
 static char                *GetSlot(int slotSZ);
                           
@@ -93,6 +94,7 @@ static char                 fsLVL;
 static char                 fsOPS;
 static char                 fsSSQ;
 static char                 fsXFR;
+static char                 fsHST;
 static char                 crecFlag;
 };
 #endif
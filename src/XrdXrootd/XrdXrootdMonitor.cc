@@ -28,12 +28,14 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <atomic>
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "XrdVersion.hh"
 
@@ -63,6 +65,7 @@ XrdNetMsg         *XrdXrootdMonitor::InetDest2  = 0;
 XrdXrootdMonitor  *XrdXrootdMonitor::altMon     = 0;
 XrdSysMutex        XrdXrootdMonitor::windowMutex;
 int                XrdXrootdMonitor::monRlen    = 0;
+int                XrdXrootdMonitor::sendQsz    = 0;
 XrdXrootdMonitor::MonRdrBuff
                    XrdXrootdMonitor::rdrMon[XrdXrootdMonitor::rdrMax];
 XrdXrootdMonitor::MonRdrBuff
@@ -114,6 +117,9 @@ long long       mySID     = 0;
 int32_t         startTime = InitStartTime();
 int             kySIDSZ   = 0;
 XrdSysMutex     seqMutex;
+XrdSysMutex     sendMutex;
+int             sendSeq1  = 0;
+int             sendSeq2  = 0;
 
 char           *SidCGI[4] = {0};
 int             LidCGI[4] = {0};
@@ -222,6 +228,116 @@ static XrdSysMutex monLock;
 
 XrdSysMutex XrdXrootdMonitorLock::monLock;
 
+/******************************************************************************/
+/*          C l a s s   X r d X r o o t d M o n i t o r _ S e n d Q           */
+/******************************************************************************/
+
+// The send queue moves i/o trace buffers off the i/o path. Protocol threads
+// copy a full buffer into a free slot (lock-free, multi-producer) and return
+// immediately. A single sender thread drains the slots in order and sends
+// them in batches, one system call per destination for the whole batch.
+//
+class XrdXrootdMonitor_SendQ
+{
+public:
+
+struct Slot {std::atomic<unsigned long> seq;
+             int                        mode;
+             int                        size;
+             char                      *buff;
+            };
+
+static const int maxBatch = 64;
+
+int           Get(Slot **sVec)
+                 {int n = 0;
+                  while(n < maxBatch)
+                       {Slot *sP = &slots[(tail+n) & mask];
+                        if (sP->seq.load(std::memory_order_acquire)
+                        !=  tail+n+1) break;
+                        sVec[n++] = sP;
+                       }
+                  return n;
+                 }
+
+bool          Put(int mmode, void *buff, int size)
+                 {Slot *sP;
+                  unsigned long pos = head.load(std::memory_order_relaxed);
+                  while(true)
+                       {sP = &slots[pos & mask];
+                        long dif = static_cast<long>
+                                   (sP->seq.load(std::memory_order_acquire))
+                                 - static_cast<long>(pos);
+                        if (dif == 0)
+                           {if (head.compare_exchange_weak(pos, pos+1,
+                                     std::memory_order_relaxed)) break;
+                           }
+                           else if (dif < 0) {overFlow++; return false;}
+                                   else pos = head.load(std::memory_order_relaxed);
+                       }
+                  memcpy(sP->buff, buff, size);
+                  sP->mode = mmode;
+                  sP->size = size;
+                  sP->seq.store(pos+1, std::memory_order_release);
+// The fence pairs with the one in Wait(): either the sender sees this slot
+// on its re-check or we see it idle here and wake it up.
+//
+                  std::atomic_thread_fence(std::memory_order_seq_cst);
+                  if (idle.exchange(false)) wakeUp.Post();
+                  return true;
+                 }
+
+void          Release(int n)
+                 {for (int i = 0; i < n; i++)
+                      slots[(tail+i) & mask].seq.store(tail+i+mask+1,
+                                                 std::memory_order_release);
+                  tail += n;
+                 }
+
+int           Overflows() {return overFlow.exchange(0);}
+
+void          Wait()
+                 {Slot *sP = &slots[tail & mask];
+                  idle.store(true, std::memory_order_seq_cst);
+                  std::atomic_thread_fence(std::memory_order_seq_cst);
+                  if (sP->seq.load(std::memory_order_seq_cst) == tail+1
+                  &&  idle.exchange(false)) return;
+                  wakeUp.Wait();
+                 }
+
+      XrdXrootdMonitor_SendQ(int qsz, int bsz) : head(0), tail(0), idle(false),
+                                                 overFlow(0), wakeUp(0)
+                 {unsigned long n = 1;
+                  while(n < static_cast<unsigned long>(qsz)) n <<= 1;
+                  mask  = n-1;
+                  slots = new Slot[n];
+                  if (posix_memalign((void **)&bufs, getpagesize(), n*bsz))
+                     bufs = 0;
+                  for (unsigned long i = 0; i < n; i++)
+                      {slots[i].seq  = i;
+                       slots[i].buff = (bufs ? bufs + i*bsz : 0);
+                      }
+                 }
+     ~XrdXrootdMonitor_SendQ() {} // Never deleted
+
+bool          isReady() {return bufs != 0;}
+
+private:
+Slot                      *slots;
+char                      *bufs;
+unsigned long              mask;
+std::atomic<unsigned long> head;
+unsigned long              tail;     // Only used by the sender thread
+std::atomic<bool>          idle;
+std::atomic<int>           overFlow;
+XrdSysSemaphore            wakeUp;
+};
+
+namespace
+{
+XrdXrootdMonitor_SendQ *monSendQ = 0;
+}
+
 /******************************************************************************/
 /*               X r d X r o o t d M o n i t o r : : H e l l o                */
 /******************************************************************************/
@@ -529,7 +645,8 @@ void XrdXrootdMonitor::Defaults(char *dest1, int mode1, char *dest2, int mode2)
 
 void XrdXrootdMonitor::Defaults(int msz,   int rsz,   int wsz,
                                 int flush, int flash, int idt, int rnm,
-                                int fbsz, int fsint, int fsopt, int fsion)
+                                int fbsz, int fsint, int fsopt, int fsion,
+                                int sendq)
 {
 
 // Set default window size and flush time
@@ -541,6 +658,7 @@ void XrdXrootdMonitor::Defaults(int msz,   int rsz,   int wsz,
    rdrNum     = (rnm   <= 0 || rnm > rdrMax ? 3 : rnm);
    rdrWin     = (sizeWindow > 16777215 ? 16777215 : sizeWindow);
    rdrWin     = htonl(rdrWin);
+   sendQsz    = (sendq <= 0 ? 0 : sendq);
 
 // Set the fstat defaults
 //
@@ -774,6 +892,24 @@ int XrdXrootdMonitor::Init()
            return 0;
           }
 
+// If i/o events are being traced, start the sender thread so that buffers
+// are sent off the i/o path, if so wanted.
+//
+   if (sendQsz && monIO)
+      {pthread_t tid;
+       int rc;
+       monSendQ = new XrdXrootdMonitor_SendQ(sendQsz, monBlen);
+       if (!monSendQ->isReady())
+          {eDest->Emsg("Monitor", "Unable to allocate monitor send queue.");
+           return 0;
+          }
+       if ((rc = XrdSysThread::Run(&tid, XrdXrootdMonitor::SendQ,
+                                   (void *)monSendQ, 0, "Monitor sender")))
+          {eDest->Emsg("Monitor", rc, "create monitor sender thread");
+           return 0;
+          }
+      } else sendQsz = 0;
+
 // Turn on the monitoring clock if we need it running all the time
 //
    if (monCLOCK) startClock();
@@ -1100,7 +1236,10 @@ void XrdXrootdMonitor::Flush()
 
 // Send off the buffer and reinitialize it
 //
-   if (this != altMon) Send(XROOTD_MON_IO, (void *)monBuff, size);
+   if (this != altMon)
+      {if (!sendQsz || !Queue(XROOTD_MON_IO, (void *)monBuff, size))
+          Send(XROOTD_MON_IO, (void *)monBuff, size);
+      }
       else {Send(XROOTD_MON_FILE, (void *)monBuff, size);
             FlushTime = localWindow + autoFlush;
            }
@@ -1200,8 +1339,6 @@ int XrdXrootdMonitor::Send(int monMode, void *buff, int blen, bool setseq)
 #ifndef NODEBUG
     const char *TraceID = "Monitor";
 #endif
-    static XrdSysMutex sendMutex;
-    static int seq1=0, seq2=0;
     XrdXrootdMonHeader *mHdr=0;
     int rc1, rc2;
 
@@ -1212,13 +1349,13 @@ int XrdXrootdMonitor::Send(int monMode, void *buff, int blen, bool setseq)
 
     sendMutex.Lock();
     if (monMode & monMode1 && InetDest1)
-       {if (mHdr) mHdr->pseq = (seq1++) & 0xff;
+       {if (mHdr) mHdr->pseq = (sendSeq1++) & 0xff;
         rc1  = InetDest1->Send((char *)buff, blen);
         TRACE(DEBUG,blen <<" bytes sent to " <<Dest1 <<" rc=" <<rc1);
        }
        else rc1 = 0;
     if (monMode & monMode2 && InetDest2)
-       {if (mHdr) mHdr->pseq = (seq2++) & 0xff;
+       {if (mHdr) mHdr->pseq = (sendSeq2++) & 0xff;
         rc2  = InetDest2->Send((char *)buff, blen);
         TRACE(DEBUG,blen <<" bytes sent to " <<Dest2 <<" rc=" <<rc2);
        }
@@ -1228,6 +1365,73 @@ int XrdXrootdMonitor::Send(int monMode, void *buff, int blen, bool setseq)
     return (rc1 ? rc1 : rc2);
 }
 
+/******************************************************************************/
+/*                                 Q u e u e                                  */
+/******************************************************************************/
+
+bool XrdXrootdMonitor::Queue(int monMode, void *buff, int blen)
+{
+// If the queue is full the caller must send the buffer itself. We prefer to
+// slow down i/o rather than lose monitoring records.
+//
+   return monSendQ && monSendQ->Put(monMode, buff, blen);
+}
+
+/******************************************************************************/
+/*                                 S e n d Q                                  */
+/******************************************************************************/
+
+void *XrdXrootdMonitor::SendQ(void *carg)
+{
+#ifndef NODEBUG
+    const char *TraceID = "MonSendQ";
+#endif
+   XrdXrootdMonitor_SendQ *sQ = static_cast<XrdXrootdMonitor_SendQ *>(carg);
+   XrdXrootdMonitor_SendQ::Slot *sVec[XrdXrootdMonitor_SendQ::maxBatch];
+   struct iovec ioV[XrdXrootdMonitor_SendQ::maxBatch];
+   XrdXrootdMonHeader *mHdr;
+   int i, n, k, ovf;
+
+// Drain the queue forever, sending whatever has accumulated as one batch per
+// destination. Sequence numbers are assigned here, under the same lock that
+// Send() uses, so both paths keep a single sequence per destination.
+//
+   while(true)
+        {if (!(n = sQ->Get(sVec))) {sQ->Wait(); continue;}
+
+         sendMutex.Lock();
+         if (InetDest1)
+            {for (i = k = 0; i < n; i++)
+                 {if (!(sVec[i]->mode & monMode1)) continue;
+                  mHdr = (XrdXrootdMonHeader *)sVec[i]->buff;
+                  mHdr->pseq = (sendSeq1++) & 0xff;
+                  ioV[k].iov_base = sVec[i]->buff;
+                  ioV[k++].iov_len = sVec[i]->size;
+                 }
+             if (k) InetDest1->SendBatch(ioV, k);
+             TRACE(DEBUG, k <<" packets sent to " <<Dest1);
+            }
+         if (InetDest2)
+            {for (i = k = 0; i < n; i++)
+                 {if (!(sVec[i]->mode & monMode2)) continue;
+                  mHdr = (XrdXrootdMonHeader *)sVec[i]->buff;
+                  mHdr->pseq = (sendSeq2++) & 0xff;
+                  ioV[k].iov_base = sVec[i]->buff;
+                  ioV[k++].iov_len = sVec[i]->size;
+                 }
+             if (k) InetDest2->SendBatch(ioV, k);
+             TRACE(DEBUG, k <<" packets sent to " <<Dest2);
+            }
+         sendMutex.UnLock();
+         sQ->Release(n);
+
+         if ((ovf = sQ->Overflows()))
+            {TRACE(DEBUG, ovf <<" buffers sent inline; send queue was full.");}
+        }
+
+   return (void *)0;
+}
+
 /******************************************************************************/
 /*                            s t a r t C l o c k                             */
 /******************************************************************************/
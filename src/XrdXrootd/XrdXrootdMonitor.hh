@@ -65,6 +65,7 @@
 #define XROOTD_MON_FSOPS    2
 #define XROOTD_MON_FSSSQ    4
 #define XROOTD_MON_FSXFR    8
+#define XROOTD_MON_FSHST   16
 
 class XrdScheduler;
 class XrdNetMsg;
@@ -117,7 +118,8 @@ inline void              Add_wr(kXR_unt32 dictid,
 static void              Defaults(char *dest1, int m1, char *dest2, int m2);
 static void              Defaults(int msz,     int rsz,     int wsz,
                                   int flush,   int flash,   int iDent, int rnm,
-                                  int fbsz, int fsint=0, int fsopt=0, int fsion=0);
+                                  int fbsz, int fsint=0, int fsopt=0, int fsion=0,
+                                  int sendq=0);
 
 static int               Flushing() {return autoFlush;}
 
@@ -267,6 +269,8 @@ static void              Flush(MonRdrBuff *mP);
 static kXR_unt32         Map(char  code, XrdXrootdMonitor::User &uInfo,
                              const char *path);
        void              Mark();
+static bool              Queue(int mmode, void *buff, int size);
+static void             *SendQ(void *carg);
 static void              startClock();
 static void              unAlloc(XrdXrootdMonitor *monp);
 
@@ -297,6 +301,7 @@ static int                isEnabled;
 static int                numMonitor;
 static int                monIdent;
 static int                monRlen;
+static int                sendQsz;
 static char               monIO;
 static char               monINFO;
 static char               monFILE;
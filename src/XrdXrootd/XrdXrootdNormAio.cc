@@ -128,6 +128,7 @@ bool XrdXrootdNormAio::CopyF2L_Add2Q(XrdXrootdAioBuff *aioP)
                dlen = aioP->sfsAio.aio_nbytes;
           else dlen = aioP->sfsAio.aio_nbytes = dataLen;
 
+       aioP->tBeg = dataFile->Stats.hstStart();
        if ((rc = dataFile->XrdSfsp->read((XrdSfsAio *)aioP)) != SFS_OK)
           {SendFSError(rc);
            aioP->Recycle();
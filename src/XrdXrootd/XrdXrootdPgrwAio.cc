@@ -134,6 +134,7 @@ bool XrdXrootdPgrwAio::CopyF2L_Add2Q(XrdXrootdAioPgrw *aioP)
            aioP->Recycle();
            return false;
           }
+       aioP->tBeg = dataFile->Stats.hstStart();
        if ((rc = dataFile->XrdSfsp->pgRead((XrdSfsAio *)aioP)) != SFS_OK)
           {SendFSError(rc);
            aioP->Recycle();
@@ -507,28 +508,38 @@ int XrdXrootdPgrwAio::SendDone()
 
 bool XrdXrootdPgrwAio::VerCks(XrdXrootdAioPgrw *aioP)
 {
-   off_t     dOffset = aioP->sfsAio.aio_offset;
-   uint32_t *csVec, *csVP, csVal;
-   int       ioVNum, dLen;
+   static const int maxSeg = XrdXrootdAioPgrw::acsSZ;
+   off_t       dOffset = aioP->sfsAio.aio_offset;
+   const void *dSeg[maxSeg] = {0};
+   size_t      dLen[maxSeg] = {0};
+   uint32_t   *csVec, csVal[maxSeg];
+   int         ioVNum, n = 0;
 
 // Get the iovec information as this will drive the checksum
 //
    struct iovec *ioV = aioP->iov4Data(ioVNum);
-   csVP = csVec = (uint32_t*)ioV[0].iov_base;
+   csVec = (uint32_t*)ioV[0].iov_base;
+
+// Compute the checksum of all the pages or page segments in one go
+//
+   for (int i = 1; i < ioVNum && n < maxSeg; i +=2, n++)
+       {dSeg[n] = ioV[i].iov_base;
+        dLen[n] = ioV[i].iov_len;
+       }
+   XrdOucCRC::Calc32C(dSeg, dLen, n, csVal);
 
 // Verify each page or page segment
 //
-   for (int i = 1; i < ioVNum; i +=2)
-       {dLen = ioV[i].iov_len;
-        csVal = ntohl(*csVP); *csVP++ = csVal;
-        if (!XrdOucCRC::Ver32C(ioV[i].iov_base, dLen, csVal))
-           {const char *eMsg = badCSP->boAdd(dataFile, dOffset, dLen);
+   for (int i = 0; i < n; i++)
+       {csVec[i] = ntohl(csVec[i]);
+        if (csVec[i] != csVal[i])
+           {const char *eMsg = badCSP->boAdd(dataFile, dOffset, dLen[i]);
             if (eMsg) {SendError(ETOOMANYREFS, eMsg);
                        aioP->Recycle();
                        return false;
                       }
            }
-        dOffset += dLen;
+        dOffset += dLen[i];
        }
 
 // All done, while we may have checksum error there is nothing we can do about
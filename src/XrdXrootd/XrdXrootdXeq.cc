@@ -2396,6 +2396,8 @@ int XrdXrootdProtocol::do_Read()
                     }
             if (pP && (aioP = XrdXrootdNormAio::Alloc(pP,pP->Response,IO.File)))
                {if (!IO.File->aioFob) IO.File->aioFob = new XrdXrootdAioFob;
+                if (IO.File->Stats.hst)
+                   IO.File->Stats.hstRead(IO.IOLen, IO.Offset);
                 aioP->Read(IO.Offset, IO.IOLen);
                 return 0;
                }
@@ -2432,18 +2434,18 @@ int XrdXrootdProtocol::do_ReadAll()
    if (IO.Mode == XrdXrootd::IOParms::useMMap)
       {if (IO.Offset >= IO.File->Stats.fSize) return Response.Send();
        if (IO.Offset+IO.IOLen <= IO.File->Stats.fSize)
-          {IO.File->Stats.rdOps(IO.IOLen);
+          {IO.File->Stats.rdOps(IO.IOLen, IO.Offset);
            return Response.Send(IO.File->mmAddr+IO.Offset, IO.IOLen);
           }
        xframt = IO.File->Stats.fSize -IO.Offset;
-       IO.File->Stats.rdOps(xframt);
+       IO.File->Stats.rdOps(xframt, IO.Offset);
        return Response.Send(IO.File->mmAddr+IO.Offset, xframt);
       }
 
 // If we are sendfile enabled, then just send the file if possible
 //
    if (IO.Mode == XrdXrootd::IOParms::useSF)
-      {IO.File->Stats.rdOps(IO.IOLen);
+      {IO.File->Stats.rdOps(IO.IOLen, IO.Offset);
        if (IO.File->fdNum >= 0)
           return Response.Send(IO.File->fdNum, IO.Offset, IO.IOLen);
        rc = IO.File->XrdSfsp->SendData((XrdSfsDio *)this, IO.Offset, IO.IOLen);
@@ -2463,8 +2465,11 @@ int XrdXrootdProtocol::do_ReadAll()
 // Now read all of the data. For statistics, we need to record the orignal
 // amount of the request even if we really do not get to read that much!
 //
-   IO.File->Stats.rdOps(IO.IOLen);
-   do {if ((xframt = IO.File->XrdSfsp->read(IO.Offset, buff, Quantum)) <= 0) break;
+   IO.File->Stats.rdOps(IO.IOLen, IO.Offset);
+   do {long long tBeg = IO.File->Stats.hstStart();
+       xframt = IO.File->XrdSfsp->read(IO.Offset, buff, Quantum);
+       IO.File->Stats.rdTime(tBeg);
+       if (xframt <= 0) break;
        if (xframt >= IO.IOLen) return Response.Send(buff, xframt);
        if (Response.Send(kXR_oksofar, buff, xframt) < 0) return -1;
        IO.Offset += xframt; IO.IOLen -= xframt;
@@ -2540,7 +2545,7 @@ int XrdXrootdProtocol::do_ReadV()
    const int hdrSZ = sizeof(readahead_list);
    struct XrdOucIOVec     rdVec[XrdProto::maxRvecsz+1];
    struct readahead_list *raVec, respHdr;
-   long long totSZ;
+   long long totSZ, tBeg;
    XrdSfsXferSize rdVAmt, rdVXfr, xfrSZ = 0;
    int rdVBeg, rdVBreak, rdVNow, rdVNum, rdVecNum;
    int currFH, i, k, Quantum, Qleft, rdVecLen = Request.header.dlen;
@@ -2629,7 +2634,9 @@ int XrdXrootdProtocol::do_ReadV()
 //
    for (i = 0; i < rdVecNum; i++)
        {if (rdVec[i].info != currFH)
-           {xfrSZ = IO.File->XrdSfsp->readv(&rdVec[rdVNow], i-rdVNow);
+           {tBeg  = IO.File->Stats.hstStart();
+            xfrSZ = IO.File->XrdSfsp->readv(&rdVec[rdVNow], i-rdVNow);
+            IO.File->Stats.rdTime(tBeg);
             if (xfrSZ != rdVAmt) break;
             rdVNum = i - rdVBeg; rdVXfr += rdVAmt;
             IO.File->Stats.rvOps(rdVXfr, rdVNum);
@@ -2651,7 +2658,9 @@ int XrdXrootdProtocol::do_ReadV()
 
         if (Qleft < (rdVec[i].size + hdrSZ))
            {if (rdVAmt)
-               {xfrSZ = IO.File->XrdSfsp->readv(&rdVec[rdVNow], i-rdVNow);
+               {tBeg  = IO.File->Stats.hstStart();
+                xfrSZ = IO.File->XrdSfsp->readv(&rdVec[rdVNow], i-rdVNow);
+                IO.File->Stats.rdTime(tBeg);
                 if (xfrSZ != rdVAmt) break;
                }
             if (Response.Send(kXR_oksofar,argp->buff,Quantum-Qleft) < 0)
@@ -2662,6 +2671,7 @@ int XrdXrootdProtocol::do_ReadV()
            }
 
         xfrSZ = rdVec[i].size; rdVAmt += xfrSZ;
+        IO.File->Stats.hstReadV(xfrSZ);
         respHdr.rlen   = htonl(xfrSZ);
         respHdr.offset = htonll(rdVec[i].offset);
         memcpy(buffp, &respHdr, hdrSZ);
@@ -3126,7 +3136,7 @@ int XrdXrootdProtocol::do_Write()
 // If zero length write, simply return
 //
    if (!IO.IOLen) return Response.Send();
-   IO.File->Stats.wrOps(IO.IOLen); // Optimistically correct
+   IO.File->Stats.wrOps(IO.IOLen, IO.Offset); // Optimistically correct
 
 // If async write allowed and it is a true write request (e.g. not chkpoint) and
 // current conditions permit async; schedule the write to occur asynchronously
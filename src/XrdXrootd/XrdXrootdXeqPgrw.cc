@@ -157,7 +157,7 @@ int XrdXrootdProtocol::do_PgRead()
 // able to fully complete the I/O from the file. Note that we also count
 // the checksums which a questionable practice.
 //
-   IO.File->Stats.pgrOps(IO.IOLen, (IO.Flags & XrdProto::kXR_pgRetry) != 0);
+   IO.File->Stats.pgrOps(IO.IOLen, IO.Offset, (IO.Flags & XrdProto::kXR_pgRetry) != 0);
 
 // Use synchronous reads unless async I/O is allowed, the read size is
 // sufficient, and there are not too many async operations in flight.
@@ -294,8 +294,10 @@ int XrdXrootdProtocol::do_PgRIO()
 // been read. In fact, no bytes may have been read.
 //
    long long ioOffset = IO.Offset;
-   do {if ((xframt = sfsP->pgRead(IO.Offset, buff, rLen, csVec, pgrOpts)) <= 0)
-          break;
+   do {long long tBeg = IO.File->Stats.hstStart();
+       xframt = sfsP->pgRead(IO.Offset, buff, rLen, csVec, pgrOpts);
+       IO.File->Stats.rdTime(tBeg);
+       if (xframt <= 0) break;
 
        items = XrdOucPgrwUtils::csNum(IO.Offset, xframt, fLen, lLen);
        iov[2].iov_len = fLen;
@@ -396,7 +398,7 @@ int XrdXrootdProtocol::do_PgWrite()
 // able to fully complete the I/O to the file. Note that we also count
 // the checksums which a questionable practice.
 //
-   IO.File->Stats.pgwOps(IO.IOLen, (IO.Flags & XrdProto::kXR_pgRetry) != 0);
+   IO.File->Stats.pgwOps(IO.IOLen, IO.Offset, (IO.Flags & XrdProto::kXR_pgRetry) != 0);
 
 // If we are monitoring, insert a write entry
 //
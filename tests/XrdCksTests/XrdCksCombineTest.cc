@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "XrdCks/XrdCksCalcadler32.hh"
+#include "XrdCks/XrdCksCalccrc32.hh"
+#include "XrdCks/XrdCksCalccrc32C.hh"
+#include "XrdCks/XrdCksData.hh"
+#include "XrdCks/XrdCksManager.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdVersion.hh"
+
+#include "XrdCksTestUtils.hh"
+
+using namespace XrdCksTest;
+
+namespace
+{
+XrdVERSIONINFODEF(myVer, XrdCksTest, XrdVNUMBER, XrdVERSION);
+
+// The checksum of data[0..len-1] computed in one go.
+//
+template<class T>
+std::string OneShot(const char *data, size_t len)
+{
+   T calc;
+   calc.Init();
+   calc.Update(data, len);
+   return Value(calc);
+}
+
+// The checksum of a file computed in one go, reading it sequentially.
+//
+template<class T>
+std::string FileOneShot(const std::string &path)
+{
+   std::vector<char> buff(1024*1024);
+   T calc;
+   calc.Init();
+   int fd = open(path.c_str(), O_RDONLY);
+   EXPECT_GE(fd, 0);
+   ssize_t n;
+   while ((n = read(fd, buff.data(), buff.size())) > 0) calc.Update(buff.data(), n);
+   close(fd);
+   return Value(calc);
+}
+
+// The checksum of data[0..len-1] computed separately for each of the pieces
+// between the split points, the results then being combined in turn.
+//
+template<class T>
+std::string Combined(const char *data, size_t len, std::vector<size_t> splits)
+{
+   splits.push_back(len);
+   T calc;
+   calc.Init();
+   size_t pos = 0;
+   for (size_t end : splits)
+       {T next;
+        next.Init();
+        next.Update(data + pos, end - pos);
+        calc.Combine(next, end - pos);
+        pos = end;
+       }
+   return Value(calc);
+}
+
+template<class T>
+void CombineTest(const char *name)
+{
+   std::vector<char> data = RandomData(300000);
+   std::mt19937 gen(7);
+
+   for (size_t len : {size_t(0), size_t(1), size_t(5), size_t(5552),
+                      size_t(65537), data.size()})
+       {std::string expect = OneShot<T>(data.data(), len);
+
+        // Every single split point in a short buffer, random ones otherwise
+        for (int round = 0; round < 200; round++)
+            {std::vector<size_t> splits;
+             int nsplit = (round < 100 ? 1 : 1 + gen() % 8);
+             for (int i = 0; i < nsplit; i++)
+                 splits.push_back(len < 100 && round < 100 ? round % (len + 1)
+                                                           : gen() % (len + 1));
+             std::sort(splits.begin(), splits.end());
+             ASSERT_EQ(Combined<T>(data.data(), len, splits), expect)
+                << name << " of " << len << " bytes split at " << splits[0];
+            }
+       }
+}
+}
+
+//------------------------------------------------------------------------------
+// Combining the checksums of consecutive pieces gives the checksum of the
+// whole, wherever the data is split, empty pieces included.
+//------------------------------------------------------------------------------
+TEST(XrdCksCombineTest, Adler32)
+{
+   CombineTest<XrdCksCalcadler32>("adler32");
+}
+
+TEST(XrdCksCombineTest, Crc32)
+{
+   CombineTest<XrdCksCalccrc32>("crc32");
+}
+
+TEST(XrdCksCombineTest, Crc32C)
+{
+   CombineTest<XrdCksCalccrc32C>("crc32c");
+}
+
+//------------------------------------------------------------------------------
+// The checksum manager computing several digests in one pass and, for a file
+// large enough, in parallel segments.
+//------------------------------------------------------------------------------
+class XrdCksManagerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    char tmpl[] = "/tmp/xrdcks-XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    dir  = tmpl;
+    path = dir + "/data";
+  }
+
+  void TearDown() override
+  {
+    unlink(path.c_str());
+    rmdir(dir.c_str());
+  }
+
+  // Configure a manager with the given ckscalc directive.
+  //
+  std::unique_ptr<XrdCksManager> Manager(const char *ckscalc)
+  {
+    std::unique_ptr<XrdCksManager> cks(new XrdCksManager(&eDest, 0, myVer));
+    if (ckscalc)
+       {std::string line(ckscalc);
+        EXPECT_EQ(cks->Config("ckscalc", &line[0]), 0);
+       }
+    EXPECT_EQ(cks->Init(0), 1);
+    return cks;
+  }
+
+  // The digest recorded for the file or an empty string if there is none.
+  //
+  std::string Recorded(XrdCksManager &cks, const char *name)
+  {
+    XrdCksData cksData;
+    cksData.Set(name);
+    if (cks.Get(path.c_str(), cksData) <= 0) return "";
+    return std::string(cksData.Value, cksData.Length);
+  }
+
+  std::string  dir, path;
+  XrdSysLogger logger;
+  XrdSysError  eDest{&logger, "cks_"};
+};
+
+TEST_F(XrdCksManagerTest, OnePass)
+{
+   std::vector<char> data = RandomData(3*1024*1024 + 12345);
+   WriteFile(path, data);
+   auto cks = Manager("onepass adler32,crc32c");
+
+   XrdCksData cksData;
+   cksData.Set("adler32");
+   ASSERT_EQ(cks->Calc(path.c_str(), cksData, 1), 0);
+   EXPECT_EQ(std::string(cksData.Value, cksData.Length),
+             OneShot<XrdCksCalcadler32>(data.data(), data.size()));
+
+   // Computed in the same pass, crc32 was not
+   EXPECT_EQ(Recorded(*cks, "adler32"),
+             OneShot<XrdCksCalcadler32>(data.data(), data.size()));
+   EXPECT_EQ(Recorded(*cks, "crc32c"),
+             OneShot<XrdCksCalccrc32C>(data.data(), data.size()));
+   EXPECT_EQ(Recorded(*cks, "crc32"), "");
+
+   // Not recorded, nothing else is computed
+   cksData.Reset();
+   cksData.Set("crc32");
+   ASSERT_EQ(cks->Calc(path.c_str(), cksData, 0), 0);
+   EXPECT_EQ(std::string(cksData.Value, cksData.Length),
+             OneShot<XrdCksCalccrc32>(data.data(), data.size()));
+   EXPECT_EQ(Recorded(*cks, "crc32"), "");
+}
+
+TEST_F(XrdCksManagerTest, ParallelSegments)
+{
+   // Large enough to be split across threads: mostly a hole, with data at
+   // both ends and around where the segments meet.
+   const off_t fsize = 2*256*1024*1024 + 3*1024*1024 + 777;
+   std::vector<char> rnd = RandomData(4*1024*1024);
+   const off_t spots[] = {0, fsize/4 - 100000, fsize/2 - 2*1024*1024,
+                          fsize/2 + 5, fsize - off_t(rnd.size())};
+   int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+   ASSERT_GE(fd, 0);
+   for (off_t off : spots)
+       ASSERT_EQ(pwrite(fd, rnd.data(), rnd.size(), off), ssize_t(rnd.size()));
+   close(fd);
+
+   auto cks = Manager("onepass adler32,crc32,crc32c parallel 4");
+   XrdCksData cksData;
+   cksData.Set("crc32");
+   ASSERT_EQ(cks->Calc(path.c_str(), cksData, 1), 0);
+
+   std::string adler32 = FileOneShot<XrdCksCalcadler32>(path);
+   EXPECT_EQ(Recorded(*cks, "adler32"), adler32);
+   EXPECT_EQ(Recorded(*cks, "crc32"), FileOneShot<XrdCksCalccrc32>(path));
+   EXPECT_EQ(Recorded(*cks, "crc32c"), FileOneShot<XrdCksCalccrc32C>(path));
+
+   // Each digest on its own, md5 cannot be combined and is read sequentially
+   auto seq = Manager("parallel 4");
+   cksData.Reset();
+   cksData.Set("adler32");
+   ASSERT_EQ(seq->Calc(path.c_str(), cksData, 0), 0);
+   EXPECT_EQ(std::string(cksData.Value, cksData.Length), adler32);
+   cksData.Reset();
+   cksData.Set("md5");
+   EXPECT_EQ(seq->Calc(path.c_str(), cksData, 0), 0);
+}
@@ -0,0 +1,55 @@
+#ifndef __XRDCKSTESTUTILS_HH__
+#define __XRDCKSTESTUTILS_HH__
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "XrdCks/XrdCksCalc.hh"
+
+namespace XrdCksTest
+{
+inline std::vector<char> RandomData(size_t size, unsigned seed = 1)
+{
+   std::mt19937 gen(seed);
+   std::vector<char> data(size);
+   for (auto &b : data) b = (char)gen();
+   return data;
+}
+
+inline std::string Value(XrdCksCalc &calc)
+{
+   int csSize;
+   calc.Type(csSize);
+   return std::string(calc.Final(), csSize);
+}
+
+inline void WriteFile(const std::string &path, const std::vector<char> &data)
+{
+   int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+   ASSERT_GE(fd, 0);
+   ASSERT_EQ(write(fd, data.data(), data.size()), ssize_t(data.size()));
+   close(fd);
+}
+}
+#endif
@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "XrdCks/XrdCksCalcadler32.hh"
+#include "XrdCks/XrdCksCalccrc32.hh"
+#include "XrdCks/XrdCksCalccrc32C.hh"
+#include "XrdCks/XrdCksData.hh"
+#include "XrdCks/XrdCksManager.hh"
+#include "XrdOfs/XrdOfsCksWrt.hh"
+#include "XrdOss/XrdOss.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdVersion.hh"
+
+#include "XrdCksTestUtils.hh"
+
+using namespace XrdCksTest;
+
+namespace
+{
+XrdVERSIONINFODEF(myVer, XrdOfsCksWrtTest, XrdVNUMBER, XrdVERSION);
+
+// All the checksum objects see is the size of the file when it is closed.
+//
+class StatDF : public XrdOssDF
+{
+public:
+
+int  Close(long long *retsz=0) override {return 0;}
+
+int  Fstat(struct stat *sb) override
+          {return (stat(path.c_str(), sb) ? -errno : 0);}
+
+     StatDF(const std::string &path) : path(path) {}
+    ~StatDF() override {}
+
+private:
+std::string path;
+};
+
+class XrdOfsCksWrtTest : public ::testing::Test
+{
+protected:
+
+  // The streaming checksums are configured once for the whole process.
+  //
+  static void SetUpTestSuite()
+  {
+    logger = new XrdSysLogger;
+    eDest  = new XrdSysError(logger, "ofs_");
+    cks    = new XrdCksManager(eDest, 0, myVer);
+    ASSERT_EQ(cks->Init(0), 1);
+    ASSERT_TRUE(XrdOfsCksWrt::Config(cks, "adler32,crc32,crc32c", false,
+                                     false, *eDest));
+  }
+
+  void SetUp() override
+  {
+    char tmpl[] = "/tmp/xrdofscks-XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    dir  = tmpl;
+    path = dir + "/data";
+  }
+
+  void TearDown() override
+  {
+    unlink(path.c_str());
+    rmdir(dir.c_str());
+  }
+
+  // Write the data, feeding it to the object in pieces between the splits.
+  //
+  void Write(XrdOfsCksWrt &cw, const std::vector<char> &data,
+             const std::vector<size_t> &splits)
+  {
+    WriteFile(path, data);
+    size_t pos = 0;
+    for (size_t end : splits)
+        {cw.Update(pos, data.data() + pos, end - pos);
+         pos = end;
+        }
+    cw.Update(pos, data.data() + pos, data.size() - pos);
+  }
+
+  std::string Recorded(const char *name)
+  {
+    XrdCksData cksData;
+    cksData.Set(name);
+    if (cks->Get(path.c_str(), cksData) <= 0) return "";
+    return std::string(cksData.Value, cksData.Length);
+  }
+
+  template<class T>
+  static std::string OneShot(const std::vector<char> &data)
+  {
+    T calc;
+    calc.Init();
+    calc.Update(data.data(), data.size());
+    return Value(calc);
+  }
+
+  static XrdSysLogger  *logger;
+  static XrdSysError   *eDest;
+  static XrdCksManager *cks;
+  std::string dir, path;
+};
+
+XrdSysLogger  *XrdOfsCksWrtTest::logger = 0;
+XrdSysError   *XrdOfsCksWrtTest::eDest  = 0;
+XrdCksManager *XrdOfsCksWrtTest::cks    = 0;
+}
+
+//------------------------------------------------------------------------------
+// Sequential writes, split anywhere, give the checksums of the whole file.
+//------------------------------------------------------------------------------
+TEST_F(XrdOfsCksWrtTest, SequentialWrites)
+{
+   std::vector<char> data = RandomData(1024*1024 + 333);
+   std::mt19937 gen(3);
+
+   for (int round = 0; round < 10; round++)
+       {std::vector<size_t> splits;
+        int nsplit = gen() % 20;
+        for (int i = 0; i < nsplit; i++) splits.push_back(gen() % data.size());
+        std::sort(splits.begin(), splits.end());
+
+        std::unique_ptr<XrdOfsCksWrt> cw(XrdOfsCksWrt::Alloc());
+        ASSERT_TRUE(cw);
+        Write(*cw, data, splits);
+        StatDF df(path);
+        cw->Done(df, path.c_str());
+
+        EXPECT_EQ(Recorded("adler32"), OneShot<XrdCksCalcadler32>(data));
+        EXPECT_EQ(Recorded("crc32"),   OneShot<XrdCksCalccrc32>(data));
+        EXPECT_EQ(Recorded("crc32c"),  OneShot<XrdCksCalccrc32C>(data));
+        unlink(path.c_str());
+       }
+}
+
+//------------------------------------------------------------------------------
+// An empty file, truncated to what was written so far.
+//------------------------------------------------------------------------------
+TEST_F(XrdOfsCksWrtTest, EmptyFile)
+{
+   std::vector<char> data;
+   std::unique_ptr<XrdOfsCksWrt> cw(XrdOfsCksWrt::Alloc());
+   ASSERT_TRUE(cw);
+   Write(*cw, data, {});
+   cw->Truncate(0);
+   StatDF df(path);
+   cw->Done(df, path.c_str());
+   EXPECT_EQ(Recorded("adler32"), OneShot<XrdCksCalcadler32>(data));
+   EXPECT_EQ(Recorded("crc32c"),  OneShot<XrdCksCalccrc32C>(data));
+}
+
+//------------------------------------------------------------------------------
+// Nothing is recorded when the data seen may not be the data in the file.
+//------------------------------------------------------------------------------
+TEST_F(XrdOfsCksWrtTest, NotSequential)
+{
+   std::vector<char> data = RandomData(200000);
+   StatDF df(path);
+
+   // a piece written out of order
+   {std::unique_ptr<XrdOfsCksWrt> cw(XrdOfsCksWrt::Alloc());
+    WriteFile(path, data);
+    cw->Update(0, data.data(), 1000);
+    cw->Update(2000, data.data() + 2000, data.size() - 2000);
+    cw->Update(1000, data.data() + 1000, 1000);
+    cw->Done(df, path.c_str());
+    EXPECT_EQ(Recorded("adler32"), "");
+   }
+
+   // a truncation to another size
+   {std::unique_ptr<XrdOfsCksWrt> cw(XrdOfsCksWrt::Alloc());
+    Write(*cw, data, {50000});
+    cw->Truncate(100);
+    cw->Done(df, path.c_str());
+    EXPECT_EQ(Recorded("crc32"), "");
+   }
+
+   // the file is larger than what was seen
+   {std::unique_ptr<XrdOfsCksWrt> cw(XrdOfsCksWrt::Alloc());
+    WriteFile(path, data);
+    cw->Update(0, data.data(), data.size() - 1);
+    cw->Done(df, path.c_str());
+    EXPECT_EQ(Recorded("crc32c"), "");
+   }
+
+   // explicitly reset
+   {std::unique_ptr<XrdOfsCksWrt> cw(XrdOfsCksWrt::Alloc());
+    Write(*cw, data, {});
+    cw->Reset();
+    cw->Done(df, path.c_str());
+    EXPECT_EQ(Recorded("adler32"), "");
+   }
+}
@@ -0,0 +1,409 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+#include "XrdCl/XrdClAsyncMsgWriter.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClXRootDTransport.hh"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace XrdCl;
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // A socket that records what is written instead of sending it. It sits on
+  // a real TCP connection only so that corking and flashing work.
+  //----------------------------------------------------------------------------
+  class RecordingSocket : public Socket
+  {
+    public:
+      RecordingSocket( int fd ) : Socket( fd, Socket::Connected ) { }
+
+      XRootDStatus Send( const char *buffer, size_t size, int &bytesWritten ) override
+      {
+        ++calls;
+        if( retryEvery && calls % retryEvery == 0 )
+          return XRootDStatus( stOK, suRetry );
+        if( failAt && data.size() >= failAt )
+          return XRootDStatus( stError, errSocketError, EPIPE );
+
+        size_t n = size;
+        if( maxWrite ) n = std::min( n, maxWrite );
+        if( failAt )   n = std::min( n, failAt - data.size() );
+        data.append( buffer, n );
+        bytesWritten = n;
+        ++writes;
+        return XRootDStatus();
+      }
+
+      std::string data;           //< everything written so far
+      size_t      calls      = 0; //< number of Send calls
+      size_t      writes     = 0; //< number of Send calls that wrote something
+      size_t      maxWrite   = 0; //< accept at most that many bytes per call
+      size_t      retryEvery = 0; //< ask to retry every that many calls
+      size_t      failAt     = 0; //< break the connection after that many bytes
+  };
+
+  //----------------------------------------------------------------------------
+  // A request handler, possibly with raw data following the request
+  //----------------------------------------------------------------------------
+  class TestHandler : public MsgHandler
+  {
+    public:
+      TestHandler( std::string body = std::string() ) : body( std::move( body ) ) { }
+
+      uint16_t Examine( std::shared_ptr<Message>& ) override { return Ignore; }
+      uint16_t InspectStatusRsp() override { return Ignore; }
+      uint16_t GetSid() const override { return 0; }
+      void OnStatusReady( const Message*, XRootDStatus ) override { }
+      time_t GetExpiration() override { return 0; }
+      bool IsRaw() const override { return !body.empty(); }
+
+      XRootDStatus WriteMessageBody( Socket *socket, uint32_t &bytesWritten ) override
+      {
+        while( offset < body.size() )
+        {
+          int wrtcnt = 0;
+          XRootDStatus st = socket->Send( body.data() + offset, body.size() - offset, wrtcnt );
+          if( !st.IsOK() || st.code == suRetry ) return st;
+          offset       += wrtcnt;
+          bytesWritten += wrtcnt;
+        }
+        return XRootDStatus();
+      }
+
+      std::string body;
+      size_t      offset = 0;
+  };
+
+  //----------------------------------------------------------------------------
+  // A transport that signs every request, if asked to
+  //----------------------------------------------------------------------------
+  class SigningTransport : public XRootDTransport
+  {
+    public:
+      using XRootDTransport::GetSignature;
+
+      Status GetSignature( Message *toSign, Message *&sign, AnyObject& ) override
+      {
+        if( !signing ) return Status();
+        sign = new Message( 16 );
+        memset( sign->GetBuffer(), 'S', 16 );
+        sign->GetBuffer()[0] = toSign->GetBuffer()[0];
+        return Status();
+      }
+
+      bool signing = false;
+  };
+
+  //----------------------------------------------------------------------------
+  // A stream handing out queued messages and recording when they get reported
+  // as sent
+  //----------------------------------------------------------------------------
+  class FakeStream : public Stream
+  {
+    public:
+      FakeStream( const URL *url, RecordingSocket &sock ) : Stream( url ), sock( sock ) { }
+
+      std::pair<Message*, MsgHandler*> OnReadyToWrite( uint16_t, bool ) override
+      {
+        if( queue.empty() ) return std::make_pair( nullptr, nullptr );
+        current = queue.front();
+        queue.pop_front();
+        return current;
+      }
+
+      void OnMessageSent( uint16_t, Message *msg, uint32_t bytesSent ) override
+      {
+        Sent( msg, bytesSent );
+        current = std::make_pair( nullptr, nullptr );
+      }
+
+      void OnMessageBatched( uint16_t, uint32_t bytes ) override
+      {
+        batched.emplace_back( current.first, bytes );
+        current = std::make_pair( nullptr, nullptr );
+      }
+
+      void OnBatchSent( uint16_t ) override
+      {
+        for( auto &b : batched ) Sent( b.first, b.second );
+        batched.clear();
+      }
+
+      void Sent( Message *msg, uint32_t bytesSent )
+      {
+        // a message may only be reported once all of its bytes are written
+        sentBytes += bytesSent;
+        EXPECT_LE( sentBytes, sock.data.size() );
+        sent.push_back( msg );
+      }
+
+      RecordingSocket                                 &sock;
+      std::deque<std::pair<Message*, MsgHandler*>>     queue;
+      std::pair<Message*, MsgHandler*>                 current;
+      std::vector<std::pair<Message*, uint32_t>>       batched;
+      std::vector<Message*>                            sent;
+      size_t                                           sentBytes = 0;
+  };
+
+  //----------------------------------------------------------------------------
+  // Open a loopback TCP connection, return the client end
+  //----------------------------------------------------------------------------
+  int Connect( int &peer )
+  {
+    int lsn = socket( AF_INET, SOCK_STREAM, 0 );
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    socklen_t len = sizeof( addr );
+    if( bind( lsn, (sockaddr*)&addr, len ) || listen( lsn, 1 ) ||
+        getsockname( lsn, (sockaddr*)&addr, &len ) )
+      return -1;
+    int fd = socket( AF_INET, SOCK_STREAM, 0 );
+    if( connect( fd, (sockaddr*)&addr, len ) ) return -1;
+    peer = accept( lsn, nullptr, nullptr );
+    close( lsn );
+    return fd;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Fixture
+//------------------------------------------------------------------------------
+class AsyncMsgWriterTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+      int fd = Connect( peer );
+      ASSERT_GE( fd, 0 );
+      ASSERT_GE( peer, 0 );
+      sock.reset( new RecordingSocket( fd ) );
+      strm.reset( new FakeStream( &url, *sock ) );
+    }
+
+    void TearDown() override
+    {
+      strm.reset();
+      sock.reset();
+      close( peer );
+    }
+
+    //--------------------------------------------------------------------------
+    // Queue a request of the given size, optionally followed by raw data
+    //--------------------------------------------------------------------------
+    void Queue( uint32_t size, const std::string &body = std::string() )
+    {
+      char id = 'a' + msgs.size();
+      msgs.emplace_back( new Message( size ) );
+      memset( msgs.back()->GetBuffer(), id, size );
+      handlers.emplace_back( new TestHandler( body ) );
+      strm->queue.emplace_back( msgs.back().get(), handlers.back().get() );
+
+      if( transport.signing )
+      {
+        expected += id;
+        expected += std::string( 15, 'S' );
+      }
+      expected += std::string( size, id );
+      expected += body;
+    }
+
+    //--------------------------------------------------------------------------
+    // Make a writer with the given limits
+    //--------------------------------------------------------------------------
+    std::unique_ptr<AsyncMsgWriter> MakeWriter( int batchsize, int batchcount )
+    {
+      Env *env = DefaultEnv::GetEnv();
+      env->PutInt( "WriteBatchSize",  batchsize );
+      env->PutInt( "WriteBatchCount", batchcount );
+      return std::unique_ptr<AsyncMsgWriter>(
+          new AsyncMsgWriter( transport, *sock, name, *strm, 0, chdata ) );
+    }
+
+    //--------------------------------------------------------------------------
+    // Call the writer, as the socket handler would on write readiness, until
+    // it has nothing left to do
+    //--------------------------------------------------------------------------
+    XRootDStatus Drain( AsyncMsgWriter &writer )
+    {
+      for( int i = 0; i < 10000; ++i )
+      {
+        XRootDStatus st = writer.Write();
+        if( !st.IsOK() || st.code == suAlreadyDone ) return st;
+        if( st.code != suRetry ) writer.Reset();
+      }
+      return XRootDStatus( stError, errInternal );
+    }
+
+    //--------------------------------------------------------------------------
+    // Check that everything has been written, in order, and reported as sent
+    //--------------------------------------------------------------------------
+    void CheckAllSent()
+    {
+      EXPECT_EQ( sock->data, expected );
+      ASSERT_EQ( strm->sent.size(), msgs.size() );
+      for( size_t i = 0; i < msgs.size(); ++i )
+        EXPECT_EQ( strm->sent[i], msgs[i].get() ) << "message " << i;
+      EXPECT_EQ( strm->sentBytes, expected.size() );
+      EXPECT_TRUE( strm->batched.empty() );
+    }
+
+    URL                                       url{ "root://localhost:1094" };
+    std::string                               name{ "test" };
+    AnyObject                                 chdata;
+    int                                       peer = -1;
+    SigningTransport                          transport;
+    std::unique_ptr<RecordingSocket>          sock;
+    std::unique_ptr<FakeStream>               strm;
+    std::vector<std::unique_ptr<Message>>     msgs;
+    std::vector<std::unique_ptr<TestHandler>> handlers;
+    std::string                               expected;
+};
+
+//------------------------------------------------------------------------------
+// No more than the given number of messages go in one write
+//------------------------------------------------------------------------------
+TEST_F(AsyncMsgWriterTest, CountLimit)
+{
+  auto writer = MakeWriter( 16384, 4 );
+  for( int i = 0; i < 10; ++i ) Queue( 24 );
+
+  XRootDStatus st = Drain( *writer );
+  EXPECT_EQ( st.code, suAlreadyDone );
+  CheckAllSent();
+  EXPECT_EQ( sock->writes, 3u );
+}
+
+//------------------------------------------------------------------------------
+// No more than the given number of bytes go in one write; a message that does
+// not fit at all is written on its own, after what has been batched before it
+//------------------------------------------------------------------------------
+TEST_F(AsyncMsgWriterTest, SizeLimit)
+{
+  auto writer = MakeWriter( 100, 64 );
+  for( int i = 0; i < 5; ++i ) Queue( 24 );
+  Queue( 300 );
+  for( int i = 0; i < 4; ++i ) Queue( 24 );
+
+  XRootDStatus st = Drain( *writer );
+  EXPECT_EQ( st.code, suAlreadyDone );
+  CheckAllSent();
+  // 4 messages, 1 message, the large one, 4 messages
+  EXPECT_EQ( sock->writes, 4u );
+}
+
+//------------------------------------------------------------------------------
+// With batching disabled every message is written on its own
+//------------------------------------------------------------------------------
+TEST_F(AsyncMsgWriterTest, Disabled)
+{
+  auto writer = MakeWriter( 0, 64 );
+  for( int i = 0; i < 5; ++i ) Queue( 24 );
+
+  XRootDStatus st = Drain( *writer );
+  EXPECT_EQ( st.code, suAlreadyDone );
+  CheckAllSent();
+  EXPECT_EQ( sock->writes, 5u );
+}
+
+//------------------------------------------------------------------------------
+// Each signature goes right before its request, in the same write
+//------------------------------------------------------------------------------
+TEST_F(AsyncMsgWriterTest, SignedMessages)
+{
+  transport.signing = true;
+  auto writer = MakeWriter( 16384, 8 );
+  for( int i = 0; i < 6; ++i ) Queue( 24 );
+
+  XRootDStatus st = Drain( *writer );
+  EXPECT_EQ( st.code, suAlreadyDone );
+  CheckAllSent();
+  EXPECT_EQ( sock->writes, 1u );
+}
+
+//------------------------------------------------------------------------------
+// Requests with raw data are not batched but keep their place in the order
+//------------------------------------------------------------------------------
+TEST_F(AsyncMsgWriterTest, RawData)
+{
+  auto writer = MakeWriter( 16384, 8 );
+  Queue( 24 );
+  Queue( 24 );
+  Queue( 24, std::string( 500, 'R' ) );
+  Queue( 24 );
+
+  XRootDStatus st = Drain( *writer );
+  EXPECT_EQ( st.code, suAlreadyDone );
+  CheckAllSent();
+  // the batch, the request with raw data, its body, the last request
+  EXPECT_EQ( sock->writes, 4u );
+}
+
+//------------------------------------------------------------------------------
+// A batch written in several pieces, with the socket asking to retry now and
+// then, is only reported as sent once it has been written out completely
+//------------------------------------------------------------------------------
+TEST_F(AsyncMsgWriterTest, PartialWrites)
+{
+  transport.signing = true;
+  sock->maxWrite   = 7;
+  sock->retryEvery = 3;
+  auto writer = MakeWriter( 16384, 8 );
+  for( int i = 0; i < 20; ++i ) Queue( 24 );
+
+  XRootDStatus st = Drain( *writer );
+  EXPECT_EQ( st.code, suAlreadyDone );
+  CheckAllSent();
+}
+
+//------------------------------------------------------------------------------
+// When the connection breaks in the middle of a batch none of the batched
+// messages is reported as sent; the stream still holds them, so that they
+// get requeued
+//------------------------------------------------------------------------------
+TEST_F(AsyncMsgWriterTest, BrokenConnection)
+{
+  sock->failAt = 50;
+  auto writer = MakeWriter( 16384, 4 );
+  for( int i = 0; i < 6; ++i ) Queue( 24 );
+
+  XRootDStatus st = Drain( *writer );
+  EXPECT_FALSE( st.IsOK() );
+  EXPECT_TRUE( strm->sent.empty() );
+  ASSERT_EQ( strm->batched.size(), 4u );
+  for( size_t i = 0; i < 4; ++i )
+  {
+    EXPECT_EQ( strm->batched[i].first, msgs[i].get() );
+    EXPECT_EQ( strm->batched[i].second, 24u );
+  }
+  // the message that did not fit in the batch has been taken out too
+  EXPECT_EQ( strm->current.first, msgs[4].get() );
+  EXPECT_EQ( strm->queue.size(), 1u );
+}
@@ -29,6 +29,7 @@
 #include "XrdCl/XrdClUtils.hh"
 #include "XrdCl/XrdClCheckSumManager.hh"
 #include "XrdCl/XrdClCopyProcess.hh"
+#include "XrdCl/XrdClConstants.hh"
 
 #include "XrdCks/XrdCks.hh"
 #include "XrdCks/XrdCksCalc.hh"
@@ -40,6 +41,34 @@
 
 using namespace XrdClTests;
 
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Set an integer in the default environment for the lifetime of the object,
+  // so that it is restored even if the test bails out
+  //----------------------------------------------------------------------------
+  class ScopedEnvInt
+  {
+    public:
+      ScopedEnvInt( const std::string &key, int value, int defaultValue ):
+        pKey( key ), pOld( defaultValue )
+      {
+        XrdCl::Env *env = XrdCl::DefaultEnv::GetEnv();
+        env->GetInt( pKey, pOld );
+        env->PutInt( pKey, value );
+      }
+
+      ~ScopedEnvInt()
+      {
+        XrdCl::DefaultEnv::GetEnv()->PutInt( pKey, pOld );
+      }
+
+    private:
+      std::string pKey;
+      int         pOld;
+  };
+}
+
 //------------------------------------------------------------------------------
 // Declaration
 //------------------------------------------------------------------------------
@@ -654,3 +683,113 @@ TEST_F(FileCopyTest, NormalCopyTest)
 {
   CopyTestFunc( false );
 }
+
+//------------------------------------------------------------------------------
+// Download and upload with small chunks and many of them in flight, so that
+// the chunks complete out of order and the checksums of the local files are
+// computed by the checksum stage
+//------------------------------------------------------------------------------
+TEST_F(FileCopyTest, PipelinedCopyTest)
+{
+  using namespace XrdCl;
+
+  Env *testEnv = TestEnv::GetEnv();
+
+  std::string manager1;
+  std::string manager2;
+  std::string sourceFile;
+  std::string dataPath;
+  std::string relativeDataPath;
+
+  EXPECT_TRUE( testEnv->GetString( "Manager1URL",         manager1 ) );
+  EXPECT_TRUE( testEnv->GetString( "Manager2URL",         manager2 ) );
+  EXPECT_TRUE( testEnv->GetString( "RemoteFile",        sourceFile ) );
+  EXPECT_TRUE( testEnv->GetString( "DataPath",            dataPath ) );
+  EXPECT_TRUE( testEnv->GetString( "LocalDataPath", relativeDataPath ) );
+
+  char *localDataPath = realpath( relativeDataPath.c_str(), NULL );
+  ASSERT_TRUE( localDataPath );
+  std::string localFile  = std::string( localDataPath ) + "/metaman/pipelined.dat";
+  free( localDataPath );
+  std::string sourceURL  = manager1 + "/" + sourceFile;
+  std::string targetPath = dataPath + "/pipelinedFile";
+  std::string targetURL  = manager2 + "/" + targetPath;
+
+  // let the number of chunks in flight grow past the initial one
+  ScopedEnvInt maxParallel( "CPMaxParallelChunks", 32,
+                            DefaultCPMaxParallelChunks );
+
+  const char *cksTypes[] = { "crc32c", "adler32" };
+  for( const char *cksType : cksTypes )
+  {
+    //--------------------------------------------------------------------------
+    // Remote to local, the destination checksum is computed while writing
+    //--------------------------------------------------------------------------
+    CopyProcess  download;
+    PropertyList properties, results;
+    properties.Set( "source",         sourceURL );
+    properties.Set( "target",         "file://localhost" + localFile );
+    properties.Set( "checkSumMode",   "end2end" );
+    properties.Set( "checkSumType",   cksType   );
+    properties.Set( "chunkSize",      64*1024   );
+    properties.Set( "parallelChunks", 8         );
+    properties.Set( "force",          true      );
+    GTEST_ASSERT_XRDST( download.AddJob( properties, &results ) );
+    GTEST_ASSERT_XRDST( download.Prepare() );
+    GTEST_ASSERT_XRDST( download.Run(0) );
+
+    //--------------------------------------------------------------------------
+    // Local to remote, the source checksum is computed while reading
+    //--------------------------------------------------------------------------
+    CopyProcess upload;
+    properties.Clear(); results.Clear();
+    properties.Set( "source",         "file://localhost" + localFile );
+    properties.Set( "target",         targetURL );
+    properties.Set( "checkSumMode",   "end2end" );
+    properties.Set( "checkSumType",   cksType   );
+    properties.Set( "chunkSize",      64*1024   );
+    properties.Set( "parallelChunks", 8         );
+    properties.Set( "force",          true      );
+    GTEST_ASSERT_XRDST( upload.AddJob( properties, &results ) );
+    GTEST_ASSERT_XRDST( upload.Prepare() );
+    GTEST_ASSERT_XRDST( upload.Run(0) );
+
+    //--------------------------------------------------------------------------
+    // The checksum computed while writing is the one of the data on disk:
+    // given the right value a download checking only the target succeeds,
+    // given a wrong one it fails
+    //--------------------------------------------------------------------------
+    std::string expected;
+    GTEST_ASSERT_XRDST( Utils::GetLocalCheckSum( expected, cksType, localFile ) );
+    expected = expected.substr( expected.find( ':' ) + 1 );
+
+    const char *presets[] = { expected.c_str(), "0badc0de" };
+    for( const char *preset : presets )
+    {
+      CopyProcess check;
+      properties.Clear(); results.Clear();
+      properties.Set( "source",         sourceURL );
+      properties.Set( "target",         "file://localhost" + localFile );
+      properties.Set( "checkSumMode",   "target"  );
+      properties.Set( "checkSumType",   cksType   );
+      properties.Set( "checkSumPreset", preset    );
+      properties.Set( "chunkSize",      64*1024   );
+      properties.Set( "parallelChunks", 8         );
+      properties.Set( "force",          true      );
+      GTEST_ASSERT_XRDST( check.AddJob( properties, &results ) );
+      GTEST_ASSERT_XRDST( check.Prepare() );
+      if( preset == expected.c_str() )
+      {
+        GTEST_ASSERT_XRDST( check.Run(0) );
+      }
+      else
+      {
+        GTEST_ASSERT_XRDST_NOTOK( check.Run(0), errCheckSumError );
+      }
+    }
+  }
+
+  FileSystem fs( manager2 );
+  GTEST_ASSERT_XRDST( fs.Rm( targetPath ) );
+  EXPECT_EQ( remove( localFile.c_str() ), 0 );
+}
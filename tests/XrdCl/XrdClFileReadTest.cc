@@ -0,0 +1,231 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "TestEnv.hh"
+
+#include "GTestXrdHelpers.hh"
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace XrdClTests;
+using namespace XrdCl;
+
+//------------------------------------------------------------------------------
+// Reads that go through the read-ahead or get split into several vector
+// reads must return the same bytes as plain reads of the same file
+//------------------------------------------------------------------------------
+class FileReadTest: public ::testing::Test
+{
+  public:
+    void SetUp() override;
+
+    //--------------------------------------------------------------------------
+    // Read a chunk and compare it with the reference copy of the file
+    //--------------------------------------------------------------------------
+    void ReadAndCompare( File &f, uint64_t offset, uint32_t size );
+
+    std::string       fileUrl;
+    std::vector<char> reference;
+};
+
+void FileReadTest::SetUp()
+{
+  Env *testEnv = TestEnv::GetEnv();
+
+  std::string address;
+  std::string remoteFile;
+
+  EXPECT_TRUE( testEnv->GetString( "MainServerURL", address ) );
+  EXPECT_TRUE( testEnv->GetString( "RemoteFile",    remoteFile ) );
+
+  fileUrl = address + "/" + remoteFile;
+
+  //----------------------------------------------------------------------------
+  // Fetch the whole file with plain reads
+  //----------------------------------------------------------------------------
+  const uint32_t  MB = 1024*1024;
+  File            f;
+  StatInfo       *stat = nullptr;
+
+  GTEST_ASSERT_XRDST( f.Open( fileUrl, OpenFlags::Read ) );
+  GTEST_ASSERT_XRDST( f.Stat( false, stat ) );
+  ASSERT_TRUE( stat );
+  reference.resize( stat->GetSize() );
+  delete stat;
+
+  uint64_t totalRead = 0;
+  while( totalRead < reference.size() )
+  {
+    uint32_t bytesRead = 0;
+    uint32_t toRead = std::min<uint64_t>( 4*MB, reference.size() - totalRead );
+    GTEST_ASSERT_XRDST( f.Read( totalRead, toRead, reference.data() + totalRead,
+                                bytesRead ) );
+    ASSERT_GT( bytesRead, 0 );
+    totalRead += bytesRead;
+  }
+  GTEST_ASSERT_XRDST( f.Close() );
+  ASSERT_GE( reference.size(), 8*MB );
+}
+
+void FileReadTest::ReadAndCompare( File &f, uint64_t offset, uint32_t size )
+{
+  std::vector<char> buffer( size );
+  uint32_t bytesRead = 0;
+  GTEST_ASSERT_XRDST( f.Read( offset, size, buffer.data(), bytesRead ) );
+  uint32_t expected = offset >= reference.size() ? 0 :
+                      std::min<uint64_t>( size, reference.size() - offset );
+  ASSERT_EQ( bytesRead, expected ) << "read of " << size << " at " << offset;
+  EXPECT_EQ( memcmp( buffer.data(), reference.data() + offset, bytesRead ), 0 )
+    << "data mismatch in read of " << size << " at " << offset;
+}
+
+//------------------------------------------------------------------------------
+// Sequential reads, not aligned to the read-ahead blocks, up to and past the
+// end of the file
+//------------------------------------------------------------------------------
+TEST_F(FileReadTest, ReadAheadSequentialTest)
+{
+  Env *env = DefaultEnv::GetEnv();
+  env->PutInt( "ReadAheadBlockSize", 128*1024 );
+  env->PutInt( "ReadAheadWindow",    8 );
+
+  File f;
+  GTEST_ASSERT_XRDST( f.Open( fileUrl + "?xrdcl.readahead=true", OpenFlags::Read ) );
+  std::string value;
+  EXPECT_TRUE( f.GetProperty( "ReadAhead", value ) );
+  EXPECT_EQ( value, "true" );
+
+  const uint32_t size = 50000;
+  for( uint64_t offset = 0; offset < reference.size() + size; offset += size )
+  {
+    ReadAndCompare( f, offset, size );
+    if( HasFatalFailure() ) break;
+  }
+  GTEST_ASSERT_XRDST( f.Close() );
+}
+
+//------------------------------------------------------------------------------
+// A sequential pattern interrupted by seeks forwards and backwards, followed
+// by a strided one; the prefetched blocks must not be returned for the wrong
+// offsets
+//------------------------------------------------------------------------------
+TEST_F(FileReadTest, ReadAheadSeekTest)
+{
+  Env *env = DefaultEnv::GetEnv();
+  env->PutInt( "ReadAheadBlockSize", 128*1024 );
+  env->PutInt( "ReadAheadWindow",    8 );
+
+  const uint32_t MB = 1024*1024;
+  File f;
+  GTEST_ASSERT_XRDST( f.Open( fileUrl + "?xrdcl.readahead=true", OpenFlags::Read ) );
+
+  uint64_t offset = 0;
+  for( int i = 0; i < 40; ++i, offset += 32768 )
+    ReadAndCompare( f, offset, 32768 );
+
+  // jump ahead, into a region that has not been prefetched
+  offset = 5*MB + 12345;
+  for( int i = 0; i < 40; ++i, offset += 32768 )
+    ReadAndCompare( f, offset, 32768 );
+
+  // jump back, into blocks that may still be cached
+  offset = 100000;
+  for( int i = 0; i < 40; ++i, offset += 20000 )
+    ReadAndCompare( f, offset, 20000 );
+
+  // strided reads of the same size
+  for( offset = 2*MB + 7; offset < 6*MB; offset += 65536 + 4096 )
+    ReadAndCompare( f, offset, 4096 );
+
+  // a read spanning the last block and the end of the file
+  ReadAndCompare( f, reference.size() - 70000, 100000 );
+
+  GTEST_ASSERT_XRDST( f.Close() );
+}
+
+//------------------------------------------------------------------------------
+// A vector read with more elements than fit in a single kXR_readv request and
+// an element larger than the server allows in one, so that the list is split
+// and sent as several requests
+//------------------------------------------------------------------------------
+TEST_F(FileReadTest, VectorReadSplitTest)
+{
+  const uint32_t MB = 1024*1024;
+  File f;
+  GTEST_ASSERT_XRDST( f.Open( fileUrl, OpenFlags::Read ) );
+
+  //----------------------------------------------------------------------------
+  // Gaps between the chunks, so that none can be merged
+  //----------------------------------------------------------------------------
+  ChunkList chunks;
+  uint64_t  total = 0;
+  chunks.push_back( ChunkInfo( 3*MB + 1, 3*MB ) );
+  total += 3*MB;
+  for( uint64_t offset = 7*MB; chunks.size() < 2500; offset += 3001 )
+  {
+    ASSERT_LT( offset + 1000, reference.size() );
+    chunks.push_back( ChunkInfo( offset, 1000 ) );
+    total += 1000;
+  }
+  chunks.push_back( ChunkInfo( 17, 777 ) );
+  total += 777;
+
+  std::vector<char> buffer( total );
+  VectorReadInfo *info = nullptr;
+  GTEST_ASSERT_XRDST( f.VectorRead( chunks, buffer.data(), info ) );
+  ASSERT_TRUE( info );
+  EXPECT_EQ( info->GetSize(), total );
+
+  //----------------------------------------------------------------------------
+  // The response describes the chunks as they were asked for
+  //----------------------------------------------------------------------------
+  ChunkList &got = info->GetChunks();
+  ASSERT_EQ( got.size(), chunks.size() );
+  uint64_t pos = 0;
+  for( size_t i = 0; i < chunks.size(); ++i )
+  {
+    EXPECT_EQ( got[i].offset, chunks[i].offset );
+    ASSERT_EQ( got[i].length, chunks[i].length );
+    EXPECT_EQ( memcmp( buffer.data() + pos, reference.data() + chunks[i].offset,
+                       chunks[i].length ), 0 ) << "chunk " << i;
+    pos += chunks[i].length;
+  }
+  delete info;
+
+  //----------------------------------------------------------------------------
+  // Same with the buffers given in the chunk list
+  //----------------------------------------------------------------------------
+  std::vector<char> buffer2( total );
+  pos = 0;
+  for( auto &chunk : chunks )
+  {
+    chunk.buffer = buffer2.data() + pos;
+    pos += chunk.length;
+  }
+  info = nullptr;
+  GTEST_ASSERT_XRDST( f.VectorRead( chunks, nullptr, info ) );
+  ASSERT_TRUE( info );
+  EXPECT_EQ( info->GetSize(), total );
+  EXPECT_EQ( buffer2, buffer );
+  delete info;
+
+  GTEST_ASSERT_XRDST( f.Close() );
+}
@@ -0,0 +1,305 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "GTestXrdHelpers.hh"
+#include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClIoUring.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace XrdCl;
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // A request that records its result
+  //----------------------------------------------------------------------------
+  class TestRequest : public IoUring::Request
+  {
+    public:
+      TestRequest(): result( 0 ), done( false ), sem( 0 ) {}
+
+      void Done( int res ) override
+      {
+        result = res;
+        done   = true;
+        sem.Post();
+      }
+
+      int               result;
+      std::atomic<bool> done;
+      XrdSysSemaphore   sem;
+  };
+
+  int Threads()
+  {
+    int n = 0;
+    DIR *dir = opendir( "/proc/self/task" );
+    if( !dir ) return -1;
+    while( struct dirent *ent = readdir( dir ) )
+      if( ent->d_name[0] != '.' ) ++n;
+    closedir( dir );
+    return n;
+  }
+
+  std::string TempFile()
+  {
+    char tmpl[] = "/tmp/xrdcl-iouring-XXXXXX";
+    int fd = mkstemp( tmpl );
+    if( fd < 0 ) return std::string();
+    close( fd );
+    return tmpl;
+  }
+
+  //----------------------------------------------------------------------------
+  // Write and read back a local file through XrdCl
+  //----------------------------------------------------------------------------
+  bool WriteReadBack( const std::string &path, size_t size )
+  {
+    std::string data( size, 0 );
+    for( size_t i = 0; i < size; ++i ) data[i] = char( i * 13 );
+
+    File file;
+    if( !file.Open( path, OpenFlags::Update ).IsOK() ) return false;
+    bool ok = file.Write( 0, size, data.data() ).IsOK() &&
+              file.Sync().IsOK();
+    std::string back( size, 0 );
+    uint32_t bytesRead = 0;
+    ok = ok && file.Read( 0, size, &back[0], bytesRead ).IsOK() &&
+         bytesRead == size && back == data;
+    return file.Close().IsOK() && ok;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Every test starts with a ring set up from the default configuration
+//------------------------------------------------------------------------------
+class IoUringTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+      IoUring::Shutdown();
+      if( !IoUring::Get() ) GTEST_SKIP() << "io_uring is not available";
+    }
+
+    void TearDown() override
+    {
+      DefaultEnv::GetEnv()->PutInt( "IoUring", DefaultIoUring );
+      DefaultEnv::GetEnv()->PutInt( "IoUringDepth", DefaultIoUringDepth );
+      IoUring::Shutdown();
+    }
+};
+
+//------------------------------------------------------------------------------
+// Shutting down waits for the requests in flight, stops the reaper thread and
+// lets the next user set up a new ring
+//------------------------------------------------------------------------------
+TEST_F(IoUringTest, Shutdown)
+{
+  IoUring *ring = IoUring::Get();
+  int pipefd[2];
+  ASSERT_EQ( pipe( pipefd ), 0 );
+
+  // a read from an empty pipe stays in flight until something is written
+  char buff[16];
+  TestRequest req;
+  ASSERT_TRUE( ring->Read( pipefd[0], 0, sizeof( buff ), buff, &req ) );
+
+  int before = Threads();
+  std::atomic<bool> stopped( false );
+  std::thread stopper( [&]{ IoUring::Shutdown(); stopped = true; } );
+  std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+  EXPECT_FALSE( stopped );
+  EXPECT_FALSE( req.done );
+
+  ASSERT_EQ( write( pipefd[1], "abc", 3 ), 3 );
+  stopper.join();
+  EXPECT_TRUE( req.done );
+  EXPECT_EQ( req.result, 3 );
+  EXPECT_EQ( Threads(), before - 1 );
+  close( pipefd[0] );
+  close( pipefd[1] );
+
+  // shutting down twice is harmless, and a new ring comes up on demand
+  IoUring::Shutdown();
+  ASSERT_NE( IoUring::Get(), nullptr );
+  std::string path = TempFile();
+  ASSERT_FALSE( path.empty() );
+  EXPECT_TRUE( WriteReadBack( path, 100000 ) );
+  unlink( path.c_str() );
+}
+
+//------------------------------------------------------------------------------
+// When the completion queue is full the ring refuses new requests and the
+// local files fall back to POSIX aio
+//------------------------------------------------------------------------------
+TEST_F(IoUringTest, FullQueue)
+{
+  IoUring::Shutdown();
+  DefaultEnv::GetEnv()->PutInt( "IoUringDepth", 1 );
+  IoUring *ring = IoUring::Get();
+  ASSERT_NE( ring, nullptr );
+
+  int pipefd[2];
+  ASSERT_EQ( pipe( pipefd ), 0 );
+  std::vector<TestRequest*> reqs;
+  char buff[64];
+  for( int i = 0; i < 16; ++i )
+  {
+    TestRequest *req = new TestRequest();
+    if( !ring->Read( pipefd[0], 0, 1, buff + i, req ) )
+    {
+      delete req;
+      break;
+    }
+    reqs.push_back( req );
+  }
+  // a ring of one entry has a completion queue of two
+  ASSERT_EQ( reqs.size(), 2u );
+  TestRequest extra;
+  EXPECT_FALSE( ring->Fsync( pipefd[1], &extra ) );
+
+  std::string path = TempFile();
+  ASSERT_FALSE( path.empty() );
+  EXPECT_TRUE( WriteReadBack( path, 300000 ) );
+  unlink( path.c_str() );
+
+  // once the requests complete there is room again
+  ASSERT_EQ( write( pipefd[1], "xy", 2 ), 2 );
+  for( auto req : reqs )
+  {
+    req->sem.Wait();
+    EXPECT_EQ( req->result, 1 );
+    delete req;
+  }
+  std::string data( 4096, 'q' );
+  int fd = open( path.c_str(), O_RDWR | O_CREAT, 0600 );
+  ASSERT_GE( fd, 0 );
+  ASSERT_TRUE( ring->Write( fd, 0, data.size(), data.data(), &extra ) );
+  extra.sem.Wait();
+  EXPECT_EQ( extra.result, int( data.size() ) );
+  close( fd );
+  unlink( path.c_str() );
+  close( pipefd[0] );
+  close( pipefd[1] );
+}
+
+//------------------------------------------------------------------------------
+// A forked child does not use the ring of its parent but one of its own, also
+// when the parent has been using the POSIX aio fallback, which is not usable
+// in the child anymore
+//------------------------------------------------------------------------------
+TEST_F(IoUringTest, FallbackAfterFork)
+{
+  std::string path = TempFile();
+  ASSERT_FALSE( path.empty() );
+
+  DefaultEnv::GetEnv()->PutInt( "IoUring", 0 );
+  IoUring::Shutdown();
+  ASSERT_EQ( IoUring::Get(), nullptr );
+  EXPECT_TRUE( WriteReadBack( path, 200000 ) );
+
+  DefaultEnv::GetEnv()->PutInt( "IoUring", 1 );
+  IoUring::Shutdown();
+  IoUring *ring = IoUring::Get();
+  ASSERT_NE( ring, nullptr );
+
+  // let the idle aio thread of the parent go away
+  std::this_thread::sleep_for( std::chrono::milliseconds( 1500 ) );
+
+  pid_t pid = fork();
+  ASSERT_GE( pid, 0 );
+  if( pid == 0 )
+  {
+    int rc = 0;
+    IoUring *child = IoUring::Get();
+    if( !child ) rc |= 1;
+    if( !WriteReadBack( path, 200000 ) ) rc |= 2;
+    IoUring::Shutdown();
+    _exit( rc );
+  }
+
+  int status = 0;
+  ASSERT_EQ( waitpid( pid, &status, 0 ), pid );
+  ASSERT_TRUE( WIFEXITED( status ) );
+  EXPECT_EQ( WEXITSTATUS( status ), 0 );
+
+  // the parent keeps its ring, untouched by the child
+  EXPECT_EQ( IoUring::Get(), ring );
+  EXPECT_TRUE( WriteReadBack( path, 200000 ) );
+  unlink( path.c_str() );
+}
+
+//------------------------------------------------------------------------------
+// A write the kernel completes only in part is finished by the local file
+// handler, here it runs into the file size limit and must fail rather than
+// report the partial write as a success
+//------------------------------------------------------------------------------
+TEST_F(IoUringTest, ShortWrite)
+{
+  std::string path = TempFile();
+  ASSERT_FALSE( path.empty() );
+
+  const rlim_t limit = 256 * 1024;
+  struct rlimit saved;
+  ASSERT_EQ( getrlimit( RLIMIT_FSIZE, &saved ), 0 );
+  struct rlimit lim = saved;
+  lim.rlim_cur = limit;
+  void (*oldHandler)( int ) = signal( SIGXFSZ, SIG_IGN );
+  ASSERT_EQ( setrlimit( RLIMIT_FSIZE, &lim ), 0 );
+
+  std::string data( 1024 * 1024, 'w' );
+  File file;
+  XRootDStatus st = file.Open( path, OpenFlags::Update );
+  XRootDStatus wst;
+  if( st.IsOK() )
+  {
+    wst = file.Write( 0, data.size(), data.data() );
+    XRootDStatus cst = file.Close();
+    EXPECT_TRUE( cst.IsOK() );
+  }
+
+  setrlimit( RLIMIT_FSIZE, &saved );
+  signal( SIGXFSZ, oldHandler );
+
+  GTEST_ASSERT_XRDST( st );
+  EXPECT_FALSE( wst.IsOK() );
+  EXPECT_EQ( wst.code, errLocalError );
+  EXPECT_EQ( wst.errNo, uint32_t( EFBIG ) );
+
+  struct stat sb;
+  ASSERT_EQ( stat( path.c_str(), &sb ), 0 );
+  EXPECT_EQ( sb.st_size, off_t( limit ) );
+  unlink( path.c_str() );
+}
@@ -28,6 +28,12 @@
 #include "XrdCl/XrdClTaskManager.hh"
 #include "XrdCl/XrdClSIDManager.hh"
 #include "XrdCl/XrdClPropertyList.hh"
+#include "XrdCl/XrdClJobManager.hh"
+#include "XrdCl/XrdClMessageUtils.hh"
+#include "XrdCl/XrdClXRootDMsgHandler.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+#include <thread>
 
 //------------------------------------------------------------------------------
 // Declaration
@@ -250,3 +256,87 @@ TEST(UtilsTest, PropertyListTest)
   for( size_t i = 0; i < v1.size(); ++i )
     EXPECT_EQ( v1[i], v2[i] );
 }
+
+//------------------------------------------------------------------------------
+// Only final responses to our own non-blocking handlers may run inline
+//------------------------------------------------------------------------------
+TEST(UtilsTest, InlineCallbackTest)
+{
+  using namespace XrdCl;
+
+  URL url( "root://localhost:1094//data/file" );
+
+  auto response = []( uint16_t status )
+  {
+    Message *msg = new Message( sizeof( ServerResponseHeader ) );
+    msg->Zero();
+    ((ServerResponseHeader*)msg->GetBuffer())->status = status;
+    return std::unique_ptr<Message>( msg );
+  };
+  std::unique_ptr<Message> ok     = response( kXR_ok );
+  std::unique_ptr<Message> oksofar = response( kXR_oksofar );
+  std::unique_ptr<Message> error  = response( kXR_error );
+  std::unique_ptr<Message> wait   = response( kXR_wait );
+
+  auto request = []()
+  {
+    Message *msg; ClientStatRequest *req;
+    MessageUtils::CreateRequest( msg, req );
+    req->requestid = kXR_stat;
+    return msg;
+  };
+
+  SyncResponseHandler syncHandler;
+  XRootDMsgHandler syncMsgHandler( request(), &syncHandler, &url, nullptr, nullptr );
+  EXPECT_TRUE( syncMsgHandler.CanRunInline( *ok ) );
+  EXPECT_FALSE( syncMsgHandler.CanRunInline( *oksofar ) );
+  EXPECT_FALSE( syncMsgHandler.CanRunInline( *error ) );
+  EXPECT_FALSE( syncMsgHandler.CanRunInline( *wait ) );
+
+  NullResponseHandler *nullHandler = new NullResponseHandler();
+  XRootDMsgHandler nullMsgHandler( request(), nullHandler, &url, nullptr, nullptr );
+  EXPECT_TRUE( nullMsgHandler.CanRunInline( *ok ) );
+  delete nullHandler;
+
+  std::unique_ptr<ResponseHandler> userHandler(
+      ResponseHandler::Wrap( []( XRootDStatus&, AnyObject& ){} ) );
+  XRootDMsgHandler userMsgHandler( request(), userHandler.get(), &url, nullptr, nullptr );
+  EXPECT_FALSE( userMsgHandler.CanRunInline( *ok ) );
+  EXPECT_FALSE( userMsgHandler.CanRunInline( *error ) );
+
+  //----------------------------------------------------------------------------
+  // A queued job is handed over to a worker, an inline one is not
+  //----------------------------------------------------------------------------
+  class ThreadJob: public Job
+  {
+    public:
+      ThreadJob( XrdSysSemaphore &sem, std::thread::id &tid ): sem( sem ), tid( tid ) {}
+      void Run( void* )
+      {
+        tid = std::this_thread::get_id();
+        sem.Post();
+      }
+    private:
+      XrdSysSemaphore &sem;
+      std::thread::id &tid;
+  };
+
+  JobManager jobMgr( 2 );
+  ASSERT_TRUE( jobMgr.Initialize() );
+  ASSERT_TRUE( jobMgr.Start() );
+
+  XrdSysSemaphore sem( 0 );
+  std::thread::id queuedTid, inlineTid;
+  ThreadJob queuedJob( sem, queuedTid ), inlineJob( sem, inlineTid );
+
+  jobMgr.QueueJob( &queuedJob );
+  sem.Wait();
+  EXPECT_NE( queuedTid, std::this_thread::get_id() );
+
+  jobMgr.RunInline( &inlineJob );
+  sem.Wait();
+  EXPECT_EQ( inlineTid, std::this_thread::get_id() );
+
+  ASSERT_TRUE( jobMgr.Stop() );
+  ASSERT_TRUE( jobMgr.Finalize() );
+}
@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "GTestXrdHelpers.hh"
+#include "XrdCl/XrdClConstants.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClXCpCtx.hh"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fcntl.h>
+#include <set>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace XrdCl;
+
+namespace
+{
+  const uint64_t KB = 1024;
+  const uint64_t MB = 1024 * KB;
+
+  //----------------------------------------------------------------------------
+  // A chunk as read by a source
+  //----------------------------------------------------------------------------
+  PageInfo *NewChunk( uint64_t offset, uint32_t length )
+  {
+    return new PageInfo( offset, length, new char[length] );
+  }
+
+  //----------------------------------------------------------------------------
+  // Delete the buffer of a chunk taken out of the sink
+  //----------------------------------------------------------------------------
+  void FreeChunk( PageInfo &ci )
+  {
+    delete[] static_cast<char*>( ci.GetBuffer() );
+  }
+}
+
+//------------------------------------------------------------------------------
+// The block handed to a source is scaled by its share of the aggregate rate
+//------------------------------------------------------------------------------
+TEST(XCpCtxTest, RateAwareBlockSize)
+{
+  const uint64_t blk = 16 * MB, chunk = 1 * MB, left = 10 * 1024 * MB;
+
+  // the rate is not known yet, the default block
+  EXPECT_EQ( XCpCtx::BlockSize( 0, 300, 3, left, blk, chunk ), blk );
+  EXPECT_EQ( XCpCtx::BlockSize( 100, 0, 3, left, blk, chunk ), blk );
+
+  // an average source gets the default block
+  EXPECT_EQ( XCpCtx::BlockSize( 100, 300, 3, left, blk, chunk ), blk );
+
+  // a source twice as fast as the others gets twice as much
+  EXPECT_EQ( XCpCtx::BlockSize( 200, 400, 3, left, blk, chunk ), 24 * MB );
+  EXPECT_EQ( XCpCtx::BlockSize( 100, 400, 3, left, blk, chunk ), 12 * MB );
+
+  // no source gets more than four default blocks
+  EXPECT_EQ( XCpCtx::BlockSize( 990, 1000, 10, left, blk, chunk ), 4 * blk );
+
+  // nor less than a chunk
+  EXPECT_EQ( XCpCtx::BlockSize( 1, 1000, 3, left, blk, chunk ), chunk );
+}
+
+//------------------------------------------------------------------------------
+// Near the end of the file a source gets no more than its share of what is
+// left, so that the tail is spread over the sources
+//------------------------------------------------------------------------------
+TEST(XCpCtxTest, RateAwareTail)
+{
+  const uint64_t blk = 16 * MB, chunk = 1 * MB;
+
+  EXPECT_EQ( XCpCtx::BlockSize( 200, 400, 3, 20 * MB, blk, chunk ), 10 * MB );
+  EXPECT_EQ( XCpCtx::BlockSize( 100, 400, 3, 20 * MB, blk, chunk ), 5 * MB );
+  EXPECT_EQ( XCpCtx::BlockSize( 100, 400, 3, 2 * MB, blk, chunk ), chunk );
+}
+
+//------------------------------------------------------------------------------
+// Without running sources GetBlock hands out default blocks, capped by the
+// end of the file
+//------------------------------------------------------------------------------
+TEST(XCpCtxTest, GetBlock)
+{
+  std::vector<std::string> urls;
+  XCpCtx *ctx = new XCpCtx( urls, 4 * MB, 2, 1 * MB, 4, 10 * MB );
+
+  std::pair<uint64_t, uint64_t> p = ctx->GetBlock( 1000 );
+  EXPECT_EQ( p.first,  0u );
+  EXPECT_EQ( p.second, 4 * MB );
+  p = ctx->GetBlock();
+  EXPECT_EQ( p.first,  4 * MB );
+  EXPECT_EQ( p.second, 4 * MB );
+  p = ctx->GetBlock();
+  EXPECT_EQ( p.first,  8 * MB );
+  EXPECT_EQ( p.second, 2 * MB );
+  p = ctx->GetBlock();
+  EXPECT_EQ( p.second, 0u );
+
+  ctx->Delete();
+}
+
+//------------------------------------------------------------------------------
+// A hedged chunk goes into the sink once, whichever copy comes first
+//------------------------------------------------------------------------------
+TEST(XCpCtxTest, HedgedChunkDeliveredOnce)
+{
+  std::vector<std::string> urls;
+  XCpCtx *ctx = new XCpCtx( urls, 4 * KB, 1, 1 * KB, 4, 2 * KB );
+
+  // each ongoing chunk is hedged at most once
+  EXPECT_TRUE( ctx->HedgingEnabled() );
+  EXPECT_TRUE( ctx->Hedge( 0 ) );
+  EXPECT_FALSE( ctx->Hedge( 0 ) );
+  EXPECT_TRUE( ctx->Hedge( 1 * KB ) );
+
+  // the first copy wins, the second one is dropped
+  EXPECT_FALSE( ctx->IsDelivered( 0 ) );
+  EXPECT_TRUE( ctx->PutChunk( NewChunk( 0, 1 * KB ) ) );
+  EXPECT_TRUE( ctx->IsDelivered( 0 ) );
+  EXPECT_FALSE( ctx->PutChunk( NewChunk( 0, 1 * KB ) ) );
+  EXPECT_TRUE( ctx->PutChunk( NewChunk( 1 * KB, 1 * KB ) ) );
+
+  // a delivered chunk is not worth hedging anymore
+  EXPECT_FALSE( ctx->Hedge( 0 ) );
+
+  ctx->Delete();
+}
+
+//------------------------------------------------------------------------------
+// Hedging can be turned off
+//------------------------------------------------------------------------------
+TEST(XCpCtxTest, HedgingDisabled)
+{
+  Env *env = DefaultEnv::GetEnv();
+  env->PutInt( "XCpHedging", 0 );
+  std::vector<std::string> urls;
+  XCpCtx *ctx = new XCpCtx( urls, 4 * KB, 1, 1 * KB, 4, 2 * KB );
+  EXPECT_FALSE( ctx->HedgingEnabled() );
+  ctx->Delete();
+  env->PutInt( "XCpHedging", DefaultXCpHedging );
+}
+
+//------------------------------------------------------------------------------
+// Several local replicas read in parallel make up the whole file, every chunk
+// being handed out exactly once
+//------------------------------------------------------------------------------
+TEST(XCpCtxTest, LocalReplicas)
+{
+  const size_t size = 3 * MB + 12345;
+  std::string data( size, 0 );
+  for( size_t i = 0; i < size; ++i ) data[i] = char( i * 7 + i / 4096 );
+
+  std::vector<std::string> paths, urls;
+  for( int i = 0; i < 3; ++i )
+  {
+    char tmpl[] = "/tmp/xrdcl-xcp-XXXXXX";
+    int fd = mkstemp( tmpl );
+    ASSERT_GE( fd, 0 );
+    ASSERT_EQ( write( fd, data.data(), size ), ssize_t( size ) );
+    close( fd );
+    paths.push_back( tmpl );
+    urls.push_back( std::string( "file://localhost" ) + tmpl );
+  }
+
+  XCpCtx *ctx = new XCpCtx( urls, 512 * KB, 3, 64 * KB, 4, size );
+  ASSERT_TRUE( ctx->Initialize().IsOK() );
+  ASSERT_EQ( ctx->GetSize(), int64_t( size ) );
+
+  std::string result( size, 0 );
+  std::set<uint64_t> offsets;
+  uint64_t received = 0;
+  XRootDStatus st;
+  while( true )
+  {
+    PageInfo ci;
+    st = ctx->GetChunk( ci );
+    if( !st.IsOK() || st.code == suDone ) break;
+    if( st.code != suContinue ) continue;
+    ASSERT_LE( ci.GetOffset() + ci.GetLength(), size );
+    EXPECT_TRUE( offsets.insert( ci.GetOffset() ).second ) << ci.GetOffset();
+    memcpy( &result[ci.GetOffset()], ci.GetBuffer(), ci.GetLength() );
+    received += ci.GetLength();
+    FreeChunk( ci );
+  }
+  EXPECT_TRUE( st.IsOK() ) << st.ToString();
+  EXPECT_EQ( received, size );
+  EXPECT_TRUE( result == data );
+
+  ctx->Delete();
+  for( auto &path : paths ) unlink( path.c_str() );
+}
@@ -25,6 +25,7 @@
 #include "XrdCl/XrdClZipArchive.hh"
 #include "XrdCl/XrdClZipListHandler.hh"
 #include "XrdCl/XrdClZipOperations.hh"
+#include "XrdCl/XrdClMessageUtils.hh"
 
 using namespace XrdClTests;
 using namespace XrdCl;
@@ -96,3 +97,52 @@ TEST_F(ZipTest, GetterTests) {
   uint64_t offset;
   GTEST_ASSERT_XRDST(zip_file.GetOffset("paper.txt", offset));
 }
+
+TEST_F(ZipTest, ReadFilesTest) {
+  std::vector<std::string> fns = { "athena.log", "paper.txt", "EastAsianWidth.txt" };
+
+  // read each file on its own first
+  std::vector<std::string> expected;
+  std::vector<std::unique_ptr<char[]>> buffers;
+  std::vector<void*> bufptrs;
+  for( auto &fn : fns )
+  {
+    StatInfo *info = nullptr;
+    GTEST_ASSERT_XRDST(zip_file.Stat(fn, info));
+    std::unique_ptr<StatInfo> stptr( info );
+    uint32_t size = info->GetSize();
+    std::string data;
+    std::unique_ptr<char[]> buff( new char[size] );
+    GTEST_ASSERT_XRDST( WaitFor(
+        ReadFrom( zip_file, fn, 0, size, buff.get() ) >>
+          [&data]( auto& s, auto& c )
+          {
+            if( s.IsOK() )
+              data.assign( static_cast<char*>(c.buffer), c.length );
+          }
+      ) );
+    EXPECT_EQ( data.size(), size );
+    expected.push_back( data );
+    buffers.emplace_back( new char[size] );
+    bufptrs.push_back( buffers.back().get() );
+  }
+
+  // now read all of them at once
+  SyncResponseHandler handler;
+  GTEST_ASSERT_XRDST(zip_file.ReadFiles(fns, bufptrs, &handler));
+  handler.WaitForResponse();
+  std::unique_ptr<XRootDStatus> status( handler.GetStatus() );
+  std::unique_ptr<AnyObject> response( handler.GetResponse() );
+  GTEST_ASSERT_XRDST(*status);
+  VectorReadInfo *info = nullptr;
+  response->Get(info);
+  ASSERT_TRUE(info);
+  ASSERT_EQ(info->GetChunks().size(), fns.size());
+  for( size_t i = 0; i < fns.size(); ++i )
+  {
+    ChunkInfo &chunk = info->GetChunks()[i];
+    EXPECT_EQ( expected[i], std::string( static_cast<char*>(chunk.buffer), chunk.length ) );
+  }
+
+  GTEST_ASSERT_XRDST_NOTOK(zip_file.ReadFiles({ "gibberish.txt" }, { bufptrs[0] }, &handler), errNotFound);
+}
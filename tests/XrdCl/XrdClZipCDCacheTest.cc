@@ -0,0 +1,338 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include "GTestXrdHelpers.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClZipArchive.hh"
+#include "XrdCl/XrdClZipOperations.hh"
+#include "XrdOuc/XrdOucCRC.hh"
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+using namespace XrdCl;
+
+//------------------------------------------------------------------------------
+// The central directories of ZIP archives opened read-only are kept in the
+// directory given by XRD_ZIPCDCACHE, so that a subsequent open needs not
+// read them from the archive as long as the archive did not change
+//------------------------------------------------------------------------------
+class ZipCDCacheTest: public ::testing::Test
+{
+  public:
+    static void SetUpTestSuite();
+    static void TearDownTestSuite();
+
+    void SetUp() override;
+    void TearDown() override;
+
+    //--------------------------------------------------------------------------
+    // Create the archive, large enough for its central directory to be
+    // read on its own
+    //--------------------------------------------------------------------------
+    void MakeArchive();
+
+    //--------------------------------------------------------------------------
+    // Open the archive read-only, list it and read back one of the files
+    //--------------------------------------------------------------------------
+    XRootDStatus OpenAndVerify();
+
+    //--------------------------------------------------------------------------
+    // Overwrite the end of central directory record of the archive, leaving
+    // its size and modification time as they were
+    //--------------------------------------------------------------------------
+    void CorruptArchive();
+
+    //--------------------------------------------------------------------------
+    // Set the modification time of the archive
+    //--------------------------------------------------------------------------
+    void SetMTime( time_t mtime );
+
+    //--------------------------------------------------------------------------
+    // The files in the cache directory
+    //--------------------------------------------------------------------------
+    static std::set<std::string> CacheFiles();
+
+    static std::string cachedir;
+
+    std::string                       dir;
+    std::string                       archive;
+    std::vector<std::string>          fns;
+    std::vector<std::vector<char>>    contents;
+};
+
+std::string ZipCDCacheTest::cachedir;
+
+namespace
+{
+  int unlink_all( const std::string &dir )
+  {
+    DIR *dp = opendir( dir.c_str() );
+    if( !dp ) return -1;
+    struct dirent *entry;
+    while( ( entry = readdir( dp ) ) )
+    {
+      if( entry->d_name[0] == '.' ) continue;
+      unlink( ( dir + "/" + entry->d_name ).c_str() );
+    }
+    closedir( dp );
+    return rmdir( dir.c_str() );
+  }
+}
+
+void ZipCDCacheTest::SetUpTestSuite()
+{
+  char tmpl[] = "/tmp/xrdcl-zipcd-XXXXXX";
+  ASSERT_TRUE( mkdtemp( tmpl ) );
+  cachedir = std::string( tmpl ) + "/cache";
+  // must be set before the cache is first used
+  DefaultEnv::GetEnv()->PutString( "ZipCDCache", cachedir );
+}
+
+void ZipCDCacheTest::TearDownTestSuite()
+{
+  unlink_all( cachedir );
+  rmdir( cachedir.substr( 0, cachedir.rfind( '/' ) ).c_str() );
+}
+
+void ZipCDCacheTest::SetUp()
+{
+  char tmpl[] = "/tmp/xrdcl-zip-XXXXXX";
+  ASSERT_TRUE( mkdtemp( tmpl ) );
+  dir     = tmpl;
+  archive = dir + "/archive.zip";
+  MakeArchive();
+}
+
+void ZipCDCacheTest::TearDown()
+{
+  unlink_all( dir );
+}
+
+void ZipCDCacheTest::MakeArchive()
+{
+  fns.clear();
+  contents.clear();
+  uint32_t seed = 17;
+  for( int i = 0; i < 5; ++i )
+  {
+    fns.push_back( "file" + std::to_string( i ) + ".dat" );
+    std::vector<char> data( 30000 + i * 1001 );
+    for( auto &c : data )
+    {
+      seed = seed * 1103515245 + 12345;
+      c = char( seed >> 16 );
+    }
+    contents.push_back( std::move( data ) );
+  }
+
+  unlink( archive.c_str() );
+  ZipArchive zip;
+  GTEST_ASSERT_XRDST( WaitFor( OpenArchive( zip, archive, OpenFlags::New | OpenFlags::Write ) ) );
+  for( size_t i = 0; i < fns.size(); ++i )
+  {
+    auto &data = contents[i];
+    uint32_t cksum = crc32( 0, (const Bytef*)data.data(), data.size() );
+    GTEST_ASSERT_XRDST( WaitFor( AppendFile( zip, fns[i], cksum, data.size(),
+                                             data.data() ) ) );
+  }
+  GTEST_ASSERT_XRDST( WaitFor( CloseArchive( zip ) ) );
+}
+
+XRootDStatus ZipCDCacheTest::OpenAndVerify()
+{
+  ZipArchive zip;
+  XRootDStatus st = WaitFor( OpenArchive( zip, archive, OpenFlags::Read ) );
+  if( !st.IsOK() ) return st;
+
+  DirectoryList *list = nullptr;
+  st = zip.List( list );
+  EXPECT_TRUE( st.IsOK() ) << st.ToString();
+  std::unique_ptr<DirectoryList> lstptr( list );
+  if( list )
+  {
+    std::set<std::string> names;
+    for( auto itr = list->Begin(); itr != list->End(); ++itr )
+      names.insert( ( *itr )->GetName() );
+    EXPECT_EQ( names, std::set<std::string>( fns.begin(), fns.end() ) );
+  }
+
+  size_t i = fns.size() - 1;
+  std::vector<char> buffer( contents[i].size() );
+  uint32_t bytesRead = 0;
+  st = WaitFor( ReadFrom( zip, fns[i], 0, buffer.size(), buffer.data() ) >>
+                [&]( XRootDStatus &s, ChunkInfo &ch ) { if( s.IsOK() ) bytesRead = ch.length; } );
+  EXPECT_TRUE( st.IsOK() ) << st.ToString();
+  EXPECT_EQ( bytesRead, buffer.size() );
+  EXPECT_EQ( buffer, contents[i] );
+
+  st = WaitFor( CloseArchive( zip ) );
+  EXPECT_TRUE( st.IsOK() ) << st.ToString();
+  return XRootDStatus();
+}
+
+void ZipCDCacheTest::CorruptArchive()
+{
+  struct stat st;
+  ASSERT_EQ( stat( archive.c_str(), &st ), 0 );
+  int fd = open( archive.c_str(), O_WRONLY );
+  ASSERT_GE( fd, 0 );
+  // the archive has no comment, the EOCD is the last 22 bytes
+  const char zeros[22] = { 0 };
+  ASSERT_EQ( pwrite( fd, zeros, sizeof( zeros ), st.st_size - sizeof( zeros ) ),
+             ssize_t( sizeof( zeros ) ) );
+  close( fd );
+  SetMTime( st.st_mtime );
+}
+
+void ZipCDCacheTest::SetMTime( time_t mtime )
+{
+  struct timespec times[2] = { { mtime, 0 }, { mtime, 0 } };
+  ASSERT_EQ( utimensat( AT_FDCWD, archive.c_str(), times, 0 ), 0 );
+}
+
+std::set<std::string> ZipCDCacheTest::CacheFiles()
+{
+  std::set<std::string> files;
+  DIR *dp = opendir( cachedir.c_str() );
+  if( !dp ) return files;
+  struct dirent *entry;
+  while( ( entry = readdir( dp ) ) )
+    if( entry->d_name[0] != '.' ) files.insert( cachedir + "/" + entry->d_name );
+  closedir( dp );
+  return files;
+}
+
+//------------------------------------------------------------------------------
+// The second open is served from the cache: it succeeds even though the
+// central directory in the archive can no longer be found
+//------------------------------------------------------------------------------
+TEST_F(ZipCDCacheTest, SecondOpenFromCache)
+{
+  std::set<std::string> before = CacheFiles();
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  std::set<std::string> after = CacheFiles();
+  EXPECT_EQ( after.size(), before.size() + 1 );
+
+  CorruptArchive();
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+
+  // without the cache the archive cannot be opened anymore
+  for( auto &file : CacheFiles() )
+    if( !before.count( file ) ) unlink( file.c_str() );
+  GTEST_ASSERT_XRDST_NOTOK( OpenAndVerify(), errDataError );
+}
+
+//------------------------------------------------------------------------------
+// Once the modification time of the archive changes, the cached central
+// directory is not used anymore
+//------------------------------------------------------------------------------
+TEST_F(ZipCDCacheTest, MTimeChanged)
+{
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  struct stat st;
+  ASSERT_EQ( stat( archive.c_str(), &st ), 0 );
+
+  CorruptArchive();
+  SetMTime( st.st_mtime + 100 );
+  GTEST_ASSERT_XRDST_NOTOK( OpenAndVerify(), errDataError );
+
+  // the archive rewritten with the same size
+  MakeArchive();
+  SetMTime( st.st_mtime + 200 );
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  // and cached again
+  CorruptArchive();
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+}
+
+//------------------------------------------------------------------------------
+// A corrupted cache entry is ignored, the central directory is read from the
+// archive and cached anew
+//------------------------------------------------------------------------------
+TEST_F(ZipCDCacheTest, CorruptedEntry)
+{
+  struct stat st;
+  ASSERT_EQ( stat( archive.c_str(), &st ), 0 );
+  std::set<std::string> before = CacheFiles();
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  std::string entry;
+  for( auto &file : CacheFiles() )
+    if( !before.count( file ) ) entry = file;
+  ASSERT_FALSE( entry.empty() );
+
+  std::vector<char> orig;
+  {
+    int fd = open( entry.c_str(), O_RDONLY );
+    ASSERT_GE( fd, 0 );
+    struct stat est;
+    ASSERT_EQ( fstat( fd, &est ), 0 );
+    orig.resize( est.st_size );
+    ASSERT_EQ( read( fd, orig.data(), orig.size() ), ssize_t( orig.size() ) );
+    close( fd );
+  }
+  auto rewrite = [&]( const std::vector<char> &data )
+  {
+    int fd = open( entry.c_str(), O_WRONLY | O_TRUNC );
+    ASSERT_GE( fd, 0 );
+    ASSERT_EQ( write( fd, data.data(), data.size() ), ssize_t( data.size() ) );
+    close( fd );
+  };
+
+  // the header: magic, archive size and mtime, key and CD lengths, CD crc32c
+  const size_t hdrsize = 40;
+  uint32_t keylen;
+  memcpy( &keylen, orig.data() + 24, sizeof( keylen ) );
+  const size_t cdoff = hdrsize + keylen;
+  ASSERT_GT( orig.size(), cdoff );
+
+  // a flipped bit in the central directory
+  std::vector<char> bad = orig;
+  bad[cdoff + 10] ^= 0x01;
+  rewrite( bad );
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  // ... and the entry has been rewritten
+  CorruptArchive();
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  // the same archive again, matching the original entry
+  MakeArchive();
+  SetMTime( st.st_mtime );
+
+  // a truncated entry
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  rewrite( std::vector<char>( orig.begin(), orig.begin() + cdoff + 5 ) );
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+
+  // garbage with a matching checksum, it does not parse as a central directory
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+  bad = orig;
+  memset( bad.data() + cdoff, 0x5a, bad.size() - cdoff );
+  uint32_t cdcrc = XrdOucCRC::Calc32C( bad.data() + cdoff, bad.size() - cdoff );
+  memcpy( bad.data() + 32, &cdcrc, sizeof( cdcrc ) );
+  rewrite( bad );
+  GTEST_ASSERT_XRDST( OpenAndVerify() );
+}
@@ -29,6 +29,8 @@
 #include "XrdEc/XrdEcStrmWriter.hh"
 #include "XrdEc/XrdEcReader.hh"
 #include "XrdEc/XrdEcObjCfg.hh"
+#include "XrdEc/XrdEcConfig.hh"
+#include "XrdEc/XrdEcSrvHealth.hh"
 
 #include "XrdCl/XrdClMessageUtils.hh"
 
@@ -39,6 +41,7 @@
 #include <string>
 #include <memory>
 #include <limits>
+#include <thread>
 
 #include <unistd.h>
 #include <cstdio>
@@ -235,6 +238,10 @@ class XrdEcTests : public ::testing::Test
     void UrlNotReachable( size_t index );
     void UrlReachable( size_t index );
 
+    void HedgedReadTest();
+
+    void BlockCacheTest();
+
   private:
 
     void AlignedWriteRaw();
@@ -319,6 +326,68 @@ TEST_F(XrdEcTests, AlignedWrite2MissingTestIsalCrcNoMt)
   AlignedWrite2MissingTestIsalCrcNoMt();
 }
 
+TEST_F(XrdEcTests, HedgedReadTest)
+{
+  HedgedReadTest();
+}
+
+TEST_F(XrdEcTests, BlockCacheTest)
+{
+  BlockCacheTest();
+}
+
+TEST(XrdEcSrvHealthTests, DeadListTest)
+{
+  Config &cfg = Config::Instance();
+  uint32_t failures = cfg.dead_failures;
+  uint32_t period   = cfg.dead_period;
+  cfg.dead_failures = 3;
+  cfg.dead_period   = 1;
+
+  SrvHealth &health = SrvHealth::Instance();
+  const std::string host = "dead-list-test.cern.ch:1094";
+
+  // a couple of failures are not enough for the server to be skipped
+  health.Failed( host );
+  health.Failed( host );
+  EXPECT_FALSE( health.IsDead( host ) );
+  health.Failed( host );
+  EXPECT_TRUE( health.IsDead( host ) );
+  EXPECT_TRUE( health.IsDead( host ) );
+  EXPECT_FALSE( health.IsDead( "other-host.cern.ch:1094" ) );
+
+  // once the backoff expired a single read is let through to probe it
+  std::this_thread::sleep_for( std::chrono::milliseconds( 1100 ) );
+  EXPECT_FALSE( health.IsDead( host ) );
+  EXPECT_TRUE( health.IsDead( host ) );
+
+  // the probe failed, the server is skipped again
+  health.Failed( host );
+  EXPECT_TRUE( health.IsDead( host ) );
+  std::this_thread::sleep_for( std::chrono::milliseconds( 1100 ) );
+  EXPECT_FALSE( health.IsDead( host ) );
+  EXPECT_TRUE( health.IsDead( host ) );
+
+  // the probe succeeded, the failures are forgotten
+  health.Alive( host );
+  EXPECT_FALSE( health.IsDead( host ) );
+  health.Failed( host );
+  EXPECT_FALSE( health.IsDead( host ) );
+  health.Alive( host );
+
+  // only the errors that mean the server could not be reached count
+  using namespace XrdCl;
+  EXPECT_TRUE( SrvHealth::IsUnreachable( XRootDStatus( stError, errOperationExpired ) ) );
+  EXPECT_TRUE( SrvHealth::IsUnreachable( XRootDStatus( stError, errConnectionError ) ) );
+  EXPECT_TRUE( SrvHealth::IsUnreachable( XRootDStatus( stError, errSocketTimeout ) ) );
+  EXPECT_FALSE( SrvHealth::IsUnreachable( XRootDStatus( stError, errDataError ) ) );
+  EXPECT_FALSE( SrvHealth::IsUnreachable( XRootDStatus( stError, errErrorResponse ) ) );
+  EXPECT_FALSE( SrvHealth::IsUnreachable( XRootDStatus() ) );
+
+  cfg.dead_failures = failures;
+  cfg.dead_period   = period;
+}
+
 
 void XrdEcTests::Init( bool usecrc32c )
 {
@@ -415,6 +484,144 @@ void XrdEcTests::CorruptedReadVerify()
 
 }
 
+void XrdEcTests::HedgedReadTest()
+{
+  Init( true );
+  AlignedWriteRaw();
+
+  //----------------------------------------------------------------------------
+  // Teach the reader that stripe reads take a microsecond, so that nearly
+  // every read gets hedged
+  //----------------------------------------------------------------------------
+  Config &cfg = Config::Instance();
+  uint8_t  percentile = cfg.hedge_percentile;
+  uint32_t minwait    = cfg.hedge_minwait;
+  cfg.hedge_percentile = 50;
+  cfg.hedge_minwait    = 0;
+  SrvHealth &health = SrvHealth::Instance();
+  for( size_t i = 0; i < 256; ++i )
+    health.AddLatency( std::chrono::microseconds( 1 ) );
+  EXPECT_EQ( health.HedgeAfter(), std::chrono::microseconds( 1 ) );
+
+  // the data must be the same whether it was read or reconstructed
+  ReadVerifyAll();
+  // and still within what the parity can make up for with a stripe corrupted
+  CorruptChunk( 1, 2 );
+  ReadVerifyAll();
+
+  //----------------------------------------------------------------------------
+  // Put the learned threshold out of the way of the other tests
+  //----------------------------------------------------------------------------
+  cfg.hedge_percentile = percentile;
+  cfg.hedge_minwait    = minwait;
+  for( size_t i = 0; i < 256; ++i )
+    health.AddLatency( std::chrono::seconds( 60 ) );
+  EXPECT_EQ( health.HedgeAfter(), std::chrono::seconds( 60 ) );
+
+  CleanUp();
+}
+
+void XrdEcTests::BlockCacheTest()
+{
+  Init( true );
+  AlignedWriteRaw();
+
+  Config &cfg = Config::Instance();
+  size_t cacheblks = cfg.cache_blocks;
+  const size_t nbblks = rawdata.size() / objcfg->datasize;
+
+  auto read_block = [this]( Reader &reader, size_t blkid )
+  {
+    uint64_t rdoff = blkid * objcfg->datasize;
+    uint32_t rdlen = objcfg->datasize;
+    std::unique_ptr<char[]> rdbuff( new char[rdlen] );
+    XrdCl::SyncResponseHandler h;
+    reader.Read( rdoff, rdlen, rdbuff.get(), &h, 0 );
+    h.WaitForResponse();
+    std::unique_ptr<XrdCl::XRootDStatus> status( h.GetStatus() );
+    GTEST_ASSERT_XRDST( *status );
+    std::unique_ptr<XrdCl::AnyObject> rsp( h.GetResponse() );
+    XrdCl::ChunkInfo *ch = nullptr;
+    rsp->Get( ch );
+    std::string result( reinterpret_cast<char*>( ch->buffer ), ch->length );
+    std::string expected( rawdata.data() + rdoff, rdlen );
+    EXPECT_EQ( result, expected );
+  };
+
+  auto open_reader = []( Reader &reader )
+  {
+    XrdCl::SyncResponseHandler handler;
+    reader.Open( &handler );
+    handler.WaitForResponse();
+    std::unique_ptr<XrdCl::XRootDStatus> status( handler.GetStatus() );
+    GTEST_ASSERT_XRDST( *status );
+  };
+
+  auto close_reader = []( Reader &reader )
+  {
+    XrdCl::SyncResponseHandler handler;
+    reader.Close( &handler );
+    handler.WaitForResponse();
+    std::unique_ptr<XrdCl::XRootDStatus> status( handler.GetStatus() );
+    GTEST_ASSERT_XRDST( *status );
+  };
+
+  //----------------------------------------------------------------------------
+  // Corrupt a data stripe in all the blocks but the last one, so that they
+  // have to be reconstructed
+  //----------------------------------------------------------------------------
+  ASSERT_GE( nbblks, 4u );
+  for( size_t blkid = 0; blkid < nbblks - 1; ++blkid )
+    CorruptChunk( blkid, 1 );
+
+  cfg.cache_blocks = 2;
+  {
+    Reader reader( *objcfg );
+    open_reader( reader );
+
+    // remember every block as we leave it
+    std::vector<std::weak_ptr<block_t>> blocks;
+    for( size_t blkid = 0; blkid < nbblks; ++blkid )
+    {
+      read_block( reader, blkid );
+      blocks.emplace_back( reader.block );
+    }
+    // only the two most recent reconstructed blocks are kept
+    EXPECT_EQ( reader.rcvblks.size(), 2u );
+    for( size_t blkid = 0; blkid < nbblks - 3; ++blkid )
+      EXPECT_TRUE( blocks[blkid].expired() );
+
+    // going back to a cached block reuses it rather than reading it again
+    for( size_t blkid = nbblks - 2; blkid >= nbblks - 3; --blkid )
+    {
+      read_block( reader, blkid );
+      std::shared_ptr<block_t> blk = blocks[blkid].lock();
+      EXPECT_TRUE( blk );
+      EXPECT_EQ( reader.block, blk );
+    }
+    // while the block that did not need reconstructing was not kept
+    EXPECT_TRUE( blocks[nbblks - 1].expired() );
+    close_reader( reader );
+  }
+
+  //----------------------------------------------------------------------------
+  // Caching disabled
+  //----------------------------------------------------------------------------
+  cfg.cache_blocks = 0;
+  {
+    Reader reader( *objcfg );
+    open_reader( reader );
+    for( size_t blkid = 0; blkid < nbblks; ++blkid )
+      read_block( reader, blkid );
+    EXPECT_TRUE( reader.rcvblks.empty() );
+    close_reader( reader );
+  }
+  ReadVerifyAll();
+
+  cfg.cache_blocks = cacheblks;
+  CleanUp();
+}
+
 void XrdEcTests::VerifyVectorRead(uint32_t seed){
 	  Reader reader( *objcfg );
 	  // open the data object
@@ -0,0 +1,305 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "XrdNet/XrdNetAddr.hh"
+#include "XrdNet/XrdNetCache.hh"
+
+namespace
+{
+//------------------------------------------------------------------------------
+// A cache whose name server is under the control of the test. Names resolve
+// to "host-<address>" unless the server is told to fail, and lookups can be
+// held until the test lets them go.
+//------------------------------------------------------------------------------
+class TestCache : public XrdNetCache
+{
+public:
+
+  std::atomic<int> lookups{0};
+  bool             fail = false;
+
+  void Hold()
+  {
+    std::lock_guard<std::mutex> lck( mtx );
+    held = true;
+  }
+
+  void Release()
+  {
+    {
+      std::lock_guard<std::mutex> lck( mtx );
+      held = false;
+    }
+    cv.notify_all();
+  }
+
+protected:
+
+  int GetName( XrdNetAddrInfo *hAddr, char *hBuff, int hBlen ) override
+  {
+    lookups++;
+    std::unique_lock<std::mutex> lck( mtx );
+    cv.wait( lck, [this]{ return !held; } );
+    if( fail ) return EAI_NONAME;
+    char aBuff[64];
+    hAddr->Format( aBuff, sizeof( aBuff ), XrdNetAddrInfo::fmtAddr,
+                   XrdNetAddrInfo::noPort );
+    snprintf( hBuff, hBlen, "host-%s", aBuff );
+    return 0;
+  }
+
+private:
+
+  std::mutex              mtx;
+  std::condition_variable cv;
+  bool                    held = false;
+};
+
+XrdNetAddr V4( uint32_t n )
+{
+  struct sockaddr_in sa = {};
+  sa.sin_family      = AF_INET;
+  sa.sin_addr.s_addr = htonl( n );
+  XrdNetAddr addr;
+  addr.Set( (struct sockaddr *)&sa );
+  return addr;
+}
+
+XrdNetAddr V6( uint32_t n )
+{
+  struct sockaddr_in6 sa = {};
+  sa.sin6_family = AF_INET6;
+  sa.sin6_addr.s6_addr[0] = 0x20;
+  sa.sin6_addr.s6_addr[1] = 0x01;
+  sa.sin6_addr.s6_addr[2] = 0x0d;
+  sa.sin6_addr.s6_addr[3] = 0xb8;
+  uint32_t v = htonl( n );
+  memcpy( &sa.sin6_addr.s6_addr[12], &v, 4 );
+  XrdNetAddr addr;
+  addr.Set( (struct sockaddr *)&sa );
+  return addr;
+}
+
+// Take ownership of a name returned by the cache
+std::string Name( char *hName )
+{
+  std::string name( hName ? hName : "" );
+  free( hName );
+  return name;
+}
+
+// Poll the cache until it has the expected name for the address
+bool WaitFor( XrdNetCache &cache, XrdNetAddr &addr, const std::string &name )
+{
+  for( int i = 0; i < 500; i++ )
+  {
+    if( Name( cache.Find( &addr ) ) == name ) return true;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+  }
+  return false;
+}
+
+// Start at the beginning of a second so that whole-second expiry is exact
+void AlignToSecond()
+{
+  time_t now = time( 0 );
+  while( time( 0 ) == now )
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+}
+}
+
+//------------------------------------------------------------------------------
+// The resolver threads of a cache may outlive any test, so the caches used by
+// the tests are never deleted, just like the one of the server.
+//------------------------------------------------------------------------------
+class XrdNetCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    XrdNetCache::SetKT( 3600 );
+    XrdNetCache::SetWT( 5 );
+    cache = new TestCache;
+  }
+
+  void TearDown() override
+  {
+    cache->Release();
+    XrdNetCache::SetKT( 0 );
+    XrdNetCache::SetWT( 5 );
+  }
+
+  TestCache *cache;
+};
+
+//------------------------------------------------------------------------------
+// Addresses spread over the shards are found again with their own name, also
+// after the tables of the shards have grown.
+//------------------------------------------------------------------------------
+TEST_F( XrdNetCacheTest, ShardLookup )
+{
+  const uint32_t n = 5000;
+  for( uint32_t i = 0; i < n; i++ )
+  {
+    XrdNetAddr a4 = V4( 0x0a000000 + i ), a6 = V6( i );
+    cache->Add( &a4, ( "v4-" + std::to_string( i ) ).c_str() );
+    cache->Add( &a6, ( "v6-" + std::to_string( i ) ).c_str() );
+  }
+
+  for( uint32_t i = 0; i < n; i++ )
+  {
+    XrdNetAddr a4 = V4( 0x0a000000 + i ), a6 = V6( i );
+    ASSERT_EQ( Name( cache->Find( &a4 ) ), "v4-" + std::to_string( i ) );
+    ASSERT_EQ( Name( cache->Find( &a6 ) ), "v6-" + std::to_string( i ) );
+  }
+
+  XrdNetAddr other = V4( 0x0b000000 );
+  EXPECT_EQ( cache->Find( &other ), nullptr );
+
+  // A new name replaces the old one
+  XrdNetAddr a4 = V4( 0x0a000007 );
+  cache->Add( &a4, "renamed" );
+  EXPECT_EQ( Name( cache->Find( &a4 ) ), "renamed" );
+  EXPECT_EQ( cache->lookups.load(), 0 );
+}
+
+//------------------------------------------------------------------------------
+// A name that could not be resolved expires, and it never replaces a name that
+// is still valid.
+//------------------------------------------------------------------------------
+TEST_F( XrdNetCacheTest, NegativeEntryExpiry )
+{
+  XrdNetCache::SetKT( 1 );
+  XrdNetAddr good = V4( 0x0a000001 ), bad = V4( 0x0a000002 );
+
+  cache->Add( &good, "good.example" );
+  cache->Add( &good, "10.0.0.1", true );
+  EXPECT_EQ( Name( cache->Find( &good ) ), "good.example" );
+
+  cache->Add( &bad, "10.0.0.2", true );
+  EXPECT_EQ( Name( cache->Find( &bad ) ), "10.0.0.2" );
+
+  std::this_thread::sleep_for( std::chrono::milliseconds( 2100 ) );
+  EXPECT_EQ( cache->Find( &bad ), nullptr );
+  EXPECT_EQ( cache->Find( &good ), nullptr );
+
+  // Once the name expired, a failed lookup is recorded
+  cache->Add( &good, "10.0.0.1", true );
+  EXPECT_EQ( Name( cache->Find( &good ) ), "10.0.0.1" );
+}
+
+//------------------------------------------------------------------------------
+// A name that is about to expire is still returned and refreshed in the
+// background, once; unresolved names are not refreshed ahead of time.
+//------------------------------------------------------------------------------
+TEST_F( XrdNetCacheTest, RefreshAhead )
+{
+  XrdNetCache::SetKT( 8 ); // refreshed within the last second
+  XrdNetAddr addr = V4( 0x7f000001 ), neg = V4( 0x7f000002 );
+
+  AlignToSecond();
+  cache->Add( &addr, "stale.example" );
+  cache->Add( &neg, "127.0.0.2", true );
+  EXPECT_EQ( Name( cache->Find( &addr ) ), "stale.example" );
+  EXPECT_EQ( cache->lookups.load(), 0 );
+
+  std::this_thread::sleep_for( std::chrono::milliseconds( 7300 ) );
+  cache->Hold();
+  EXPECT_EQ( Name( cache->Find( &addr ) ), "stale.example" );
+  EXPECT_EQ( Name( cache->Find( &addr ) ), "stale.example" );
+  EXPECT_EQ( Name( cache->Find( &neg ) ), "127.0.0.2" );
+  cache->Release();
+
+  EXPECT_TRUE( WaitFor( *cache, addr, "host-127.0.0.1" ) );
+  EXPECT_EQ( cache->lookups.load(), 1 );
+}
+
+//------------------------------------------------------------------------------
+// A lookup that takes longer than dnswait returns nothing, the name arrives in
+// the cache once the lookup completes. Callers for the same address share the
+// lookup.
+//------------------------------------------------------------------------------
+TEST_F( XrdNetCacheTest, WaitTimeout )
+{
+  XrdNetCache::SetWT( 1 );
+  XrdNetAddr addr = V4( 0x0a010203 );
+
+  cache->Hold();
+  char *names[2] = { nullptr, nullptr };
+  auto t0 = std::chrono::steady_clock::now();
+  std::thread other( [&]{ names[1] = cache->Resolve( &addr ); } );
+  names[0] = cache->Resolve( &addr );
+  other.join();
+  auto waited = std::chrono::steady_clock::now() - t0;
+
+  EXPECT_EQ( names[0], nullptr );
+  EXPECT_EQ( names[1], nullptr );
+  EXPECT_GE( waited, std::chrono::milliseconds( 900 ) );
+  EXPECT_LT( waited, std::chrono::seconds( 4 ) );
+  EXPECT_EQ( cache->Find( &addr ), nullptr );
+
+  cache->Release();
+  EXPECT_TRUE( WaitFor( *cache, addr, "host-10.1.2.3" ) );
+  EXPECT_EQ( cache->lookups.load(), 1 );
+}
+
+//------------------------------------------------------------------------------
+// With a wait time of zero a name that is not cached is never waited for.
+//------------------------------------------------------------------------------
+TEST_F( XrdNetCacheTest, NoWait )
+{
+  XrdNetCache::SetWT( 0 );
+  XrdNetAddr addr = V4( 0x0a010204 );
+
+  cache->Hold();
+  EXPECT_EQ( cache->Resolve( &addr ), nullptr );
+  cache->Release();
+  EXPECT_TRUE( WaitFor( *cache, addr, "host-10.1.2.4" ) );
+}
+
+//------------------------------------------------------------------------------
+// A lookup within the wait time returns the name; an address that cannot be
+// resolved gets itself as its name.
+//------------------------------------------------------------------------------
+TEST_F( XrdNetCacheTest, Resolve )
+{
+  XrdNetAddr addr = V4( 0x0a010205 ), bad = V6( 7 );
+
+  EXPECT_EQ( Name( cache->Resolve( &addr ) ), "host-10.1.2.5" );
+  EXPECT_EQ( Name( cache->Find( &addr ) ), "host-10.1.2.5" );
+
+  cache->fail = true;
+  std::string name = Name( cache->Resolve( &bad ) );
+  EXPECT_NE( name.find( "2001:db8::7" ), std::string::npos ) << name;
+  EXPECT_EQ( Name( cache->Find( &bad ) ), name );
+}
@@ -0,0 +1,279 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "XrdOss/XrdOss.hh"
+#include "XrdOssCsi/XrdOssCsiTagstore.hh"
+#include "XrdOssCsi/XrdOssCsiTagstoreFile.hh"
+#include "XrdOuc/XrdOucCRC.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdOuc/XrdOucTrace.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPlatform.hh"
+
+XrdSysError  OssCsiEroute(0, "osscsi_");
+XrdOucTrace  OssCsiTrace(&OssCsiEroute);
+
+namespace
+{
+//------------------------------------------------------------------------------
+// A file on the local file system that records the order in which the tags
+// and the header are written and synced. Once "crashed" it silently drops
+// everything, as if the machine had lost power.
+//------------------------------------------------------------------------------
+struct IoLog
+{
+  struct Op { char what; off_t off; uint32_t flags; };
+  std::vector<Op> ops;
+  bool crashed = false;
+};
+
+class PosixDF : public XrdOssDF
+{
+public:
+
+  int Open( const char *path, int oflag, mode_t mode, XrdOucEnv& ) override
+  {
+    fd = open( path, oflag, mode );
+    return fd < 0 ? -errno : 0;
+  }
+
+  ssize_t Read( void *buff, off_t off, size_t len ) override
+  {
+    ssize_t n = pread( fd, buff, len, off );
+    return n < 0 ? -errno : n;
+  }
+
+  ssize_t Write( const void *buff, off_t off, size_t len ) override
+  {
+    if( log && log->crashed ) return len;
+    if( log )
+    {
+      uint32_t flags = 0;
+      if( off == 0 && len >= 16 ) memcpy( &flags, (const char*)buff + 12, 4 );
+      log->ops.push_back( { 'W', off, flags } );
+    }
+    ssize_t n = pwrite( fd, buff, len, off );
+    return n < 0 ? -errno : n;
+  }
+
+  int Fstat( struct stat *sb ) override
+  {
+    return fstat( fd, sb ) ? -errno : 0;
+  }
+
+  int Fsync() override
+  {
+    if( log && log->crashed ) return 0;
+    if( log ) log->ops.push_back( { 'S', 0, 0 } );
+    return fsync( fd ) ? -errno : 0;
+  }
+
+  int Ftruncate( unsigned long long len ) override
+  {
+    if( log && log->crashed ) return 0;
+    return ftruncate( fd, len ) ? -errno : 0;
+  }
+
+  int Close( long long *retsz = 0 ) override
+  {
+    if( fd >= 0 ) close( fd );
+    fd = -1;
+    return 0;
+  }
+
+  PosixDF( IoLog *log = 0 ) : log( log ) {}
+  ~PosixDF() override { Close(); }
+
+private:
+  int    fd = -1;
+  IoLog *log;
+};
+
+class XrdOssCsiTagstoreTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    char tmpl[] = "/tmp/xrdosscsi-XXXXXX";
+    ASSERT_NE( mkdtemp( tmpl ), nullptr );
+    dir      = tmpl;
+    dataPath = dir + "/data";
+    tagPath  = dir + "/data.xrdt";
+  }
+
+  void TearDown() override
+  {
+    unlink( dataPath.c_str() );
+    unlink( tagPath.c_str() );
+    rmdir( dir.c_str() );
+  }
+
+  std::unique_ptr<XrdOssCsiTagstoreFile> Tagstore( IoLog *log = 0,
+                                                   size_t cachepages = 4 )
+  {
+    std::unique_ptr<XrdOssDF> fd( new PosixDF( log ) );
+    return std::unique_ptr<XrdOssCsiTagstoreFile>(
+        new XrdOssCsiTagstoreFile( tagPath, std::move( fd ), "test", cachepages ) );
+  }
+
+  std::vector<char> WriteData( size_t npages )
+  {
+    std::vector<char> data( npages * XrdSys::PageSize );
+    for( size_t i = 0; i < data.size(); i++ ) data[i] = char( i * 7 + i / 4096 );
+    int fd = open( dataPath.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644 );
+    EXPECT_GE( fd, 0 );
+    EXPECT_EQ( write( fd, data.data(), data.size() ), ssize_t( data.size() ) );
+    close( fd );
+    return data;
+  }
+
+  std::string dir, dataPath, tagPath;
+  XrdOucEnv   env;
+};
+}
+
+//------------------------------------------------------------------------------
+// The header that clears csDirty may only be written once the tags it
+// vouches for have been synced.
+//------------------------------------------------------------------------------
+TEST_F( XrdOssCsiTagstoreTest, TagsSyncedBeforeDirtyCleared )
+{
+  const size_t npages = 3000; // spans several cache pages
+  std::vector<char> data = WriteData( npages );
+  std::vector<uint32_t> tags( npages );
+  XrdOucCRC::Calc32C( data.data(), data.size(), tags.data() );
+
+  IoLog log;
+  auto ts = Tagstore( &log );
+  ASSERT_EQ( ts->Open( tagPath.c_str(), 0, O_RDWR | O_CREAT, env ), 0 );
+  ASSERT_EQ( ts->WriteTags( tags.data(), 0, npages ), ssize_t( npages ) );
+  ASSERT_EQ( ts->SetTrackedSize( data.size() ), 0 );
+  ASSERT_EQ( ts->Close(), 0 );
+
+  bool sawDirty = false, sawClear = false;
+  off_t lastTagWrite = -1;
+  bool syncedSinceTags = true;
+  for( auto &op : log.ops )
+  {
+    if( op.what == 'S' ) { syncedSinceTags = true; continue; }
+    if( op.off >= 20 ) { lastTagWrite = op.off; syncedSinceTags = false; continue; }
+    if( op.off != 0 ) continue;
+    if( op.flags & XrdOssCsiTagstore::csDirty ) { sawDirty = true; continue; }
+    if( sawDirty )
+    {
+      sawClear = true;
+      EXPECT_TRUE( syncedSinceTags ) << "csDirty cleared before the tags "
+                                        "written at " << lastTagWrite << " were synced";
+    }
+  }
+  EXPECT_TRUE( sawDirty );
+  EXPECT_TRUE( sawClear );
+  EXPECT_GE( lastTagWrite, 20 );
+}
+
+//------------------------------------------------------------------------------
+// The header setting csDirty is synced as soon as it is written, before any
+// data the cached tags describe can reach the disk, and only once for a run
+// of writes.
+//------------------------------------------------------------------------------
+TEST_F( XrdOssCsiTagstoreTest, DirtyHeaderSyncedOnce )
+{
+  const size_t npages = 64;
+  std::vector<char> data = WriteData( npages );
+  std::vector<uint32_t> tags( npages );
+  XrdOucCRC::Calc32C( data.data(), data.size(), tags.data() );
+
+  IoLog log;
+  auto ts = Tagstore( &log );
+  ASSERT_EQ( ts->Open( tagPath.c_str(), 0, O_RDWR | O_CREAT, env ), 0 );
+  log.ops.clear();
+
+  ASSERT_EQ( ts->WriteTags( tags.data(), 0, 1 ), 1 );
+  ASSERT_EQ( log.ops.size(), 2u );
+  EXPECT_EQ( log.ops[0].what, 'W' );
+  EXPECT_EQ( log.ops[0].off, 0 );
+  EXPECT_TRUE( log.ops[0].flags & XrdOssCsiTagstore::csDirty );
+  EXPECT_EQ( log.ops[1].what, 'S' );
+
+  // further writes stay in the cache, the header is already dirty
+  for( size_t i = 1; i < npages; i++ )
+    ASSERT_EQ( ts->WriteTags( &tags[i], i, 1 ), 1 );
+  EXPECT_EQ( log.ops.size(), 2u );
+
+  ASSERT_EQ( ts->Close(), 0 );
+}
+
+//------------------------------------------------------------------------------
+// If the tags never made it to disk the header still has csDirty set. On the
+// next open all the tags are recomputed from the data.
+//------------------------------------------------------------------------------
+TEST_F( XrdOssCsiTagstoreTest, RecoverAfterCrashWithDirtyHeader )
+{
+  const size_t npages = 1500;
+  std::vector<char> data = WriteData( npages );
+  std::vector<uint32_t> good( npages ), bad( npages, 0xdeadbeef );
+  XrdOucCRC::Calc32C( data.data(), data.size(), good.data() );
+
+  // Start from a clean tagfile holding tags that are known to be wrong, then
+  // crash while the correct ones are only in the cache.
+  {
+    auto ts = Tagstore( nullptr, 0 );
+    ASSERT_EQ( ts->Open( tagPath.c_str(), 0, O_RDWR | O_CREAT, env ), 0 );
+    ASSERT_EQ( ts->WriteTags( bad.data(), 0, npages ), ssize_t( npages ) );
+    ASSERT_EQ( ts->SetTrackedSize( data.size() ), 0 );
+    ASSERT_EQ( ts->Close(), 0 );
+  }
+  {
+    IoLog log;
+    auto ts = Tagstore( &log );
+    ASSERT_EQ( ts->Open( tagPath.c_str(), data.size(), O_RDWR, env ), 0 );
+    ASSERT_EQ( ts->WriteTags( good.data(), 0, npages ), ssize_t( npages ) );
+    log.crashed = true;
+    ts->Close();
+  }
+
+  auto ts = Tagstore();
+  ASSERT_EQ( ts->Open( tagPath.c_str(), data.size(), O_RDWR, env ), 0 );
+  PosixDF datafd;
+  ASSERT_EQ( datafd.Open( dataPath.c_str(), O_RDONLY, 0, env ), 0 );
+  ASSERT_EQ( ts->Recover( &datafd ), 0 );
+  EXPECT_EQ( ts->GetTrackedTagSize(), off_t( data.size() ) );
+
+  std::vector<uint32_t> got( npages );
+  ASSERT_EQ( ts->ReadTags( got.data(), 0, npages ), ssize_t( npages ) );
+  EXPECT_EQ( got, good );
+  ASSERT_EQ( ts->Close(), 0 );
+
+  // Recovered and clean: a further open finds nothing to do and keeps them
+  ts = Tagstore( nullptr, 0 );
+  ASSERT_EQ( ts->Open( tagPath.c_str(), data.size(), O_RDWR, env ), 0 );
+  ASSERT_EQ( ts->ReadTags( got.data(), 0, npages ), ssize_t( npages ) );
+  EXPECT_EQ( got, good );
+  ASSERT_EQ( ts->Close(), 0 );
+}
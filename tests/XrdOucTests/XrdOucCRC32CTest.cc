@@ -0,0 +1,179 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "XrdOuc/XrdOucCRC.hh"
+#include "XrdOuc/XrdOucCRC32C.hh"
+#include "XrdSys/XrdSysPlatform.hh"
+
+namespace
+{
+// Random data, with some slack so that buffers can start at any alignment.
+//
+std::vector<uint8_t> RandomData(size_t size, unsigned seed = 1)
+{
+   std::mt19937 gen(seed);
+   std::vector<uint8_t> data(size + 64);
+   for (auto &b : data) b = (uint8_t)gen();
+   return data;
+}
+
+// Reference page checksums.
+//
+std::vector<uint32_t> PageCRCs(const uint8_t *data, size_t count)
+{
+   std::vector<uint32_t> crcs;
+   while(count)
+        {size_t n = (count < (size_t)XrdSys::PageSize
+                  ?  count : (size_t)XrdSys::PageSize);
+         crcs.push_back(crc32c_sw(0, data, n));
+         data += n; count -= n;
+        }
+   return crcs;
+}
+
+// Number of pages the batch verification handles at a time.
+//
+const int pgBatch = 64;
+}
+
+//------------------------------------------------------------------------------
+// Every buffer of a batch has the same checksum as when computed on its own,
+// whatever the lengths, the alignment and the number of buffers.
+//------------------------------------------------------------------------------
+TEST(XrdOucCRC32CTest, BatchMatchesSoftware)
+{
+   const size_t lens[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 23, 24,
+                          31, 33, 47, 100, 4095, 4096, 4097, 5003, 65537};
+   const size_t nlens = sizeof(lens)/sizeof(lens[0]);
+   std::vector<uint8_t> data = RandomData(70000);
+   std::mt19937 gen(2);
+
+   for (size_t num = 0; num <= 13; num++)
+       for (int round = 0; round < 50; round++)
+           {std::vector<const void*> buf(num);
+            std::vector<size_t>      len(num);
+            std::vector<uint32_t>    crc(num, 0xdeadbeef);
+            for (size_t i = 0; i < num; i++)
+                {len[i] = lens[gen() % nlens];
+                 buf[i] = data.data() + gen() % 64;
+                }
+            crc32c_batch(buf.data(), len.data(), crc.data(), num);
+            for (size_t i = 0; i < num; i++)
+                {ASSERT_EQ(crc[i], crc32c_sw(0, buf[i], len[i]))
+                    << "buffer " << i << " of " << num << " with " << len[i]
+                    << " bytes";
+                 ASSERT_EQ(crc[i], crc32c(0, buf[i], len[i]));
+                }
+           }
+}
+
+//------------------------------------------------------------------------------
+// Each length on its own and in batches of four where all but one buffer are
+// long, so that the common part of the four is as short as that one.
+//------------------------------------------------------------------------------
+TEST(XrdOucCRC32CTest, BatchShortBuffers)
+{
+   std::vector<uint8_t> data = RandomData(4096);
+
+   for (size_t n = 0; n < 64; n++)
+       for (size_t pos = 0; pos < 4; pos++)
+           {const void* buf[4];
+            size_t      len[4];
+            uint32_t    crc[4];
+            for (size_t i = 0; i < 4; i++)
+                {buf[i] = data.data() + i + 1;
+                 len[i] = (i == pos ? n : 1000 + i);
+                }
+            crc32c_batch(buf, len, crc, 4);
+            for (size_t i = 0; i < 4; i++)
+                ASSERT_EQ(crc[i], crc32c_sw(0, buf[i], len[i]))
+                   << "buffer " << i << " with " << len[i] << " bytes";
+           }
+}
+
+//------------------------------------------------------------------------------
+// Page checksums, with a short last page and more pages than fit in a batch.
+//------------------------------------------------------------------------------
+TEST(XrdOucCRC32CTest, PageChecksums)
+{
+   const size_t counts[] = {0, 1, 7, 4095, 4096, 4097, 3*4096 + 5,
+                            pgBatch*4096, pgBatch*4096 + 1,
+                            (2*pgBatch + 3)*4096 + 17};
+   std::vector<uint8_t> data = RandomData((2*pgBatch + 4)*4096);
+
+   for (size_t count : counts)
+       {std::vector<uint32_t> expect = PageCRCs(data.data(), count);
+        std::vector<uint32_t> got(expect.size() + 1, 0xdeadbeef);
+        XrdOucCRC::Calc32C(data.data(), count, got.data());
+        got.pop_back();
+        EXPECT_EQ(got, expect) << count << " bytes";
+        EXPECT_EQ(XrdOucCRC::Calc32C(data.data(), count),
+                  crc32c_sw(0, data.data(), count));
+       }
+}
+
+//------------------------------------------------------------------------------
+// A bad page checksum is reported at its own index, also when it is in the
+// first or last page of a batch or in a later batch.
+//------------------------------------------------------------------------------
+TEST(XrdOucCRC32CTest, VerifyMismatchIndex)
+{
+   const size_t count = (3*pgBatch + 5)*4096 + 100;
+   std::vector<uint8_t>  data = RandomData(count);
+   std::vector<uint32_t> good = PageCRCs(data.data(), count);
+   const int npages = good.size();
+   uint32_t valcs = 0;
+
+   ASSERT_EQ(XrdOucCRC::Ver32C(data.data(), count, good.data(), valcs), -1);
+
+   const int bad[] = {0, 1, pgBatch - 1, pgBatch, pgBatch + 1, 2*pgBatch - 1,
+                      2*pgBatch, 3*pgBatch, npages - 2, npages - 1};
+   for (int idx : bad)
+       {std::vector<uint32_t> csval = good;
+        csval[idx] ^= 0x5a5a5a5a;
+        valcs = 0;
+        EXPECT_EQ(XrdOucCRC::Ver32C(data.data(), count, csval.data(), valcs),
+                  idx);
+        EXPECT_EQ(valcs, good[idx]) << "page " << idx;
+
+        std::vector<uint32_t> valcsv(npages);
+        EXPECT_FALSE(XrdOucCRC::Ver32C(data.data(), count, csval.data(),
+                                       valcsv.data()));
+        EXPECT_EQ(valcsv, good);
+
+        std::unique_ptr<bool[]> valok(new bool[npages]);
+        EXPECT_FALSE(XrdOucCRC::Ver32C(data.data(), count, csval.data(),
+                                       valok.get()));
+        for (int i = 0; i < npages; i++)
+            EXPECT_EQ(valok[i], i != idx) << "page " << i;
+       }
+
+   // The first of several mismatches is the one reported
+   std::vector<uint32_t> csval = good;
+   csval[pgBatch + 3]++;
+   csval[2*pgBatch + 1]++;
+   EXPECT_EQ(XrdOucCRC::Ver32C(data.data(), count, csval.data(), valcs),
+             pgBatch + 3);
+   EXPECT_EQ(valcs, good[pgBatch + 3]);
+}
@@ -0,0 +1,243 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d P o s i x F D L o a d . c c                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+//-----------------------------------------------------------------------------
+//! A small load generator for the XrdPosix descriptor table. Each thread looks
+//! up descriptors, locks and unlocks the object as every POSIX call does, and
+//! reports the per-lookup cost. Optionally, another thread keeps opening and
+//! closing descriptors so that lookups race with object removal. With -o each
+//! lookup is serialized on a global mutex, as was done before lookups became
+//! lock-free, so that the two can be compared on the same machine.
+//-----------------------------------------------------------------------------
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "XrdPosix/XrdPosixObject.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                          U n i t   G l o b a l s                           */
+/******************************************************************************/
+
+namespace
+{
+   int         numThreads  = 4;
+   int         numFiles    = 64;
+   long long   numLookups  = 10000000;
+   bool        doChurn     = false;
+   bool        oldDesign   = false;
+   const char *MeMe        = "xrdposixfdload: ";
+
+   XrdSysMutex       oldMutex;
+   std::atomic<bool> allDone(false);
+}
+
+/******************************************************************************/
+/*                              O b j e c t s                                 */
+/******************************************************************************/
+
+namespace
+{
+// Directory lookups are used as they need nothing but the object itself. The
+// returned pointer is only ever compared, never dereferenced.
+//
+class TestObj : public XrdPosixObject
+{
+public:
+
+bool     Who(XrdPosixDir **dirP) override
+            {*dirP = (XrdPosixDir *)this; return true;}
+
+         TestObj() {}
+        ~TestObj() override {}
+};
+
+std::vector<TestObj *> theFiles;
+}
+
+/******************************************************************************/
+/*                                R u n n e r                                 */
+/******************************************************************************/
+
+namespace
+{
+void Runner(int tNum, long long nLook, long long *misses)
+{
+   XrdPosixDir *dP;
+   long long bad = 0;
+   int i = tNum;
+
+// Look up the descriptors in turn. Each one is held just as long as it takes
+// to unlock it again, which is the overhead every POSIX call pays.
+//
+   for (long long n = 0; n < nLook; n++)
+       {TestObj *oP = theFiles[i];
+        if (oldDesign) oldMutex.Lock();
+        dP = XrdPosixObject::Dir(oP->FDNum());
+        if (oldDesign) oldMutex.UnLock();
+        if (dP != (XrdPosixDir *)oP) bad++;
+           else oP->UnLock();
+        if (++i >= numFiles) i = 0;
+       }
+   *misses = bad;
+}
+
+// Open and close descriptors while the lookups run. A lookup of a descriptor
+// that has just been closed must fail cleanly, never return a dead object.
+//
+void Churner(long long *cycles, long long *misses)
+{
+   XrdPosixDir *dP;
+   long long n = 0, bad = 0;
+   int fd;
+
+   while(!allDone.load())
+        {TestObj *oP = new TestObj;
+         if (!oP->AssignFD()) {delete oP; bad++; break;}
+         fd = oP->FDNum();
+         if (XrdPosixObject::ReleaseDir(fd) != (XrdPosixDir *)oP) bad++;
+         delete oP;
+         if ((dP = XrdPosixObject::Dir(fd)))
+            {((TestObj *)dP)->UnLock(); bad++;}
+         n++;
+        }
+   *cycles = n; *misses = bad;
+}
+}
+
+/******************************************************************************/
+/*                                 U s a g e                                  */
+/******************************************************************************/
+
+namespace
+{
+void Usage(int rc)
+{
+   std::cerr <<"Usage: xrdposixfdload [-c] [-f <files>] [-n <lookups>] [-o] "
+               "[-t <threads>]\n\n"
+               "-c open and close descriptors while the lookups run.\n"
+               "-f number of open descriptors (default 64).\n"
+               "-n total number of lookups to run (default 10000000).\n"
+               "-o serialize lookups on a global mutex as before.\n"
+               "-t number of threads (default 4)." <<std::endl;
+   exit(rc);
+}
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   long long totMiss = 0, churnMiss = 0, churnCycles = 0;
+   int c;
+
+// Process the options
+//
+   while((c = getopt(argc, argv, "cf:hn:ot:")) != -1)
+        {switch(c)
+               {case 'c': doChurn    = true; break;
+                case 'f': numFiles   = atoi(optarg); break;
+                case 'n': numLookups = atoll(optarg); break;
+                case 'o': oldDesign  = true; break;
+                case 't': numThreads = atoi(optarg); break;
+                case 'h': Usage(0); break;
+                default:  Usage(1); break;
+               }
+        }
+   if (numFiles < 1 || numLookups < 1 || numThreads < 1)
+      {std::cerr <<MeMe <<"Option values must be positive." <<std::endl;
+       Usage(1);
+      }
+
+// Use virtual descriptors so that no real ones are consumed
+//
+   if (XrdPosixObject::Init(-(numFiles + 16)) < 0)
+      {std::cerr <<MeMe <<"Unable to initialize the descriptor table."
+                 <<std::endl;
+       return 1;
+      }
+
+// Open all of the descriptors
+//
+   for (int i = 0; i < numFiles; i++)
+       {TestObj *oP = new TestObj;
+        if (!oP->AssignFD())
+           {std::cerr <<MeMe <<"Unable to assign a descriptor." <<std::endl;
+            return 1;
+           }
+        theFiles.push_back(oP);
+       }
+
+// Run the threads
+//
+   std::vector<std::thread>  threads;
+   std::vector<long long>    misses(numThreads, 0);
+   std::thread               churner;
+   long long nLook = numLookups / numThreads;
+
+   if (doChurn) churner = std::thread(Churner, &churnCycles, &churnMiss);
+   auto tBeg = std::chrono::steady_clock::now();
+
+   for (int i = 0; i < numThreads; i++)
+       threads.emplace_back(Runner, i, nLook, &misses[i]);
+   for (int i = 0; i < numThreads; i++)
+       {threads[i].join(); totMiss += misses[i];}
+
+   auto tEnd = std::chrono::steady_clock::now();
+   allDone = true;
+   if (doChurn) churner.join();
+
+// Report the results
+//
+   double secs = std::chrono::duration<double>(tEnd - tBeg).count();
+   long long done = nLook * numThreads;
+   printf("%s%s design: %lld lookups in %.3f sec = %.1f ns/lookup/thread "
+          "(threads=%d files=%d)\n", MeMe, (oldDesign ? "old" : "new"),
+          done, secs, (done ? secs * 1e9 * numThreads / done : 0.0),
+          numThreads, numFiles);
+   if (doChurn)
+      printf("%s%lld descriptors opened and closed meanwhile\n",
+             MeMe, churnCycles);
+
+   if (totMiss || churnMiss)
+      {std::cerr <<MeMe <<totMiss + churnMiss <<" lookups failed!"
+                 <<std::endl;
+       return 1;
+      }
+   return 0;
+}
@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <thread>
+#include <vector>
+
+#include "XrdPosix/XrdPosixObject.hh"
+
+namespace
+{
+// Directory lookups are used as they need nothing but the object itself. The
+// returned pointer is only ever compared, never dereferenced.
+//
+class TestObj : public XrdPosixObject
+{
+public:
+
+static const int Magic = 0x0b1ec7;
+
+int      magic = Magic;  // Cleared once the object is gone
+
+bool     Who(XrdPosixDir **dirP) override
+            {*dirP = (XrdPosixDir *)this; return true;}
+
+         TestObj() {}
+        ~TestObj() override {magic = 0;}
+};
+
+const int numFiles = 64;
+
+// Use virtual descriptors so that no real ones are consumed. The table can
+// only be initialized once per process.
+//
+class XrdPosixObjectTest : public ::testing::Test
+{
+protected:
+static void SetUpTestSuite()
+           {ASSERT_GE(XrdPosixObject::Init(-(numFiles + 16)), 0);}
+};
+}
+
+//------------------------------------------------------------------------------
+// A descriptor can be looked up until it is released, and not afterwards.
+//------------------------------------------------------------------------------
+TEST_F(XrdPosixObjectTest, AssignLookUpRelease)
+{
+  TestObj *oP = new TestObj;
+  ASSERT_TRUE(oP->AssignFD());
+  int fd = oP->FDNum();
+  ASSERT_GE(fd, 0);
+  EXPECT_TRUE(XrdPosixObject::Valid(fd));
+
+  XrdPosixDir *dP = XrdPosixObject::Dir(fd);
+  ASSERT_EQ(dP, (XrdPosixDir *)oP);
+  oP->UnLock();
+
+  EXPECT_EQ(XrdPosixObject::File(fd), nullptr);
+
+  EXPECT_EQ(XrdPosixObject::ReleaseDir(fd), (XrdPosixDir *)oP);
+  delete oP;
+
+  errno = 0;
+  EXPECT_EQ(XrdPosixObject::Dir(fd), nullptr);
+  EXPECT_EQ(errno, EBADF);
+  EXPECT_FALSE(XrdPosixObject::Valid(fd));
+}
+
+//------------------------------------------------------------------------------
+// Lookups of open descriptors run in parallel with other descriptors being
+// opened and closed. Every lookup of an open descriptor must succeed, and a
+// lookup of a closed descriptor must fail rather than return a dead object.
+//------------------------------------------------------------------------------
+TEST_F(XrdPosixObjectTest, LookUpWhileChurning)
+{
+  const int numThreads = 4;
+  const int numLookups = 200000;
+  const int numStable  = numFiles / 2;
+  std::vector<TestObj *> files;
+  std::atomic<bool> allDone(false);
+  std::atomic<long long> misses(0), churnBad(0), cycles(0);
+
+  for (int i = 0; i < numStable; i++)
+  {
+    TestObj *oP = new TestObj;
+    ASSERT_TRUE(oP->AssignFD());
+    files.push_back(oP);
+  }
+
+  std::thread churner([&]
+  {
+    long long n = 0, bad = 0;
+    while (!allDone.load() || n == 0)
+    {
+      TestObj *oP = new TestObj;
+      if (!oP->AssignFD()) {delete oP; bad++; break;}
+      int fd = oP->FDNum();
+      if (XrdPosixObject::ReleaseDir(fd) != (XrdPosixDir *)oP) bad++;
+      delete oP;
+      XrdPosixDir *dP = XrdPosixObject::Dir(fd);
+      if (dP) {((TestObj *)dP)->UnLock(); bad++;}
+      n++;
+    }
+    cycles = n;
+    churnBad = bad;
+  });
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++)
+    threads.emplace_back([&, t]
+    {
+      long long bad = 0;
+      int i = t;
+      for (int n = 0; n < numLookups; n++)
+      {
+        TestObj *oP = files[i];
+        XrdPosixDir *dP = XrdPosixObject::Dir(oP->FDNum());
+        if (dP != (XrdPosixDir *)oP) bad++;
+        else oP->UnLock();
+        if (++i >= numStable) i = 0;
+      }
+      misses += bad;
+    });
+
+  for (auto &t : threads) t.join();
+  allDone = true;
+  churner.join();
+
+  EXPECT_EQ(misses.load(), 0);
+  EXPECT_EQ(churnBad.load(), 0);
+  EXPECT_GT(cycles.load(), 0);
+
+  for (auto *oP : files)
+  {
+    EXPECT_EQ(XrdPosixObject::ReleaseDir(oP->FDNum()), (XrdPosixDir *)oP);
+    delete oP;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Lookups of a descriptor run while that same descriptor is being released
+// and reused. A lookup either gets the object, which then stays alive until it
+// is unlocked, or fails with EBADF; it never returns a released object.
+//------------------------------------------------------------------------------
+TEST_F(XrdPosixObjectTest, LookUpWhileReleasing)
+{
+  const int numThreads = 4;
+  const int numCycles  = 200;
+  std::atomic<int> curFD(-1);
+  std::atomic<bool> allDone(false);
+  std::atomic<long long> hits(0), bad(0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++)
+    threads.emplace_back([&]
+    {
+      while (!allDone.load())
+      {
+        int fd = curFD.load();
+        if (fd < 0) continue;
+        errno = 0;
+        XrdPosixDir *dP = XrdPosixObject::Dir(fd);
+        if (dP)
+        {
+          if (((TestObj *)dP)->magic != TestObj::Magic) bad++;
+          hits++;
+          ((TestObj *)dP)->UnLock();
+        }
+        else if (errno != EBADF) bad++;
+        std::this_thread::yield();
+      }
+    });
+
+  for (int n = 0; n < numCycles; n++)
+  {
+    TestObj *oP = new TestObj;
+    ASSERT_TRUE(oP->AssignFD());
+    int fd = oP->FDNum();
+    long long seen = hits.load();
+    curFD = fd;
+    for (int i = 0; i < 100000 && hits.load() == seen; i++)
+      std::this_thread::yield();
+    EXPECT_EQ(XrdPosixObject::ReleaseDir(fd), (XrdPosixDir *)oP);
+    delete oP;
+  }
+
+  allDone = true;
+  for (auto &t : threads) t.join();
+
+  EXPECT_EQ(bad.load(), 0);
+  EXPECT_GT(hits.load(), 0);
+}
@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "XrdS3Index.hh"
+
+using namespace S3;
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // The keys of the entries of a page, and those of its common prefixes
+  //----------------------------------------------------------------------------
+  std::vector<std::string> Keys( const S3Index::Page &page )
+  {
+    std::vector<std::string> keys;
+    for( const auto &entry : page.entries ) keys.push_back( entry.key );
+    return keys;
+  }
+
+  std::vector<std::string> CommonPrefixes( const S3Index::Page &page )
+  {
+    std::vector<std::string> prefixes;
+    for( const auto &entry : page.entries )
+      if( entry.common_prefix ) prefixes.push_back( entry.key );
+    return prefixes;
+  }
+}
+
+//------------------------------------------------------------------------------
+// A bucket directory with a few nested objects
+//------------------------------------------------------------------------------
+class S3IndexTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+      char tmpl[] = "/tmp/xrds3-index-XXXXXX";
+      ASSERT_TRUE( mkdtemp( tmpl ) );
+      root = tmpl;
+      for( const char *key : { "a", "b/1", "b/2", "b/c/3", "b0", "c", "d/4",
+                               "d/5", "e" } )
+        Create( key );
+      // the temporary file of an upload in progress
+      Create( "b/.upload-1234" );
+    }
+
+    void TearDown() override
+    {
+      std::filesystem::remove_all( root );
+    }
+
+    void Create( const std::string &key )
+    {
+      auto path = root / key;
+      std::filesystem::create_directories( path.parent_path() );
+      std::ofstream( path ) << key;
+    }
+
+    S3Index::Page List( const std::string &prefix, const std::string &marker,
+                        char delimiter, int max_keys = 1000,
+                        bool inclusive = false )
+    {
+      return index.List( "bucket", root, prefix, marker, delimiter, max_keys,
+                         inclusive );
+    }
+
+    using Keys_t = std::vector<std::string>;
+
+    std::filesystem::path root;
+    S3Index               index;
+};
+
+//------------------------------------------------------------------------------
+// Without prefix and delimiter all the objects are listed in order, the
+// temporary files excepted
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, ListAll)
+{
+  auto page = List( "", "", 0 );
+  EXPECT_EQ( Keys( page ), Keys_t( { "a", "b/1", "b/2", "b/c/3", "b0", "c",
+                                     "d/4", "d/5", "e" } ) );
+  EXPECT_TRUE( CommonPrefixes( page ).empty() );
+  EXPECT_FALSE( page.is_truncated );
+}
+
+//------------------------------------------------------------------------------
+// Only the keys starting with the prefix are listed
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, Prefix)
+{
+  EXPECT_EQ( Keys( List( "b/", "", 0 ) ), Keys_t( { "b/1", "b/2", "b/c/3" } ) );
+  EXPECT_EQ( Keys( List( "b", "", 0 ) ),
+             Keys_t( { "b/1", "b/2", "b/c/3", "b0" } ) );
+  EXPECT_EQ( Keys( List( "e", "", 0 ) ), Keys_t( { "e" } ) );
+  EXPECT_TRUE( List( "f", "", 0 ).entries.empty() );
+  EXPECT_TRUE( List( "b/x", "", 0 ).entries.empty() );
+}
+
+//------------------------------------------------------------------------------
+// The keys with the delimiter after the prefix are rolled up into common
+// prefixes, each listed once
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, Delimiter)
+{
+  auto page = List( "", "", '/' );
+  EXPECT_EQ( Keys( page ), Keys_t( { "a", "b/", "b0", "c", "d/", "e" } ) );
+  EXPECT_EQ( CommonPrefixes( page ), Keys_t( { "b/", "d/" } ) );
+
+  page = List( "b/", "", '/' );
+  EXPECT_EQ( Keys( page ), Keys_t( { "b/1", "b/2", "b/c/" } ) );
+  EXPECT_EQ( CommonPrefixes( page ), Keys_t( { "b/c/" } ) );
+
+  // a delimiter that does not occur lists every key
+  EXPECT_EQ( Keys( List( "b", "", '#' ) ),
+             Keys_t( { "b/1", "b/2", "b/c/3", "b0" } ) );
+}
+
+//------------------------------------------------------------------------------
+// The listing starts after the marker; a marker before the prefix is of no
+// consequence and one past it leaves nothing to list
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, Marker)
+{
+  EXPECT_EQ( Keys( List( "", "b/1", 0 ) ),
+             Keys_t( { "b/2", "b/c/3", "b0", "c", "d/4", "d/5", "e" } ) );
+  EXPECT_EQ( Keys( List( "", "b/15", 0 ) ),
+             Keys_t( { "b/2", "b/c/3", "b0", "c", "d/4", "d/5", "e" } ) );
+  EXPECT_EQ( Keys( List( "b/", "a", 0 ) ), Keys_t( { "b/1", "b/2", "b/c/3" } ) );
+  EXPECT_EQ( Keys( List( "b/", "b/2", '/' ) ), Keys_t( { "b/c/" } ) );
+  EXPECT_TRUE( List( "b/", "c", 0 ).entries.empty() );
+  EXPECT_TRUE( List( "", "e", 0 ).entries.empty() );
+}
+
+//------------------------------------------------------------------------------
+// A page that is full is truncated, the next marker being the first entry
+// that did not fit, a common prefix if need be
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, Truncated)
+{
+  auto page = List( "", "", '/', 2 );
+  EXPECT_EQ( Keys( page ), Keys_t( { "a", "b/" } ) );
+  EXPECT_TRUE( page.is_truncated );
+  EXPECT_EQ( page.next_marker, "b0" );
+
+  page = List( "", "b0", '/', 1, true );
+  EXPECT_EQ( Keys( page ), Keys_t( { "b0" } ) );
+  EXPECT_TRUE( page.is_truncated );
+  EXPECT_EQ( page.next_marker, "c" );
+
+  page = List( "", "c", '/', 1 );
+  EXPECT_EQ( Keys( page ), Keys_t( { "d/" } ) );
+  EXPECT_EQ( CommonPrefixes( page ), Keys_t( { "d/" } ) );
+  EXPECT_TRUE( page.is_truncated );
+  EXPECT_EQ( page.next_marker, "e" );
+
+  // exactly full is not truncated
+  page = List( "b/", "", '/', 3 );
+  EXPECT_EQ( page.entries.size(), 3u );
+  EXPECT_FALSE( page.is_truncated );
+  EXPECT_TRUE( page.next_marker.empty() );
+}
+
+//------------------------------------------------------------------------------
+// A marker that ends in the delimiter is a common prefix that was listed
+// already, all the keys rolled up into it are skipped; without a delimiter
+// it is an ordinary key
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, MarkerEndingInDelimiter)
+{
+  EXPECT_EQ( Keys( List( "", "b/", '/' ) ),
+             Keys_t( { "b0", "c", "d/", "e" } ) );
+  EXPECT_EQ( Keys( List( "", "d/", '/' ) ), Keys_t( { "e" } ) );
+  EXPECT_EQ( Keys( List( "b/", "b/c/", '/' ) ), Keys_t() );
+
+  EXPECT_EQ( Keys( List( "", "b/", 0 ) ),
+             Keys_t( { "b/1", "b/2", "b/c/3", "b0", "c", "d/4", "d/5",
+                       "e" } ) );
+
+  // nor when the delimiter is another one
+  EXPECT_EQ( Keys( List( "b", "b/", '#' ) ),
+             Keys_t( { "b/1", "b/2", "b/c/3", "b0" } ) );
+}
+
+//------------------------------------------------------------------------------
+// An inclusive marker is listed itself, a common prefix included
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, InclusiveMarker)
+{
+  EXPECT_EQ( Keys( List( "", "c", 0, 1000, true ) ),
+             Keys_t( { "c", "d/4", "d/5", "e" } ) );
+  EXPECT_EQ( Keys( List( "", "d/", '/', 1000, true ) ),
+             Keys_t( { "d/", "e" } ) );
+  EXPECT_EQ( Keys( List( "", "b/", '/', 1000, true ) ),
+             Keys_t( { "b/", "b0", "c", "d/", "e" } ) );
+  // a marker that is not a key starts at the next one
+  EXPECT_EQ( Keys( List( "", "cc", 0, 1000, true ) ),
+             Keys_t( { "d/4", "d/5", "e" } ) );
+}
+
+//------------------------------------------------------------------------------
+// Paging with the next marker, inclusive, yields the same entries as a single
+// listing, whatever the page size
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, Paging)
+{
+  for( char delimiter : { char( 0 ), '/' } )
+    for( const std::string prefix : { "", "b", "b/", "d/" } )
+    {
+      auto all = Keys( List( prefix, "", delimiter ) );
+      for( int max_keys = 1; max_keys <= 4; ++max_keys )
+      {
+        Keys_t paged;
+        std::string marker;
+        bool inclusive = false;
+        for( int n = 0; n < 20; ++n )
+        {
+          auto page = List( prefix, marker, delimiter, max_keys, inclusive );
+          auto keys = Keys( page );
+          paged.insert( paged.end(), keys.begin(), keys.end() );
+          if( !page.is_truncated ) break;
+          marker    = page.next_marker;
+          inclusive = true;
+        }
+        EXPECT_EQ( paged, all ) << "prefix '" << prefix << "' delimiter "
+                                << int( delimiter ) << " max " << max_keys;
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Objects created and deleted once the index is built show in the listing,
+// a dropped index is built again from the bucket directory
+//------------------------------------------------------------------------------
+TEST_F(S3IndexTest, Update)
+{
+  EXPECT_EQ( Keys( List( "d/", "", 0 ) ), Keys_t( { "d/4", "d/5" } ) );
+
+  Create( "d/6" );
+  index.Add( "bucket", "d/6" );
+  std::filesystem::remove( root / "d/4" );
+  index.Remove( "bucket", "d/4" );
+  EXPECT_EQ( Keys( List( "d/", "", 0 ) ), Keys_t( { "d/5", "d/6" } ) );
+
+  // changes behind the back of the index are only seen once it is dropped
+  Create( "d/7" );
+  EXPECT_EQ( Keys( List( "d/", "", 0 ) ), Keys_t( { "d/5", "d/6" } ) );
+  index.Drop( "bucket" );
+  EXPECT_EQ( Keys( List( "d/", "", 0 ) ), Keys_t( { "d/5", "d/6", "d/7" } ) );
+
+  // a bucket that is not indexed yet ignores the updates
+  index.Add( "other", "x" );
+  auto page = index.List( "other", root / "b", "", "", 0, 1000, false );
+  EXPECT_EQ( Keys( page ), Keys_t( { "1", "2", "c/3" } ) );
+}
@@ -0,0 +1,279 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "XrdS3ObjectStore.hh"
+#include "XrdS3Utils.hh"
+
+using namespace S3;
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // A range of a composite object: length bytes at offset in file path
+  //----------------------------------------------------------------------------
+  struct Range
+  {
+    std::string path;
+    off_t       offset;
+    size_t      length;
+  };
+
+  std::string RandomData( size_t size, unsigned seed )
+  {
+    std::mt19937 gen( seed );
+    std::string data( size, 0 );
+    for( auto &c : data ) c = static_cast<char>( gen() );
+    return data;
+  }
+
+  void WriteAt( const std::filesystem::path &path, off_t offset,
+                const std::string &data )
+  {
+    int fd = open( path.c_str(), O_CREAT | O_WRONLY, 0644 );
+    ASSERT_GE( fd, 0 );
+    ASSERT_EQ( pwrite( fd, data.data(), data.size(), offset ),
+               static_cast<ssize_t>( data.size() ) );
+    close( fd );
+  }
+
+  std::string ReadFile( const std::filesystem::path &path )
+  {
+    std::ifstream in( path, std::ios::binary );
+    return std::string( std::istreambuf_iterator<char>( in ), {} );
+  }
+}
+
+//------------------------------------------------------------------------------
+// Composite objects, as left by a multipart upload completed without copying
+// the parts: a sparse object file pointing at a directory with the parts and
+// a manifest listing the ranges they make up
+//------------------------------------------------------------------------------
+class S3CompositeObjectTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+      char tmpl[] = "/tmp/xrds3-XXXXXX";
+      ASSERT_TRUE( mkdtemp( tmpl ) );
+      root = tmpl;
+      mtpu = root / "mtpu";
+      bucket.name = "bucket";
+      bucket.path = root / "bucket";
+      std::filesystem::create_directories( bucket.path );
+      std::filesystem::create_directories( root / "config" );
+      store.reset( new S3ObjectStore( root / "config", mtpu ) );
+    }
+
+    void TearDown() override
+    {
+      store.reset();
+      std::filesystem::remove_all( root );
+    }
+
+    //--------------------------------------------------------------------------
+    // Make the composite object key out of the given ranges, the composite
+    // directory being recorded as given, relative to the multipart upload
+    // directory; return the content of the object
+    //--------------------------------------------------------------------------
+    std::string MakeComposite( const std::string &key,
+                               const std::vector<Range> &ranges,
+                               const std::string &recorded = "bucket/.upload" )
+    {
+      composite = mtpu / "bucket" / ".upload";
+      std::filesystem::create_directories( composite );
+
+      std::string content, manifest;
+      for( size_t i = 0; i < ranges.size(); ++i )
+      {
+        auto data = RandomData( ranges[i].length, i + 1 );
+        WriteAt( composite / ranges[i].path, ranges[i].offset, data );
+        content  += data;
+        manifest += std::to_string( ranges[i].offset ) + ' ' +
+                    std::to_string( ranges[i].length ) + ' ' + ranges[i].path + '\n';
+      }
+      WriteAt( composite / "manifest", 0, manifest );
+
+      auto path = bucket.path / key;
+      int fd = open( path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644 );
+      EXPECT_GE( fd, 0 );
+      EXPECT_EQ( ftruncate( fd, content.size() ), 0 );
+      close( fd );
+      EXPECT_EQ( S3Utils::SetXattr( path, "composite", recorded, 0 ), 0 );
+      return content;
+    }
+
+    //--------------------------------------------------------------------------
+    // Read the object from its current position in chunks of the given size
+    //--------------------------------------------------------------------------
+    static std::string ReadAll( S3ObjectStore::Object &obj, size_t chunk )
+    {
+      std::string data;
+      char *ptr = nullptr;
+      ssize_t n;
+      while( ( n = obj.Read( chunk, &ptr ) ) > 0 )
+        data.append( ptr, n );
+      EXPECT_EQ( n, 0 );
+      return data;
+    }
+
+    std::filesystem::path          root;
+    std::filesystem::path          mtpu;
+    std::filesystem::path          composite;
+    S3Auth::Bucket                 bucket;
+    std::unique_ptr<S3ObjectStore> store;
+
+    // Three parts, the second one stored within the optimized upload file
+    const std::vector<Range> ranges{ { "1", 0, 1000 }, { "opt", 300, 5000 },
+                                     { "3", 0, 3000 } };
+};
+
+//------------------------------------------------------------------------------
+// Reads that span the boundaries between parts return the data of the object
+//------------------------------------------------------------------------------
+TEST_F(S3CompositeObjectTest, ReadAcrossParts)
+{
+  auto content = MakeComposite( "obj", ranges );
+
+  S3ObjectStore::Object obj;
+  ASSERT_EQ( obj.Init( bucket.path / "obj", mtpu ), S3Error::None );
+  EXPECT_EQ( obj.GetSize(), static_cast<ssize_t>( content.size() ) );
+  EXPECT_EQ( ReadAll( obj, 777 ), content );
+
+  S3ObjectStore::Object whole;
+  ASSERT_EQ( whole.Init( bucket.path / "obj", mtpu ), S3Error::None );
+  EXPECT_EQ( ReadAll( whole, content.size() ), content );
+}
+
+//------------------------------------------------------------------------------
+// Seeking maps the position onto the right part
+//------------------------------------------------------------------------------
+TEST_F(S3CompositeObjectTest, SeekAcrossParts)
+{
+  auto content = MakeComposite( "obj", ranges );
+
+  S3ObjectStore::Object obj;
+  ASSERT_EQ( obj.Init( bucket.path / "obj", mtpu ), S3Error::None );
+
+  char *ptr = nullptr;
+  for( off_t offset : { 0, 995, 1000, 5990, 6000, 8990 } )
+  {
+    ASSERT_EQ( obj.Lseek( offset, SEEK_SET ), offset );
+    ssize_t n = obj.Read( 20, &ptr );
+    size_t expected = std::min<size_t>( 20, content.size() - offset );
+    ASSERT_EQ( n, static_cast<ssize_t>( expected ) ) << "at " << offset;
+    EXPECT_EQ( std::string( ptr, n ), content.substr( offset, expected ) )
+      << "at " << offset;
+  }
+
+  EXPECT_EQ( obj.Lseek( -10, SEEK_END ), static_cast<off_t>( content.size() - 10 ) );
+  EXPECT_EQ( obj.Lseek( -1000, SEEK_CUR ), static_cast<off_t>( content.size() - 1010 ) );
+  EXPECT_EQ( ReadAll( obj, 333 ), content.substr( content.size() - 1010 ) );
+  EXPECT_EQ( obj.Lseek( -1, SEEK_SET ), -1 );
+}
+
+//------------------------------------------------------------------------------
+// Composite directories recorded as absolute paths are still found
+//------------------------------------------------------------------------------
+TEST_F(S3CompositeObjectTest, AbsolutePath)
+{
+  auto content = MakeComposite( "obj", ranges,
+                                ( mtpu / "bucket" / ".upload" ).string() );
+
+  S3ObjectStore::Object obj;
+  ASSERT_EQ( obj.Init( bucket.path / "obj", mtpu ), S3Error::None );
+  EXPECT_EQ( ReadAll( obj, 4096 ), content );
+}
+
+//------------------------------------------------------------------------------
+// An object whose manifest does not add up to its size is refused
+//------------------------------------------------------------------------------
+TEST_F(S3CompositeObjectTest, SizeMismatch)
+{
+  MakeComposite( "obj", ranges );
+  ASSERT_EQ( truncate( ( bucket.path / "obj" ).c_str(), 8999 ), 0 );
+
+  S3ObjectStore::Object obj;
+  EXPECT_EQ( obj.Init( bucket.path / "obj", mtpu ), S3Error::InternalError );
+}
+
+//------------------------------------------------------------------------------
+// A part that cannot be opened while the object is still composite is an
+// error, not a reason to read the (all zero) object file
+//------------------------------------------------------------------------------
+TEST_F(S3CompositeObjectTest, MissingPart)
+{
+  auto content = MakeComposite( "obj", ranges );
+
+  S3ObjectStore::Object obj;
+  ASSERT_EQ( obj.Init( bucket.path / "obj", mtpu ), S3Error::None );
+  ASSERT_EQ( unlink( ( composite / "3" ).c_str() ), 0 );
+
+  char *ptr = nullptr;
+  ASSERT_EQ( obj.Read( 6000, &ptr ), 6000 );
+  EXPECT_EQ( std::string( ptr, 6000 ), content.substr( 0, 6000 ) );
+  EXPECT_EQ( obj.Read( 1000, &ptr ), -1 );
+}
+
+//------------------------------------------------------------------------------
+// An object made of small parts gets compacted into its object file once it
+// is used, and readers that opened it before keep getting the right data
+//------------------------------------------------------------------------------
+TEST_F(S3CompositeObjectTest, Compaction)
+{
+  auto content = MakeComposite( "obj", ranges );
+  auto path = bucket.path / "obj";
+
+  S3ObjectStore::Object before;
+  ASSERT_EQ( before.Init( path, mtpu ), S3Error::None );
+  char *ptr = nullptr;
+  ASSERT_EQ( before.Read( 500, &ptr ), 500 );
+  std::string read( ptr, 500 );
+
+  S3ObjectStore::Object obj;
+  ASSERT_EQ( store->GetObject( bucket, "obj", obj ), S3Error::None );
+  EXPECT_TRUE( obj.NeedsCompaction() );
+
+  for( int i = 0; i < 1000 && !S3Utils::GetXattr( path, "composite" ).empty(); ++i )
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+  ASSERT_TRUE( S3Utils::GetXattr( path, "composite" ).empty() );
+  EXPECT_FALSE( std::filesystem::exists( composite ) );
+  EXPECT_EQ( ReadFile( path ), content );
+
+  read += ReadAll( before, 700 );
+  EXPECT_EQ( read, content );
+
+  S3ObjectStore::Object after;
+  ASSERT_EQ( store->GetObject( bucket, "obj", after ), S3Error::None );
+  EXPECT_FALSE( after.NeedsCompaction() );
+  EXPECT_EQ( ReadAll( after, 4096 ), content );
+}
@@ -0,0 +1,234 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "XrdCks/XrdCksCalcmd5.hh"
+#include "XrdS3Crypt.hh"
+#include "XrdS3UploadPipeline.hh"
+
+using namespace S3;
+
+namespace
+{
+  std::string RandomData( size_t size, unsigned seed )
+  {
+    std::mt19937 gen( seed );
+    std::string data( size, 0 );
+    for( auto &c : data ) c = static_cast<char>( gen() );
+    return data;
+  }
+
+  std::string ReadFd( int fd )
+  {
+    std::string data;
+    char buff[65536];
+    ssize_t n;
+    off_t off = 0;
+    while( ( n = pread( fd, buff, sizeof( buff ), off ) ) > 0 )
+    {
+      data.append( buff, n );
+      off += n;
+    }
+    return data;
+  }
+
+  int Threads()
+  {
+    int n = 0;
+    DIR *dir = opendir( "/proc/self/task" );
+    if( !dir ) return -1;
+    while( struct dirent *ent = readdir( dir ) )
+      if( ent->d_name[0] != '.' ) ++n;
+    closedir( dir );
+    return n;
+  }
+
+  //----------------------------------------------------------------------------
+  // An upload to a temporary file, checked against the data given
+  //----------------------------------------------------------------------------
+  struct Upload
+  {
+    Upload()
+    {
+      char tmpl[] = "/tmp/xrds3-upload-XXXXXX";
+      fd = mkstemp( tmpl );
+      unlink( tmpl );
+      md5.Init();
+      sha256.Init();
+    }
+
+    ~Upload() { close( fd ); }
+
+    //--------------------------------------------------------------------------
+    // Push the data through a pipeline in pieces of the given size
+    //--------------------------------------------------------------------------
+    bool Run( const std::string &data, size_t piece )
+    {
+      S3UploadPipeline pipeline( md5, sha256, fd );
+      for( size_t off = 0; off < data.size(); off += piece )
+        if( !pipeline.Append( data.data() + off,
+                              std::min( piece, data.size() - off ) ) )
+          return false;
+      return pipeline.Finish();
+    }
+
+    void Check( const std::string &data )
+    {
+      XrdCksCalcmd5 refMD5;
+      refMD5.Init();
+      refMD5.Update( data.data(), data.size() );
+      S3Crypt::S3SHA256 refSHA;
+      refSHA.Init();
+      refSHA.Update( data.data(), data.size() );
+
+      EXPECT_EQ( ReadFd( fd ), data );
+      EXPECT_EQ( std::string( md5.Final(), 16 ),
+                 std::string( refMD5.Final(), 16 ) );
+      EXPECT_TRUE( sha256.Finish() == refSHA.Finish() );
+    }
+
+    int               fd;
+    XrdCksCalcmd5     md5;
+    S3Crypt::S3SHA256 sha256;
+  };
+}
+
+//------------------------------------------------------------------------------
+// An upload that fits in one buffer is processed on the calling thread
+//------------------------------------------------------------------------------
+TEST(S3UploadPipelineTest, SingleBuffer)
+{
+  for( size_t size : { size_t( 0 ), size_t( 1 ), size_t( 100000 ),
+                       S3UploadPipeline::kBufferSize } )
+  {
+    Upload upload;
+    auto data = RandomData( size, size + 1 );
+    ASSERT_TRUE( upload.Run( data, 8192 ) ) << size;
+    upload.Check( data );
+  }
+}
+
+//------------------------------------------------------------------------------
+// Uploads of many buffers, appended in pieces that do not line up with them,
+// come out hashed and written in order
+//------------------------------------------------------------------------------
+TEST(S3UploadPipelineTest, ManyBuffers)
+{
+  const size_t bsz = S3UploadPipeline::kBufferSize;
+  for( size_t size : { bsz + 1, 3 * bsz, 9 * bsz + 12345 } )
+  {
+    Upload upload;
+    auto data = RandomData( size, size );
+    ASSERT_TRUE( upload.Run( data, 100003 ) ) << size;
+    upload.Check( data );
+  }
+}
+
+//------------------------------------------------------------------------------
+// Concurrent uploads share a fixed set of worker threads rather than starting
+// threads of their own
+//------------------------------------------------------------------------------
+TEST(S3UploadPipelineTest, SharedWorkers)
+{
+  const int nUploads = 8;
+  ASSERT_GE( S3UploadPipeline::Workers(), 3u );
+  int base = Threads();
+  ASSERT_GT( base, 0 );
+
+  std::atomic<bool> done( false );
+  std::atomic<int> maxThreads( 0 );
+  std::thread sampler( [&]{
+    while( !done )
+    {
+      maxThreads = std::max( maxThreads.load(), Threads() );
+      std::this_thread::yield();
+    }
+  } );
+
+  auto data = RandomData( 6 * S3UploadPipeline::kBufferSize + 777, 42 );
+  std::vector<std::thread> uploaders;
+  std::atomic<int> ok( 0 );
+  for( int i = 0; i < nUploads; ++i )
+    uploaders.emplace_back( [&]{
+      Upload upload;
+      if( upload.Run( data, 65536 ) ) ++ok;
+      upload.Check( data );
+    } );
+  for( auto &t : uploaders ) t.join();
+  done = true;
+  sampler.join();
+
+  EXPECT_EQ( ok.load(), nUploads );
+  // The sampler and the uploaders are the only new threads
+  EXPECT_LE( maxThreads.load(), base + 1 + nUploads );
+}
+
+//------------------------------------------------------------------------------
+// A failed write fails the upload, without hanging the pipeline
+//------------------------------------------------------------------------------
+TEST(S3UploadPipelineTest, WriteFailure)
+{
+  char tmpl[] = "/tmp/xrds3-upload-XXXXXX";
+  int wfd = mkstemp( tmpl );
+  ASSERT_GE( wfd, 0 );
+  int fd = open( tmpl, O_RDONLY );
+  unlink( tmpl );
+  close( wfd );
+  ASSERT_GE( fd, 0 );
+
+  XrdCksCalcmd5 md5;
+  S3Crypt::S3SHA256 sha256;
+  sha256.Init();
+  auto data = RandomData( 10 * S3UploadPipeline::kBufferSize, 7 );
+  {
+    S3UploadPipeline pipeline( md5, sha256, fd );
+    bool ok = true;
+    for( size_t off = 0; ok && off < data.size(); off += 1000000 )
+      ok = pipeline.Append( data.data() + off,
+                            std::min<size_t>( 1000000, data.size() - off ) );
+    EXPECT_FALSE( ok && pipeline.Finish() );
+  }
+  close( fd );
+}
+
+//------------------------------------------------------------------------------
+// An upload abandoned half way, as when the client goes away, waits for the
+// workers to be done with it
+//------------------------------------------------------------------------------
+TEST(S3UploadPipelineTest, Abandoned)
+{
+  Upload upload;
+  auto data = RandomData( 5 * S3UploadPipeline::kBufferSize, 3 );
+  {
+    S3UploadPipeline pipeline( upload.md5, upload.sha256, upload.fd );
+    ASSERT_TRUE( pipeline.Append( data.data(), data.size() ) );
+  }
+  EXPECT_LE( ReadFd( upload.fd ).size(), data.size() );
+}
@@ -0,0 +1,276 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#include "XrdOuc/XrdOucErrInfo.hh"
+#include "XrdSfs/XrdSfsInterface.hh"
+#include "XrdSsi/XrdSsiFileReq.hh"
+#include "XrdSsi/XrdSsiFileResource.hh"
+#include "XrdSsi/XrdSsiResponder.hh"
+#include "XrdSsi/XrdSsiService.hh"
+#include "XrdSsi/XrdSsiStream.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+
+class XrdOucBuffPool;
+class XrdScheduler;
+
+//------------------------------------------------------------------------------
+// The plugin configuration used by the request and session objects
+//------------------------------------------------------------------------------
+namespace XrdSsi
+{
+extern XrdSysError Log;
+
+XrdOucBuffPool *BuffPool = 0;
+XrdScheduler   *Sched    = 0;
+XrdSsiService  *Service  = 0;
+int             respWT   = 0x7fffffff;
+int             minRSZ   = 8192;
+int             maxRSZ   = 2097152;
+}
+
+namespace
+{
+  XrdSysLogger logger;
+
+  //----------------------------------------------------------------------------
+  // A region of a file stream
+  //----------------------------------------------------------------------------
+  struct Region
+  {
+    long long offset;
+    long long length;
+  };
+
+  //----------------------------------------------------------------------------
+  // File stream handing out the given regions of one file. After the last
+  // region the stream either ends or fails.
+  //----------------------------------------------------------------------------
+  class TestFileStream : public XrdSsiFileStream
+  {
+    public:
+      TestFileStream( int fd, const std::vector<Region> &regions, bool fail ) :
+        fd( fd ), regions( regions ), fail( fail )
+      {
+      }
+
+      bool GetFile( XrdSsiErrInfo &eRef, int &fdnum, long long &foffs,
+                    long long &flen, bool &last ) override
+      {
+        ++calls;
+        if( next == regions.size() )
+        {
+          last = !fail;
+          if( fail ) eRef.Set( "Stream broke", EIO );
+          return false;
+        }
+        fdnum = fd;
+        foffs = regions[next].offset;
+        flen  = regions[next].length;
+        last  = ++next == regions.size() && !fail;
+        return true;
+      }
+
+      int                 calls = 0;
+
+    private:
+      int                 fd;
+      std::vector<Region> regions;
+      bool                fail;
+      size_t              next = 0;
+  };
+
+  //----------------------------------------------------------------------------
+  // Responder posting the stream as the response to the request
+  //----------------------------------------------------------------------------
+  class TestResponder : public XrdSsiResponder
+  {
+    public:
+      void Respond( XrdSsiRequest &req, XrdSsiStream *strm )
+      {
+        BindRequest( req );
+        SetResponse( strm );
+      }
+
+      void Finished( XrdSsiRequest &, const XrdSsiRespInfo &, bool ) override
+      {
+        UnBindRequest();
+      }
+  };
+
+  class TestService : public XrdSsiService
+  {
+    public:
+      void ProcessRequest( XrdSsiRequest &req, XrdSsiResource & ) override
+      {
+        responder.Respond( req, strm );
+      }
+
+      TestResponder  responder;
+      XrdSsiStream  *strm = nullptr;
+  };
+}
+
+//------------------------------------------------------------------------------
+// Requests answered with a file stream read through the copying path, as done
+// when the response cannot be sent with sendfile
+//------------------------------------------------------------------------------
+class XrdSsiFileStreamTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+      char tmpl[] = "/tmp/xrdssi-XXXXXX";
+      fd = mkstemp( tmpl );
+      ASSERT_GE( fd, 0 );
+      unlink( tmpl );
+      for( int i = 0; i < 4096; ++i ) data += static_cast<char>( 'a' + i % 26 );
+      ASSERT_EQ( write( fd, data.data(), data.size() ),
+                 static_cast<ssize_t>( data.size() ) );
+      XrdSsi::Service = &service;
+      XrdSsi::Log.logger( &logger );
+    }
+
+    void TearDown() override
+    {
+      if( req ) req->Finalize();
+      XrdSsi::Service = 0;
+      close( fd );
+    }
+
+    //--------------------------------------------------------------------------
+    // Issue a request answered by the given stream
+    //--------------------------------------------------------------------------
+    void Start( XrdSsiStream *strm )
+    {
+      service.strm = strm;
+      req = XrdSsiFileReq::Alloc( &eInfo, &resource, nullptr, "test", "test", 1 );
+      ASSERT_TRUE( req );
+      req->DoIt();
+    }
+
+    int                 fd = -1;
+    std::string         data;
+    TestService         service;
+    XrdSsiFileResource  resource;
+    XrdOucErrInfo       eInfo;
+    XrdSsiFileReq      *req = nullptr;
+};
+
+//------------------------------------------------------------------------------
+// A read spanning several regions gets the data of all of them
+//------------------------------------------------------------------------------
+TEST_F(XrdSsiFileStreamTest, ReadAcrossRegions)
+{
+  TestFileStream strm( fd, { { 100, 300 }, { 1000, 200 }, { 0, 50 } }, false );
+  Start( &strm );
+
+  std::string expected = data.substr( 100, 300 ) + data.substr( 1000, 200 ) +
+                         data.substr( 0, 50 );
+  std::string result;
+  char buff[256];
+  bool done = false;
+  while( !done )
+  {
+    XrdSfsXferSize n = req->Read( done, buff, sizeof( buff ) );
+    ASSERT_GE( n, 0 );
+    result.append( buff, n );
+  }
+  EXPECT_EQ( result, expected );
+}
+
+//------------------------------------------------------------------------------
+// An invalid region following valid ones: the data already copied is returned
+// and the error is reported by the next read
+//------------------------------------------------------------------------------
+TEST_F(XrdSsiFileStreamTest, InvalidRegionAfterData)
+{
+  TestFileStream strm( fd, { { 10, 100 }, { 500, 0 } }, true );
+  Start( &strm );
+
+  char buff[1024];
+  bool done = false;
+  ASSERT_EQ( req->Read( done, buff, sizeof( buff ) ), 100 );
+  EXPECT_FALSE( done );
+  EXPECT_EQ( std::string( buff, 100 ), data.substr( 10, 100 ) );
+
+  int calls = strm.calls;
+  EXPECT_EQ( req->Read( done, buff, sizeof( buff ) ), SFS_ERROR );
+  EXPECT_EQ( strm.calls, calls );
+  EXPECT_EQ( eInfo.getErrInfo(), EINVAL );
+  EXPECT_NE( std::string( eInfo.getErrText() ).find( "Invalid file region" ),
+             std::string::npos );
+}
+
+//------------------------------------------------------------------------------
+// A stream failing after some data: the data comes first, then the error
+//------------------------------------------------------------------------------
+TEST_F(XrdSsiFileStreamTest, StreamErrorAfterData)
+{
+  TestFileStream strm( fd, { { 0, 64 }, { 64, 64 } }, true );
+  Start( &strm );
+
+  char buff[1024];
+  bool done = false;
+  ASSERT_EQ( req->Read( done, buff, sizeof( buff ) ), 128 );
+  EXPECT_EQ( std::string( buff, 128 ), data.substr( 0, 128 ) );
+  EXPECT_EQ( req->Read( done, buff, sizeof( buff ) ), SFS_ERROR );
+  EXPECT_EQ( eInfo.getErrInfo(), EIO );
+  EXPECT_NE( std::string( eInfo.getErrText() ).find( "Stream broke" ),
+             std::string::npos );
+}
+
+//------------------------------------------------------------------------------
+// A region extending past the end of the file: the data up to the end is
+// returned, then the read error
+//------------------------------------------------------------------------------
+TEST_F(XrdSsiFileStreamTest, RegionPastEndOfFile)
+{
+  TestFileStream strm( fd, { { 4000, 1000 } }, false );
+  Start( &strm );
+
+  char buff[2048];
+  bool done = false;
+  ASSERT_EQ( req->Read( done, buff, sizeof( buff ) ), 96 );
+  EXPECT_EQ( std::string( buff, 96 ), data.substr( 4000 ) );
+  EXPECT_EQ( req->Read( done, buff, sizeof( buff ) ), SFS_ERROR );
+  EXPECT_EQ( eInfo.getErrInfo(), ENODATA );
+}
+
+//------------------------------------------------------------------------------
+// A stream failing before any data reports the error right away
+//------------------------------------------------------------------------------
+TEST_F(XrdSsiFileStreamTest, StreamErrorFirst)
+{
+  TestFileStream strm( fd, {}, true );
+  Start( &strm );
+
+  char buff[64];
+  bool done = false;
+  EXPECT_EQ( req->Read( done, buff, sizeof( buff ) ), SFS_ERROR );
+  EXPECT_EQ( eInfo.getErrInfo(), EIO );
+}
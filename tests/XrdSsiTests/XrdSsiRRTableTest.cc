@@ -0,0 +1,241 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "XrdSsi/XrdSsiPool.hh"
+#include "XrdSsi/XrdSsiRRTable.hh"
+
+namespace
+{
+std::atomic<int> liveReqs(0);
+
+class TestReq
+{
+public:
+
+void      Finalize() {finalized++;}
+
+TestReq  *poolNext;
+int       finalized;
+
+          TestReq() : poolNext(0), finalized(0) {liveReqs++;}
+         ~TestReq() {liveReqs--;}
+};
+}
+
+//------------------------------------------------------------------------------
+// The first request lives in the base slot, the others in the hash table.
+//------------------------------------------------------------------------------
+TEST(XrdSsiRRTableTest, BaseSlotAndTable)
+{
+  XrdSsiRRTable<TestReq> tab;
+  TestReq r1, r2, r3;
+
+  EXPECT_EQ(tab.LookUp(1), nullptr);
+  tab.Add(&r1, 1);
+  EXPECT_EQ(tab.Num(), 1);
+  EXPECT_EQ(tab.LookUp(1), &r1);
+  EXPECT_EQ(tab.LookUp(2), nullptr);
+
+  tab.Add(&r2, 2);
+  tab.Add(&r3, 3);
+  EXPECT_EQ(tab.Num(), 3);
+  EXPECT_EQ(tab.LookUp(2), &r2);
+  EXPECT_EQ(tab.LookUp(3), &r3);
+
+  tab.Del(1, true);
+  EXPECT_EQ(r1.finalized, 1);
+  EXPECT_EQ(tab.LookUp(1), nullptr);
+  EXPECT_EQ(tab.LookUp(2), &r2);
+  EXPECT_EQ(tab.Num(), 2);
+
+  tab.Del(42);
+  EXPECT_EQ(tab.Num(), 2);
+
+  tab.Reset();
+  EXPECT_EQ(r2.finalized, 1);
+  EXPECT_EQ(r3.finalized, 1);
+  EXPECT_EQ(tab.Num(), 0);
+}
+
+//------------------------------------------------------------------------------
+// Grow the table well past its initial size and delete in random order so
+// that backward shift deletion has to move entries across probe chains.
+//------------------------------------------------------------------------------
+TEST(XrdSsiRRTableTest, GrowAndDeleteRandomly)
+{
+  const int numReqs = 5000;
+  XrdSsiRRTable<TestReq> tab;
+  std::vector<TestReq> reqs(numReqs);
+  std::vector<uint64_t> ids;
+  std::set<uint64_t> present;
+  std::mt19937_64 rng(12345);
+
+  for (int i = 0; i < numReqs; i++)
+  {
+    uint64_t id = rng();
+    if (!present.insert(id).second) continue;
+    tab.Add(&reqs[ids.size()], id);
+    ids.push_back(id);
+  }
+  ASSERT_EQ(tab.Num(), static_cast<int>(ids.size()));
+
+  std::vector<size_t> order(ids.size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = i;
+  std::shuffle(order.begin(), order.end(), rng);
+
+  for (size_t n = 0; n < order.size(); n++)
+  {
+    size_t k = order[n];
+    ASSERT_EQ(tab.LookUp(ids[k]), &reqs[k]);
+    tab.Del(ids[k]);
+    present.erase(ids[k]);
+    ASSERT_EQ(tab.LookUp(ids[k]), nullptr);
+    if (n % 97 == 0)
+    {
+      for (size_t j = 0; j < ids.size(); j++)
+      {
+        if (present.count(ids[j]))
+        {
+          ASSERT_EQ(tab.LookUp(ids[j]), &reqs[j]) << "lost id " << ids[j];
+        }
+      }
+    }
+  }
+  EXPECT_EQ(tab.Num(), 0);
+}
+
+//------------------------------------------------------------------------------
+// Many threads share one table, as the streams of a single session do. One
+// long lived request sits in the base slot and is looked up lock-free while
+// the other threads add, look up and delete their own requests.
+//------------------------------------------------------------------------------
+TEST(XrdSsiRRTableTest, SharedTableUnderContention)
+{
+  const int numThreads = 8;
+  const int numIter    = 20000;
+  const int numInFlight = 4;
+  XrdSsiRRTable<TestReq> tab;
+  TestReq base;
+  std::atomic<bool> stop(false);
+  std::atomic<long long> misses(0);
+
+  tab.Add(&base, 0);
+
+  std::thread reader([&]
+  {
+    long long bad = 0;
+    while (!stop.load())
+      if (tab.LookUp(0) != &base) bad++;
+    misses += bad;
+  });
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < numThreads; t++)
+    workers.emplace_back([&, t]
+    {
+      std::vector<TestReq> reqs(numInFlight);
+      std::vector<uint64_t> inFlight(numInFlight, 0);
+      uint64_t seq = static_cast<uint64_t>(t + 1) << 40;
+      long long bad = 0;
+
+      for (int i = 0; i < numIter; i++)
+      {
+        int slot = i % numInFlight;
+        if (inFlight[slot])
+        {
+          if (tab.LookUp(inFlight[slot]) != &reqs[slot]) bad++;
+          tab.Del(inFlight[slot]);
+          if (tab.LookUp(inFlight[slot])) bad++;
+        }
+        inFlight[slot] = ++seq;
+        tab.Add(&reqs[slot], inFlight[slot]);
+        if (tab.LookUp(inFlight[slot]) != &reqs[slot]) bad++;
+      }
+      for (int slot = 0; slot < numInFlight; slot++)
+        tab.Del(inFlight[slot]);
+      misses += bad;
+    });
+
+  for (auto &w : workers) w.join();
+  stop = true;
+  reader.join();
+
+  EXPECT_EQ(misses.load(), 0);
+  EXPECT_EQ(tab.Num(), 1);
+  tab.Del(0);
+  EXPECT_EQ(tab.Num(), 0);
+}
+
+//------------------------------------------------------------------------------
+// Objects freed by one thread are reused by another and nothing is lost:
+// every object is either in use, in the pool, or deleted.
+//------------------------------------------------------------------------------
+TEST(XrdSsiPoolTest, ReuseAcrossThreads)
+{
+  const int numThreads = 4;
+  const int numIter    = 10000;
+  const int poolMax    = 64;
+  XrdSsiPool<TestReq> pool(poolMax, 8);
+  std::atomic<long long> allocs(0);
+
+  TestReq *rP = new TestReq;
+  allocs++;
+  pool.Put(rP);
+  EXPECT_EQ(pool.Get(), rP);
+  EXPECT_EQ(pool.Get(), nullptr);
+  pool.Put(rP);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++)
+    threads.emplace_back([&]
+    {
+      std::vector<TestReq *> held;
+      for (int i = 0; i < numIter; i++)
+      {
+        TestReq *item = pool.Get();
+        if (!item) {item = new TestReq; allocs++;}
+        held.push_back(item);
+        if (held.size() > 16)
+        {
+          for (auto *h : held) pool.Put(h);
+          held.clear();
+        }
+      }
+      for (auto *h : held) pool.Put(h);
+    });
+  for (auto &t : threads) t.join();
+
+  // Objects are reused rather than allocated for every request, and the
+  // pool never holds more than its global plus per-thread limits.
+  EXPECT_LT(allocs.load(), numThreads * numIter / 10);
+  EXPECT_LE(liveReqs.load(), poolMax + 8 + 1);
+
+  int drained = 0;
+  while ((rP = pool.Get())) {delete rP; drained++;}
+  EXPECT_EQ(liveReqs.load(), 0);
+  EXPECT_GT(drained, 0);
+}
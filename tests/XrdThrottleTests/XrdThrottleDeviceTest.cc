@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "XrdThrottle/XrdThrottleDevice.hh"
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Count the requests running against a device and remember the peak
+  //----------------------------------------------------------------------------
+  struct Gauge
+  {
+    std::atomic<int> current{0};
+    std::atomic<int> peak{0};
+
+    void Enter()
+    {
+      int now = ++current;
+      int prev = peak.load();
+      while( now > prev && !peak.compare_exchange_weak( prev, now ) ) { }
+    }
+
+    void Leave() { --current; }
+  };
+
+  void RunRequests( XrdThrottleDevice &dev, Gauge &gauge, int nthreads,
+                    int nrequests )
+  {
+    std::vector<std::thread> threads;
+    for( int t = 0; t < nthreads; ++t )
+      threads.emplace_back( [&]
+      {
+        for( int i = 0; i < nrequests; ++i )
+        {
+          XrdThrottleDevice::Guard guard( &dev );
+          gauge.Enter();
+          std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+          gauge.Leave();
+        }
+      } );
+    for( auto &t : threads ) t.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+// No more requests than the concurrency limit run against a device at once
+//------------------------------------------------------------------------------
+TEST(XrdThrottleDeviceTest, ConcurrencyLimit)
+{
+  XrdThrottleDevice dev( 1, 3, 0 );
+  Gauge gauge;
+  RunRequests( dev, gauge, 12, 20 );
+
+  EXPECT_EQ( gauge.peak.load(), 3 );
+
+  int active, waiting;
+  long long svc_us;
+  unsigned long long ops, waits, refused;
+  dev.Snapshot( active, waiting, svc_us, ops, waits, refused );
+  EXPECT_EQ( active, 0 );
+  EXPECT_EQ( waiting, 0 );
+  EXPECT_EQ( ops, 12u * 20u );
+  EXPECT_GT( waits, 0u );
+  EXPECT_EQ( refused, 0u );
+  EXPECT_GE( svc_us, 1000 );
+}
+
+//------------------------------------------------------------------------------
+// Each device has its own limit: two devices loaded at the same time each run
+// up to their own limit
+//------------------------------------------------------------------------------
+TEST(XrdThrottleDeviceTest, ConcurrencyPerDevice)
+{
+  XrdThrottleDevice dev1( 1, 2, 0 ), dev2( 2, 4, 0 );
+  Gauge gauge1, gauge2;
+  std::thread t1( [&]{ RunRequests( dev1, gauge1, 8, 20 ); } );
+  std::thread t2( [&]{ RunRequests( dev2, gauge2, 8, 20 ); } );
+  t1.join();
+  t2.join();
+
+  EXPECT_EQ( gauge1.peak.load(), 2 );
+  EXPECT_EQ( gauge2.peak.load(), 4 );
+}
+
+//------------------------------------------------------------------------------
+// A saturated device only holds up requests against itself
+//------------------------------------------------------------------------------
+TEST(XrdThrottleDeviceTest, SaturatedDeviceIsolated)
+{
+  XrdThrottleDevice busy( 1, 1, 0 ), idle( 2, 1, 0 );
+  std::unique_ptr<XrdThrottleDevice::Guard> held( new XrdThrottleDevice::Guard( &busy ) );
+
+  auto onBusy = std::async( std::launch::async, [&]{ XrdThrottleDevice::Guard g( &busy ); } );
+  auto onIdle = std::async( std::launch::async, [&]{ XrdThrottleDevice::Guard g( &idle ); } );
+
+  EXPECT_EQ( onIdle.wait_for( std::chrono::seconds( 5 ) ), std::future_status::ready );
+  EXPECT_EQ( onBusy.wait_for( std::chrono::milliseconds( 100 ) ), std::future_status::timeout );
+
+  held.reset();
+  EXPECT_EQ( onBusy.wait_for( std::chrono::seconds( 5 ) ), std::future_status::ready );
+}
+
+//------------------------------------------------------------------------------
+// The queue depth is bounded by how much the device can drain in the maximum
+// wait, once its service time is known
+//------------------------------------------------------------------------------
+TEST(XrdThrottleDeviceTest, QueueBound)
+{
+  XrdThrottleDevice dev( 1, 2, 100 );
+  EXPECT_EQ( dev.MaxQueue(), -1 );
+  EXPECT_FALSE( dev.Overloaded() );
+
+  dev.Acquire();
+  dev.Release( std::chrono::milliseconds( 10 ) );
+  EXPECT_EQ( dev.MaxQueue(), 20 );
+
+  XrdThrottleDevice unbounded( 2, 2, 0 );
+  unbounded.Acquire();
+  unbounded.Release( std::chrono::milliseconds( 10 ) );
+  EXPECT_EQ( unbounded.MaxQueue(), -1 );
+}
+
+//------------------------------------------------------------------------------
+// A guard without a device does nothing
+//------------------------------------------------------------------------------
+TEST(XrdThrottleDeviceTest, NullDevice)
+{
+  XrdThrottleDevice::Guard guard( nullptr );
+}
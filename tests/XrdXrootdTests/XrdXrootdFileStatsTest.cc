@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+// This file is part of the XRootD software suite.
+//
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "XrdXrootd/XrdXrootdFileStats.hh"
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Sum of the buckets of a histogram
+  //----------------------------------------------------------------------------
+  template<size_t N>
+  unsigned int Total( const kXR_unt32 (&hist)[N] )
+  {
+    unsigned int total = 0;
+    for( size_t i = 0; i < N; ++i ) total += hist[i];
+    return total;
+  }
+}
+
+//------------------------------------------------------------------------------
+// File statistics with the histograms enabled, as set up by the monitor
+//------------------------------------------------------------------------------
+class XrdXrootdFileStatsTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+      stats.monLvl = XrdXrootdFileStats::monOn;
+      stats.hst = new XrdXrootdMonStatHST;
+      memset( stats.hst, 0, sizeof( XrdXrootdMonStatHST ) );
+    }
+
+    XrdXrootdFileStats stats;
+};
+
+//------------------------------------------------------------------------------
+// Requests are sequential when they start where the previous one ended
+//------------------------------------------------------------------------------
+TEST_F(XrdXrootdFileStatsTest, SequentialAndRandom)
+{
+  stats.rdOps( 4096, 0 );
+  stats.rdOps( 4096, 4096 );
+  stats.rdOps( 1024, 100000 );
+  stats.pgrOps( 1024, 101024 );
+  stats.wrOps( 512, 0 );
+  stats.pgwOps( 512, 512 );
+  stats.wrOps( 512, 0 );
+
+  EXPECT_EQ( stats.hst->rdSeq, 2u );
+  EXPECT_EQ( stats.hst->rdRnd, 2u );
+  EXPECT_EQ( stats.hst->wrSeq, 1u );
+  EXPECT_EQ( stats.hst->wrRnd, 2u );
+  EXPECT_EQ( stats.hst->rdSize[0], 0u );
+  EXPECT_EQ( stats.hst->rdSize[1], 2u );
+  EXPECT_EQ( stats.hst->rdSize[3], 2u );
+  EXPECT_EQ( stats.hst->wrSize[0], 3u );
+}
+
+//------------------------------------------------------------------------------
+// A writev has no single offset, it is counted but kept out of the histograms
+//------------------------------------------------------------------------------
+TEST_F(XrdXrootdFileStatsTest, WriteV)
+{
+  stats.wvOps( 8192, 4 );
+  EXPECT_EQ( stats.ops.write, 1 );
+  EXPECT_EQ( Total( stats.hst->wrSize ), 0u );
+  EXPECT_EQ( stats.hst->wrSeq + stats.hst->wrRnd, 0u );
+}
+
+//------------------------------------------------------------------------------
+// readv elements have their own size histogram and do not affect the
+// sequential/random split of the reads
+//------------------------------------------------------------------------------
+TEST_F(XrdXrootdFileStatsTest, ReadVCountedSeparately)
+{
+  stats.rdOps( 4096, 0 );
+  for( int i = 0; i < 10; ++i ) stats.hstReadV( 64 * 1024 );
+  stats.rvOps( 10 * 64 * 1024, 10 );
+  stats.rdOps( 4096, 4096 );
+
+  EXPECT_EQ( Total( stats.hst->rdSize ), 2u );
+  EXPECT_EQ( Total( stats.hst->rvSize ), 10u );
+  EXPECT_EQ( stats.hst->rvSize[7], 10u );
+  EXPECT_EQ( stats.hst->rvSegs[3], 1u );
+  EXPECT_EQ( stats.hst->rdSeq, 1u );
+  EXPECT_EQ( stats.hst->rdRnd, 1u );
+}
+
+//------------------------------------------------------------------------------
+// Service times are only measured when histograms are kept
+//------------------------------------------------------------------------------
+TEST(XrdXrootdFileStats, NoHistograms)
+{
+  XrdXrootdFileStats stats;
+  stats.monLvl = XrdXrootdFileStats::monOn;
+  EXPECT_EQ( stats.hstStart(), 0 );
+  stats.rdTime( 0 );
+  stats.hstReadV( 1024 );
+  stats.rdOps( 1024, 0 );
+  EXPECT_EQ( stats.ops.read, 1 );
+}
+
+//------------------------------------------------------------------------------
+// Asynchronous completions record their service times from other threads
+// while requests keep being issued and the histograms are being reported
+//------------------------------------------------------------------------------
+TEST_F(XrdXrootdFileStatsTest, ConcurrentUpdates)
+{
+  const int nThreads = 4, nOps = 20000;
+  std::vector<std::thread> threads;
+  for( int t = 0; t < nThreads; ++t )
+    threads.emplace_back( [this, nOps]{
+      for( int i = 0; i < nOps; ++i )
+        stats.rdTime( XrdXrootdFileStats::hstClock() );
+    } );
+  threads.emplace_back( [this, nOps]{
+    for( int i = 0; i < nOps; ++i )
+    {
+      long long tBeg = stats.hstStart();
+      stats.hstRead( 4096, 4096LL * i );
+      stats.hstReadV( 1024 );
+      stats.rdTime( tBeg );
+    }
+  } );
+  threads.emplace_back( [this, nOps]{
+    XrdXrootdMonStatHST copy;
+    for( int i = 0; i < nOps / 100; ++i )
+    {
+      stats.hstCopy( copy );
+      EXPECT_LE( copy.rdSeq + copy.rdRnd, Total( copy.rdSize ) );
+    }
+  } );
+  for( auto &t : threads ) t.join();
+
+  EXPECT_EQ( Total( stats.hst->rdTime ), unsigned( ( nThreads + 1 ) * nOps ) );
+  EXPECT_EQ( Total( stats.hst->rdSize ), unsigned( nOps ) );
+  EXPECT_EQ( Total( stats.hst->rvSize ), unsigned( nOps ) );
+  EXPECT_EQ( stats.hst->rdSeq, unsigned( nOps - 1 ) );
+  EXPECT_EQ( stats.hst->rdRnd, 1u );
+}